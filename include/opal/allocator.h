@@ -208,6 +208,20 @@ struct OPAL_EXPORT PushScratch
     ~PushScratch();
 };
 
+/**
+ * Remembers the position of the current scratch allocator and resets it to that position when destroyed, which frees
+ * everything allocated from it in between.
+ */
+struct OPAL_EXPORT ScratchScope
+{
+    ScratchScope();
+    ~ScratchScope();
+
+private:
+    LinearAllocator* m_allocator = nullptr;
+    u64 m_mark = 0;
+};
+
 template <typename T, class... Args>
 T* New(AllocatorBase* allocator, Args&&... args)
 {
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstring>
+
+#include "opal/container/expected.h"
+#include "opal/error-codes.h"
+#include "opal/export.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+/** Number of characters that is always enough for decimal ToChars of any integer and ToChars of any floating point value. */
+inline constexpr u64 k_max_to_chars_size = 32;
+
+namespace Impl
+{
+
+/** Two decimal digits for every number in [0, 100). */
+inline constexpr char8 k_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+inline u32 CountDecimalDigits(u64 value)
+{
+    u32 count = 1;
+    for (;;)
+    {
+        if (value < 10)
+        {
+            return count;
+        }
+        if (value < 100)
+        {
+            return count + 1;
+        }
+        if (value < 1000)
+        {
+            return count + 2;
+        }
+        if (value < 10000)
+        {
+            return count + 3;
+        }
+        value /= 10000;
+        count += 4;
+    }
+}
+
+/** Writes the decimal digits of @p value so that the last digit ends up right before @p end. */
+inline void WriteDecimalDigitsBackwards(char8* end, u64 value)
+{
+    while (value >= 100)
+    {
+        const u64 pair = (value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        std::memcpy(end, k_digit_pairs + pair, 2);
+    }
+    if (value >= 10)
+    {
+        std::memcpy(end - 2, k_digit_pairs + value * 2, 2);
+    }
+    else
+    {
+        *(end - 1) = static_cast<char8>('0' + value);
+    }
+}
+
+OPAL_EXPORT Expected<char8*, ErrorCode> IntegerToChars(char8* first, char8* last, u64 magnitude, bool is_negative, i32 base);
+
+/** Parses a magnitude of at most @p max_magnitude, or @p max_magnitude + 1 for negative numbers. */
+OPAL_EXPORT Expected<const char8*, ErrorCode> CharsToInteger(const char8* first, const char8* last, u64 max_magnitude, bool is_signed,
+                                                             i32 base, u64& out_magnitude, bool& out_is_negative);
+
+}  // namespace Impl
+
+/**
+ * Write @p value to [first, last) without a null terminator. Decimal conversion writes two digits at a time from a lookup table.
+ * @param first Start of the output buffer.
+ * @param last End of the output buffer.
+ * @param value Value to convert. Negative values start with '-'.
+ * @param base Base in range [2, 36]. Digits larger than 9 are written in lower case.
+ * @return Pointer one past the last written character. ErrorCode::InsufficientSpace when the buffer is too small, in which
+ * case the content of the buffer is unspecified. ErrorCode::InvalidArgument when the base is out of range.
+ */
+template <Integral T>
+Expected<char8*, ErrorCode> ToChars(char8* first, char8* last, T value, i32 base = 10)
+{
+    u64 magnitude = 0;
+    bool is_negative = false;
+    if constexpr (SignedIntegral<T>)
+    {
+        const i64 wide = static_cast<i64>(value);
+        is_negative = wide < 0;
+        // Negating in unsigned arithmetic also works for the minimum value.
+        magnitude = is_negative ? 0 - static_cast<u64>(wide) : static_cast<u64>(wide);
+    }
+    else
+    {
+        magnitude = static_cast<u64>(value);
+    }
+    if (base == 10)
+    {
+        const u32 digit_count = Impl::CountDecimalDigits(magnitude);
+        const u64 size = digit_count + (is_negative ? 1 : 0);
+        if (static_cast<u64>(last - first) < size)
+        {
+            return Expected<char8*, ErrorCode>(ErrorCode::InsufficientSpace);
+        }
+        if (is_negative)
+        {
+            *first = '-';
+        }
+        Impl::WriteDecimalDigitsBackwards(first + size, magnitude);
+        return Expected<char8*, ErrorCode>(first + size);
+    }
+    return Impl::IntegerToChars(first, last, magnitude, is_negative, base);
+}
+
+/**
+ * Write the shortest decimal representation of @p value that parses back to exactly the same value, like std::to_chars
+ * without a format. Fixed notation is used unless scientific notation is shorter. The digits are computed with the
+ * Schubfach algorithm, which never needs more than 128-bit integer arithmetic.
+ * @return Pointer one past the last written character or ErrorCode::InsufficientSpace when the buffer is too small. A
+ * buffer of k_max_to_chars_size characters is always large enough.
+ */
+OPAL_EXPORT Expected<char8*, ErrorCode> ToChars(char8* first, char8* last, f64 value);
+OPAL_EXPORT Expected<char8*, ErrorCode> ToChars(char8* first, char8* last, f32 value);
+
+/** Number of characters that, plus the precision, is always enough for ToCharsFixed of any floating point value. */
+inline constexpr u64 k_max_fixed_to_chars_size = 312;
+
+/**
+ * Write @p value in fixed notation with exactly @p precision digits after the decimal point, rounded to nearest, like
+ * printf("%.*f") in the "C" locale. The decimal separator is always '.', whatever the current locale is.
+ * @return Pointer one past the last written character, ErrorCode::InvalidArgument when @p precision is negative or
+ * ErrorCode::InsufficientSpace when the buffer is too small. A buffer of k_max_fixed_to_chars_size + @p precision
+ * characters is always large enough.
+ */
+OPAL_EXPORT Expected<char8*, ErrorCode> ToCharsFixed(char8* first, char8* last, f64 value, i32 precision);
+OPAL_EXPORT Expected<char8*, ErrorCode> ToCharsFixed(char8* first, char8* last, f32 value, i32 precision);
+
+/**
+ * Parse an integer at the start of [first, last). Accepts an optional '-' for signed types followed by digits, no
+ * whitespace, '+' or base prefixes.
+ * @param first Start of the input.
+ * @param last End of the input.
+ * @param out_value Receives the parsed value. Left untouched on error.
+ * @param base Base in range [2, 36]. Letters are case-insensitive.
+ * @return Pointer to the first character that is not part of the number. ErrorCode::InvalidArgument when the input does
+ * not start with a number, ErrorCode::OutOfBounds when the number does not fit into @p T.
+ */
+template <Integral T>
+Expected<const char8*, ErrorCode> FromChars(const char8* first, const char8* last, T& out_value, i32 base = 10)
+{
+    constexpr u64 k_all_bits = ~0ull >> (64 - sizeof(T) * 8);
+    constexpr u64 k_max_magnitude = SignedIntegral<T> ? k_all_bits >> 1 : k_all_bits;
+    u64 magnitude = 0;
+    bool is_negative = false;
+    Expected<const char8*, ErrorCode> result =
+        Impl::CharsToInteger(first, last, k_max_magnitude, SignedIntegral<T>, base, magnitude, is_negative);
+    if (result.HasValue())
+    {
+        out_value = is_negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+    }
+    return result;
+}
+
+/**
+ * Parse a decimal floating point number at the start of [first, last), rounded to the nearest representable value.
+ * Accepts an optional '-', digits with an optional fraction and an optional exponent, as well as "inf", "infinity" and
+ * "nan" in any case. Uses the Eisel-Lemire algorithm, which needs a single 128-bit multiplication in the common case.
+ * @param out_value Receives the parsed value. Left untouched on error.
+ * @return Pointer to the first character that is not part of the number. ErrorCode::InvalidArgument when the input does
+ * not start with a number, ErrorCode::OutOfBounds when the number is too large for @p out_value.
+ */
+OPAL_EXPORT Expected<const char8*, ErrorCode> FromChars(const char8* first, const char8* last, f64& out_value);
+OPAL_EXPORT Expected<const char8*, ErrorCode> FromChars(const char8* first, const char8* last, f32& out_value);
+
+}  // namespace Opal
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "opal/allocator.h"
+#include "opal/assert.h"
+#include "opal/bit.h"
+#include "opal/export.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+/**
+ * Variable-length set of bits stored in 64-bit words. Bulk operations (And, Or, Xor, AndNot, PopCount and searching)
+ * process whole words and use SSE2 or AVX2 when the target supports them.
+ *
+ * Bits past GetSize() in the last word are always zero, so word level operations never have to mask them.
+ */
+class OPAL_EXPORT DynamicBitSet
+{
+public:
+    using size_type = u64;
+    using word_type = u64;
+    using allocator_type = AllocatorBase;
+
+    static constexpr size_type k_bits_per_word = 64;
+    static constexpr size_type k_npos = static_cast<size_type>(-1);
+
+    /**
+     * Iterates over indices of the set bits in increasing order.
+     */
+    class SetBitIterator
+    {
+    public:
+        SetBitIterator(const word_type* words, size_type word_index, size_type word_count);
+
+        size_type operator*() const { return m_word_index * k_bits_per_word + CountTrailingZeros(m_current_word); }
+
+        SetBitIterator& operator++();
+
+        bool operator==(const SetBitIterator& other) const
+        {
+            return m_word_index == other.m_word_index && m_current_word == other.m_current_word;
+        }
+
+    private:
+        void SkipEmptyWords();
+
+        const word_type* m_words;
+        size_type m_word_index;
+        size_type m_word_count;
+        word_type m_current_word = 0;
+    };
+
+    explicit DynamicBitSet(allocator_type* allocator = nullptr);
+
+    /**
+     * Create a bitset with @p size bits.
+     * @param size Number of bits.
+     * @param value Initial value of all bits.
+     * @param allocator Allocator to be used for memory allocation. If nullptr, the default allocator will be used.
+     */
+    explicit DynamicBitSet(size_type size, bool value = false, allocator_type* allocator = nullptr);
+
+    DynamicBitSet(const DynamicBitSet&) = delete;
+    DynamicBitSet(DynamicBitSet&& other) noexcept;
+
+    ~DynamicBitSet();
+
+    DynamicBitSet& operator=(const DynamicBitSet&) = delete;
+    DynamicBitSet& operator=(DynamicBitSet&& other) noexcept;
+
+    /**
+     * Create a deep copy of the bitset.
+     * @param allocator Allocator to be used for the clone. If nullptr, the source bitset's allocator will be used.
+     * @return New bitset with the same bits.
+     */
+    DynamicBitSet Clone(allocator_type* allocator = nullptr) const;
+
+    bool operator==(const DynamicBitSet& other) const;
+
+    [[nodiscard]] size_type GetSize() const { return m_size; }
+    [[nodiscard]] size_type GetCapacity() const { return m_word_capacity * k_bits_per_word; }
+    [[nodiscard]] size_type GetWordCount() const { return GetWordCount(m_size); }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+    [[nodiscard]] allocator_type* GetAllocator() const { return m_allocator; }
+
+    /**
+     * Get the underlying words. Bit i is stored in word i / 64 at position i % 64.
+     */
+    [[nodiscard]] word_type* GetData() { return m_words; }
+    [[nodiscard]] const word_type* GetData() const { return m_words; }
+
+    /**
+     * Make sure the bitset can hold at least @p capacity bits without reallocating.
+     * @param capacity Number of bits. Rounded up to a whole number of cache lines.
+     */
+    void Reserve(size_type capacity);
+
+    /**
+     * Change the number of bits.
+     * @param size New number of bits.
+     * @param value Value of the bits that are added when the bitset grows.
+     */
+    void Resize(size_type size, bool value = false);
+
+    /**
+     * Remove all bits. Capacity is not changed.
+     */
+    void Clear() { m_size = 0; }
+
+    [[nodiscard]] bool Test(size_type index) const
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        return (m_words[index / k_bits_per_word] & GetBit(index)) != 0;
+    }
+    [[nodiscard]] bool operator[](size_type index) const { return Test(index); }
+
+    void Set(size_type index)
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        m_words[index / k_bits_per_word] |= GetBit(index);
+    }
+    void Set(size_type index, bool value)
+    {
+        if (value)
+        {
+            Set(index);
+        }
+        else
+        {
+            Reset(index);
+        }
+    }
+    void Reset(size_type index)
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        m_words[index / k_bits_per_word] &= ~GetBit(index);
+    }
+    void Flip(size_type index)
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        m_words[index / k_bits_per_word] ^= GetBit(index);
+    }
+
+    /** Set all bits to 1. */
+    void SetAll();
+
+    /** Set all bits to 0. */
+    void ResetAll();
+
+    /** Invert all bits. */
+    void FlipAll();
+
+    /**
+     * Bitwise operations with another bitset of the same size. The result is stored in this bitset.
+     * @throw InvalidArgumentException When the sizes of the bitsets are not the same.
+     */
+    DynamicBitSet& And(const DynamicBitSet& other);
+    DynamicBitSet& Or(const DynamicBitSet& other);
+    DynamicBitSet& Xor(const DynamicBitSet& other);
+    /** Clears every bit that is set in @p other. */
+    DynamicBitSet& AndNot(const DynamicBitSet& other);
+
+    /**
+     * Count the set bits.
+     * @return Number of bits set to 1.
+     */
+    [[nodiscard]] size_type PopCount() const;
+
+    /**
+     * Count the set bits in range [begin, end).
+     * @param begin Index of the first bit in the range.
+     * @param end Index one past the last bit in the range.
+     * @return Number of bits set to 1 in the range.
+     * @throw OutOfBoundsException When the range is not inside the bitset.
+     */
+    [[nodiscard]] size_type PopCount(size_type begin, size_type end) const;
+
+    [[nodiscard]] bool Any() const { return FindFirstSet() != k_npos; }
+    [[nodiscard]] bool None() const { return !Any(); }
+    [[nodiscard]] bool All() const { return PopCount() == m_size; }
+
+    /**
+     * Find the index of the first set bit.
+     * @return Index of the first set bit or k_npos if no bit is set.
+     */
+    [[nodiscard]] size_type FindFirstSet() const { return FindNextSet(0); }
+
+    /**
+     * Find the index of the first set bit at or after @p index.
+     * @param index Index to start the search from.
+     * @return Index of the set bit or k_npos if there are no set bits at or after @p index.
+     */
+    [[nodiscard]] size_type FindNextSet(size_type index) const;
+
+    SetBitIterator begin() const { return SetBitIterator(m_words, 0, GetWordCount()); }
+    SetBitIterator end() const { return SetBitIterator(m_words, GetWordCount(), GetWordCount()); }
+
+private:
+    static size_type GetWordCount(size_type bit_count) { return (bit_count + k_bits_per_word - 1) / k_bits_per_word; }
+    static word_type GetBit(size_type index) { return 1ull << (index % k_bits_per_word); }
+
+    void ClearUnusedBits();
+    void ThrowIfSizeMismatch(const DynamicBitSet& other, const char* function) const;
+
+    allocator_type* m_allocator = nullptr;
+    word_type* m_words = nullptr;
+    size_type m_size = 0;
+    size_type m_word_capacity = 0;
+};
+
+}  // namespace Opal
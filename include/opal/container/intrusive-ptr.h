@@ -0,0 +1,240 @@
+#pragma once
+
+#include "opal/allocator.h"
+#include "opal/container/shared-ptr.h"
+#include "opal/exceptions.h"
+
+namespace Opal
+{
+
+template <typename T>
+class IntrusivePtr;
+
+/**
+ * Base class for objects that embed their own reference count and can be owned by IntrusivePtr.
+ *
+ * The reference count and the allocator that created the object are stored inside the object, so an IntrusivePtr is a
+ * single pointer and creating an object needs one allocation. Objects must be created through IntrusivePtr or
+ * MakeIntrusive, which record the allocator that is used to destroy them.
+ *
+ * @tparam Policy Threading policy of the reference count. When set to ThreadingPolicy::ThreadSafe (the default), the count
+ *         is an atomic variable and the allocator must be thread-safe. When set to ThreadingPolicy::SingleThread, the count
+ *         is a plain integer.
+ */
+template <ThreadingPolicy Policy = ThreadingPolicy::ThreadSafe>
+class RefCounted
+{
+    using RefCountOps = Impl::RefCountType<Policy>;
+
+public:
+    static constexpr ThreadingPolicy k_threading_policy = Policy;
+
+    RefCounted(const RefCounted&) = delete;
+    RefCounted& operator=(const RefCounted&) = delete;
+
+    /**
+     * Returns the number of IntrusivePtr instances that own this object. When the object is shared between threads,
+     * the value can be outdated by the time it is returned.
+     */
+    [[nodiscard]] size_t GetReferenceCount() const { return RefCountOps::Load(&m_refcount); }
+
+    /** Returns the allocator that created the object and will be used to destroy it. */
+    [[nodiscard]] AllocatorBase* GetOwningAllocator() const { return m_allocator; }
+
+protected:
+    RefCounted() { RefCountOps::Store(&m_refcount, 0); }
+    ~RefCounted() = default;
+
+private:
+    template <typename T>
+    friend class IntrusivePtr;
+
+    void InitializeReference(AllocatorBase* allocator)
+    {
+        m_allocator = allocator;
+        RefCountOps::Store(&m_refcount, 1);
+    }
+    void AcquireReference() const { RefCountOps::Increment(&m_refcount); }
+    /** @return True if the last reference was released. */
+    bool ReleaseReference() const { return RefCountOps::DecrementAndGet(&m_refcount) == 1; }
+
+    mutable typename RefCountOps::Type m_refcount;
+    AllocatorBase* m_allocator = nullptr;
+};
+
+/**
+ * Reference counting pointer to objects that derive from RefCounted.
+ *
+ * Behaves like SharedPtr, but the reference count lives inside the object. The pointer itself is the size of a raw
+ * pointer and sharing ownership touches only the cache line of the object.
+ *
+ * Copy construction and copy assignment are deleted. Use Clone() to create a new pointer that shares ownership. Move
+ * construction and move assignment are supported.
+ *
+ * When the pointer type is a base class of the created object, the base class must have a virtual destructor, same as
+ * with SharedPtr created from a raw pointer.
+ *
+ * @tparam T Object type. Must derive from RefCounted.
+ */
+template <typename T>
+class IntrusivePtr
+{
+public:
+    /** Default constructor. Creates an invalid pointer that holds no object. */
+    IntrusivePtr() = default;
+
+    /**
+     * Constructs the managed object in-place.
+     * @param allocator Allocator used for the object. If nullptr, the default allocator is used.
+     * @param args Arguments forwarded to the constructor of T.
+     * @throws InvalidArgumentException If T uses ThreadingPolicy::ThreadSafe and the allocator is not thread-safe.
+     */
+    template <typename... Args>
+    explicit IntrusivePtr(AllocatorBase* allocator, Args&&... args)
+    {
+        if (allocator == nullptr)
+        {
+            allocator = GetDefaultAllocator();
+        }
+        if constexpr (T::k_threading_policy == ThreadingPolicy::ThreadSafe)
+        {
+            if (!allocator->IsThreadSafe())
+            {
+                throw InvalidArgumentException("IntrusivePtr", "Allocator should be thread-safe");
+            }
+        }
+        m_object = New<T>(allocator, std::forward<Args>(args)...);
+        m_object->InitializeReference(allocator);
+    }
+
+    /** Destructor. Releases the reference and destroys the managed object if this was the last owner. */
+    ~IntrusivePtr() { Reset(); }
+
+    IntrusivePtr(const IntrusivePtr&) = delete;
+    IntrusivePtr& operator=(const IntrusivePtr&) = delete;
+
+    /** Move constructor. Transfers ownership from other, leaving other in an invalid state. */
+    IntrusivePtr(IntrusivePtr&& other) noexcept : m_object(other.m_object) { other.m_object = nullptr; }
+
+    /**
+     * Converting move constructor. Transfers ownership from an IntrusivePtr of a convertible type.
+     * @tparam U Source type, must be convertible to T*.
+     */
+    template <typename U>
+        requires Convertible<U*, T*>
+    explicit IntrusivePtr(IntrusivePtr<U>&& other) noexcept : m_object(static_cast<T*>(other.m_object))
+    {
+        other.m_object = nullptr;
+    }
+
+    /** Move assignment operator. Releases the current object (if any) and transfers ownership from other. */
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        Reset();
+        m_object = other.m_object;
+        other.m_object = nullptr;
+        return *this;
+    }
+
+    T* operator->() { return m_object; }
+    const T* operator->() const { return m_object; }
+
+    T& operator*() { return *m_object; }
+    const T& operator*() const { return *m_object; }
+
+    /**
+     * Creates a new IntrusivePtr that shares ownership of the managed object. The reference count is incremented.
+     * If this pointer is invalid, the returned clone is also invalid.
+     * @param allocator Ignored. The object is always freed by the allocator that created it. This parameter exists for
+     *        API compatibility with Opal::Clone(source, allocator).
+     * @return A new IntrusivePtr that points to the same object.
+     */
+    IntrusivePtr Clone([[maybe_unused]] AllocatorBase* allocator = nullptr) const
+    {
+        IntrusivePtr clone;
+        if (m_object != nullptr)
+        {
+            m_object->AcquireReference();
+            clone.m_object = m_object;
+        }
+        return clone;
+    }
+
+    /**
+     * Releases ownership of the managed object. If this was the last owner, the object is destroyed.
+     * After this call, the pointer is in an invalid state.
+     */
+    void Reset()
+    {
+        if (m_object != nullptr && m_object->ReleaseReference())
+        {
+            Delete(m_object->GetOwningAllocator(), m_object);
+        }
+        m_object = nullptr;
+    }
+
+    /**
+     * Gives up ownership without releasing the reference. The pointer becomes invalid and the caller is responsible for
+     * handing the reference back with Adopt(). Used to pass ownership through lock-free structures that can only hold
+     * raw pointers.
+     * @return The managed object, or nullptr if the pointer is invalid.
+     */
+    [[nodiscard]] T* Detach()
+    {
+        T* object = m_object;
+        m_object = nullptr;
+        return object;
+    }
+
+    /**
+     * Takes over a reference that was given up with Detach(). The reference count is not changed.
+     * @param object Object returned by Detach(). Can be nullptr.
+     */
+    [[nodiscard]] static IntrusivePtr Adopt(T* object)
+    {
+        IntrusivePtr ptr;
+        ptr.m_object = object;
+        return ptr;
+    }
+
+    [[nodiscard]] bool IsValid() const { return m_object != nullptr; }
+
+    /** Two pointers are equal if they point to the same object. */
+    bool operator==(const IntrusivePtr& other) const { return m_object == other.m_object; }
+
+    T* Get() { return m_object; }
+    const T* Get() const { return m_object; }
+
+    Ref<T> GetRef() { return Ref<T>(m_object); }
+    Ref<const T> GetRef() const { return Ref<const T>(m_object); }
+
+    Ref<T> ToRef() { return Ref<T>(m_object); }
+    Ref<const T> ToRef() const { return Ref<const T>(m_object); }
+
+private:
+    template <typename U>
+    friend class IntrusivePtr;
+
+    T* m_object = nullptr;
+};
+
+/**
+ * Constructs an object of type Derived and returns an IntrusivePtr<Base>.
+ * @tparam Base Base type for the returned IntrusivePtr.
+ * @tparam Derived Type to construct. Must be convertible to Base*. Defaults to Base.
+ * @param allocator Allocator used for the object. If nullptr, the default allocator is used.
+ * @param args Arguments forwarded to the constructor of Derived.
+ * @return IntrusivePtr<Base> owning the newly constructed Derived object.
+ */
+template <typename Base, typename Derived = Base, typename... Args>
+    requires Convertible<Derived*, Base*>
+IntrusivePtr<Base> MakeIntrusive(AllocatorBase* allocator, Args&&... args)
+{
+    return IntrusivePtr<Base>(IntrusivePtr<Derived>(allocator, std::forward<Args>(args)...));
+}
+
+}  // namespace Opal
@@ -4,7 +4,7 @@
 #include "opal/casts.h"
 #include "opal/container/dynamic-array.h"
 #include "opal/container/hash-map.h"
-#include "opal/container/shared-ptr.h"
+#include "opal/container/intrusive-ptr.h"
 #include "opal/container/string-view.h"
 #include "opal/container/string.h"
 #include "opal/exceptions.h"
@@ -59,9 +59,11 @@ enum class JsonType : u8
 };
 
 class JsonValue;
+struct JsonArrayStorage;
+struct JsonObjectStorage;
 
-using JsonArray = SharedPtr<DynamicArray<JsonValue>, ThreadingPolicy::SingleThread>;
-using JsonObject = SharedPtr<HashMap<StringViewUtf8, JsonValue>, ThreadingPolicy::SingleThread>;
+using JsonArray = IntrusivePtr<JsonArrayStorage>;
+using JsonObject = IntrusivePtr<JsonObjectStorage>;
 
 // ------------------------------------------------------------------------------------------------
 // JsonValue.
@@ -261,6 +263,22 @@ private:
     VariantType m_data;
 };
 
+/**
+ * Elements of a JSON array. The reference count is embedded, so JsonArray is a single pointer and an array node is
+ * created with one allocation.
+ */
+struct JsonArrayStorage : RefCounted<ThreadingPolicy::SingleThread>, DynamicArray<JsonValue>
+{
+};
+
+/**
+ * Members of a JSON object. The reference count is embedded, so JsonObject is a single pointer and an object node is
+ * created with one allocation.
+ */
+struct JsonObjectStorage : RefCounted<ThreadingPolicy::SingleThread>, HashMap<StringViewUtf8, JsonValue>
+{
+};
+
 // ------------------------------------------------------------------------------------------------
 // JsonReader.
 // ------------------------------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "opal/container/json-reader.h"
+#include "opal/container/string-builder.h"
 #include "opal/container/string.h"
 #include "opal/export.h"
 
@@ -54,6 +55,16 @@ public:
     static StringUtf8 Serialize(const JsonValue& value, const JsonWriteOptions& options,
                                 AllocatorBase* allocator = nullptr);
 
+    /**
+     * Serialize a JsonValue by appending to a StringBuilder. Large documents are written without reallocating and
+     * copying the text that was already produced.
+     * @param value    The JSON value to serialize.
+     * @param output   Builder to append the JSON text to.
+     * @param options  Formatting options (pretty print, indent width, tabs vs spaces).
+     * @throws JsonSerializeException if the value contains NaN or Infinity.
+     */
+    static void Serialize(const JsonValue& value, StringBuilder& output, const JsonWriteOptions& options = {});
+
     JsonWriter(const JsonWriter&) = delete;
     JsonWriter& operator=(const JsonWriter&) = delete;
     JsonWriter(JsonWriter&&) = delete;
@@ -0,0 +1,480 @@
+#pragma once
+
+#include <cstring>
+
+#include "opal/allocator.h"
+#include "opal/assert.h"
+#include "opal/bit.h"
+#include "opal/container/array-view.h"
+#include "opal/container/expected.h"
+#include "opal/error-codes.h"
+#include "opal/exceptions.h"
+#include "opal/math-base.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+/**
+ * What a RingBuffer does when a new element is pushed while it is full.
+ */
+enum class RingBufferOverflowPolicy : u8
+{
+    /** Drop the oldest element to make room for the new one. */
+    OverwriteOldest,
+    /** Keep the existing elements and refuse the new one. */
+    Reject,
+};
+
+/**
+ * Pair of views that together cover a region of a ring buffer that may wrap around the end of the storage. Elements in
+ * `first` come before elements in `second`. `second` is empty when the region does not wrap.
+ */
+template <typename T>
+struct RingBufferViews
+{
+    ArrayView<T> first;
+    ArrayView<T> second;
+
+    [[nodiscard]] u64 GetSize() const { return first.GetSize() + second.GetSize(); }
+};
+
+/**
+ * Bounded FIFO buffer with a fixed, power of two capacity. Unlike Deque it never grows, and unlike the SPSC channel it
+ * never blocks: when full it either overwrites the oldest element or rejects the new one, based on the overflow policy.
+ *
+ * Elements are copied with memcpy, so bulk operations (PushRange, PopRange) cost at most two memcpy calls each. The
+ * readable region can be accessed without copying through GetReadViews and then released with Consume, which allows
+ * draining the buffer directly into a file or a network sink.
+ *
+ * The container does no internal synchronization. Use it from a single thread or protect it with a Mutex.
+ *
+ * @tparam T Type of the elements. Must be trivially copyable.
+ */
+template <typename T>
+    requires IsTriviallyCopyable<T>
+class RingBuffer
+{
+public:
+    using value_type = T;
+    using allocator_type = AllocatorBase;
+    using size_type = u64;
+    using difference_type = i64;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+
+    /**
+     * Construct an empty ring buffer.
+     * @param capacity Maximum number of elements. Rounded up to the next power of two.
+     * @param policy What to do when pushing to a full buffer.
+     * @param allocator Allocator to be used for memory allocation. If nullptr, the default allocator will be used.
+     * @throw InvalidArgumentException when capacity is 0.
+     * @throw OutOfMemoryException when allocator runs out of memory.
+     */
+    explicit RingBuffer(size_type capacity, RingBufferOverflowPolicy policy = RingBufferOverflowPolicy::OverwriteOldest,
+                        allocator_type* allocator = nullptr);
+
+    RingBuffer(RingBuffer&& other) noexcept;
+    RingBuffer& operator=(RingBuffer&& other) noexcept;
+
+    ~RingBuffer();
+
+    /**
+     * Create a copy of this ring buffer with the same capacity, policy and elements.
+     * @param allocator Allocator to be used for the clone. If nullptr, the source buffer's allocator will be used.
+     * @return New ring buffer.
+     */
+    RingBuffer Clone(AllocatorBase* allocator = nullptr) const;
+
+    [[nodiscard]] size_type GetSize() const { return m_write_idx - m_read_idx; }
+    [[nodiscard]] size_type GetCapacity() const { return m_capacity; }
+    [[nodiscard]] bool IsEmpty() const { return m_write_idx == m_read_idx; }
+    [[nodiscard]] bool empty() const { return IsEmpty(); }
+    [[nodiscard]] bool IsFull() const { return GetSize() == m_capacity; }
+
+    [[nodiscard]] RingBufferOverflowPolicy GetOverflowPolicy() const { return m_policy; }
+    allocator_type* GetAllocator() const { return m_allocator; }
+
+    /**
+     * Number of elements that were dropped because of the overwrite policy since the construction or the last Clear.
+     */
+    [[nodiscard]] size_type GetOverwrittenCount() const { return m_overwritten_count; }
+
+    /**
+     * Get the element at the given position, where 0 is the oldest element. No bounds checking.
+     */
+    reference operator[](size_type index);
+    const_reference operator[](size_type index) const;
+
+    /**
+     * Get the oldest element.
+     * @return Reference to the oldest element, or ErrorCode::OutOfBounds if the buffer is empty.
+     */
+    Expected<T&, ErrorCode> Front();
+    [[nodiscard]] Expected<const T&, ErrorCode> Front() const;
+
+    /**
+     * Get the newest element.
+     * @return Reference to the newest element, or ErrorCode::OutOfBounds if the buffer is empty.
+     */
+    Expected<T&, ErrorCode> Back();
+    [[nodiscard]] Expected<const T&, ErrorCode> Back() const;
+
+    /**
+     * Add an element to the back of the buffer.
+     * @param value Value to add.
+     * @return ErrorCode::Success, or ErrorCode::InsufficientSpace if the buffer is full and the policy is Reject.
+     */
+    ErrorCode PushBack(const T& value);
+
+    /**
+     * Add a range of elements to the back of the buffer. With the OverwriteOldest policy all elements are accepted, and
+     * if the range is larger than the capacity only its last GetCapacity() elements are kept. With the Reject policy
+     * only as many elements as there is free space are added.
+     * @param values Elements to add.
+     * @return Number of elements from the range that were written to the buffer.
+     */
+    size_type PushRange(ArrayView<const T> values);
+
+    /**
+     * Remove the oldest element from the buffer.
+     * @return The removed element, or ErrorCode::OutOfBounds if the buffer is empty.
+     */
+    Expected<T, ErrorCode> PopFront();
+
+    /**
+     * Move up to out.GetSize() oldest elements into the output view.
+     * @param out Destination for the elements.
+     * @return Number of elements written to the output.
+     */
+    size_type PopRange(ArrayView<T> out);
+
+    /**
+     * Get views that cover all elements currently in the buffer, oldest first. The views stay valid until the next
+     * modification of the buffer.
+     */
+    RingBufferViews<T> GetReadViews();
+    RingBufferViews<const T> GetReadViews() const;
+
+    /**
+     * Remove up to `count` oldest elements without copying them. Usually called after the data from GetReadViews was
+     * processed.
+     * @param count Number of elements to remove.
+     * @return Number of elements actually removed.
+     */
+    size_type Consume(size_type count);
+
+    /**
+     * Remove all elements and reset the overwrite counter. Does not deallocate memory.
+     */
+    void Clear();
+
+private:
+    [[nodiscard]] size_type GetMask() const { return m_capacity - 1; }
+
+    template <typename U>
+    RingBufferViews<U> MakeViews(U* data, size_type start, size_type count) const;
+
+    void CopyIn(size_type write_idx, const T* src, size_type count);
+    void CopyOut(size_type read_idx, T* dst, size_type count) const;
+
+    allocator_type* m_allocator = nullptr;
+    T* m_data = nullptr;
+    size_type m_capacity = 0;
+    size_type m_read_idx = 0;
+    size_type m_write_idx = 0;
+    size_type m_overwritten_count = 0;
+    RingBufferOverflowPolicy m_policy = RingBufferOverflowPolicy::OverwriteOldest;
+};
+
+}  // namespace Opal
+
+/*************************************************************************************************/
+/***************************************** Implementation ****************************************/
+/*************************************************************************************************/
+
+#define TEMPLATE_HEADER \
+    template <typename T> \
+        requires Opal::IsTriviallyCopyable<T>
+#define CLASS_HEADER Opal::RingBuffer<T>
+
+TEMPLATE_HEADER
+CLASS_HEADER::RingBuffer(size_type capacity, RingBufferOverflowPolicy policy, allocator_type* allocator)
+    : m_allocator(allocator == nullptr ? GetDefaultAllocator() : allocator), m_policy(policy)
+{
+    if (capacity == 0)
+    {
+        throw InvalidArgumentException("RingBuffer", "capacity", capacity);
+    }
+    m_capacity = GetNextPowerOf2(capacity);
+    m_data = static_cast<T*>(m_allocator->Alloc(m_capacity * sizeof(T), alignof(T)));
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER::RingBuffer(RingBuffer&& other) noexcept
+    : m_allocator(other.m_allocator),
+      m_data(other.m_data),
+      m_capacity(other.m_capacity),
+      m_read_idx(other.m_read_idx),
+      m_write_idx(other.m_write_idx),
+      m_overwritten_count(other.m_overwritten_count),
+      m_policy(other.m_policy)
+{
+    other.m_data = nullptr;
+    other.m_capacity = 0;
+    other.m_read_idx = 0;
+    other.m_write_idx = 0;
+    other.m_overwritten_count = 0;
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER& CLASS_HEADER::operator=(RingBuffer&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    if (m_data != nullptr)
+    {
+        m_allocator->Free(m_data);
+    }
+    m_allocator = other.m_allocator;
+    m_data = other.m_data;
+    m_capacity = other.m_capacity;
+    m_read_idx = other.m_read_idx;
+    m_write_idx = other.m_write_idx;
+    m_overwritten_count = other.m_overwritten_count;
+    m_policy = other.m_policy;
+    other.m_data = nullptr;
+    other.m_capacity = 0;
+    other.m_read_idx = 0;
+    other.m_write_idx = 0;
+    other.m_overwritten_count = 0;
+    return *this;
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER::~RingBuffer()
+{
+    if (m_data != nullptr)
+    {
+        m_allocator->Free(m_data);
+        m_data = nullptr;
+    }
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER CLASS_HEADER::Clone(AllocatorBase* allocator) const
+{
+    RingBuffer clone(m_capacity, m_policy, allocator == nullptr ? m_allocator : allocator);
+    CopyOut(m_read_idx, clone.m_data, GetSize());
+    clone.m_write_idx = GetSize();
+    clone.m_overwritten_count = m_overwritten_count;
+    return clone;
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::reference CLASS_HEADER::operator[](size_type index)
+{
+    OPAL_ASSERT(index < GetSize(), "Index out of bounds");
+    return m_data[(m_read_idx + index) & GetMask()];
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::const_reference CLASS_HEADER::operator[](size_type index) const
+{
+    OPAL_ASSERT(index < GetSize(), "Index out of bounds");
+    return m_data[(m_read_idx + index) & GetMask()];
+}
+
+TEMPLATE_HEADER
+Opal::Expected<T&, Opal::ErrorCode> CLASS_HEADER::Front()
+{
+    if (IsEmpty())
+    {
+        return Expected<T&, ErrorCode>(ErrorCode::OutOfBounds);
+    }
+    return Expected<T&, ErrorCode>(m_data[m_read_idx & GetMask()]);
+}
+
+TEMPLATE_HEADER
+Opal::Expected<const T&, Opal::ErrorCode> CLASS_HEADER::Front() const
+{
+    if (IsEmpty())
+    {
+        return Expected<const T&, ErrorCode>(ErrorCode::OutOfBounds);
+    }
+    return Expected<const T&, ErrorCode>(m_data[m_read_idx & GetMask()]);
+}
+
+TEMPLATE_HEADER
+Opal::Expected<T&, Opal::ErrorCode> CLASS_HEADER::Back()
+{
+    if (IsEmpty())
+    {
+        return Expected<T&, ErrorCode>(ErrorCode::OutOfBounds);
+    }
+    return Expected<T&, ErrorCode>(m_data[(m_write_idx - 1) & GetMask()]);
+}
+
+TEMPLATE_HEADER
+Opal::Expected<const T&, Opal::ErrorCode> CLASS_HEADER::Back() const
+{
+    if (IsEmpty())
+    {
+        return Expected<const T&, ErrorCode>(ErrorCode::OutOfBounds);
+    }
+    return Expected<const T&, ErrorCode>(m_data[(m_write_idx - 1) & GetMask()]);
+}
+
+TEMPLATE_HEADER
+Opal::ErrorCode CLASS_HEADER::PushBack(const T& value)
+{
+    if (IsFull())
+    {
+        if (m_policy == RingBufferOverflowPolicy::Reject)
+        {
+            return ErrorCode::InsufficientSpace;
+        }
+        ++m_read_idx;
+        ++m_overwritten_count;
+    }
+    m_data[m_write_idx & GetMask()] = value;
+    ++m_write_idx;
+    return ErrorCode::Success;
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::size_type CLASS_HEADER::PushRange(ArrayView<const T> values)
+{
+    const T* src = values.GetData();
+    size_type count = values.GetSize();
+    if (m_policy == RingBufferOverflowPolicy::Reject)
+    {
+        count = Min(count, m_capacity - GetSize());
+    }
+    else if (count > m_capacity)
+    {
+        // Only the last m_capacity elements of the range survive, so skip the rest and drop the current content.
+        const size_type skipped = count - m_capacity;
+        m_overwritten_count += skipped + GetSize();
+        m_read_idx = m_write_idx;
+        src += skipped;
+        count = m_capacity;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+    const size_type free_space = m_capacity - GetSize();
+    if (count > free_space)
+    {
+        m_overwritten_count += count - free_space;
+        m_read_idx += count - free_space;
+    }
+    CopyIn(m_write_idx, src, count);
+    m_write_idx += count;
+    return m_policy == RingBufferOverflowPolicy::Reject ? count : values.GetSize();
+}
+
+TEMPLATE_HEADER
+Opal::Expected<T, Opal::ErrorCode> CLASS_HEADER::PopFront()
+{
+    if (IsEmpty())
+    {
+        return Expected<T, ErrorCode>(ErrorCode::OutOfBounds);
+    }
+    T value = m_data[m_read_idx & GetMask()];
+    ++m_read_idx;
+    return Expected<T, ErrorCode>(value);
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::size_type CLASS_HEADER::PopRange(ArrayView<T> out)
+{
+    const size_type count = Min(out.GetSize(), GetSize());
+    if (count == 0)
+    {
+        return 0;
+    }
+    CopyOut(m_read_idx, out.GetData(), count);
+    m_read_idx += count;
+    return count;
+}
+
+TEMPLATE_HEADER
+Opal::RingBufferViews<T> CLASS_HEADER::GetReadViews()
+{
+    return MakeViews(m_data, m_read_idx, GetSize());
+}
+
+TEMPLATE_HEADER
+Opal::RingBufferViews<const T> CLASS_HEADER::GetReadViews() const
+{
+    return MakeViews(static_cast<const T*>(m_data), m_read_idx, GetSize());
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::size_type CLASS_HEADER::Consume(size_type count)
+{
+    count = Min(count, GetSize());
+    m_read_idx += count;
+    return count;
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::Clear()
+{
+    m_read_idx = 0;
+    m_write_idx = 0;
+    m_overwritten_count = 0;
+}
+
+TEMPLATE_HEADER
+template <typename U>
+Opal::RingBufferViews<U> CLASS_HEADER::MakeViews(U* data, size_type start, size_type count) const
+{
+    RingBufferViews<U> views;
+    if (count == 0)
+    {
+        return views;
+    }
+    const size_type offset = start & GetMask();
+    const size_type first_count = Min(count, m_capacity - offset);
+    views.first = ArrayView<U>(data + offset, first_count);
+    if (first_count < count)
+    {
+        views.second = ArrayView<U>(data, count - first_count);
+    }
+    return views;
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::CopyIn(size_type write_idx, const T* src, size_type count)
+{
+    const size_type offset = write_idx & GetMask();
+    const size_type first_count = Min(count, m_capacity - offset);
+    memcpy(m_data + offset, src, first_count * sizeof(T));
+    if (first_count < count)
+    {
+        memcpy(m_data, src + first_count, (count - first_count) * sizeof(T));
+    }
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::CopyOut(size_type read_idx, T* dst, size_type count) const
+{
+    const size_type offset = read_idx & GetMask();
+    const size_type first_count = Min(count, m_capacity - offset);
+    memcpy(dst, m_data + offset, first_count * sizeof(T));
+    if (first_count < count)
+    {
+        memcpy(dst + first_count, m_data, (count - first_count) * sizeof(T));
+    }
+}
+
+#undef TEMPLATE_HEADER
+#undef CLASS_HEADER
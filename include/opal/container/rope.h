@@ -0,0 +1,232 @@
+#pragma once
+
+#include <iterator>
+
+#include "opal/allocator.h"
+#include "opal/container/intrusive-ptr.h"
+#include "opal/container/string-view.h"
+#include "opal/container/string.h"
+#include "opal/export.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+namespace Impl
+{
+
+/**
+ * Immutable text shared by the leaves that were cut out of it.
+ */
+struct RopeBuffer : RefCounted<>
+{
+    explicit RopeBuffer(StringUtf8&& in_text) : text(std::move(in_text)) {}
+
+    StringUtf8 text;
+};
+
+/**
+ * Node of a Rope. Leaves point to a range of a RopeBuffer, inner nodes concatenate their children. Nodes are never
+ * modified after they are created, so ropes share them freely.
+ */
+struct RopeNode : RefCounted<>
+{
+    /** Creates a leaf. */
+    RopeNode(IntrusivePtr<RopeBuffer> in_buffer, const char8* in_data, u64 in_size)
+        : buffer(std::move(in_buffer)), data(in_data), size(in_size)
+    {
+    }
+
+    /** Creates an inner node. */
+    RopeNode(IntrusivePtr<RopeNode> in_left, IntrusivePtr<RopeNode> in_right);
+
+    [[nodiscard]] bool IsLeaf() const { return !left.IsValid(); }
+
+    IntrusivePtr<RopeNode> left;
+    IntrusivePtr<RopeNode> right;
+    IntrusivePtr<RopeBuffer> buffer;
+    const char8* data = nullptr;
+    u64 size = 0;
+    /** Zero for leaves, one more than the highest child for inner nodes. */
+    u32 height = 0;
+};
+
+}  // namespace Impl
+
+/**
+ * Forward iterator over the leaves of a Rope. Dereferencing gives a view of one contiguous piece of the text.
+ */
+class OPAL_EXPORT RopeChunkIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = StringViewUtf8;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = StringViewUtf8;
+
+    /** Ropes never get this high, a balanced tree of this height holds more leaves than fit into memory. */
+    static constexpr u32 k_max_height = 96;
+
+    RopeChunkIterator() = default;
+    explicit RopeChunkIterator(const Impl::RopeNode* root);
+
+    StringViewUtf8 operator*() const
+    {
+        const Impl::RopeNode* leaf = m_stack[m_depth - 1];
+        return {leaf->data, leaf->size};
+    }
+
+    RopeChunkIterator& operator++();
+    RopeChunkIterator operator++(int)
+    {
+        RopeChunkIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    /** Iterators are equal when they stopped at the same position, which also tells apart leaves that are shared. */
+    bool operator==(const RopeChunkIterator& other) const;
+
+private:
+    void DescendLeft(const Impl::RopeNode* node);
+
+    /** Right subtrees that are still to be visited, with the current leaf on top. */
+    const Impl::RopeNode* m_stack[k_max_height] = {};
+    u32 m_depth = 0;
+};
+
+/** Leaves of a Rope, for use in range-based for loops. */
+struct RopeChunkRange
+{
+    RopeChunkIterator first;
+    RopeChunkIterator last;
+
+    [[nodiscard]] RopeChunkIterator begin() const { return first; }
+    [[nodiscard]] RopeChunkIterator end() const { return last; }
+};
+
+/**
+ * UTF-8 text stored as a balanced tree of chunks, for very large text that is edited in place.
+ *
+ * Leaves are views into immutable buffers, and nodes are shared between ropes instead of copied. Insert, Erase, Append,
+ * SubRope and At take O(log n) time no matter how large the text is, and Clone is O(1). Text is only copied when it is
+ * added to the rope, when small neighbouring leaves are merged and when the rope is converted with ToString().
+ *
+ * The tree is kept balanced with AVL rules: the heights of the two children of a node differ by at most one.
+ *
+ * Positions and sizes are in code units. Nodes are reference counted with atomic counters, so the allocator must be
+ * thread-safe and ropes that share nodes can be used from different threads.
+ */
+class OPAL_EXPORT Rope
+{
+public:
+    using value_type = char8;
+    using size_type = u64;
+    using allocator_type = AllocatorBase;
+
+    static constexpr size_type k_npos = static_cast<size_type>(-1);
+    /** Text added to the rope is cut into leaves of at most this size. */
+    static constexpr size_type k_max_leaf_size = 2048;
+    /** Neighbouring leaves are merged into a new leaf when their combined size is at most this size. */
+    static constexpr size_type k_merge_leaf_size = 512;
+
+    /**
+     * @param allocator Allocator used for nodes and buffers. If nullptr, the default allocator is used.
+     * @throw InvalidArgumentException When the allocator is not thread-safe.
+     */
+    explicit Rope(allocator_type* allocator = nullptr);
+
+    /**
+     * Creates a rope with a copy of @p str.
+     * @param str Initial text.
+     * @param allocator Allocator used for nodes and buffers. If nullptr, the default allocator is used.
+     * @throw InvalidArgumentException When the allocator is not thread-safe.
+     */
+    explicit Rope(StringViewUtf8 str, allocator_type* allocator = nullptr);
+
+    Rope(const Rope&) = delete;
+    Rope& operator=(const Rope&) = delete;
+
+    Rope(Rope&& other) noexcept = default;
+    Rope& operator=(Rope&& other) noexcept = default;
+
+    ~Rope() = default;
+
+    /**
+     * Create a rope with the same text. The clone shares all nodes with this rope, so this is O(1).
+     * @param allocator Allocator for nodes created by later edits of the clone. If nullptr, the allocator of this rope is used.
+     */
+    [[nodiscard]] Rope Clone(allocator_type* allocator = nullptr) const;
+
+    [[nodiscard]] size_type GetSize() const { return m_root.IsValid() ? m_root->size : 0; }
+    [[nodiscard]] bool IsEmpty() const { return !m_root.IsValid(); }
+    [[nodiscard]] allocator_type* GetAllocator() const { return m_allocator; }
+
+    /** Returns the height of the tree. Zero when the rope is empty or has a single leaf. */
+    [[nodiscard]] u32 GetHeight() const { return m_root.IsValid() ? m_root->height : 0; }
+
+    /**
+     * Get the code unit at @p pos in O(log n).
+     * @throw OutOfBoundsException When @p pos is not smaller than the size.
+     */
+    [[nodiscard]] char8 At(size_type pos) const;
+
+    /**
+     * Insert @p str before the code unit at @p pos.
+     * @throw OutOfBoundsException When @p pos is larger than the size.
+     */
+    void Insert(size_type pos, StringViewUtf8 str);
+
+    /**
+     * Insert the text of @p other before the code unit at @p pos. The nodes of @p other are shared, not copied.
+     * @throw OutOfBoundsException When @p pos is larger than the size.
+     */
+    void Insert(size_type pos, const Rope& other);
+
+    /**
+     * Remove @p count code units starting at @p pos. The count is clamped to the end of the rope.
+     * @throw OutOfBoundsException When @p pos is larger than the size.
+     */
+    void Erase(size_type pos, size_type count = k_npos);
+
+    void Append(StringViewUtf8 str);
+
+    /** Append the text of @p other. The nodes of @p other are shared, not copied. */
+    void Append(const Rope& other);
+
+    /**
+     * Get @p count code units starting at @p pos as a new rope that shares nodes with this one. The count is clamped to
+     * the end of the rope.
+     * @throw OutOfBoundsException When @p pos is larger than the size.
+     */
+    [[nodiscard]] Rope SubRope(size_type pos, size_type count = k_npos) const;
+
+    void Clear() { m_root.Reset(); }
+
+    /**
+     * Copy the text into a string.
+     * @param allocator Allocator of the returned string. If nullptr, the default allocator is used.
+     */
+    [[nodiscard]] StringUtf8 ToString(allocator_type* allocator = nullptr) const;
+
+    /** Returns the leaves in text order. */
+    [[nodiscard]] RopeChunkRange GetChunks() const { return {RopeChunkIterator(m_root.Get()), RopeChunkIterator()}; }
+
+private:
+    using NodePtr = IntrusivePtr<Impl::RopeNode>;
+
+    NodePtr MakeTree(StringViewUtf8 str) const;
+
+    allocator_type* m_allocator = nullptr;
+    NodePtr m_root;
+};
+
+/**
+ * Find the first occurrence of @p needle in @p haystack at or after @p start_pos. Matches that cross leaf boundaries are
+ * found as well.
+ * @return Position of the match or Rope::k_npos if there is none.
+ */
+OPAL_EXPORT Rope::size_type Find(const Rope& haystack, StringViewUtf8 needle, Rope::size_type start_pos = 0);
+
+}  // namespace Opal
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <new>
 
 #include "opal/allocator.h"
 #include "opal/exceptions.h"
@@ -26,8 +27,23 @@ struct RefCountType<ThreadingPolicy::ThreadSafe>
     using Type = std::atomic<size_t>;
 
     static void Store(Type* refcount, size_t value) { refcount->store(value, std::memory_order_relaxed); }
+    static size_t Load(const Type* refcount) { return refcount->load(std::memory_order_relaxed); }
     static void Increment(Type* refcount) { refcount->fetch_add(1, std::memory_order_relaxed); }
+    static void Add(Type* refcount, size_t count) { refcount->fetch_add(count, std::memory_order_relaxed); }
     static size_t DecrementAndGet(Type* refcount) { return refcount->fetch_sub(1, std::memory_order_acq_rel); }
+    static size_t SubtractAndGet(Type* refcount, size_t count) { return refcount->fetch_sub(count, std::memory_order_acq_rel); }
+    static bool IncrementIfNotZero(Type* refcount)
+    {
+        size_t count = refcount->load(std::memory_order_relaxed);
+        while (count != 0)
+        {
+            if (refcount->compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 template <>
@@ -36,17 +52,175 @@ struct RefCountType<ThreadingPolicy::SingleThread>
     using Type = size_t;
 
     static void Store(Type* refcount, size_t value) { *refcount = value; }
+    static size_t Load(const Type* refcount) { return *refcount; }
     static void Increment(Type* refcount) { ++(*refcount); }
+    static void Add(Type* refcount, size_t count) { *refcount += count; }
     static size_t DecrementAndGet(Type* refcount)
     {
         const size_t prev = *refcount;
         --(*refcount);
         return prev;
     }
+    static size_t SubtractAndGet(Type* refcount, size_t count)
+    {
+        const size_t prev = *refcount;
+        *refcount -= count;
+        return prev;
+    }
+    static bool IncrementIfNotZero(Type* refcount)
+    {
+        if (*refcount == 0)
+        {
+            return false;
+        }
+        ++(*refcount);
+        return true;
+    }
 };
 
+enum class SharedControlOperation : u8
+{
+    DestroyObject,
+    FreeBlock,
+    GetObject,
+};
+
+/**
+ * Bookkeeping shared by all SharedPtr and WeakPtr instances that refer to the same object.
+ *
+ * refcount counts SharedPtr owners. weak_refcount counts WeakPtr instances plus one that is held collectively by all
+ * SharedPtr owners. The object is destroyed when refcount drops to zero and the block is freed when weak_refcount does.
+ * The manage function knows the real type of the object and of the block, so a SharedPtr<Base> can release an object
+ * created as Derived.
+ */
+template <ThreadingPolicy Policy>
+struct SharedControlBlock
+{
+    using RefCountOps = RefCountType<Policy>;
+
+    void Initialize(AllocatorBase* in_allocator)
+    {
+        allocator = in_allocator;
+        RefCountOps::Store(&refcount, 1);
+        RefCountOps::Store(&weak_refcount, 1);
+    }
+
+    void AcquireStrong() { RefCountOps::Increment(&refcount); }
+    void ReleaseStrong(size_t count = 1)
+    {
+        if (RefCountOps::SubtractAndGet(&refcount, count) == count)
+        {
+            manage(this, SharedControlOperation::DestroyObject);
+            ReleaseWeak();
+        }
+    }
+    void AcquireWeak() { RefCountOps::Increment(&weak_refcount); }
+    void ReleaseWeak()
+    {
+        if (RefCountOps::DecrementAndGet(&weak_refcount) == 1)
+        {
+            manage(this, SharedControlOperation::FreeBlock);
+        }
+    }
+    void* GetObject() { return manage(this, SharedControlOperation::GetObject); }
+
+    typename RefCountOps::Type refcount;
+    typename RefCountOps::Type weak_refcount;
+    AllocatorBase* allocator = nullptr;
+    void* (*manage)(SharedControlBlock* block, SharedControlOperation operation) = nullptr;
+};
+
+/**
+ * Control block that stores the object right after the reference counts, so both are created with one allocation.
+ * The object lives in raw storage because it is destroyed before the block is freed when WeakPtr instances remain.
+ */
+template <typename T, ThreadingPolicy Policy>
+struct SharedInlineControlBlock : SharedControlBlock<Policy>
+{
+    template <typename... Args>
+    explicit SharedInlineControlBlock(Args&&... args)
+    {
+        new (m_storage) T(std::forward<Args>(args)...);
+        this->manage = &Manage;
+    }
+
+    T* GetTypedObject() { return std::launder(reinterpret_cast<T*>(m_storage)); }
+
+    static void* Manage(SharedControlBlock<Policy>* block, SharedControlOperation operation)
+    {
+        SharedInlineControlBlock* self = static_cast<SharedInlineControlBlock*>(block);
+        switch (operation)
+        {
+            case SharedControlOperation::DestroyObject:
+                self->GetTypedObject()->~T();
+                break;
+            case SharedControlOperation::FreeBlock:
+                Delete(self->allocator, self);
+                break;
+            case SharedControlOperation::GetObject:
+                return self->GetTypedObject();
+        }
+        return nullptr;
+    }
+
+    alignas(T) u8 m_storage[sizeof(T)];
+};
+
+/**
+ * Control block for objects that were allocated by the user and handed over as a raw pointer.
+ */
+template <typename T, ThreadingPolicy Policy>
+struct SharedPointerControlBlock : SharedControlBlock<Policy>
+{
+    explicit SharedPointerControlBlock(T* in_object) : object(in_object) { this->manage = &Manage; }
+
+    static void* Manage(SharedControlBlock<Policy>* block, SharedControlOperation operation)
+    {
+        SharedPointerControlBlock* self = static_cast<SharedPointerControlBlock*>(block);
+        switch (operation)
+        {
+            case SharedControlOperation::DestroyObject:
+                Delete(self->allocator, self->object);
+                self->object = nullptr;
+                break;
+            case SharedControlOperation::FreeBlock:
+                Delete(self->allocator, self);
+                break;
+            case SharedControlOperation::GetObject:
+                return self->object;
+        }
+        return nullptr;
+    }
+
+    T* object;
+};
+
+/**
+ * Alignment for a control block allocation. Blocks that fit in a cache line are aligned to their size rounded up to a
+ * power of 2, so the reference count and the object never straddle two cache lines.
+ */
+template <typename Block>
+constexpr u32 GetSharedControlBlockAlignment()
+{
+    u64 alignment = alignof(Block);
+    if constexpr (sizeof(Block) <= OPAL_CACHE_LINE_SIZE)
+    {
+        while (alignment < sizeof(Block))
+        {
+            alignment *= 2;
+        }
+    }
+    return static_cast<u32>(alignment);
+}
+
 }  // namespace Impl
 
+template <typename T, ThreadingPolicy Policy>
+class WeakPtr;
+
+template <typename T>
+class AtomicSharedPtr;
+
 /**
  * Reference counting wrapper around objects of the desired type.
  *
@@ -66,14 +240,14 @@ template <typename T, ThreadingPolicy Policy = ThreadingPolicy::ThreadSafe>
 class SharedPtr
 {
     using RefCountOps = Impl::RefCountType<Policy>;
-    using RefCountT = typename RefCountOps::Type;
+    using ControlBlock = Impl::SharedControlBlock<Policy>;
 
 public:
     /** Default constructor. Creates an invalid shared pointer that holds no object. */
     SharedPtr() = default;
 
     /**
-     * Constructs a shared pointer and the managed object in-place.
+     * Constructs a shared pointer and the managed object in-place. The object and the reference count share one allocation.
      * @param allocator Allocator used for the object and reference count. If nullptr, the default allocator is used.
      * @param args Arguments forwarded to the constructor of T.
      * @throws InvalidArgumentException If Policy is ThreadSafe and the allocator is not thread-safe.
@@ -92,10 +266,11 @@ public:
                 throw InvalidArgumentException("SharedPtr", "Allocator should be thread-safe");
             }
         }
-        m_object = New<T>(allocator, std::forward<Args>(args)...);
-        m_refcount = New<RefCountT>(allocator);
-        RefCountOps::Store(m_refcount, 1);
-        m_allocator = allocator;
+        using Block = Impl::SharedInlineControlBlock<T, Policy>;
+        Block* block = New<Block, Impl::GetSharedControlBlockAlignment<Block>()>(allocator, std::forward<Args>(args)...);
+        block->Initialize(allocator);
+        m_object = block->GetTypedObject();
+        m_control_block = block;
     }
 
     /**
@@ -123,10 +298,10 @@ public:
                 throw InvalidArgumentException("SharedPtr", "Allocator should be thread-safe");
             }
         }
+        ControlBlock* block = New<Impl::SharedPointerControlBlock<T, Policy>>(allocator, object);
+        block->Initialize(allocator);
         m_object = object;
-        m_refcount = New<RefCountT>(allocator);
-        RefCountOps::Store(m_refcount, 1);
-        m_allocator = allocator;
+        m_control_block = block;
     }
 
     /** Destructor. Decrements the reference count and destroys the managed object if this was the last owner. */
@@ -136,11 +311,10 @@ public:
     SharedPtr& operator=(const SharedPtr&) = delete;
 
     /** Move constructor. Transfers ownership from other, leaving other in an invalid state. */
-    SharedPtr(SharedPtr&& other) noexcept : m_object(other.m_object), m_allocator(other.m_allocator), m_refcount(other.m_refcount)
+    SharedPtr(SharedPtr&& other) noexcept : m_object(other.m_object), m_control_block(other.m_control_block)
     {
         other.m_object = nullptr;
-        other.m_allocator = nullptr;
-        other.m_refcount = nullptr;
+        other.m_control_block = nullptr;
     }
 
     /**
@@ -151,11 +325,10 @@ public:
     template <typename U>
         requires Convertible<U*, T*>
     explicit SharedPtr(SharedPtr<U, Policy>&& other) noexcept
-        : m_object(static_cast<T*>(other.m_object)), m_allocator(other.m_allocator), m_refcount(other.m_refcount)
+        : m_object(static_cast<T*>(other.m_object)), m_control_block(other.m_control_block)
     {
         other.m_object = nullptr;
-        other.m_allocator = nullptr;
-        other.m_refcount = nullptr;
+        other.m_control_block = nullptr;
     }
 
     /** Move assignment operator. Releases the current object (if any) and transfers ownership from other. */
@@ -167,11 +340,9 @@ public:
         }
         Reset();
         m_object = other.m_object;
-        m_refcount = other.m_refcount;
-        m_allocator = other.m_allocator;
+        m_control_block = other.m_control_block;
         other.m_object = nullptr;
-        other.m_refcount = nullptr;
-        other.m_allocator = nullptr;
+        other.m_control_block = nullptr;
         return *this;
     }
 
@@ -194,10 +365,9 @@ public:
         {
             return clone;
         }
+        m_control_block->AcquireStrong();
         clone.m_object = m_object;
-        clone.m_refcount = m_refcount;
-        RefCountOps::Increment(m_refcount);
-        clone.m_allocator = m_allocator;
+        clone.m_control_block = m_control_block;
         return clone;
     }
 
@@ -207,16 +377,20 @@ public:
      */
     void Reset()
     {
-        if (m_refcount != nullptr && RefCountOps::DecrementAndGet(m_refcount) == 1)
+        if (m_control_block != nullptr)
         {
-            Delete(m_allocator, m_object);
-            Delete(m_allocator, m_refcount);
+            m_control_block->ReleaseStrong();
         }
         m_object = nullptr;
-        m_refcount = nullptr;
-        m_allocator = nullptr;
+        m_control_block = nullptr;
     }
 
+    /**
+     * Returns the number of SharedPtr instances that own the managed object, or 0 if this pointer is invalid. When the
+     * object is shared between threads, the value can be outdated by the time it is returned.
+     */
+    [[nodiscard]] size_t GetReferenceCount() const { return m_control_block != nullptr ? RefCountOps::Load(&m_control_block->refcount) : 0; }
+
     /**
      * Checks whether this shared pointer manages a valid object.
      * @return True if the managed object pointer is not nullptr.
@@ -247,15 +421,133 @@ public:
 private:
     template <typename U, ThreadingPolicy P>
     friend class SharedPtr;
+    friend class WeakPtr<T, Policy>;
+    friend class AtomicSharedPtr<T>;
+
+    /** Wraps a reference to the control block that the caller already acquired. */
+    static SharedPtr Adopt(T* object, ControlBlock* control_block)
+    {
+        SharedPtr result;
+        result.m_object = object;
+        result.m_control_block = control_block;
+        return result;
+    }
+
+    T* m_object = nullptr;
+    ControlBlock* m_control_block = nullptr;
+};
+
+/**
+ * Non-owning reference to an object managed by SharedPtr.
+ *
+ * A WeakPtr does not keep the object alive. Use Lock() to get a SharedPtr when the object still exists. The control
+ * block stays allocated until the last WeakPtr is gone, so for objects created in place the memory of the object is
+ * only returned to the allocator at that point.
+ *
+ * Copy construction and copy assignment are deleted. Use Clone() to create another WeakPtr to the same object.
+ *
+ * @tparam T Object type.
+ * @tparam Policy Threading policy, must match the SharedPtr the weak pointer is created from.
+ */
+template <typename T, ThreadingPolicy Policy = ThreadingPolicy::ThreadSafe>
+class WeakPtr
+{
+    using RefCountOps = Impl::RefCountType<Policy>;
+    using ControlBlock = Impl::SharedControlBlock<Policy>;
+
+public:
+    /** Default constructor. Creates an empty weak pointer. */
+    WeakPtr() = default;
+
+    /** Creates a weak pointer that observes the object managed by @p shared. */
+    explicit WeakPtr(const SharedPtr<T, Policy>& shared) : m_object(shared.m_object), m_control_block(shared.m_control_block)
+    {
+        if (m_control_block != nullptr)
+        {
+            m_control_block->AcquireWeak();
+        }
+    }
+
+    ~WeakPtr() { Reset(); }
+
+    WeakPtr(const WeakPtr&) = delete;
+    WeakPtr& operator=(const WeakPtr&) = delete;
+
+    WeakPtr(WeakPtr&& other) noexcept : m_object(other.m_object), m_control_block(other.m_control_block)
+    {
+        other.m_object = nullptr;
+        other.m_control_block = nullptr;
+    }
+
+    WeakPtr& operator=(WeakPtr&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        Reset();
+        m_object = other.m_object;
+        m_control_block = other.m_control_block;
+        other.m_object = nullptr;
+        other.m_control_block = nullptr;
+        return *this;
+    }
 
+    /**
+     * Creates another weak pointer to the same object.
+     * @param allocator Ignored. Exists for API compatibility with Opal::Clone(source, allocator).
+     */
+    WeakPtr Clone([[maybe_unused]] AllocatorBase* allocator = nullptr) const
+    {
+        WeakPtr clone;
+        if (m_control_block != nullptr)
+        {
+            m_control_block->AcquireWeak();
+            clone.m_object = m_object;
+            clone.m_control_block = m_control_block;
+        }
+        return clone;
+    }
+
+    /**
+     * Tries to take shared ownership of the object.
+     * @return Valid SharedPtr if the object is still alive, invalid SharedPtr otherwise.
+     */
+    SharedPtr<T, Policy> Lock() const
+    {
+        if (m_control_block == nullptr || !RefCountOps::IncrementIfNotZero(&m_control_block->refcount))
+        {
+            return SharedPtr<T, Policy>();
+        }
+        return SharedPtr<T, Policy>::Adopt(m_object, m_control_block);
+    }
+
+    /**
+     * Checks whether the object was destroyed. When other threads own the object, the result can be outdated by the time
+     * it is returned, use Lock() to get a stable answer.
+     */
+    [[nodiscard]] bool IsExpired() const { return m_control_block == nullptr || RefCountOps::Load(&m_control_block->refcount) == 0; }
+
+    /** Stops observing the object. */
+    void Reset()
+    {
+        if (m_control_block != nullptr)
+        {
+            m_control_block->ReleaseWeak();
+        }
+        m_object = nullptr;
+        m_control_block = nullptr;
+    }
+
+private:
     T* m_object = nullptr;
-    AllocatorBase* m_allocator = nullptr;
-    RefCountT* m_refcount = nullptr;
+    ControlBlock* m_control_block = nullptr;
 };
 
 /**
  * Constructs an object of type Derived and returns a SharedPtr<Base>.
- * Useful for creating shared pointers to polymorphic types without manual New/cast.
+ * Useful for creating shared pointers to polymorphic types without manual New/cast. The object and the reference count
+ * are created with a single allocation, and the object is destroyed as Derived.
  * @tparam Base Base type for the returned SharedPtr.
  * @tparam Derived Derived type to construct. Must be convertible to Base*. Defaults to Base.
  * @tparam Policy Threading policy for the SharedPtr.
@@ -271,8 +563,7 @@ SharedPtr<Base, Policy> MakeShared(AllocatorBase* allocator, Args&&... args)
     {
         allocator = GetDefaultAllocator();
     }
-    Derived* object = New<Derived>(allocator, std::forward<Args>(args)...);
-    return SharedPtr<Base, Policy>(allocator, static_cast<Base*>(object));
+    return SharedPtr<Base, Policy>(SharedPtr<Derived, Policy>(allocator, std::forward<Args>(args)...));
 }
 
 }  // namespace Opal
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "opal/allocator.h"
+#include "opal/assert.h"
+#include "opal/casts.h"
+#include "opal/common.h"
+#include "opal/container/array-view.h"
+#include "opal/exceptions.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+namespace Impl
+{
+
+/**
+ * Smallest number of elements of the given size that spans a whole number of cache lines.
+ */
+constexpr u64 GetSoaColumnGranularity(u64 element_size)
+{
+    u64 common_divisor = OPAL_CACHE_LINE_SIZE;
+    while (element_size % common_divisor != 0)
+    {
+        common_divisor /= 2;
+    }
+    return OPAL_CACHE_LINE_SIZE / common_divisor;
+}
+
+template <typename... Fields>
+constexpr u64 GetSoaCapacityGranularity()
+{
+    u64 result = 1;
+    ((result = GetSoaColumnGranularity(sizeof(Fields)) > result ? GetSoaColumnGranularity(sizeof(Fields)) : result), ...);
+    return result;
+}
+
+}  // namespace Impl
+
+/**
+ * Structure-of-arrays container. Each field type gets its own contiguous column, so loops that touch only one field
+ * stream through memory without loading the other fields into the cache.
+ *
+ * All columns live in a single allocation. Every column starts on a cache line boundary and the capacity is always a
+ * multiple of k_capacity_granularity, which means that each column spans a whole number of cache lines. Vector loops can
+ * therefore process columns in full SIMD-width steps up to GetPaddedSize() without a scalar tail. Elements in the range
+ * [GetSize(), GetPaddedSize()) are readable and writable but their values are unspecified.
+ *
+ * @tparam Fields Types of the columns. Must not be references or const types.
+ */
+template <typename... Fields>
+class SoaArray
+{
+public:
+    using allocator_type = AllocatorBase;
+    using size_type = u64;
+    using difference_type = i64;
+
+    template <u64 Index>
+    using FieldType = std::tuple_element_t<Index, std::tuple<Fields...>>;
+
+    static_assert(sizeof...(Fields) > 0, "SoaArray needs at least one field");
+    static_assert((!k_is_reference_value<Fields> && ...), "Field types must not be references");
+    static_assert((!k_is_const_value<Fields> && ...), "Field types must not be const");
+    static_assert(((alignof(Fields) <= OPAL_CACHE_LINE_SIZE) && ...), "Field alignment can't exceed the cache line size");
+
+    static constexpr u64 k_field_count = sizeof...(Fields);
+
+    /** Alignment of every column in bytes. */
+    static constexpr u64 k_column_alignment = OPAL_CACHE_LINE_SIZE;
+
+    /** Capacity is always a multiple of this value so that each column occupies a whole number of cache lines. */
+    static constexpr u64 k_capacity_granularity = Impl::GetSoaCapacityGranularity<Fields...>();
+
+    /**
+     * Default constructor.
+     * @param allocator Allocator to be used for memory allocation. If nullptr, the default allocator will be used.
+     */
+    SoaArray(allocator_type* allocator = nullptr);
+
+    /**
+     * Move constructor.
+     * @param other Source array.
+     */
+    SoaArray(SoaArray&& other) noexcept;
+
+    ~SoaArray();
+
+    /**
+     * Move assignment. Uses the allocator from the source array.
+     * @param other Source array.
+     * @return Reference to this array.
+     */
+    SoaArray& operator=(SoaArray&& other) noexcept;
+
+    /**
+     * Create a deep copy of this array.
+     * @param allocator Allocator to be used for the cloned array. If nullptr, the source array's allocator will be used.
+     * @return A new SoaArray with the same elements as this array.
+     */
+    SoaArray Clone(AllocatorBase* allocator = nullptr) const
+        requires((IsPOD<Fields> || Clonable<Fields>) && ...);
+
+    [[nodiscard]] size_type GetSize() const { return m_size; }
+    [[nodiscard]] size_type GetCapacity() const { return m_capacity; }
+
+    /**
+     * Get the size rounded up to k_capacity_granularity. This is the number of elements a SIMD loop can safely process
+     * in every column. Never larger than the capacity.
+     */
+    [[nodiscard]] size_type GetPaddedSize() const { return RoundUpToGranularity(m_size); }
+
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    allocator_type* GetAllocator() const { return m_allocator; }
+
+    /**
+     * Increase the capacity of all columns to at least `new_capacity`. The capacity is rounded up to
+     * k_capacity_granularity. Does nothing if the current capacity is already large enough.
+     * @param new_capacity Minimal new capacity.
+     * @throw OutOfMemoryException when allocator runs out of memory.
+     */
+    void Reserve(size_type new_capacity);
+
+    /**
+     * Add a new element to the end of the array. One value per column must be provided.
+     * @param values Values of the new element, in the same order as the Fields.
+     * @throw OutOfMemoryException when allocator runs out of memory.
+     */
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Fields))
+    void PushBack(Args&&... values);
+
+    /**
+     * Remove the last element from the array.
+     */
+    void PopBack();
+
+    /**
+     * Erase the element at the specified index by moving the last element in its place. The order of the elements is not
+     * preserved. Does not deallocate memory.
+     * @param index Index of the element to erase.
+     * @throw OutOfBoundsException when index is out of bounds.
+     */
+    void Erase(size_type index);
+
+    /**
+     * Destroy all elements and set the size to 0. Does not deallocate memory.
+     */
+    void Clear();
+
+    /**
+     * Get a reference to a single field of an element. No bounds checking.
+     * @tparam Index Index of the column.
+     * @param index Index of the element.
+     * @return Reference to the field.
+     */
+    template <u64 Index>
+    FieldType<Index>& Get(size_type index)
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        return std::get<Index>(m_columns)[index];
+    }
+    template <u64 Index>
+    const FieldType<Index>& Get(size_type index) const
+    {
+        OPAL_ASSERT(index < m_size, "Index out of bounds");
+        return std::get<Index>(m_columns)[index];
+    }
+
+    /**
+     * Get a view of a column that covers the elements in the range [0, GetSize()).
+     * @tparam Index Index of the column.
+     * @return View of the column.
+     */
+    template <u64 Index>
+    ArrayView<FieldType<Index>> GetColumn()
+    {
+        return MakeColumnView<FieldType<Index>>(std::get<Index>(m_columns), m_size);
+    }
+    template <u64 Index>
+    ArrayView<const FieldType<Index>> GetColumn() const
+    {
+        return MakeColumnView<const FieldType<Index>>(std::get<Index>(m_columns), m_size);
+    }
+
+    /**
+     * Get a view of a column that covers the elements in the range [0, GetPaddedSize()). Only available for POD columns,
+     * since elements past the size are not constructed objects. The start of the view is aligned to k_column_alignment.
+     * @tparam Index Index of the column.
+     * @return View of the padded column.
+     */
+    template <u64 Index>
+        requires IsPOD<FieldType<Index>>
+    ArrayView<FieldType<Index>> GetPaddedColumn()
+    {
+        return MakeColumnView<FieldType<Index>>(std::get<Index>(m_columns), GetPaddedSize());
+    }
+    template <u64 Index>
+        requires IsPOD<FieldType<Index>>
+    ArrayView<const FieldType<Index>> GetPaddedColumn() const
+    {
+        return MakeColumnView<const FieldType<Index>>(std::get<Index>(m_columns), GetPaddedSize());
+    }
+
+private:
+    using ColumnPointers = std::tuple<Fields*...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    static constexpr size_type RoundUpToGranularity(size_type count)
+    {
+        return (count + k_capacity_granularity - 1) / k_capacity_granularity * k_capacity_granularity;
+    }
+
+    template <typename T>
+    static ArrayView<T> MakeColumnView(T* column, size_type count)
+    {
+        if (count == 0)
+        {
+            return {};
+        }
+        return ArrayView<T>(column, count);
+    }
+
+    template <typename Func, size_t... Is>
+    static void ForEachColumn(Func&& func, std::index_sequence<Is...>)
+    {
+        (func(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    void* Allocate(size_type capacity, ColumnPointers& columns);
+    void DestroyElements();
+    size_type GetNextCapacity(size_type current_capacity) const;
+
+    static constexpr f64 k_resize_factor = 1.5;
+
+    allocator_type* m_allocator = nullptr;
+    size_type m_capacity = 0;
+    size_type m_size = 0;
+    void* m_memory = nullptr;
+    ColumnPointers m_columns = {};
+};
+
+}  // namespace Opal
+
+/*************************************************************************************************/
+/***************************************** Implementation ****************************************/
+/*************************************************************************************************/
+
+#define TEMPLATE_HEADER template <typename... Fields>
+#define CLASS_HEADER Opal::SoaArray<Fields...>
+
+TEMPLATE_HEADER
+CLASS_HEADER::SoaArray(allocator_type* allocator) : m_allocator(allocator == nullptr ? GetDefaultAllocator() : allocator) {}
+
+TEMPLATE_HEADER
+CLASS_HEADER::SoaArray(SoaArray&& other) noexcept
+    : m_allocator(other.m_allocator), m_capacity(other.m_capacity), m_size(other.m_size), m_memory(other.m_memory), m_columns(other.m_columns)
+{
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_memory = nullptr;
+    other.m_columns = {};
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER::~SoaArray()
+{
+    if (m_memory != nullptr)
+    {
+        DestroyElements();
+        m_allocator->Free(m_memory);
+        m_memory = nullptr;
+    }
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER& CLASS_HEADER::operator=(SoaArray&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    if (m_memory != nullptr)
+    {
+        DestroyElements();
+        m_allocator->Free(m_memory);
+    }
+    m_allocator = other.m_allocator;
+    m_capacity = other.m_capacity;
+    m_size = other.m_size;
+    m_memory = other.m_memory;
+    m_columns = other.m_columns;
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_memory = nullptr;
+    other.m_columns = {};
+    return *this;
+}
+
+TEMPLATE_HEADER
+CLASS_HEADER CLASS_HEADER::Clone(AllocatorBase* allocator) const
+    requires((IsPOD<Fields> || Clonable<Fields>) && ...)
+{
+    SoaArray clone(allocator == nullptr ? m_allocator : allocator);
+    clone.Reserve(m_size);
+    ForEachColumn(
+        [&](auto column_index)
+        {
+            using T = FieldType<decltype(column_index)::value>;
+            const T* src = std::get<decltype(column_index)::value>(m_columns);
+            T* dst = std::get<decltype(column_index)::value>(clone.m_columns);
+            if constexpr (IsPOD<T>)
+            {
+                if (m_size > 0)
+                {
+                    memcpy(dst, src, m_size * sizeof(T));
+                }
+            }
+            else
+            {
+                for (size_type i = 0; i < m_size; ++i)
+                {
+                    new (&dst[i]) T(Opal::Clone(src[i], clone.m_allocator));
+                }
+            }
+        },
+        Indices{});
+    clone.m_size = m_size;
+    return clone;
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::Reserve(size_type new_capacity)
+{
+    new_capacity = RoundUpToGranularity(new_capacity);
+    if (new_capacity <= m_capacity)
+    {
+        return;
+    }
+    ColumnPointers new_columns;
+    void* new_memory = Allocate(new_capacity, new_columns);
+    ForEachColumn(
+        [&](auto column_index)
+        {
+            using T = FieldType<decltype(column_index)::value>;
+            T* src = std::get<decltype(column_index)::value>(m_columns);
+            T* dst = std::get<decltype(column_index)::value>(new_columns);
+            if constexpr (IsPOD<T>)
+            {
+                if (m_size > 0)
+                {
+                    memcpy(dst, src, m_size * sizeof(T));
+                }
+            }
+            else
+            {
+                for (size_type i = 0; i < m_size; ++i)
+                {
+                    new (&dst[i]) T(Move(src[i]));
+                    src[i].~T();
+                }
+            }
+        },
+        Indices{});
+    if (m_memory != nullptr)
+    {
+        m_allocator->Free(m_memory);
+    }
+    m_memory = new_memory;
+    m_columns = new_columns;
+    m_capacity = new_capacity;
+}
+
+TEMPLATE_HEADER
+template <typename... Args>
+    requires(sizeof...(Args) == sizeof...(Fields))
+void CLASS_HEADER::PushBack(Args&&... values)
+{
+    if (m_size == m_capacity)
+    {
+        Reserve(GetNextCapacity(m_capacity));
+    }
+    std::apply([&](Fields*... columns) { (new (&columns[m_size]) Fields(std::forward<Args>(values)), ...); }, m_columns);
+    ++m_size;
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::PopBack()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    --m_size;
+    std::apply(
+        [&](Fields*... columns)
+        {
+            (
+                [&]
+                {
+                    if constexpr (!IsPOD<Fields>)
+                    {
+                        columns[m_size].~Fields();
+                    }
+                }(),
+                ...);
+        },
+        m_columns);
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::Erase(size_type index)
+{
+    if (index >= m_size) [[unlikely]]
+    {
+        throw OutOfBoundsException(index, 0, m_size - 1);
+    }
+    const size_type last = m_size - 1;
+    if (index != last)
+    {
+        std::apply([&](Fields*... columns) { ((columns[index] = Move(columns[last])), ...); }, m_columns);
+    }
+    PopBack();
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::Clear()
+{
+    DestroyElements();
+    m_size = 0;
+}
+
+TEMPLATE_HEADER
+void* CLASS_HEADER::Allocate(size_type capacity, ColumnPointers& columns)
+{
+    OPAL_ASSERT(m_allocator, "Allocator should never be null!");
+    OPAL_ASSERT(capacity % k_capacity_granularity == 0, "Capacity must be a multiple of the granularity");
+    const size_type bytes_to_allocate = (0 + ... + (capacity * sizeof(Fields)));
+    u8* memory = static_cast<u8*>(m_allocator->Alloc(bytes_to_allocate, k_column_alignment));
+    // Zero the memory so that the padded tail of POD columns never contains garbage.
+    memset(memory, 0, bytes_to_allocate);
+    size_type offset = 0;
+    ForEachColumn(
+        [&](auto column_index)
+        {
+            using T = FieldType<decltype(column_index)::value>;
+            std::get<decltype(column_index)::value>(columns) = reinterpret_cast<T*>(memory + offset);
+            offset += capacity * sizeof(T);
+        },
+        Indices{});
+    return memory;
+}
+
+TEMPLATE_HEADER
+void CLASS_HEADER::DestroyElements()
+{
+    std::apply(
+        [&](Fields*... columns)
+        {
+            (
+                [&]
+                {
+                    if constexpr (!IsPOD<Fields>)
+                    {
+                        for (size_type i = 0; i < m_size; ++i)
+                        {
+                            columns[i].~Fields();
+                        }
+                    }
+                }(),
+                ...);
+        },
+        m_columns);
+}
+
+TEMPLATE_HEADER
+typename CLASS_HEADER::size_type CLASS_HEADER::GetNextCapacity(size_type current_capacity) const
+{
+    if (current_capacity == 0)
+    {
+        return k_capacity_granularity;
+    }
+    return static_cast<size_type>((Narrow<f64>(current_capacity) * k_resize_factor) + 1.0);
+}
+
+#undef TEMPLATE_HEADER
+#undef CLASS_HEADER
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstring>
+#include <iterator>
+
+#include "opal/allocator.h"
+#include "opal/container/string-view.h"
+#include "opal/container/string.h"
+#include "opal/export.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+class StringBuilder;
+
+namespace Impl
+{
+
+/**
+ * Header of a StringBuilder chunk. The code units follow the header in memory.
+ */
+struct StringBuilderChunk
+{
+    StringBuilderChunk* next;
+    u64 size;
+    u64 capacity;
+
+    [[nodiscard]] char8* GetData() { return reinterpret_cast<char8*>(this + 1); }
+    [[nodiscard]] const char8* GetData() const { return reinterpret_cast<const char8*>(this + 1); }
+};
+
+}  // namespace Impl
+
+/**
+ * Output iterator that appends characters to a StringBuilder. Can be passed to std::format_to and std::vformat_to.
+ */
+struct StringBuilderIterator
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit StringBuilderIterator(StringBuilder& builder) : m_builder(&builder) {}
+
+    StringBuilderIterator& operator=(char c);
+
+    StringBuilderIterator& operator*() { return *this; }
+    StringBuilderIterator& operator++() { return *this; }
+    StringBuilderIterator operator++(int) { return *this; }
+
+private:
+    StringBuilder* m_builder;
+};
+
+/**
+ * Forward iterator over the chunks of a StringBuilder. Dereferencing gives a view of the code units in one chunk.
+ */
+class StringBuilderChunkIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = StringViewUtf8;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = StringViewUtf8;
+
+    StringBuilderChunkIterator() = default;
+    explicit StringBuilderChunkIterator(const Impl::StringBuilderChunk* chunk) : m_chunk(chunk) {}
+
+    StringViewUtf8 operator*() const { return {m_chunk->GetData(), m_chunk->size}; }
+
+    StringBuilderChunkIterator& operator++()
+    {
+        m_chunk = m_chunk->next;
+        return *this;
+    }
+    StringBuilderChunkIterator operator++(int)
+    {
+        StringBuilderChunkIterator previous = *this;
+        m_chunk = m_chunk->next;
+        return previous;
+    }
+
+    bool operator==(const StringBuilderChunkIterator& other) const { return m_chunk == other.m_chunk; }
+
+private:
+    const Impl::StringBuilderChunk* m_chunk = nullptr;
+};
+
+/** Chunks of a StringBuilder, for use in range-based for loops. */
+struct StringBuilderChunkRange
+{
+    StringBuilderChunkIterator first;
+    StringBuilderChunkIterator last;
+
+    [[nodiscard]] StringBuilderChunkIterator begin() const { return first; }
+    [[nodiscard]] StringBuilderChunkIterator end() const { return last; }
+};
+
+/**
+ * Builds a large string out of many small appends without ever moving the text that was already written.
+ *
+ * Text is appended into a chain of chunks. When the last chunk is full, a new chunk twice the size of the previous one
+ * is allocated, up to k_max_chunk_size. Appending is therefore linear in the size of the output, and the only copy is
+ * made when the result is materialized with ToString() or written out with WriteToFile(). Chunks can also be read
+ * directly with GetChunks().
+ *
+ * The allocator is typically the scratch allocator, in which case the builder should be destroyed or cleared before the
+ * scratch allocator is reset.
+ */
+class OPAL_EXPORT StringBuilder
+{
+public:
+    using value_type = char8;
+    using size_type = u64;
+    using allocator_type = AllocatorBase;
+
+    /** Size of the first chunk. */
+    static constexpr u64 k_min_chunk_size = 256;
+    /** Chunks stop growing at this size. */
+    static constexpr u64 k_max_chunk_size = OPAL_MB(1);
+
+    /**
+     * @param allocator Allocator used for the chunks. If nullptr, the default allocator is used.
+     */
+    explicit StringBuilder(allocator_type* allocator = nullptr);
+    ~StringBuilder();
+
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+    StringBuilder(StringBuilder&& other) noexcept;
+    StringBuilder& operator=(StringBuilder&& other) noexcept;
+
+    void Append(char8 value)
+    {
+        if (m_tail != nullptr && m_tail->size < m_tail->capacity)
+        {
+            m_tail->GetData()[m_tail->size++] = value;
+            ++m_size;
+            return;
+        }
+        AppendSlow(&value, 1);
+    }
+
+    void Append(const char8* data, size_type size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        if (m_tail != nullptr && m_tail->capacity - m_tail->size >= size)
+        {
+            std::memcpy(m_tail->GetData() + m_tail->size, data, size);
+            m_tail->size += size;
+            m_size += size;
+            return;
+        }
+        AppendSlow(data, size);
+    }
+
+    void Append(StringViewUtf8 str) { Append(str.GetData(), str.GetSize()); }
+
+    /** Append @p count copies of @p value. */
+    void Append(size_type count, char8 value);
+
+    StringBuilder& operator+=(char8 value)
+    {
+        Append(value);
+        return *this;
+    }
+    StringBuilder& operator+=(StringViewUtf8 str)
+    {
+        Append(str);
+        return *this;
+    }
+
+    /** Returns the number of code units appended so far. */
+    [[nodiscard]] size_type GetSize() const { return m_size; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+    [[nodiscard]] allocator_type* GetAllocator() const { return m_allocator; }
+
+    /** Remove all text and free all chunks. */
+    void Clear();
+
+    /**
+     * Copy the text into a new string. This is the only copy of the text that is made.
+     * @param allocator Allocator of the returned string. If nullptr, the default allocator is used.
+     */
+    [[nodiscard]] StringUtf8 ToString(allocator_type* allocator = nullptr) const;
+
+    /** Append the text to the end of @p output. */
+    void AppendTo(StringUtf8& output) const;
+
+    /**
+     * Write the text to a file, replacing any existing content. Creates the file if it does not exist.
+     * @param path Path to the file.
+     * @throw PathNotFoundException when the parent directory does not exist.
+     * @throw Exception when any other error occurs.
+     */
+    void WriteToFile(const StringUtf8& path) const;
+
+    /** Returns an output iterator for std::format_to and std::vformat_to. */
+    StringBuilderIterator GetFormatIterator() { return StringBuilderIterator(*this); }
+
+    /** Returns the chunks in the order the text was appended. */
+    [[nodiscard]] StringBuilderChunkRange GetChunks() const
+    {
+        return {StringBuilderChunkIterator(m_head), StringBuilderChunkIterator()};
+    }
+
+private:
+    void AppendSlow(const char8* data, size_type size);
+    Impl::StringBuilderChunk* AllocateChunk(size_type min_capacity);
+
+    allocator_type* m_allocator = nullptr;
+    Impl::StringBuilderChunk* m_head = nullptr;
+    Impl::StringBuilderChunk* m_tail = nullptr;
+    size_type m_size = 0;
+};
+
+inline StringBuilderIterator& StringBuilderIterator::operator=(char c)
+{
+    m_builder->Append(c);
+    return *this;
+}
+
+}  // namespace Opal
@@ -133,6 +133,46 @@ private:
     std::mbstate_t m_decoding_state;
 };
 
+/**
+ * Check if the input is well-formed UTF-8 as defined by RFC 3629. Overlong encodings, encoded surrogates, code points
+ * above U+10FFFF and truncated sequences are rejected. Runs of ASCII are checked 16 or 32 bytes at a time.
+ * @param input UTF-8 code units.
+ * @return True if the whole input is valid UTF-8.
+ */
+OPAL_EXPORT bool ValidateUtf8(ArrayView<const u8> input);
+
+/**
+ * Bulk transcoding between Unicode encodings. Runs of ASCII are converted 16 code units at a time, everything else
+ * one code point at a time with full validation of the input.
+ * @param input Input code units.
+ * @param output Output span. It will be updated to point after the written data, also when an error is returned.
+ * @return ErrorCode::Success if the whole input was converted, ErrorCode::InsufficientSpace if the output is too small,
+ * ErrorCode::IncompleteSequence if the input ends in the middle of a sequence, ErrorCode::InvalidArgument if the input is
+ * malformed or contains a code point that can't be encoded.
+ */
+OPAL_EXPORT ErrorCode TranscodeUtf8ToUtf16(ArrayView<const u8> input, ArrayView<u16>& output);
+OPAL_EXPORT ErrorCode TranscodeUtf16ToUtf8(ArrayView<const u16> input, ArrayView<u8>& output);
+OPAL_EXPORT ErrorCode TranscodeUtf8ToUtf32(ArrayView<const u8> input, ArrayView<u32>& output);
+OPAL_EXPORT ErrorCode TranscodeUtf32ToUtf8(ArrayView<const u32> input, ArrayView<u8>& output);
+
+namespace Impl
+{
+
+/** Number of bytes in the code units of a Unicode encoding that has a bulk transcoder, 0 for other encodings. */
+template <typename EncodingType>
+inline constexpr u64 k_unicode_code_unit_size = 0;
+
+template <typename CodeUnitT>
+inline constexpr u64 k_unicode_code_unit_size<EncodingUtf8<CodeUnitT>> = sizeof(CodeUnitT) == 1 ? 1 : 0;
+
+template <typename CodeUnitT>
+inline constexpr u64 k_unicode_code_unit_size<EncodingUtf16LE<CodeUnitT>> = sizeof(CodeUnitT) == 2 ? 2 : 0;
+
+template <typename CodeUnitT>
+inline constexpr u64 k_unicode_code_unit_size<EncodingUtf32LE<CodeUnitT>> = sizeof(CodeUnitT) == 4 ? 4 : 0;
+
+}  // namespace Impl
+
 }  // namespace Opal
 
 #define TEMPLATE_HEADER template <typename CodeUnitT>
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <format>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "opal/char-conv.h"
+#include "opal/container/string-builder.h"
 #include "opal/container/string-view.h"
 #include "opal/container/string.h"
 
@@ -38,13 +43,23 @@ struct StringFormatIterator
     StringFormatIterator operator++(int) { return *this; }
 };
 
+/** Numbers that std::format writes the same way as ToChars. Character types are formatted as characters instead. */
+template <typename T>
+concept ToCharsFormattable = (Integral<T> && !AnyOf<T, char8, char16, uchar32>) || FloatingPoint<T>;
+
+/** Returns true if @p fmt formats a single argument with default options. */
+inline bool IsPlainPlaceholder(StringViewUtf8 fmt)
+{
+    return fmt.GetSize() == 2 && fmt.GetData()[0] == '{' && fmt.GetData()[1] == '}';
+}
+
 }  // namespace Impl
 
 /**
  * Append formatted text to an existing string using std::format syntax.
  *
- * When called with no variadic arguments, the format string is appended directly without parsing. Otherwise, arguments
- * are formatted via std::vformat_to.
+ * When called with no variadic arguments, the format string is appended directly without parsing. A single number with a
+ * plain "{}" placeholder is written with ToChars. Otherwise, arguments are formatted via std::vformat_to.
  *
  * @param output  String to append to.
  * @param fmt     Format string using std::format syntax (e.g., "{}", "{:.2f}", "{:#x}").
@@ -59,11 +74,51 @@ void AppendFormat(StringUtf8& output, StringViewUtf8 fmt, Args&&... args)
     }
     else
     {
+        if constexpr (sizeof...(Args) == 1 && (Impl::ToCharsFormattable<std::remove_cvref_t<Args>> && ...))
+        {
+            if (Impl::IsPlainPlaceholder(fmt))
+            {
+                char8 buffer[k_max_to_chars_size];
+                const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, args...).GetValue();
+                output.Append(buffer, static_cast<u64>(end - buffer));
+                return;
+            }
+        }
         Impl::StringFormatIterator out(output);
         std::vformat_to(std::move(out), std::string_view(fmt.GetData(), fmt.GetSize()), std::make_format_args(args...));
     }
 }
 
+/**
+ * Append formatted text to a StringBuilder using std::format syntax.
+ *
+ * @param output  Builder to append to.
+ * @param fmt     Format string using std::format syntax (e.g., "{}", "{:.2f}", "{:#x}").
+ * @param args    Values to format into the string.
+ */
+template <typename... Args>
+void AppendFormat(StringBuilder& output, StringViewUtf8 fmt, Args&&... args)
+{
+    if constexpr (sizeof...(Args) == 0)
+    {
+        output.Append(fmt);
+    }
+    else
+    {
+        if constexpr (sizeof...(Args) == 1 && (Impl::ToCharsFormattable<std::remove_cvref_t<Args>> && ...))
+        {
+            if (Impl::IsPlainPlaceholder(fmt))
+            {
+                char8 buffer[k_max_to_chars_size];
+                const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, args...).GetValue();
+                output.Append(buffer, static_cast<u64>(end - buffer));
+                return;
+            }
+        }
+        std::vformat_to(output.GetFormatIterator(), std::string_view(fmt.GetData(), fmt.GetSize()), std::make_format_args(args...));
+    }
+}
+
 /**
  * Create a new formatted string using std::format syntax.
  *
@@ -79,4 +134,571 @@ StringUtf8 Format(StringViewUtf8 fmt, Args&&... args)
     return result;
 }
 
+/**
+ * String literal that is passed as a template argument, for example the format string of Format<"{} + {}">(1, 2).
+ */
+template <u64 N>
+struct FixedString
+{
+    // Implicit so that string literals can be used directly as template arguments.
+    constexpr FixedString(const char8 (&str)[N])  // NOLINT(google-explicit-constructor)
+    {
+        for (u64 i = 0; i < N; i++)
+        {
+            data[i] = str[i];
+        }
+    }
+
+    /** Returns the number of characters without the null terminator. */
+    [[nodiscard]] static constexpr u64 GetSize() { return N - 1; }
+
+    char8 data[N] = {};
+};
+
+namespace Impl
+{
+
+/**
+ * Not constexpr on purpose. Reaching it while a format string is parsed at compile time makes the compilation fail with
+ * the message in the diagnostic.
+ */
+void FormatStringError(const char* message);
+
+enum class FormatSegmentKind : u8
+{
+    Literal,
+    Argument
+};
+
+/** Literal text or replacement field of a compile-time format string. Offset and size refer to the format string. */
+struct FormatSegment
+{
+    FormatSegmentKind kind = FormatSegmentKind::Literal;
+    /** Literal text, or the format options after the ':' of a replacement field. */
+    u64 offset = 0;
+    u64 size = 0;
+    u64 arg_index = 0;
+};
+
+/**
+ * Split @p fmt into literal text and replacement fields. Escaped braces end a literal segment so that the second brace
+ * can be skipped. Writes the segments to @p out_segments unless it is nullptr.
+ * @return Number of segments.
+ */
+consteval u64 ParseFormatString(const char8* fmt, u64 size, FormatSegment* out_segments)
+{
+    u64 count = 0;
+    const auto emit = [&](FormatSegmentKind kind, u64 offset, u64 segment_size, u64 arg_index)
+    {
+        if (out_segments != nullptr)
+        {
+            out_segments[count] = {kind, offset, segment_size, arg_index};
+        }
+        count++;
+    };
+
+    u64 next_arg_index = 0;
+    bool has_automatic_index = false;
+    bool has_manual_index = false;
+    u64 literal_start = 0;
+    u64 i = 0;
+    while (i < size)
+    {
+        if (fmt[i] == '}')
+        {
+            if (i + 1 >= size || fmt[i + 1] != '}')
+            {
+                FormatStringError("Unmatched '}' in format string");
+            }
+            emit(FormatSegmentKind::Literal, literal_start, i + 1 - literal_start, 0);
+            i += 2;
+            literal_start = i;
+            continue;
+        }
+        if (fmt[i] != '{')
+        {
+            i++;
+            continue;
+        }
+        if (i + 1 < size && fmt[i + 1] == '{')
+        {
+            emit(FormatSegmentKind::Literal, literal_start, i + 1 - literal_start, 0);
+            i += 2;
+            literal_start = i;
+            continue;
+        }
+        if (i > literal_start)
+        {
+            emit(FormatSegmentKind::Literal, literal_start, i - literal_start, 0);
+        }
+        i++;
+
+        u64 arg_index = 0;
+        if (i < size && fmt[i] >= '0' && fmt[i] <= '9')
+        {
+            while (i < size && fmt[i] >= '0' && fmt[i] <= '9')
+            {
+                arg_index = arg_index * 10 + static_cast<u64>(fmt[i] - '0');
+                i++;
+            }
+            has_manual_index = true;
+        }
+        else
+        {
+            arg_index = next_arg_index++;
+            has_automatic_index = true;
+        }
+        if (has_automatic_index && has_manual_index)
+        {
+            FormatStringError("Format string mixes automatic and manual argument indices");
+        }
+
+        u64 spec_start = i;
+        if (i < size && fmt[i] == ':')
+        {
+            i++;
+            spec_start = i;
+            while (i < size && fmt[i] != '}')
+            {
+                if (fmt[i] == '{')
+                {
+                    FormatStringError("Nested replacement fields are not supported in compile-time format strings");
+                }
+                i++;
+            }
+        }
+        if (i >= size || fmt[i] != '}')
+        {
+            FormatStringError("Unterminated replacement field in format string");
+        }
+        emit(FormatSegmentKind::Argument, spec_start, i - spec_start, arg_index);
+        i++;
+        literal_start = i;
+    }
+    if (size > literal_start)
+    {
+        emit(FormatSegmentKind::Literal, literal_start, size - literal_start, 0);
+    }
+    return count;
+}
+
+/** Segments of the format string @p k_fmt, parsed once at compile time. */
+template <FixedString k_fmt>
+struct CompiledFormat
+{
+    static constexpr u64 k_segment_count = ParseFormatString(k_fmt.data, k_fmt.GetSize(), nullptr);
+
+    struct Segments
+    {
+        FormatSegment items[k_segment_count > 0 ? k_segment_count : 1];
+    };
+
+    static constexpr Segments k_segments = []() consteval
+    {
+        Segments segments{};
+        ParseFormatString(k_fmt.data, k_fmt.GetSize(), segments.items);
+        return segments;
+    }();
+
+    /** Number of arguments the format string refers to. */
+    static constexpr u64 k_argument_count = []
+    {
+        u64 count = 0;
+        for (u64 i = 0; i < k_segment_count; i++)
+        {
+            const FormatSegment& segment = k_segments.items[i];
+            if (segment.kind == FormatSegmentKind::Argument && segment.arg_index + 1 > count)
+            {
+                count = segment.arg_index + 1;
+            }
+        }
+        return count;
+    }();
+
+    /** Number of characters written for the literal text. */
+    static constexpr u64 k_literal_size = []
+    {
+        u64 size = 0;
+        for (u64 i = 0; i < k_segment_count; i++)
+        {
+            if (k_segments.items[i].kind == FormatSegmentKind::Literal)
+            {
+                size += k_segments.items[i].size;
+            }
+        }
+        return size;
+    }();
+};
+
+/** Integer format options that are written without std::format: [#][0][width][d|x|X|b|o]. */
+struct IntegerFormatSpec
+{
+    bool is_supported = false;
+    bool alternate_form = false;
+    bool zero_pad = false;
+    bool upper_case = false;
+    u64 width = 0;
+    i32 base = 10;
+};
+
+consteval IntegerFormatSpec ParseIntegerFormatSpec(const char8* spec, u64 size)
+{
+    IntegerFormatSpec result;
+    u64 i = 0;
+    if (i < size && spec[i] == '#')
+    {
+        result.alternate_form = true;
+        i++;
+    }
+    if (i < size && spec[i] == '0')
+    {
+        result.zero_pad = true;
+        i++;
+    }
+    while (i < size && spec[i] >= '0' && spec[i] <= '9')
+    {
+        result.width = result.width * 10 + static_cast<u64>(spec[i] - '0');
+        i++;
+    }
+    if (i < size)
+    {
+        switch (spec[i])
+        {
+            case 'd':
+                break;
+            case 'x':
+                result.base = 16;
+                break;
+            case 'X':
+                result.base = 16;
+                result.upper_case = true;
+                break;
+            case 'b':
+                result.base = 2;
+                break;
+            case 'o':
+                result.base = 8;
+                break;
+            default:
+                return result;
+        }
+        i++;
+    }
+    result.is_supported = i == size;
+    return result;
+}
+
+/** Replacement field "{:options}" of @p k_segment for std::format, with the argument index removed. */
+template <FixedString k_fmt, FormatSegment k_segment>
+struct FormatFieldString
+{
+    static constexpr u64 k_size = k_segment.size + 3;
+
+    struct Storage
+    {
+        char8 data[k_size];
+    };
+
+    static constexpr Storage k_storage = []
+    {
+        Storage storage{};
+        storage.data[0] = '{';
+        storage.data[1] = ':';
+        for (u64 i = 0; i < k_segment.size; i++)
+        {
+            storage.data[i + 2] = k_fmt.data[k_segment.offset + i];
+        }
+        storage.data[k_size - 1] = '}';
+        return storage;
+    }();
+};
+
+/** Output iterator for std::format_to that appends to a StringUtf8, StringBuilder or FormatBuffer. */
+template <typename Sink>
+struct FormatSinkIterator
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    Sink* m_sink;
+
+    explicit FormatSinkIterator(Sink& sink) : m_sink(&sink) {}
+
+    FormatSinkIterator& operator=(char c)
+    {
+        m_sink->Append(c);
+        return *this;
+    }
+
+    FormatSinkIterator& operator*() { return *this; }
+    FormatSinkIterator& operator++() { return *this; }
+    FormatSinkIterator operator++(int) { return *this; }
+};
+
+/** Fixed-size output of FormatTo. Output that does not fit is cut off. */
+struct FormatBuffer
+{
+    char8* position;
+    char8* end;
+    bool is_truncated = false;
+
+    void Append(char8 value)
+    {
+        if (position == end)
+        {
+            is_truncated = true;
+            return;
+        }
+        *position++ = value;
+    }
+
+    void Append(const char8* data, u64 size)
+    {
+        const u64 available = static_cast<u64>(end - position);
+        if (size > available)
+        {
+            size = available;
+            is_truncated = true;
+        }
+        std::memcpy(position, data, static_cast<size_t>(size));
+        position += size;
+    }
+};
+
+template <typename T>
+concept StringFormattable = std::is_convertible_v<const T&, StringViewUtf8>;
+
+template <IntegerFormatSpec k_spec, typename Sink, typename T>
+void WriteFormattedInteger(Sink& sink, T value)
+{
+    // Large enough for 64 binary digits, a sign and a base prefix.
+    constexpr u64 k_buffer_size = 72;
+    char8 digits[k_buffer_size];
+    char8* digits_end = ToChars(digits, digits + k_buffer_size, value, k_spec.base).GetValue();
+    char8* digits_begin = digits;
+    const bool is_negative = *digits_begin == '-';
+    if (is_negative)
+    {
+        digits_begin++;
+    }
+    if constexpr (k_spec.upper_case)
+    {
+        for (char8* c = digits_begin; c != digits_end; c++)
+        {
+            if (*c >= 'a' && *c <= 'z')
+            {
+                *c = static_cast<char8>(*c - 'a' + 'A');
+            }
+        }
+    }
+
+    char8 prefix[3] = {};
+    u64 prefix_size = 0;
+    if (is_negative)
+    {
+        prefix[prefix_size++] = '-';
+    }
+    if constexpr (k_spec.alternate_form && k_spec.base == 8)
+    {
+        // Like std::format, zero is written without the octal prefix.
+        if (value != 0)
+        {
+            prefix[prefix_size++] = '0';
+        }
+    }
+    else if constexpr (k_spec.alternate_form && k_spec.base != 10)
+    {
+        prefix[prefix_size++] = '0';
+        prefix[prefix_size++] = k_spec.base == 2 ? 'b' : (k_spec.upper_case ? 'X' : 'x');
+    }
+
+    const u64 digit_count = static_cast<u64>(digits_end - digits_begin);
+    const u64 size = prefix_size + digit_count;
+    const u64 padding = k_spec.width > size ? k_spec.width - size : 0;
+    if constexpr (!k_spec.zero_pad)
+    {
+        for (u64 i = 0; i < padding; i++)
+        {
+            sink.Append(' ');
+        }
+    }
+    sink.Append(prefix, prefix_size);
+    if constexpr (k_spec.zero_pad)
+    {
+        for (u64 i = 0; i < padding; i++)
+        {
+            sink.Append('0');
+        }
+    }
+    sink.Append(digits_begin, digit_count);
+}
+
+/**
+ * Write one argument. Numbers, booleans, characters and strings without options and integers with simple options are
+ * written directly. Everything else goes through std::format_to with a format string that is checked at compile time.
+ */
+template <FixedString k_fmt, FormatSegment k_segment, typename Sink, typename T>
+void WriteFormatArgument(Sink& sink, const T& value)
+{
+    constexpr bool k_has_options = k_segment.size > 0;
+    constexpr IntegerFormatSpec k_integer_spec = ParseIntegerFormatSpec(k_fmt.data + k_segment.offset, k_segment.size);
+    if constexpr (!k_has_options && ToCharsFormattable<T>)
+    {
+        char8 buffer[k_max_to_chars_size];
+        const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, value).GetValue();
+        sink.Append(buffer, static_cast<u64>(end - buffer));
+    }
+    else if constexpr (k_integer_spec.is_supported && ToCharsFormattable<T> && Integral<T>)
+    {
+        WriteFormattedInteger<k_integer_spec>(sink, value);
+    }
+    else if constexpr (!k_has_options && SameAs<T, bool>)
+    {
+        if (value)
+        {
+            sink.Append("true", 4);
+        }
+        else
+        {
+            sink.Append("false", 5);
+        }
+    }
+    else if constexpr (!k_has_options && SameAs<T, char8>)
+    {
+        sink.Append(value);
+    }
+    else if constexpr (StringFormattable<T>)
+    {
+        const StringViewUtf8 str(value);
+        if constexpr (!k_has_options)
+        {
+            sink.Append(str.GetData(), str.GetSize());
+        }
+        else
+        {
+            using Field = FormatFieldString<k_fmt, k_segment>;
+            std::format_to(FormatSinkIterator<Sink>(sink),
+                           std::format_string<std::string_view>(std::string_view(Field::k_storage.data, Field::k_size)),
+                           std::string_view(str.GetData(), str.GetSize()));
+        }
+    }
+    else
+    {
+        using Field = FormatFieldString<k_fmt, k_segment>;
+        std::format_to(FormatSinkIterator<Sink>(sink), std::format_string<const T&>(std::string_view(Field::k_storage.data, Field::k_size)),
+                       value);
+    }
+}
+
+template <FixedString k_fmt, u64 k_index, typename Sink, typename... Args>
+void WriteFormatSegment(Sink& sink, const Args&... args)
+{
+    constexpr FormatSegment k_segment = CompiledFormat<k_fmt>::k_segments.items[k_index];
+    if constexpr (k_segment.kind == FormatSegmentKind::Literal)
+    {
+        if constexpr (k_segment.size == 1)
+        {
+            sink.Append(k_fmt.data[k_segment.offset]);
+        }
+        else
+        {
+            sink.Append(k_fmt.data + k_segment.offset, k_segment.size);
+        }
+    }
+    else
+    {
+        WriteFormatArgument<k_fmt, k_segment>(sink, std::get<k_segment.arg_index>(std::forward_as_tuple(args...)));
+    }
+}
+
+template <FixedString k_fmt, typename Sink, typename... Args, u64... k_indices>
+void WriteFormat(Sink& sink, std::integer_sequence<u64, k_indices...>, const Args&... args)
+{
+    static_assert(CompiledFormat<k_fmt>::k_argument_count <= sizeof...(Args), "Format string refers to more arguments than were passed");
+    (WriteFormatSegment<k_fmt, k_indices>(sink, args...), ...);
+}
+
+template <typename T>
+u64 EstimateFormattedSize(const T& value)
+{
+    if constexpr (ToCharsFormattable<T>)
+    {
+        return k_max_to_chars_size;
+    }
+    else if constexpr (SameAs<T, StringUtf8> || SameAs<T, StringViewUtf8>)
+    {
+        return value.GetSize();
+    }
+    else
+    {
+        return 8;
+    }
+}
+
+}  // namespace Impl
+
+/**
+ * Append formatted text to a string. The format string is parsed at compile time, so a malformed format string, options
+ * that do not fit an argument or too few arguments fail to compile, and nothing is parsed at runtime.
+ *
+ * Literal text is copied directly. Numbers, booleans, characters and strings with a plain "{}" and integers with the
+ * options [#][0][width][d|x|X|b|o] are written without std::format. Other options go through std::format_to. The string
+ * grows once by an estimate of the output size. Nested replacement fields such as "{:{}}" are not supported.
+ *
+ * @tparam k_fmt  Format string using std::format syntax (e.g., "{}", "{:.2f}", "{:#x}").
+ * @param output  String to append to.
+ * @param args    Values to format into the string. StringUtf8, StringViewUtf8 and C strings can be used directly.
+ */
+template <FixedString k_fmt, typename... Args>
+void AppendFormat(StringUtf8& output, const Args&... args)
+{
+    using Compiled = Impl::CompiledFormat<k_fmt>;
+    const u64 required = output.GetSize() + Compiled::k_literal_size + (Impl::EstimateFormattedSize(args) + ... + 0) + 1;
+    if (required > output.GetCapacity())
+    {
+        output.Reserve(required > output.GetCapacity() * 2 ? required : output.GetCapacity() * 2);
+    }
+    Impl::WriteFormat<k_fmt>(output, std::make_integer_sequence<u64, Compiled::k_segment_count>(), args...);
+}
+
+/**
+ * Append formatted text to a StringBuilder. See AppendFormat for StringUtf8.
+ */
+template <FixedString k_fmt, typename... Args>
+void AppendFormat(StringBuilder& output, const Args&... args)
+{
+    Impl::WriteFormat<k_fmt>(output, std::make_integer_sequence<u64, Impl::CompiledFormat<k_fmt>::k_segment_count>(), args...);
+}
+
+/**
+ * Create a new formatted string. See AppendFormat for StringUtf8.
+ */
+template <FixedString k_fmt, typename... Args>
+StringUtf8 Format(const Args&... args)
+{
+    StringUtf8 result;
+    AppendFormat<k_fmt>(result, args...);
+    return result;
+}
+
+/**
+ * Write formatted text to [first, last) without a null terminator. See AppendFormat for StringUtf8.
+ * @return Pointer one past the last written character. ErrorCode::InsufficientSpace when the output does not fit, in
+ * which case the buffer holds as much of the output as fits.
+ */
+template <FixedString k_fmt, typename... Args>
+Expected<char8*, ErrorCode> FormatTo(char8* first, char8* last, const Args&... args)
+{
+    Impl::FormatBuffer buffer{first, last};
+    Impl::WriteFormat<k_fmt>(buffer, std::make_integer_sequence<u64, Impl::CompiledFormat<k_fmt>::k_segment_count>(), args...);
+    if (buffer.is_truncated)
+    {
+        return Expected<char8*, ErrorCode>(ErrorCode::InsufficientSpace);
+    }
+    return Expected<char8*, ErrorCode>(buffer.position);
+}
+
 }  // namespace Opal
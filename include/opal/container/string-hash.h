@@ -1,5 +1,6 @@
 #pragma once
 
+#include "opal/container/string-view.h"
 #include "opal/container/string.h"
 #include "opal/hash.h"
 
@@ -15,4 +16,16 @@ struct StringHash
     }
 };
 
+/** Hash functor that matches EqualsIgnoreCase, for tables with case-insensitive UTF-8 keys. */
+struct StringHashIgnoreCase
+{
+    size_t operator()(StringViewUtf8 str) const { return HashIgnoreCase(str); }
+};
+
+/** Equality functor that goes with StringHashIgnoreCase. */
+struct StringEqualsIgnoreCase
+{
+    bool operator()(StringViewUtf8 first, StringViewUtf8 second) const { return EqualsIgnoreCase(first, second); }
+};
+
 } // namespace Opal
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "opal/allocator.h"
+#include "opal/container/expected.h"
+#include "opal/container/hash-set.h"
+#include "opal/container/string-view.h"
+#include "opal/error-codes.h"
+#include "opal/export.h"
+#include "opal/hash.h"
+#include "opal/threading/mutex.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+namespace Impl
+{
+
+/**
+ * Header of an interned string. The code units follow the header in memory and are null-terminated.
+ */
+struct InternedStringData
+{
+    u64 hash;
+    u64 size;
+
+    [[nodiscard]] const char8* GetData() const { return reinterpret_cast<const char8*>(this + 1); }
+};
+
+/**
+ * Key of the lookup table of StringPool. Keys used for lookups point to the caller's string, keys stored in the table
+ * point to the code units of an InternedStringData.
+ */
+struct StringPoolKey
+{
+    u64 hash = 0;
+    u64 size = 0;
+    const char8* data = nullptr;
+
+    bool operator==(const StringPoolKey& other) const;
+};
+
+}  // namespace Impl
+
+template <>
+struct Hasher<Impl::StringPoolKey>
+{
+    u64 operator()(const Impl::StringPoolKey& key) const { return key.hash; }
+};
+
+/**
+ * Handle to a string stored in a StringPool.
+ *
+ * The handle is the size of a pointer and can be freely copied. Equal strings interned in the same pool get the same
+ * handle, so comparing two handles is a pointer comparison and the hash is computed only once, when the string is
+ * interned. Handles stay valid for the lifetime of the pool.
+ *
+ * A default constructed handle represents the empty string. Handles from different pools never compare equal unless
+ * both are empty.
+ */
+class InternedString
+{
+public:
+    InternedString() = default;
+
+    [[nodiscard]] StringViewUtf8 GetView() const
+    {
+        return m_data != nullptr ? StringViewUtf8(m_data->GetData(), m_data->size) : StringViewUtf8();
+    }
+
+    /** Returns a null-terminated string. */
+    [[nodiscard]] const char8* GetData() const { return m_data != nullptr ? m_data->GetData() : ""; }
+    [[nodiscard]] u64 GetSize() const { return m_data != nullptr ? m_data->size : 0; }
+    [[nodiscard]] bool IsEmpty() const { return m_data == nullptr; }
+
+    /** Returns the hash of the string contents that was computed when the string was interned. */
+    [[nodiscard]] u64 GetHash() const { return m_data != nullptr ? m_data->hash : 0; }
+
+    bool operator==(const InternedString& other) const { return m_data == other.m_data; }
+
+private:
+    friend class StringPool;
+
+    explicit InternedString(const Impl::InternedStringData* data) : m_data(data) {}
+
+    const Impl::InternedStringData* m_data = nullptr;
+};
+
+template <>
+struct Hasher<InternedString>
+{
+    u64 operator()(const InternedString& str) const { return str.GetHash(); }
+};
+
+/**
+ * Thread-safe pool of unique strings.
+ *
+ * Strings are copied into a linear arena that never moves or frees them, so handles returned by Intern() stay valid until
+ * the pool is destroyed. A HashSet finds the existing copy of a string. Interning and lookups take a lock, so strings
+ * should be interned once up front and the handles kept around for comparisons and hash map lookups.
+ */
+class OPAL_EXPORT StringPool
+{
+public:
+    /**
+     * @param desc Memory reserved for the string arena. The reserved range is virtual memory that is committed as
+     *        strings are added.
+     */
+    explicit StringPool(const SystemMemoryAllocatorDesc& desc = {.bytes_to_reserve = OPAL_MB(64)});
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * Get the handle to @p str, copying it into the pool if it was not interned before.
+     * @param str String to intern.
+     * @return Handle that compares equal to all other handles of the same string from this pool.
+     * @throw OutOfMemoryException When the arena runs out of reserved memory.
+     */
+    InternedString Intern(StringViewUtf8 str);
+
+    /**
+     * Get the handle to @p str without adding it to the pool.
+     * @param str String to look up.
+     * @return Handle to the string or ErrorCode::StringNotFound if it was never interned.
+     */
+    Expected<InternedString, ErrorCode> Find(StringViewUtf8 str) const;
+
+    /** Returns the number of unique non-empty strings in the pool. */
+    [[nodiscard]] u64 GetSize() const;
+
+private:
+    struct State
+    {
+        explicit State(const SystemMemoryAllocatorDesc& desc) : arena("StringPool", desc) {}
+
+        LinearAllocator arena;
+        HashSet<Impl::StringPoolKey> lookup;
+    };
+
+    mutable Mutex<State> m_state;
+};
+
+}  // namespace Opal
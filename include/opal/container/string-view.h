@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "opal/container/array-view.h"
 #include "opal/container/expected.h"
 #include "opal/container/iterator.h"
@@ -7,6 +9,7 @@
 #include "opal/container/string.h"
 #include "opal/error-codes.h"
 #include "opal/exceptions.h"
+#include "opal/export.h"
 #include "opal/types.h"
 
 namespace Opal
@@ -176,18 +179,11 @@ public:
         {
             return false;
         }
-        if (m_data == other.m_data)
+        if (m_data == other.m_data || m_size == 0)
         {
             return true;
         }
-        for (size_type i = 0; i < m_size; ++i)
-        {
-            if (m_data[i] != other.m_data[i])
-            {
-                return false;
-            }
-        }
-        return true;
+        return std::memcmp(m_data, other.m_data, m_size * sizeof(CodeUnitType)) == 0;
     }
 
     // Iterators
@@ -215,6 +211,228 @@ String<CodeUnitType, EncodingType> StringView<CodeUnitType, EncodingType>::ToStr
     return {m_data, m_size};
 }
 
+/**
+ * How SplitIterator recognizes a delimiter.
+ */
+enum class SplitMode : u8
+{
+    /** Delimiter is a single code unit. */
+    Character,
+    /** Delimiter is a sequence of code units that has to match completely. */
+    Sequence,
+    /** Delimiter is any single code unit from a set. */
+    AnyOf,
+};
+
+/**
+ * @brief Forward iterator over the tokens of a string separated by delimiters. Tokens are views into the original
+ * string, so iterating never allocates. The string and the delimiter view must outlive the iterator.
+ *
+ * Two consecutive delimiters produce an empty token, as do delimiters at the start and at the end of the string, unless
+ * empty tokens are skipped. For strings with 8-bit code units, delimiters are located with the vectorized search
+ * kernels used by Find.
+ */
+template <typename CodeUnitType, typename EncodingType>
+class SplitIterator
+{
+public:
+    using ViewType = StringView<CodeUnitType, EncodingType>;
+    using value_type = ViewType;
+    using difference_type = i64;
+    using reference = const ViewType&;
+    using pointer = const ViewType*;
+    using size_type = u64;
+
+    /** @brief Creates the end iterator. */
+    SplitIterator() = default;
+
+    /**
+     * @brief Creates an iterator that points to the first token of @p str.
+     * @param str String to split.
+     * @param delimiters Delimiter sequence for SplitMode::Sequence, or set of delimiters for SplitMode::AnyOf. An empty
+     *        view never matches, so the whole string becomes one token.
+     * @param delimiter Delimiter for SplitMode::Character.
+     * @param mode How delimiters are recognized.
+     * @param skip_empty If true, empty tokens are skipped.
+     */
+    SplitIterator(ViewType str, ViewType delimiters, CodeUnitType delimiter, SplitMode mode, bool skip_empty)
+        : m_str(str), m_delimiters(delimiters), m_delimiter(delimiter), m_mode(mode), m_skip_empty(skip_empty), m_next_pos(0)
+    {
+        Advance();
+    }
+
+    reference operator*() const { return m_token; }
+    pointer operator->() const { return &m_token; }
+
+    SplitIterator& operator++()
+    {
+        Advance();
+        return *this;
+    }
+
+    SplitIterator operator++(int)
+    {
+        SplitIterator copy = *this;
+        Advance();
+        return copy;
+    }
+
+    bool operator==(const SplitIterator& other) const
+    {
+        return m_is_end == other.m_is_end && (m_is_end || m_token.GetData() == other.m_token.GetData());
+    }
+
+private:
+    void Advance();
+    size_type FindDelimiter(size_type start_pos, size_type& delimiter_size) const;
+
+    ViewType m_str;
+    ViewType m_delimiters;
+    ViewType m_token;
+    CodeUnitType m_delimiter = 0;
+    SplitMode m_mode = SplitMode::Character;
+    bool m_skip_empty = false;
+    bool m_is_end = true;
+    size_type m_next_pos = ViewType::k_npos;
+};
+
+/**
+ * @brief Lazy range of tokens returned by Tokenize and TokenizeAnyOf.
+ */
+template <typename CodeUnitType, typename EncodingType>
+class SplitRange
+{
+public:
+    using iterator = SplitIterator<CodeUnitType, EncodingType>;
+
+    explicit SplitRange(iterator first) : m_begin(first) {}
+
+    iterator begin() const { return m_begin; }
+    iterator end() const { return iterator(); }
+
+private:
+    iterator m_begin;
+};
+
+/**
+ * @brief Split a string around a single code unit without allocating.
+ * @param str String or view to split. Must outlive the returned range.
+ * @param delimiter Code unit that separates tokens.
+ * @param skip_empty If true, empty tokens are not returned.
+ * @return Range of StringView tokens.
+ */
+template <StringLike StringClass>
+SplitRange<typename StringClass::value_type, typename StringClass::encoding_type> Tokenize(const StringClass& str,
+                                                                                           typename StringClass::value_type delimiter,
+                                                                                           bool skip_empty = false)
+{
+    using RangeType = SplitRange<typename StringClass::value_type, typename StringClass::encoding_type>;
+    using IteratorType = typename RangeType::iterator;
+    using ViewType = typename IteratorType::ViewType;
+    return RangeType(IteratorType(ViewType(str.GetData(), str.GetSize()), ViewType(), delimiter, SplitMode::Character, skip_empty));
+}
+
+/**
+ * @brief Split a string around a sequence of code units without allocating.
+ * @param str String or view to split. Must outlive the returned range.
+ * @param delimiter Sequence that separates tokens. Must outlive the returned range.
+ * @param skip_empty If true, empty tokens are not returned.
+ * @return Range of StringView tokens.
+ */
+template <StringLike StringClass>
+SplitRange<typename StringClass::value_type, typename StringClass::encoding_type> Tokenize(
+    const StringClass& str, StringView<typename StringClass::value_type, typename StringClass::encoding_type> delimiter,
+    bool skip_empty = false)
+{
+    using RangeType = SplitRange<typename StringClass::value_type, typename StringClass::encoding_type>;
+    using IteratorType = typename RangeType::iterator;
+    using ViewType = typename IteratorType::ViewType;
+    return RangeType(IteratorType(ViewType(str.GetData(), str.GetSize()), delimiter, 0, SplitMode::Sequence, skip_empty));
+}
+
+/**
+ * @brief Split a string around any code unit from a set without allocating.
+ * @param str String or view to split. Must outlive the returned range.
+ * @param delimiters Code units that separate tokens. Must outlive the returned range.
+ * @param skip_empty If true, empty tokens are not returned.
+ * @return Range of StringView tokens.
+ */
+template <StringLike StringClass>
+SplitRange<typename StringClass::value_type, typename StringClass::encoding_type> TokenizeAnyOf(
+    const StringClass& str, StringView<typename StringClass::value_type, typename StringClass::encoding_type> delimiters,
+    bool skip_empty = false)
+{
+    using RangeType = SplitRange<typename StringClass::value_type, typename StringClass::encoding_type>;
+    using IteratorType = typename RangeType::iterator;
+    using ViewType = typename IteratorType::ViewType;
+    return RangeType(IteratorType(ViewType(str.GetData(), str.GetSize()), delimiters, 0, SplitMode::AnyOf, skip_empty));
+}
+
+template <typename CodeUnitType, typename EncodingType>
+void SplitIterator<CodeUnitType, EncodingType>::Advance()
+{
+    while (m_next_pos != ViewType::k_npos)
+    {
+        size_type delimiter_size = 0;
+        const size_type found = FindDelimiter(m_next_pos, delimiter_size);
+        const size_type token_end = found == ViewType::k_npos ? m_str.GetSize() : found;
+        m_token = ViewType(m_str.GetData() + m_next_pos, token_end - m_next_pos);
+        m_next_pos = found == ViewType::k_npos ? ViewType::k_npos : found + delimiter_size;
+        if (!m_skip_empty || !m_token.IsEmpty())
+        {
+            m_is_end = false;
+            return;
+        }
+    }
+    m_is_end = true;
+    m_token = ViewType();
+}
+
+template <typename CodeUnitType, typename EncodingType>
+typename SplitIterator<CodeUnitType, EncodingType>::size_type SplitIterator<CodeUnitType, EncodingType>::FindDelimiter(
+    size_type start_pos, size_type& delimiter_size) const
+{
+    delimiter_size = 1;
+    if (start_pos >= m_str.GetSize())
+    {
+        return ViewType::k_npos;
+    }
+    switch (m_mode)
+    {
+        case SplitMode::Character:
+            return Find(m_str, m_delimiter, start_pos);
+        case SplitMode::Sequence:
+            if (m_delimiters.IsEmpty())
+            {
+                return ViewType::k_npos;
+            }
+            delimiter_size = m_delimiters.GetSize();
+            return Find(m_str, m_delimiters.GetData(), start_pos, m_delimiters.GetSize());
+        case SplitMode::AnyOf:
+            break;
+    }
+    if constexpr (sizeof(CodeUnitType) == 1)
+    {
+        const u64 pos = Impl::FindAnyByte(reinterpret_cast<const u8*>(m_str.GetData()) + start_pos, m_str.GetSize() - start_pos,
+                                          reinterpret_cast<const u8*>(m_delimiters.GetData()), m_delimiters.GetSize());
+        return pos == ViewType::k_npos ? ViewType::k_npos : start_pos + pos;
+    }
+    else
+    {
+        for (size_type pos = start_pos; pos < m_str.GetSize(); ++pos)
+        {
+            for (size_type i = 0; i < m_delimiters.GetSize(); ++i)
+            {
+                if (m_str.At(pos) == m_delimiters.At(i))
+                {
+                    return pos;
+                }
+            }
+        }
+        return ViewType::k_npos;
+    }
+}
+
 /*************************************************************************************************/
 /** Most common StringView specializations. ******************************************************/
 /*************************************************************************************************/
@@ -224,4 +442,18 @@ using StringViewUtf32 = StringView<uchar32, EncodingUtf32LE<uchar32>>;
 using StringViewLocale = StringView<char8, EncodingLocale>;
 using StringViewWide = StringView<char16, EncodingUtf16LE<char16>>;
 
+/**
+ * Check if two UTF-8 strings are equal ignoring case, using Unicode full case folding as defined by CaseFolding.txt
+ * without the Turkic mappings. For example "Straße" equals "STRASSE". Runs of ASCII are compared 16 or 32 bytes at a
+ * time, other code points are folded one at a time. Does not allocate. Bytes that are not valid UTF-8 only match
+ * themselves.
+ */
+OPAL_EXPORT bool EqualsIgnoreCase(StringViewUtf8 first, StringViewUtf8 second);
+
+/**
+ * Hash a UTF-8 string so that strings that are equal according to EqualsIgnoreCase get the same hash. The hash is
+ * computed over the case folded text, with runs of ASCII lower cased 16 or 32 bytes at a time. Does not allocate.
+ */
+OPAL_EXPORT u64 HashIgnoreCase(StringViewUtf8 str, u64 seed = 0);
+
 }  // namespace Opal
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <cstring>
 
 #include "opal/allocator.h"
+#include "opal/char-conv.h"
 #include "opal/container/array-view.h"
 #include "opal/container/dynamic-array.h"
 #include "opal/container/string-encoding.h"
@@ -702,6 +703,17 @@ template <StringLike StringClass>
 Expected<i32, ErrorCode> Compare(const StringClass& first, typename StringClass::size_type pos1, typename StringClass::size_type count1,
                                  const typename StringClass::value_type* second, typename StringClass::size_type count2);
 
+/**
+ * @brief Check if two strings or views contain the same code units. Cheaper than Compare when the order is not needed,
+ * since strings of different sizes are rejected without looking at the code units.
+ * @param first First string to compare.
+ * @param second Second string to compare.
+ * @return True if both have the same size and the same code units.
+ */
+template <StringLike FirstStringClass, StringLike SecondStringClass>
+    requires SameAs<typename FirstStringClass::value_type, typename SecondStringClass::value_type>
+bool Equals(const FirstStringClass& first, const SecondStringClass& second);
+
 template <StringLike StringClass>
 StringClass operator+(const StringClass& lhs, const StringClass& rhs);
 
@@ -717,6 +729,64 @@ StringClass operator+(const typename StringClass::value_type* lhs, const StringC
 template <StringLike StringClass>
 StringClass operator+(typename StringClass::value_type ch, const StringClass& rhs);
 
+namespace Impl
+{
+
+/**
+ * Search kernels used by Find and ReverseFind for strings with 8-bit code units. They use SSE2 or AVX2 when the target
+ * supports them. All of them return the offset of the match from @p data, or -1 converted to u64 if there is no match.
+ */
+
+/** Find the first occurrence of @p value in [data, data + size). */
+OPAL_EXPORT u64 FindByte(const u8* data, u64 size, u8 value);
+
+/** Find the last occurrence of @p value in [data, data + size). */
+OPAL_EXPORT u64 ReverseFindByte(const u8* data, u64 size, u8 value);
+
+/**
+ * Find the first occurrence of a needle that lies entirely inside [data, data + size). Short needles are located by
+ * comparing the first and the last byte of the needle against 16 or 32 positions at once. Long needles use
+ * Boyer-Moore-Horspool. @p needle_size must not be zero.
+ */
+OPAL_EXPORT u64 FindBytes(const u8* data, u64 size, const u8* needle, u64 needle_size);
+
+/** Find the last occurrence of a needle that lies entirely inside [data, data + size). @p needle_size must not be zero. */
+OPAL_EXPORT u64 ReverseFindBytes(const u8* data, u64 size, const u8* needle, u64 needle_size);
+
+/** Find the first byte in [data, data + size) that is equal to any of the bytes in [set, set + set_size). */
+OPAL_EXPORT u64 FindAnyByte(const u8* data, u64 size, const u8* set, u64 set_size);
+
+/** Find the first position where [first, first + size) and [second, second + size) differ. */
+OPAL_EXPORT u64 FindFirstMismatch(const u8* first, const u8* second, u64 size);
+
+/** Compare @p count code units. Strings with 8-bit code units are compared 16 or 32 code units at a time. */
+template <typename CodeUnitType>
+i32 CompareCodeUnits(const CodeUnitType* first, const CodeUnitType* second, u64 count)
+{
+    if constexpr (sizeof(CodeUnitType) == 1)
+    {
+        const u64 pos = FindFirstMismatch(reinterpret_cast<const u8*>(first), reinterpret_cast<const u8*>(second), count);
+        if (pos == static_cast<u64>(-1))
+        {
+            return 0;
+        }
+        return first[pos] < second[pos] ? -1 : 1;
+    }
+    else
+    {
+        for (u64 i = 0; i < count; i++)
+        {
+            if (first[i] != second[i])
+            {
+                return first[i] < second[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+}
+
+}  // namespace Impl
+
 /**
  * @brief Find the first occurrence of a string in another string.
  * @tparam StringClass String type to search in.
@@ -914,6 +984,13 @@ using StringWide = String<char16, EncodingUtf16LE<char16>>;
 template <Integral T>
 StringUtf8 NumberToString(T value, NumberSystemBase base = NumberSystemBase::Decimal, bool add_leading_zeros = false);
 
+/**
+ * Converts a floating point number to a string in fixed notation. The decimal separator is always '.', whatever the
+ * current locale is.
+ * @param decimal_points Number of digits after the decimal point. A negative value uses six, like printf("%f").
+ * @return Number as a string.
+ * @throw OutOfMemoryException when default allocator runs out of memory.
+ */
 template <FloatingPoint T>
 StringUtf8 NumberToString(T value, i32 decimal_points = -1);
 
@@ -921,15 +998,22 @@ StringUtf8 NumberToString(T value, i32 decimal_points = -1);
  * Converts a string to an integral type.
  * @tparam T Integral type to convert to.
  * @tparam StringClass String-like type that supports operator* returning a const char pointer (e.g. StringUtf8, StringViewUtf8).
- * @param str String to convert.
+ * @param str String to convert. The whole string must be a number with an optional leading '-'.
  * @param base Number base system used. If 0, the base is auto-detected from the string prefix (0x for hex, 0 for octal, etc.).
  * @return Converted value.
+ * @throw InvalidArgumentException when the string is not a number or the number does not fit into T.
  */
 template <Integral T, StringLike StringClass>
 T StringToNumber(const StringClass& str, i32 base = 0);
 template <Integral T>
 T StringToNumber(const char8* str, i32 base = 0);
 
+namespace Impl
+{
+template <Integral T>
+T ParseWholeNumber(const char8* first, const char8* last, i32 base);
+}  // namespace Impl
+
 };  // namespace Opal
 
 #define TEMPLATE_HEADER template <typename CodeUnitType, typename EncodingType>
@@ -2179,6 +2263,39 @@ template <typename InputStringClass, typename OutputStringClass>
              Opal::EncodableEncoding<typename OutputStringClass::encoding_type>
 Opal::ErrorCode Opal::Transcode(const InputStringClass& input, OutputStringClass& output)
 {
+    constexpr u64 k_input_unit_size = Impl::k_unicode_code_unit_size<typename InputStringClass::encoding_type>;
+    constexpr u64 k_output_unit_size = Impl::k_unicode_code_unit_size<typename OutputStringClass::encoding_type>;
+    if constexpr ((k_input_unit_size == 1 && (k_output_unit_size == 2 || k_output_unit_size == 4)) ||
+                  (k_output_unit_size == 1 && (k_input_unit_size == 2 || k_input_unit_size == 4)))
+    {
+        using InputUnit = ConditionalType<k_input_unit_size == 1, u8, ConditionalType<k_input_unit_size == 2, u16, u32>>;
+        using OutputUnit = ConditionalType<k_output_unit_size == 1, u8, ConditionalType<k_output_unit_size == 2, u16, u32>>;
+        const ArrayView<const InputUnit> input_span(reinterpret_cast<const InputUnit*>(input.GetData()), input.GetSize());
+        ArrayView<OutputUnit> output_span(reinterpret_cast<OutputUnit*>(output.GetData()), output.GetSize());
+        ErrorCode error = ErrorCode::Success;
+        if constexpr (k_input_unit_size == 1 && k_output_unit_size == 2)
+        {
+            error = TranscodeUtf8ToUtf16(input_span, output_span);
+        }
+        else if constexpr (k_input_unit_size == 1)
+        {
+            error = TranscodeUtf8ToUtf32(input_span, output_span);
+        }
+        else if constexpr (k_input_unit_size == 2)
+        {
+            error = TranscodeUtf16ToUtf8(input_span, output_span);
+        }
+        else
+        {
+            error = TranscodeUtf32ToUtf8(input_span, output_span);
+        }
+        if (error != ErrorCode::Success)
+        {
+            return error;
+        }
+        output.Resize(output.GetSize() - output_span.GetSize());
+        return ErrorCode::Success;
+    }
     typename InputStringClass::encoding_type src_decoder;
     typename OutputStringClass::encoding_type dst_encoder;
     ArrayView<const typename InputStringClass::value_type> input_span(input.GetData(), input.GetSize());
@@ -2440,6 +2557,18 @@ CLASS_HEADER Opal::operator+(typename StringConstIterator<StringClass>::differen
 #undef TEMPLATE_HEADER
 #undef CLASS_HEADER
 
+template <Opal::StringLike FirstStringClass, Opal::StringLike SecondStringClass>
+    requires Opal::SameAs<typename FirstStringClass::value_type, typename SecondStringClass::value_type>
+bool Opal::Equals(const FirstStringClass& first, const SecondStringClass& second)
+{
+    const u64 size = first.GetSize();
+    if (size != second.GetSize())
+    {
+        return false;
+    }
+    return size == 0 || std::memcmp(first.GetData(), second.GetData(), size * sizeof(typename FirstStringClass::value_type)) == 0;
+}
+
 template <Opal::StringLike StringClass>
 Opal::Expected<Opal::i32, Opal::ErrorCode> Opal::Compare(const StringClass& first, const StringClass& second)
 {
@@ -2487,16 +2616,10 @@ Opal::Expected<Opal::i32, Opal::ErrorCode> Opal::Compare(const StringClass& firs
     }
 
     const size_type count = count1 > count2 ? count2 : count1;
-    for (size_type i = 0; i < count; i++)
+    const i32 result = Impl::CompareCodeUnits(first.GetData() + pos1, second.GetData() + pos2, count);
+    if (result != 0)
     {
-        if (first[pos1 + i] < second[pos2 + i])
-        {
-            return ReturnType(-1);
-        }
-        if (first[pos1 + i] > second[pos2 + i])
-        {
-            return ReturnType(1);
-        }
+        return ReturnType(result);
     }
     if (count1 < count2)
     {
@@ -2535,17 +2658,11 @@ Opal::Expected<Opal::i32, Opal::ErrorCode> Opal::Compare(const StringClass& firs
     }
     size_type count2 = GetStringLength(second);
 
-    size_type count = count2 > count1 ? count1 : count2;
-    for (size_type i = 0; i < count; i++)
+    const size_type count = count2 > count1 ? count1 : count2;
+    const i32 result = Impl::CompareCodeUnits(first.GetData() + pos1, second, count);
+    if (result != 0)
     {
-        if (first[pos1 + i] < second[i])
-        {
-            return ReturnType(-1);
-        }
-        if (first[pos1 + i] > second[i])
-        {
-            return ReturnType(1);
-        }
+        return ReturnType(result);
     }
     if (count1 < count2)
     {
@@ -2593,17 +2710,11 @@ Opal::Expected<Opal::i32, Opal::ErrorCode> Opal::Compare(const StringClass& firs
         return ReturnType(ErrorCode::OutOfBounds);
     }
 
-    size_type count = count2 > count1 ? count1 : count2;
-    for (size_type i = 0; i < count; ++i)
+    const size_type count = count2 > count1 ? count1 : count2;
+    const i32 result = Impl::CompareCodeUnits(first.GetData() + pos1, second, count);
+    if (result != 0)
     {
-        if (first[pos1 + i] < second[i])
-        {
-            return ReturnType(-1);
-        }
-        if (first[pos1 + i] > second[i])
-        {
-            return ReturnType(1);
-        }
+        return ReturnType(result);
     }
     if (count1 < count2)
     {
@@ -2701,24 +2812,30 @@ typename StringClass::size_type Opal::Find(const StringClass& haystack, const ty
     {
         return StringClass::k_npos;
     }
-    for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos < haystack.GetSize(); ++haystack_pos)
+    if constexpr (sizeof(typename StringClass::value_type) == 1)
+    {
+        const u64 pos = Impl::FindBytes(reinterpret_cast<const u8*>(haystack.GetData()) + start_pos, haystack.GetSize() - start_pos,
+                                        reinterpret_cast<const u8*>(needle), needle_count);
+        return pos == StringClass::k_npos ? StringClass::k_npos : start_pos + pos;
+    }
+    else
     {
-        bool is_found = false;
-        for (typename StringClass::size_type needle_pos = 0; needle_pos < needle_count; ++needle_pos)
+        const typename StringClass::value_type* data = haystack.GetData();
+        const typename StringClass::size_type last_pos = haystack.GetSize() - needle_count;
+        for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos <= last_pos; ++haystack_pos)
         {
-            // We found the symbol only if there is enough of a haystack to find it
-            is_found = haystack_pos + needle_pos < haystack.GetSize() && needle[needle_pos] == haystack[haystack_pos + needle_pos];
-            if (!is_found)
+            typename StringClass::size_type needle_pos = 0;
+            while (needle_pos < needle_count && needle[needle_pos] == data[haystack_pos + needle_pos])
             {
-                break;
+                ++needle_pos;
+            }
+            if (needle_pos == needle_count)
+            {
+                return haystack_pos;
             }
         }
-        if (is_found)
-        {
-            return haystack_pos;
-        }
+        return StringClass::k_npos;
     }
-    return StringClass::k_npos;
 }
 
 template <Opal::StringLike StringClass>
@@ -2733,14 +2850,24 @@ typename StringClass::size_type Opal::Find(const StringClass& haystack, const ty
     {
         return StringClass::k_npos;
     }
-    for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos < haystack.GetSize(); ++haystack_pos)
+    if constexpr (sizeof(typename StringClass::value_type) == 1)
     {
-        if (haystack[haystack_pos] == ch)
+        const u64 pos = Impl::FindByte(reinterpret_cast<const u8*>(haystack.GetData()) + start_pos, haystack.GetSize() - start_pos,
+                                       static_cast<u8>(ch));
+        return pos == StringClass::k_npos ? StringClass::k_npos : start_pos + pos;
+    }
+    else
+    {
+        const typename StringClass::value_type* data = haystack.GetData();
+        for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos < haystack.GetSize(); ++haystack_pos)
         {
-            return haystack_pos;
+            if (data[haystack_pos] == ch)
+            {
+                return haystack_pos;
+            }
         }
+        return StringClass::k_npos;
     }
-    return StringClass::k_npos;
 }
 
 template <Opal::StringLike StringClass>
@@ -2751,31 +2878,7 @@ typename StringClass::size_type Opal::ReverseFind(const StringClass& haystack, c
     {
         return start_pos >= haystack.GetSize() ? haystack.GetSize() : start_pos;
     }
-    if (start_pos >= haystack.GetSize())
-    {
-        start_pos = haystack.GetSize();
-    }
-    if (needle.GetSize() > start_pos + 1)
-    {
-        return StringClass::k_npos;
-    }
-    for (typename StringClass::size_type haystack_pos = start_pos - needle.GetSize(); haystack_pos != StringClass::k_npos; --haystack_pos)
-    {
-        bool is_found = true;
-        for (typename StringClass::size_type needle_pos = 0; needle_pos < needle.GetSize(); ++needle_pos)
-        {
-            if (needle[needle_pos] != haystack[haystack_pos + needle_pos])
-            {
-                is_found = false;
-                break;
-            }
-        }
-        if (is_found)
-        {
-            return haystack_pos;
-        }
-    }
-    return StringClass::k_npos;
+    return ReverseFind(haystack, needle.GetData(), start_pos, needle.GetSize());
 }
 
 template <Opal::StringLike StringClass>
@@ -2798,31 +2901,37 @@ typename StringClass::size_type Opal::ReverseFind(const StringClass& haystack, c
     {
         return start_pos >= haystack.GetSize() ? haystack.GetSize() : start_pos;
     }
+    // The match has to end before start_pos
     if (start_pos >= haystack.GetSize())
     {
-        start_pos = haystack.GetSize() - 1;
+        start_pos = haystack.GetSize();
     }
-    if (needle_count > start_pos + 1)
+    if (needle_count > start_pos)
     {
         return StringClass::k_npos;
     }
-    for (typename StringClass::size_type haystack_pos = start_pos - needle_count; haystack_pos != StringClass::k_npos; --haystack_pos)
+    if constexpr (sizeof(typename StringClass::value_type) == 1)
     {
-        bool is_found = true;
-        for (typename StringClass::size_type needle_pos = 0; needle_pos < needle_count; ++needle_pos)
+        return Impl::ReverseFindBytes(reinterpret_cast<const u8*>(haystack.GetData()), start_pos, reinterpret_cast<const u8*>(needle),
+                                      needle_count);
+    }
+    else
+    {
+        const typename StringClass::value_type* data = haystack.GetData();
+        for (typename StringClass::size_type haystack_pos = start_pos - needle_count; haystack_pos != StringClass::k_npos; --haystack_pos)
         {
-            if (needle[needle_pos] != haystack[haystack_pos + needle_pos])
+            typename StringClass::size_type needle_pos = 0;
+            while (needle_pos < needle_count && needle[needle_pos] == data[haystack_pos + needle_pos])
             {
-                is_found = false;
-                break;
+                ++needle_pos;
+            }
+            if (needle_pos == needle_count)
+            {
+                return haystack_pos;
             }
         }
-        if (is_found)
-        {
-            return haystack_pos;
-        }
+        return StringClass::k_npos;
     }
-    return StringClass::k_npos;
 }
 
 template <Opal::StringLike StringClass>
@@ -2837,14 +2946,22 @@ typename StringClass::size_type Opal::ReverseFind(const StringClass& haystack, c
     {
         start_pos = haystack.GetSize() - 1;
     }
-    for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos != StringClass::k_npos; --haystack_pos)
+    if constexpr (sizeof(typename StringClass::value_type) == 1)
     {
-        if (haystack[haystack_pos] == ch)
+        return Impl::ReverseFindByte(reinterpret_cast<const u8*>(haystack.GetData()), start_pos + 1, static_cast<u8>(ch));
+    }
+    else
+    {
+        const typename StringClass::value_type* data = haystack.GetData();
+        for (typename StringClass::size_type haystack_pos = start_pos; haystack_pos != StringClass::k_npos; --haystack_pos)
         {
-            return haystack_pos;
+            if (data[haystack_pos] == ch)
+            {
+                return haystack_pos;
+            }
         }
+        return StringClass::k_npos;
     }
-    return StringClass::k_npos;
 }
 
 template <Opal::StringLike StringClass, typename Allocator>
@@ -3108,6 +3225,12 @@ Opal::StringUtf8 GetFormat(Opal::NumberSystemBase number_system_base, bool add_l
 template <Opal::Integral T>
 Opal::StringUtf8 Opal::NumberToString(T value, NumberSystemBase base, bool add_leading_zeros)
 {
+    if (base == NumberSystemBase::Decimal)
+    {
+        char8 buffer[k_max_to_chars_size];
+        const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, value).GetValue();
+        return StringUtf8(buffer, static_cast<u64>(end - buffer));
+    }
     StringUtf8 str(256, 0);
     if (base == NumberSystemBase::Binary)
     {
@@ -3132,54 +3255,63 @@ Opal::StringUtf8 Opal::NumberToString(T value, NumberSystemBase base, bool add_l
 template <Opal::FloatingPoint T>
 Opal::StringUtf8 Opal::NumberToString(T value, i32 decimal_points)
 {
-    StringUtf8 str(256, 0);
-    StringUtf8 format("%");
-    format += decimal_points == -1 ? "" : "." + NumberToString(decimal_points);
-    if constexpr (sizeof(T) == 8)
-    {
-        format += "lf";
-    }
-    else
-    {
-        format += "f";
-    }
-#if defined(OPAL_COMPILER_MSVC)
-    sprintf_s(*str, str.GetSize(), *format, value);
-#else
-    OPAL_START_DISABLE_WARNINGS
-    OPAL_DISABLE_WARNING("-Wformat-nonliteral")
-    OPAL_DISABLE_WARNING("-Wdouble-promotion")
-    sprintf(*str, *format, value);
-    OPAL_END_DISABLE_WARNINGS
-#endif
-    str.Trim();
+    // Six fraction digits by default, like printf("%f")
+    const i32 precision = decimal_points < 0 ? 6 : decimal_points;
+    StringUtf8 str(k_max_fixed_to_chars_size + static_cast<u64>(precision), 0);
+    const char8* end = ToCharsFixed(str.GetData(), str.GetData() + str.GetSize(), value, precision).GetValue();
+    str.Resize(static_cast<u64>(end - str.GetData()));
     return str;
 }
 
-template <Opal::Integral T, Opal::StringLike StringClass>
-T Opal::StringToNumber(const StringClass& str, i32 base)
+template <Opal::Integral T>
+T Opal::Impl::ParseWholeNumber(const char8* first, const char8* last, i32 base)
 {
-    char* end = const_cast<char*>(*str + str.GetSize());
+    const bool is_negative = first != last && *first == '-';
+    const char8* digits = is_negative ? first + 1 : first;
+    if (base == 0)
+    {
+        base = 10;
+        if (last - digits > 1 && digits[0] == '0')
+        {
+            const bool is_hex = digits[1] == 'x' || digits[1] == 'X';
+            base = is_hex ? 16 : 8;
+            digits += is_hex ? 2 : 1;
+        }
+    }
     if constexpr (SignedIntegral<T>)
     {
-        return Narrow<T>(strtoll(*str, &end, base));
+        // Parse the magnitude as the unsigned type so that a sign and a base prefix can be combined.
+        constexpr u64 k_max_magnitude = ~0ull >> (64 - sizeof(T) * 8 + 1);
+        u64 magnitude = 0;
+        bool has_sign = false;
+        Expected<const char8*, ErrorCode> result =
+            CharsToInteger(digits, last, k_max_magnitude + (is_negative ? 1 : 0), false, base, magnitude, has_sign);
+        if (!result.HasValue() || result.GetValue() != last)
+        {
+            throw InvalidArgumentException(__FUNCTION__, "String is not a number in range of the type");
+        }
+        return is_negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
     }
     else
     {
-        return Narrow<T>(strtoull(*str, &end, base));
+        T value = 0;
+        Expected<const char8*, ErrorCode> result = FromChars(digits, last, value, base);
+        if (is_negative || !result.HasValue() || result.GetValue() != last)
+        {
+            throw InvalidArgumentException(__FUNCTION__, "String is not a number in range of the type");
+        }
+        return value;
     }
 }
 
+template <Opal::Integral T, Opal::StringLike StringClass>
+T Opal::StringToNumber(const StringClass& str, i32 base)
+{
+    return Impl::ParseWholeNumber<T>(*str, *str + str.GetSize(), base);
+}
+
 template <Opal::Integral T>
 T Opal::StringToNumber(const char8* str, i32 base)
 {
-    char* end = nullptr;
-    if constexpr (SignedIntegral<T>)
-    {
-        return Narrow<T>(strtoll(str, &end, base));
-    }
-    else
-    {
-        return Narrow<T>(strtoull(str, &end, base));
-    }
+    return Impl::ParseWholeNumber<T>(str, str + std::strlen(str), base);
 }
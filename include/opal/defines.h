@@ -58,3 +58,12 @@
 
 #define OPAL_CACHE_LINE_SIZE (64)
 
+
+// SIMD instruction sets available at compile time. SSE2 is part of every x86-64 target, AVX2 has to be enabled with the
+// OPAL_AVX2 CMake option or the matching compiler flags.
+#if defined(__AVX2__)
+#define OPAL_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPAL_SIMD_SSE2
+#endif
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstring>
 #include <functional>
+#include <new>
+#include <type_traits>
 
-#include "opal/container/hash-map.h"
+#include "opal/container/dynamic-array.h"
 #include "opal/type-traits.h"
 
 namespace Opal
@@ -61,44 +64,200 @@ private:
     Function m_functor;
 };
 
+template <typename Signature, u64 k_buffer_size = 32>
+struct InplaceDelegate;
+
+/**
+ * Single-cast delegate that stores the callable inside the delegate and never allocates.
+ *
+ * The callable is constructed in a buffer of k_buffer_size bytes. Binding a callable that does not fit is a compile
+ * error. Execute() is a single call through a function pointer that knows the type of the stored callable. Callables
+ * that are not trivially copyable also get a second function pointer used to move and destroy them.
+ *
+ * Copy is deleted, the delegate can only be moved. Executing an unbound delegate returns a default-constructed ReturnType.
+ *
+ * @tparam k_buffer_size Size of the inline storage in bytes.
+ */
+template <typename ReturnType, typename... Args, u64 k_buffer_size>
+struct InplaceDelegate<ReturnType(Args...), k_buffer_size>
+{
+    InplaceDelegate() = default;
+
+    /** Create a delegate bound to @p callable. */
+    template <typename Callable>
+        requires(!SameAs<typename Decay<Callable>::Type, InplaceDelegate>)
+    InplaceDelegate(Callable&& callable)
+    {
+        Bind(std::forward<Callable>(callable));
+    }
+
+    ~InplaceDelegate() { Unbind(); }
+
+    InplaceDelegate(const InplaceDelegate&) = delete;
+    InplaceDelegate& operator=(const InplaceDelegate&) = delete;
+
+    InplaceDelegate(InplaceDelegate&& other) noexcept { MoveFrom(other); }
+
+    InplaceDelegate& operator=(InplaceDelegate&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Unbind();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    /** Bind a callable to this delegate, replacing any previously bound callable. */
+    template <typename Callable>
+    void Bind(Callable&& callable)
+    {
+        using Stored = typename Decay<Callable>::Type;
+        static_assert(sizeof(Stored) <= k_buffer_size, "Callable does not fit into the delegate buffer, increase k_buffer_size");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "Callable alignment is not supported");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>, "Callable must be nothrow move constructible");
+
+        Unbind();
+        new (m_storage) Stored(std::forward<Callable>(callable));
+        m_invoke = &Invoke<Stored>;
+        if constexpr (!std::is_trivially_copyable_v<Stored>)
+        {
+            m_manage = &Manage<Stored>;
+        }
+    }
+
+    /** Unbind the current callable. */
+    void Unbind()
+    {
+        if (m_manage != nullptr)
+        {
+            m_manage(Operation::Destroy, m_storage, nullptr);
+        }
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+    /** Returns true if a callable is currently bound. */
+    [[nodiscard]] bool IsBound() const { return m_invoke != nullptr; }
+
+    /**
+     * Execute the bound callable with the given arguments.
+     * If no callable is bound, returns a default-constructed ReturnType.
+     */
+    template <typename... ExecArgs>
+    ReturnType Execute(ExecArgs&&... arguments)
+    {
+        if constexpr (k_is_void_value<ReturnType>)
+        {
+            if (m_invoke != nullptr)
+            {
+                m_invoke(m_storage, std::forward<ExecArgs>(arguments)...);
+            }
+        }
+        else
+        {
+            if (m_invoke != nullptr)
+            {
+                return m_invoke(m_storage, std::forward<ExecArgs>(arguments)...);
+            }
+
+            return ReturnType{};
+        }
+    }
+
+private:
+    enum class Operation : u8
+    {
+        Move,
+        Destroy,
+    };
+
+    template <typename Stored>
+    static ReturnType Invoke(void* storage, Args... arguments)
+    {
+        return (*std::launder(reinterpret_cast<Stored*>(storage)))(std::forward<Args>(arguments)...);
+    }
+
+    template <typename Stored>
+    static void Manage(Operation operation, void* destination, void* source)
+    {
+        if (operation == Operation::Move)
+        {
+            Stored* from = std::launder(reinterpret_cast<Stored*>(source));
+            new (destination) Stored(std::move(*from));
+            from->~Stored();
+        }
+        else
+        {
+            std::launder(reinterpret_cast<Stored*>(destination))->~Stored();
+        }
+    }
+
+    void MoveFrom(InplaceDelegate& other)
+    {
+        if (other.m_manage != nullptr)
+        {
+            other.m_manage(Operation::Move, m_storage, other.m_storage);
+        }
+        else if (other.m_invoke != nullptr)
+        {
+            std::memcpy(m_storage, other.m_storage, k_buffer_size);
+        }
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+        other.m_invoke = nullptr;
+        other.m_manage = nullptr;
+    }
+
+    ReturnType (*m_invoke)(void* storage, Args... arguments) = nullptr;
+    void (*m_manage)(Operation operation, void* destination, void* source) = nullptr;
+    alignas(std::max_align_t) u8 m_storage[k_buffer_size];
+};
+
 template <typename... Args>
 struct MultiDelegate;
 
 /**
  * Multi-cast delegate that supports binding multiple callables with signature void(Args...).
  * Each bound callable is identified by a DelegateHandle, which can be used to unbind it later.
- * Executing the delegate invokes all bound callables.
+ * Executing the delegate invokes all bound callables in the order they were bound.
+ *
+ * Callables are kept in a dense array, so Execute() is a linear loop. Handles are handed out in increasing order and
+ * are stored in a parallel sorted array, so IsBound() and Unbind() use binary search.
  */
 template <typename... Args>
 struct MultiDelegate<void(Args...)>
 {
     using Function = std::function<void(Args...)>;
 
-    MultiDelegate(AllocatorBase* allocator = nullptr) : m_functors(HashMap<DelegateHandle, Function>::k_default_capacity, allocator) {}
+    MultiDelegate(AllocatorBase* allocator = nullptr) : m_handles(allocator), m_functors(allocator) {}
 
     /** Bind a callable and return a handle that can be used to unbind it later. */
     DelegateHandle Bind(Function functor)
     {
         const DelegateHandle handle = m_handle_generator++;
-        m_functors.Insert(handle, std::move(functor));
+        m_handles.PushBack(handle);
+        m_functors.PushBack(std::move(functor));
         return handle;
     }
 
     /** Unbind the callable associated with the given handle. No-op if the handle is invalid or not found. */
     void Unbind(DelegateHandle handle)
     {
-        if (handle == k_invalid_delegate_handle)
+        const u64 index = FindIndex(handle);
+        if (index == m_handles.GetSize())
         {
             return;
         }
 
-        m_functors.Erase(handle);
+        m_handles.Erase(m_handles.begin() + static_cast<i64>(index));
+        m_functors.Erase(m_functors.begin() + static_cast<i64>(index));
     }
 
     /** Returns true if the callable associated with the given handle is still bound. */
     [[nodiscard]] bool IsBound(DelegateHandle handle) const
     {
-        return m_functors.Find(handle) != m_functors.end();
+        return FindIndex(handle) != m_handles.GetSize();
     }
 
     /** Returns true if any callable is bound. */
@@ -111,14 +270,35 @@ struct MultiDelegate<void(Args...)>
     template <typename... ExecArgs>
     void Execute(ExecArgs&&... arguments)
     {
-        for (auto& pair : m_functors)
+        for (Function& functor : m_functors)
         {
-            pair.value(std::forward<ExecArgs>(arguments)...);
+            functor(arguments...);
         }
     }
 
 private:
-    HashMap<DelegateHandle, Function> m_functors;
+    /** Returns the index of @p handle or the number of bound callables if it is not bound. */
+    [[nodiscard]] u64 FindIndex(DelegateHandle handle) const
+    {
+        u64 low = 0;
+        u64 high = m_handles.GetSize();
+        while (low < high)
+        {
+            const u64 middle = low + (high - low) / 2;
+            if (m_handles[middle] < handle)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low < m_handles.GetSize() && m_handles[low] == handle ? low : m_handles.GetSize();
+    }
+
+    DynamicArray<DelegateHandle> m_handles;
+    DynamicArray<Function> m_functors;
     DelegateHandle m_handle_generator = 0;
 };
 
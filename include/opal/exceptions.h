@@ -158,4 +158,19 @@ struct AllocatorNotInitializedException : Exception
     }
 };
 
+struct BrokenPromiseException : Exception
+{
+    BrokenPromiseException() : Exception("Promise was destroyed before it got a value or an exception") {}
+};
+
+struct PromiseAlreadySatisfiedException : Exception
+{
+    PromiseAlreadySatisfiedException() : Exception("Promise already has a value or an exception") {}
+};
+
+struct ThreadPoolClosedException : Exception
+{
+    ThreadPoolClosedException() : Exception("Thread pool was closed before the task could run") {}
+};
+
 }  // namespace Opal
\ No newline at end of file
@@ -131,6 +131,16 @@ void OPAL_EXPORT WriteStringToFile(const StringUtf8& path, const StringUtf8& con
  */
 void OPAL_EXPORT WriteBytesToFile(const StringUtf8& path, ArrayView<const u8> content);
 
+/**
+ * @brief Write several byte ranges to a file, one after another, replacing any existing content. Creates the file if it
+ * does not exist. The file is opened once for all ranges.
+ * @param path Path to the file to write.
+ * @param chunks Byte ranges to write, in order.
+ * @throw PathNotFoundException when the parent directory does not exist.
+ * @throw Exception when any other error occurs.
+ */
+void OPAL_EXPORT WriteChunksToFile(const StringUtf8& path, ArrayView<const ArrayView<const u8>> chunks);
+
 /**
  * @brief Append a string to a file. Creates the file if it does not exist.
  * @param path Path to the file to append to.
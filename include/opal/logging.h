@@ -8,6 +8,7 @@
 #include "opal/container/dynamic-array.h"
 #include "opal/container/hash-map.h"
 #include "opal/container/shared-ptr.h"
+#include "opal/container/string-format.h"
 #include "opal/container/string-view.h"
 #include "opal/container/string.h"
 #include "opal/export.h"
@@ -104,7 +105,31 @@ public:
     template <typename... Args>
     void Fatal(StringViewUtf8 category, StringViewUtf8 fmt, Args&&... args);
 
+    /**
+     * Log a message with a format string that is parsed at compile time, for example Info<"{} ms">("Timing", ms). See
+     * AppendFormat. Messages longer than k_max_message_size are cut off.
+     */
+    template <FixedString k_fmt, typename... Args>
+    void Log(LogLevel level, StringViewUtf8 category, const Args&... args);
+
+    template <FixedString k_fmt, typename... Args>
+    void Verbose(StringViewUtf8 category, const Args&... args);
+
+    template <FixedString k_fmt, typename... Args>
+    void Info(StringViewUtf8 category, const Args&... args);
+
+    template <FixedString k_fmt, typename... Args>
+    void Warning(StringViewUtf8 category, const Args&... args);
+
+    template <FixedString k_fmt, typename... Args>
+    void Error(StringViewUtf8 category, const Args&... args);
+
+    template <FixedString k_fmt, typename... Args>
+    void Fatal(StringViewUtf8 category, const Args&... args);
+
 private:
+    /** @throw UnregisteredCategoryException when @p category is not registered. */
+    bool IsEnabled(LogLevel level, StringViewUtf8 category) const;
     void Emit(LogLevel level, StringViewUtf8 category, StringViewUtf8 message);
     void HandleFatal();
 
@@ -153,15 +178,7 @@ private:
 template <typename... Args>
 void Logger::Log(LogLevel level, StringViewUtf8 category, StringViewUtf8 fmt, Args&&... args)
 {
-    if (level > m_log_level)
-    {
-        return;
-    }
-    if (!IsCategoryRegistered(category))
-    {
-        throw UnregisteredCategoryException(category.GetData());
-    }
-    if (level > GetCategoryLevel(category))
+    if (!IsEnabled(level, category))
     {
         return;
     }
@@ -183,6 +200,53 @@ void Logger::Log(LogLevel level, StringViewUtf8 category, StringViewUtf8 fmt, Ar
     }
 }
 
+template <FixedString k_fmt, typename... Args>
+void Logger::Log(LogLevel level, StringViewUtf8 category, const Args&... args)
+{
+    if (!IsEnabled(level, category))
+    {
+        return;
+    }
+    char8 buffer[k_max_message_size];
+    const Expected<char8*, ErrorCode> end = FormatTo<k_fmt>(buffer, buffer + k_max_message_size, args...);
+    const u64 size = end.HasValue() ? static_cast<u64>(end.GetValue() - buffer) : k_max_message_size;
+    Emit(level, category, StringViewUtf8(buffer, size));
+    if (level == LogLevel::Fatal)
+    {
+        HandleFatal();
+    }
+}
+
+template <FixedString k_fmt, typename... Args>
+void Logger::Verbose(StringViewUtf8 category, const Args&... args)
+{
+    Log<k_fmt>(LogLevel::Verbose, category, args...);
+}
+
+template <FixedString k_fmt, typename... Args>
+void Logger::Info(StringViewUtf8 category, const Args&... args)
+{
+    Log<k_fmt>(LogLevel::Info, category, args...);
+}
+
+template <FixedString k_fmt, typename... Args>
+void Logger::Warning(StringViewUtf8 category, const Args&... args)
+{
+    Log<k_fmt>(LogLevel::Warning, category, args...);
+}
+
+template <FixedString k_fmt, typename... Args>
+void Logger::Error(StringViewUtf8 category, const Args&... args)
+{
+    Log<k_fmt>(LogLevel::Error, category, args...);
+}
+
+template <FixedString k_fmt, typename... Args>
+void Logger::Fatal(StringViewUtf8 category, const Args&... args)
+{
+    Log<k_fmt>(LogLevel::Fatal, category, args...);
+}
+
 template <typename... Args>
 void Logger::Verbose(StringViewUtf8 category, StringViewUtf8 fmt, Args&&... args)
 {
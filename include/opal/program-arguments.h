@@ -1,6 +1,7 @@
 #pragma once
 
 #include "container/scope-ptr.h"
+#include "opal/char-conv.h"
 #include "opal/common.h"
 #include "opal/container/dynamic-array.h"
 #include "opal/container/hash-map.h"
@@ -150,6 +151,12 @@ struct TypedProgramArgumentDefinitionBase : ProgramArgumentDefinition
                 {
                     result.PushBack(NumberToString(val));
                 }
+                else if constexpr (FloatingPoint<T>)
+                {
+                    char8 buffer[k_max_to_chars_size];
+                    const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, val).GetValue();
+                    result.PushBack(StringUtf8(buffer, static_cast<u64>(end - buffer)));
+                }
             }
         }
         else if (m_possible_value_mappings.GetSize() != 0)
@@ -259,6 +266,40 @@ struct TypedProgramArgumentDefinition<T> final : TypedProgramArgumentDefinitionB
     }
 };
 
+/**
+ * @brief Specialization for floating point types. Parses the string with FromChars, so the result does not depend on
+ *        the locale. Optionally validates against possible values or mappings.
+ * @tparam T f32 or f64.
+ */
+template <FloatingPoint T>
+struct TypedProgramArgumentDefinition<T> final : TypedProgramArgumentDefinitionBase<T>
+{
+    using Super = TypedProgramArgumentDefinitionBase<T>;
+
+    TypedProgramArgumentDefinition(Ref<T> dest, StringUtf8 name, StringUtf8 desc, bool is_optional, DynamicArray<T> possible_values,
+                                   HashMap<StringUtf8, T> possible_value_mappings)
+        : Super(std::move(name), std::move(desc), is_optional, std::move(possible_values), std::move(possible_value_mappings),
+                std::move(dest))
+    {
+        if (Super::HasPossibleValues() && Super::HasPossibleValueMappings())
+        {
+            throw InvalidArgumentException(__FUNCTION__,
+                                           "Floating point program argument can't have both possible values and possible value mappings");
+        }
+    }
+
+    void SetValue(const StringUtf8& str) override
+    {
+        T value = 0;
+        Expected<const char8*, ErrorCode> result = FromChars(*str, *str + str.GetSize(), value);
+        if (!result.HasValue() || result.GetValue() != *str + str.GetSize())
+        {
+            throw InvalidArgumentException(__FUNCTION__, "Value is not a number");
+        }
+        Super::SetDestinationValue(value);
+    }
+};
+
 /**
  * @brief Specialization for bool. Acts as a flag: presence of the argument sets the value to true.
  *        Ignores possible values and mappings.
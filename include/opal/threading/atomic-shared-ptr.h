@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+
+#include "opal/assert.h"
+#include "opal/container/shared-ptr.h"
+#include "opal/exceptions.h"
+
+namespace Opal
+{
+
+/**
+ * SharedPtr that can be read and replaced by many threads at the same time without locks.
+ *
+ * Meant for read-mostly data like configuration snapshots: readers call Load() to get their own SharedPtr to the current
+ * object and keep using it while writers publish new objects with Store() or CompareExchange().
+ *
+ * The control block pointer and a 16-bit count of references handed out by Load() are packed into one 64-bit word.
+ * When an object is stored, the atomic pointer takes a batch of references in the control block up front. Load() is
+ * then a single fetch_add on the packed word that takes one reference from the batch, so readers never touch the
+ * reference count in the control block unless the batch runs low. When the object is replaced, the references that
+ * were not handed out are returned to the control block.
+ *
+ * Objects must be stored through a SharedPtr whose object pointer is the object created for the control block, which
+ * is always the case unless the pointer was converted to a base class at a different address.
+ *
+ * @tparam T Object type. The reference count always uses ThreadingPolicy::ThreadSafe.
+ */
+template <typename T>
+class AtomicSharedPtr
+{
+public:
+    using Pointer = SharedPtr<T, ThreadingPolicy::ThreadSafe>;
+
+    static_assert(sizeof(void*) == sizeof(u64), "AtomicSharedPtr requires 64-bit pointers");
+    static_assert(std::atomic<u64>::is_always_lock_free, "Type u64 is not atomic on this platform!");
+
+    /** Creates an atomic pointer that holds no object. */
+    AtomicSharedPtr() = default;
+
+    /** Creates an atomic pointer that holds the object of @p initial. */
+    explicit AtomicSharedPtr(Pointer initial) { m_packed.store(Pack(initial), std::memory_order_relaxed); }
+
+    ~AtomicSharedPtr() { Unpack(m_packed.load(std::memory_order_acquire), 0); }
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr(AtomicSharedPtr&&) = delete;
+    AtomicSharedPtr& operator=(AtomicSharedPtr&&) = delete;
+
+    /**
+     * Get shared ownership of the current object.
+     * @return SharedPtr to the current object or invalid SharedPtr if no object is stored.
+     */
+    Pointer Load() const
+    {
+        if (m_packed.load(std::memory_order_relaxed) == 0)
+        {
+            return Pointer();
+        }
+        const u64 previous = m_packed.fetch_add(k_count_one, std::memory_order_acquire);
+        ControlBlock* block = GetBlock(previous);
+        if (block == nullptr)
+        {
+            // The count of an empty word is never read, so the increment does not have to be undone
+            return Pointer();
+        }
+        if (GetCount(previous) + 1 >= k_refill_threshold)
+        {
+            Refill(block);
+        }
+        return Pointer::Adopt(static_cast<T*>(block->GetObject()), block);
+    }
+
+    /**
+     * Replace the current object. Readers that already loaded the old object keep it alive until they release it.
+     * @param desired New object. Can be an invalid SharedPtr to clear the pointer.
+     * @throw InvalidArgumentException When the object pointer of @p desired is not the object owned by its control block.
+     */
+    void Store(Pointer desired) { Exchange(std::move(desired)); }
+
+    /**
+     * Replace the current object and return the old one.
+     * @param desired New object. Can be an invalid SharedPtr to clear the pointer.
+     * @return Previous object.
+     * @throw InvalidArgumentException When the object pointer of @p desired is not the object owned by its control block.
+     */
+    Pointer Exchange(Pointer desired)
+    {
+        const u64 packed = Pack(desired);
+        return Unpack(m_packed.exchange(packed, std::memory_order_acq_rel), 1);
+    }
+
+    /**
+     * Replace the current object with @p desired if the current object is the one @p expected points to.
+     * @param expected Object that is expected to be stored. When the exchange fails, it is replaced with the current
+     *        object.
+     * @param desired New object.
+     * @return True if the object was replaced, false otherwise.
+     * @throw InvalidArgumentException When the object pointer of @p desired is not the object owned by its control block.
+     */
+    bool CompareExchange(Pointer& expected, Pointer desired)
+    {
+        const u64 packed = Pack(desired);
+        u64 current = m_packed.load(std::memory_order_relaxed);
+        while (true)
+        {
+            if (GetBlock(current) != expected.m_control_block)
+            {
+                Pointer actual = Load();
+                if (actual.m_control_block == expected.m_control_block)
+                {
+                    current = m_packed.load(std::memory_order_relaxed);
+                    continue;
+                }
+                Unpack(packed, 0);
+                expected = std::move(actual);
+                return false;
+            }
+            if (m_packed.compare_exchange_weak(current, packed, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                Unpack(current, 0);
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Checks whether an object is stored. The result can be outdated by the time it is returned.
+     */
+    [[nodiscard]] bool IsValid() const { return GetBlock(m_packed.load(std::memory_order_relaxed)) != nullptr; }
+
+private:
+    using ControlBlock = Impl::SharedControlBlock<ThreadingPolicy::ThreadSafe>;
+
+    static constexpr u64 k_count_shift = 48;
+    static constexpr u64 k_count_one = 1ull << k_count_shift;
+    static constexpr u64 k_pointer_mask = k_count_one - 1;
+    /** References that the atomic pointer owns in the control block of the stored object. */
+    static constexpr u64 k_reserved_references = 1ull << 15;
+    /** Once this many references were handed out, the reader that took the last one adds more to the control block. */
+    static constexpr u64 k_refill_threshold = k_reserved_references / 2;
+
+    static ControlBlock* GetBlock(u64 packed) { return reinterpret_cast<ControlBlock*>(packed & k_pointer_mask); }
+    static u64 GetCount(u64 packed) { return packed >> k_count_shift; }
+
+    /**
+     * Move the reference held by @p pointer into a packed word and reserve the references handed out by Load().
+     */
+    static u64 Pack(Pointer& pointer)
+    {
+        ControlBlock* block = pointer.m_control_block;
+        if (block == nullptr)
+        {
+            return 0;
+        }
+        if (block->GetObject() != static_cast<void*>(pointer.m_object))
+        {
+            throw InvalidArgumentException("AtomicSharedPtr", "Object pointer does not match its control block");
+        }
+        const u64 address = reinterpret_cast<u64>(block);
+        OPAL_ASSERT((address & ~k_pointer_mask) == 0, "Control block address does not fit into 48 bits");
+        Impl::RefCountType<ThreadingPolicy::ThreadSafe>::Add(&block->refcount, k_reserved_references - 1);
+        pointer.m_object = nullptr;
+        pointer.m_control_block = nullptr;
+        return address;
+    }
+
+    /**
+     * Take back the references owned by a packed word that is no longer stored.
+     * @param packed Word that was stored.
+     * @param kept Number of references to keep. When 1, the returned pointer owns it.
+     * @return SharedPtr that owns the kept reference, or invalid SharedPtr if @p kept is 0.
+     */
+    static Pointer Unpack(u64 packed, u64 kept)
+    {
+        ControlBlock* block = GetBlock(packed);
+        if (block == nullptr)
+        {
+            return Pointer();
+        }
+        const u64 unused = k_reserved_references - GetCount(packed) - kept;
+        Pointer result = kept == 0 ? Pointer() : Pointer::Adopt(static_cast<T*>(block->GetObject()), block);
+        if (unused > 0)
+        {
+            block->ReleaseStrong(unused);
+        }
+        return result;
+    }
+
+    /**
+     * Move references from the control block into the batch. The caller owns a reference to @p block, so the block
+     * cannot be freed and reused while this runs.
+     */
+    void Refill(ControlBlock* block) const
+    {
+        Impl::RefCountType<ThreadingPolicy::ThreadSafe>::Add(&block->refcount, k_refill_threshold);
+        u64 current = m_packed.load(std::memory_order_relaxed);
+        while (GetBlock(current) == block && GetCount(current) >= k_refill_threshold)
+        {
+            if (m_packed.compare_exchange_weak(current, current - k_refill_threshold * k_count_one, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+        // Another reader refilled the batch or the object was replaced
+        block->ReleaseStrong(k_refill_threshold);
+    }
+
+    mutable std::atomic<u64> m_packed = 0;
+};
+
+}  // namespace Opal
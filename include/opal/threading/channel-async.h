@@ -0,0 +1,88 @@
+#pragma once
+
+#include <coroutine>
+#include <utility>
+
+#include "opal/container/expected.h"
+#include "opal/error-codes.h"
+#include "opal/threading/channel-mpmc.h"
+#include "opal/threading/coro.h"
+#include "opal/threading/thread-pool.h"
+
+namespace Opal
+{
+
+namespace Impl
+{
+
+/**
+ * Suspends a coroutine until the channel has an item or is closed, then resumes it on a pool.
+ */
+template <typename T, bool UseSignaling>
+class ChannelReceiveAwaiter final : public ChannelWaiter
+{
+public:
+    ChannelReceiveAwaiter(ReceiverMPMC<T, UseSignaling>& receiver, ThreadPool& pool, TaskPriority priority)
+        : m_receiver(&receiver), m_pool(&pool), m_priority(priority)
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        m_handle = handle;
+        // Once registered, a pusher can resume the coroutine and destroy this awaiter, so nothing is touched after
+        return m_receiver->AddWaiter(this);
+    }
+
+    void await_resume() const noexcept {}
+
+    void Wake() override
+    {
+        ThreadPool* pool = m_pool;
+        // Runs inside Send(), TrySend() and Close(), possibly on a worker of the same pool, so it must not block on a full
+        // lane queue
+        pool->AddTaskNonBlocking(MakeIntrusive<Task, CoroutineResumeTask>(pool->GetAllocator(), m_handle), m_priority);
+    }
+
+private:
+    ReceiverMPMC<T, UseSignaling>* m_receiver;
+    ThreadPool* m_pool;
+    TaskPriority m_priority;
+    std::coroutine_handle<> m_handle;
+};
+
+}  // namespace Impl
+
+/**
+ * Coroutine version of ReceiverMPMC::Receive(). Suspends the awaiting coroutine instead of blocking the thread while the
+ * channel is empty, and resumes it on a worker of @p pool once an item was sent or the channel was closed. The coroutine
+ * is resumed in the lane of @p priority.
+ * @code
+ * Opal::Expected<Opal::i32, Opal::ErrorCode> item = co_await Opal::ReceiveAsync(receiver, pool);
+ * @endcode
+ * The receiver must outlive the returned coroutine.
+ */
+template <typename T, bool UseSignaling>
+Coro<Expected<T, ErrorCode>> ReceiveAsync(ReceiverMPMC<T, UseSignaling>& receiver, ThreadPool& pool,
+                                          TaskPriority priority = TaskPriority::Normal)
+{
+    while (true)
+    {
+        T result;
+        const ErrorCode code = receiver.TryReceive(result);
+        if (code == ErrorCode::Success)
+        {
+            co_return Expected<T, ErrorCode>(std::move(result));
+        }
+        if (code == ErrorCode::ChannelClosed)
+        {
+            co_return Expected<T, ErrorCode>(ErrorCode::ChannelClosed);
+        }
+        // Another receiver can take the item that woke us, then we simply wait again
+        co_await Impl::ChannelReceiveAwaiter<T, UseSignaling>(receiver, pool, priority);
+    }
+}
+
+}  // namespace Opal
@@ -9,6 +9,7 @@
 #include "opal/container/shared-ptr.h"
 #include "opal/error-codes.h"
 #include "opal/threading/cpu-pause.h"
+#include "opal/threading/spin-wait.h"
 #include "opal/type-traits.h"
 
 namespace Opal
@@ -27,57 +28,43 @@ struct QueueMPMCSlot
     OPAL_END_DISABLE_WARNINGS
 };
 
+/**
+ * Receiver that waits for an item without blocking a thread, see QueueMPMC::AddWaiter().
+ */
+struct ChannelWaiter
+{
+    /** Called once, on the thread that pushed an item or closed the channel. */
+    virtual void Wake() = 0;
+
+    ChannelWaiter* next_waiter = nullptr;
+
+protected:
+    ~ChannelWaiter() = default;
+};
+
 /**
  * Lock-free multiple-producer multiple-consumer bounded queue.
  * @tparam T Type of data stored in the queue. Must be default constructable.
- * @tparam UseSignaling If true, uses std::atomic::wait/notify to block when waiting for a slot's turn.
- *         If false, busy-waits using a CPU pause instruction. Defaults to false.
+ * @tparam UseSignaling If true, spins with exponential backoff and then uses std::atomic::wait/notify to block when
+ *         waiting for a slot's turn, see SpinWaitPolicy. If false, busy-waits using a CPU pause instruction. Defaults to
+ *         false.
  */
 template <typename T, bool UseSignaling = false>
     requires Opal::DefaultConstructable<T>
 class QueueMPMC
 {
 public:
-    QueueMPMC(size_t capacity, AllocatorBase* allocator = nullptr) : m_data(capacity, allocator), m_capacity(capacity) {}
-
-    void Push(const T& data)
+    /**
+     * @param spin_wait How long a blocking Push() or Pop() spins before it parks the thread. Ignored without signaling.
+     */
+    QueueMPMC(size_t capacity, AllocatorBase* allocator = nullptr, const SpinWaitPolicy& spin_wait = {})
+        : m_data(capacity, allocator), m_capacity(capacity), m_spin_wait(spin_wait)
     {
-        size_t write_idx = m_write_idx.fetch_add(1, std::memory_order_relaxed);
-        size_t slot_idx = write_idx & (m_capacity - 1);
-        auto& slot = m_data[slot_idx];
-        size_t turn = write_idx >> CountSetBits(static_cast<u64>(m_capacity - 1));
-        size_t current_turn = slot.turn.load(std::memory_order_acquire);
-        while (2 * turn != current_turn)
-        {
-            if constexpr (UseSignaling)
-            {
-                slot.turn.wait(current_turn, std::memory_order_relaxed);
-            }
-            else
-            {
-                CpuPause();
-            }
-            current_turn = slot.turn.load(std::memory_order_acquire);
-        }
-        if constexpr (Opal::CopyAssignable<T>)
-        {
-            slot.data = data;
-        }
-        else if constexpr (Opal::Clonable<T>)
-        {
-            slot.data = data.Clone();
-        }
-        else
-        {
-            throw Exception("Data type can't be copied!");
-        }
-        slot.turn.store(2 * turn + 1, std::memory_order_release);
-        if constexpr (UseSignaling)
-        {
-            slot.turn.notify_all();
-        }
     }
 
+    void Push(const T& data) { PushImpl(data); }
+    void Push(T&& data) { PushImpl(Move(data)); }
+
     bool TryPush(const T& data)
     {
         size_t write_idx = m_write_idx.load(std::memory_order_acquire);
@@ -104,18 +91,7 @@ public:
                 {
                     // If write_idx didn't change since last check, consume it and increment the
                     // atomic
-                    if constexpr (Opal::CopyAssignable<T>)
-                    {
-                        slot.data = data;
-                    }
-                    else if constexpr (Opal::Clonable<T>)
-                    {
-                        slot.data = data.Clone();
-                    }
-                    else
-                    {
-                        throw Exception("Data type can't be copied!");
-                    }
+                    StoreData(slot, data);
                     slot.turn.store(2 * turn + 1, std::memory_order_release);
                     if constexpr (UseSignaling)
                     {
@@ -138,7 +114,7 @@ public:
         {
             if constexpr (UseSignaling)
             {
-                slot.turn.wait(current_turn, std::memory_order_relaxed);
+                SpinThenWait(slot.turn, current_turn, std::memory_order_relaxed, m_spin_wait);
             }
             else
             {
@@ -188,7 +164,159 @@ public:
         }
     }
 
+    /**
+     * Returns true if there is nothing left to pop. A push that is still in progress already counts as an item.
+     */
+    [[nodiscard]] bool IsEmpty() const
+    {
+        return m_read_idx.load(std::memory_order_seq_cst) >= m_write_idx.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Registers @p waiter to be woken by the next WakeWaiter(), unless there is something to pop already or
+     * @p is_closed is set. Pushers must call WakeWaiter() after every push and WakeAllWaiters() after closing, or the
+     * waiter is never woken.
+     * @return False if the waiter was not registered because it should try to pop right away.
+     */
+    bool AddWaiter(ChannelWaiter* waiter, const std::atomic<bool>& is_closed)
+    {
+        LockWaiters();
+        // Count first, then look at the queue. Pushers do it the other way around, so either we see the item or the
+        // pusher sees the waiter.
+        m_waiter_count.fetch_add(1, std::memory_order_seq_cst);
+        if (!IsEmpty() || is_closed.load(std::memory_order_seq_cst))
+        {
+            m_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+            UnlockWaiters();
+            return false;
+        }
+        waiter->next_waiter = nullptr;
+        if (m_last_waiter != nullptr)
+        {
+            m_last_waiter->next_waiter = waiter;
+        }
+        else
+        {
+            m_first_waiter = waiter;
+        }
+        m_last_waiter = waiter;
+        UnlockWaiters();
+        return true;
+    }
+
+    /** Wakes the longest waiting waiter, if any. Costs a fence and a load when nobody waits. */
+    void WakeWaiter()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiter_count.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        LockWaiters();
+        ChannelWaiter* waiter = m_first_waiter;
+        if (waiter != nullptr)
+        {
+            m_first_waiter = waiter->next_waiter;
+            if (m_first_waiter == nullptr)
+            {
+                m_last_waiter = nullptr;
+            }
+            m_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        UnlockWaiters();
+        if (waiter != nullptr)
+        {
+            waiter->Wake();
+        }
+    }
+
+    /** Wakes all waiters, used when the channel is closed. */
+    void WakeAllWaiters()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiter_count.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        LockWaiters();
+        ChannelWaiter* waiter = m_first_waiter;
+        m_first_waiter = nullptr;
+        m_last_waiter = nullptr;
+        m_waiter_count.store(0, std::memory_order_relaxed);
+        UnlockWaiters();
+        while (waiter != nullptr)
+        {
+            // The waiter can be destroyed as soon as it was woken
+            ChannelWaiter* next = waiter->next_waiter;
+            waiter->Wake();
+            waiter = next;
+        }
+    }
+
 private:
+    void LockWaiters()
+    {
+        while (m_waiter_lock.exchange(true, std::memory_order_acquire))
+        {
+            CpuPause();
+        }
+    }
+
+    void UnlockWaiters() { m_waiter_lock.store(false, std::memory_order_release); }
+
+    template <typename U>
+    void PushImpl(U&& data)
+    {
+        size_t write_idx = m_write_idx.fetch_add(1, std::memory_order_relaxed);
+        size_t slot_idx = write_idx & (m_capacity - 1);
+        auto& slot = m_data[slot_idx];
+        size_t turn = write_idx >> CountSetBits(static_cast<u64>(m_capacity - 1));
+        size_t current_turn = slot.turn.load(std::memory_order_acquire);
+        while (2 * turn != current_turn)
+        {
+            if constexpr (UseSignaling)
+            {
+                SpinThenWait(slot.turn, current_turn, std::memory_order_relaxed, m_spin_wait);
+            }
+            else
+            {
+                CpuPause();
+            }
+            current_turn = slot.turn.load(std::memory_order_acquire);
+        }
+        StoreData(slot, std::forward<U>(data));
+        slot.turn.store(2 * turn + 1, std::memory_order_release);
+        if constexpr (UseSignaling)
+        {
+            slot.turn.notify_all();
+        }
+    }
+
+    /**
+     * Stores data into the slot. Rvalues are moved in, which for reference counted types saves a reference count
+     * increment and decrement per item.
+     */
+    template <typename U>
+    static void StoreData(QueueMPMCSlot<T>& slot, U&& data)
+    {
+        if constexpr (!k_is_reference_value<U> && Opal::MoveAssignable<T>)
+        {
+            slot.data = Move(data);
+        }
+        else if constexpr (Opal::CopyAssignable<T>)
+        {
+            slot.data = data;
+        }
+        else if constexpr (Opal::Clonable<T>)
+        {
+            slot.data = data.Clone();
+        }
+        else
+        {
+            throw Exception("Data type can't be copied!");
+        }
+    }
+
     OPAL_START_DISABLE_WARNINGS
     OPAL_DISABLE_MSVC_WARNING(4324)
     alignas(OPAL_CACHE_LINE_SIZE) std::atomic<size_t> m_write_idx = 0;
@@ -196,6 +324,12 @@ private:
     OPAL_END_DISABLE_WARNINGS
     DynamicArray<QueueMPMCSlot<T>> m_data;
     size_t m_capacity = 0;
+    SpinWaitPolicy m_spin_wait;
+    /** Waiters are rare and only held for a few instructions, so a spin lock keeps the queue free of allocations. */
+    std::atomic<bool> m_waiter_lock = false;
+    std::atomic<u32> m_waiter_count = 0;
+    ChannelWaiter* m_first_waiter = nullptr;
+    ChannelWaiter* m_last_waiter = nullptr;
 };
 
 }  // namespace Impl
@@ -240,15 +374,36 @@ struct TransmitterMPMC
 
     [[nodiscard]] bool IsValid() const { return m_queue.IsValid(); }
 
-    void Send(const T& item) { m_queue->Push(item); }
-    void Send(T&& item) { m_queue->Push(std::move(item)); }
-    bool TrySend(const T& item) { return m_queue->TryPush(item); }
+    void Send(const T& item)
+    {
+        m_queue->Push(item);
+        m_queue->WakeWaiter();
+    }
+    void Send(T&& item)
+    {
+        m_queue->Push(std::move(item));
+        m_queue->WakeWaiter();
+    }
+    bool TrySend(const T& item)
+    {
+        if (!m_queue->TryPush(item))
+        {
+            return false;
+        }
+        m_queue->WakeWaiter();
+        return true;
+    }
 
     /**
      * Marks the channel as closed. After this, Receive() and TryReceive() on the
      * corresponding receiver will return ErrorCode::ChannelClosed without blocking.
+     * Waiters registered with ReceiverMPMC::AddWaiter() are woken.
      */
-    void Close() const { m_is_closed->store(true, std::memory_order_release); }
+    void Close()
+    {
+        m_is_closed->store(true, std::memory_order_seq_cst);
+        m_queue->WakeAllWaiters();
+    }
 
 private:
     SharedPtr<Impl::QueueMPMC<T, UseSignaling>> m_queue;
@@ -328,6 +483,13 @@ struct ReceiverMPMC
         return ErrorCode::ChannelEmpty;
     }
 
+    /**
+     * Registers @p waiter to be woken by the next send or by closing the channel, see QueueMPMC::AddWaiter(). Lets code
+     * outside of this header wait for items without blocking a thread, like ReceiveAsync() in channel-async.h.
+     * @return False if the waiter was not registered because TryReceive() should be called again right away.
+     */
+    bool AddWaiter(Impl::ChannelWaiter* waiter) { return m_queue->AddWaiter(waiter, *m_is_closed); }
+
     bool operator==(const ReceiverMPMC& other) const { return m_queue == other.m_queue; }
 
     [[nodiscard]] bool IsValid() const { return m_queue.IsValid(); }
@@ -341,7 +503,8 @@ private:
  * One-way, thread-safe communication channel with multiple producers and multiple consumers.
  * Use the transmitter field to send data and the receiver field to receive it.
  * @tparam T Type of data to be sent over the channel.
- * @tparam UseSignaling If true, blocking operations use OS signaling. If false, busy-waits. Defaults to false.
+ * @tparam UseSignaling If true, blocking operations spin for a while and then use OS signaling. If false, busy-waits.
+ * Defaults to false.
  */
 template <typename T, bool UseSignaling = false>
 struct ChannelMPMC
@@ -350,10 +513,13 @@ struct ChannelMPMC
     ReceiverMPMC<T, UseSignaling> receiver;
     std::atomic<bool> m_is_closed = false;
 
-    explicit ChannelMPMC(size_t capacity, AllocatorBase* allocator = nullptr)
+    /**
+     * @param spin_wait How long blocking operations spin before they park the thread. Ignored without signaling.
+     */
+    explicit ChannelMPMC(size_t capacity, AllocatorBase* allocator = nullptr, const SpinWaitPolicy& spin_wait = {})
     {
         capacity = GetNextPowerOf2(capacity);
-        SharedPtr<Impl::QueueMPMC<T, UseSignaling>> q(allocator, capacity, allocator);
+        SharedPtr<Impl::QueueMPMC<T, UseSignaling>> q(allocator, capacity, allocator, spin_wait);
         transmitter = TransmitterMPMC<T, UseSignaling>(q.Clone(), m_is_closed);
         receiver = ReceiverMPMC<T, UseSignaling>(std::move(q), m_is_closed);
     }
@@ -9,6 +9,7 @@
 #include "opal/container/shared-ptr.h"
 #include "opal/error-codes.h"
 #include "opal/threading/cpu-pause.h"
+#include "opal/threading/spin-wait.h"
 #include "opal/type-traits.h"
 
 namespace Opal
@@ -19,8 +20,8 @@ namespace Impl
  * Lock-free single-producer single-consumer bounded queue.
  * Capacity is rounded up to the next power of two.
  * @tparam T Type of data stored in the queue. Must be default constructable.
- * @tparam UseSignaling If true, uses std::atomic::wait/notify to block when the queue is full/empty.
- *         If false, busy-waits using a CPU pause instruction. Defaults to true.
+ * @tparam UseSignaling If true, spins with exponential backoff and then uses std::atomic::wait/notify to block when the
+ *         queue is full/empty, see SpinWaitPolicy. If false, busy-waits using a CPU pause instruction. Defaults to true.
  */
 template <typename T, bool UseSignaling = true>
     requires Opal::DefaultConstructable<T>
@@ -29,8 +30,11 @@ class QueueSPSC
 public:
     static_assert(std::atomic<size_t>::is_always_lock_free, "Type size_t is not atomic on this platform!");
 
-    explicit QueueSPSC(size_t capacity, AllocatorBase* allocator = nullptr)
-        : m_capacity(GetNextPowerOf2(capacity)), m_data(m_capacity, allocator)
+    /**
+     * @param spin_wait How long a blocking Push() or Pop() spins before it parks the thread. Ignored without signaling.
+     */
+    explicit QueueSPSC(size_t capacity, AllocatorBase* allocator = nullptr, const SpinWaitPolicy& spin_wait = {})
+        : m_capacity(GetNextPowerOf2(capacity)), m_data(m_capacity, allocator), m_spin_wait(spin_wait)
     {
         OPAL_ASSERT(m_data.GetAllocator()->IsThreadSafe(), "Allocator must be thread safe!");
         m_write_idx.store(0, std::memory_order_relaxed);
@@ -46,7 +50,7 @@ public:
         {
             if constexpr (UseSignaling)
             {
-                m_read_idx.wait(read_idx, std::memory_order_relaxed);
+                SpinThenWait(m_read_idx, read_idx, std::memory_order_relaxed, m_spin_wait);
             }
             else
             {
@@ -95,7 +99,7 @@ public:
         {
             if constexpr (UseSignaling)
             {
-                m_read_idx.wait(read_idx, std::memory_order_relaxed);
+                SpinThenWait(m_read_idx, read_idx, std::memory_order_relaxed, m_spin_wait);
             }
             else
             {
@@ -124,7 +128,7 @@ public:
         {
             if constexpr (UseSignaling)
             {
-                m_read_idx.wait(read_idx, std::memory_order_relaxed);
+                SpinThenWait(m_read_idx, read_idx, std::memory_order_relaxed, m_spin_wait);
             }
             else
             {
@@ -174,7 +178,7 @@ public:
         {
             if constexpr (UseSignaling)
             {
-                m_write_idx.wait(write_idx, std::memory_order_acquire);
+                SpinThenWait(m_write_idx, write_idx, std::memory_order_acquire, m_spin_wait);
             }
             else
             {
@@ -220,6 +224,7 @@ private:
 
     size_t m_capacity = 0;
     DynamicArray<T> m_data = nullptr;
+    SpinWaitPolicy m_spin_wait;
 };
 }  // namespace Impl
 
@@ -362,7 +367,8 @@ private:
  * Use the transmitter field to send data and the receiver field to receive it.
  * The transmitter and receiver can be moved to separate threads.
  * @tparam T Type of data to be sent over the channel.
- * @tparam UseSignaling If true, blocking operations use OS signaling. If false, busy-waits. Defaults to true.
+ * @tparam UseSignaling If true, blocking operations spin for a while and then use OS signaling. If false, busy-waits.
+ * Defaults to true.
  */
 template <typename T, bool UseSignaling = true>
 struct ChannelSPSC
@@ -371,9 +377,12 @@ struct ChannelSPSC
     ReceiverSPSC<T, UseSignaling> receiver;
     std::atomic<bool> m_is_closed = false;
 
-    ChannelSPSC(size_t capacity, AllocatorBase* allocator = nullptr)
+    /**
+     * @param spin_wait How long blocking operations spin before they park the thread. Ignored without signaling.
+     */
+    ChannelSPSC(size_t capacity, AllocatorBase* allocator = nullptr, const SpinWaitPolicy& spin_wait = {})
     {
-        SharedPtr<Impl::QueueSPSC<T, UseSignaling>> q(allocator, capacity, allocator);
+        SharedPtr<Impl::QueueSPSC<T, UseSignaling>> q(allocator, capacity, allocator, spin_wait);
         transmitter = TransmitterSPSC<T, UseSignaling>(q.Clone(), m_is_closed);
         receiver = ReceiverSPSC<T, UseSignaling>(std::move(q), m_is_closed);
     }
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <utility>
+
+#include "opal/allocator.h"
+#include "opal/assert.h"
+#include "opal/threading/future.h"
+#include "opal/threading/thread-pool.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+template <typename T>
+class Coro;
+
+namespace Impl
+{
+
+/** Size of the header in front of every coroutine frame that remembers the allocator of the frame. */
+inline constexpr u64 k_coro_frame_header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+inline void* AllocateCoroFrame(size_t size)
+{
+    AllocatorBase* allocator = GetDefaultAllocator();
+    void* memory = allocator->Alloc(size + k_coro_frame_header_size, k_coro_frame_header_size);
+    *static_cast<AllocatorBase**>(memory) = allocator;
+    return static_cast<u8*>(memory) + k_coro_frame_header_size;
+}
+
+inline void FreeCoroFrame(void* frame)
+{
+    void* memory = static_cast<u8*>(frame) - k_coro_frame_header_size;
+    (*static_cast<AllocatorBase**>(memory))->Free(memory);
+}
+
+/**
+ * Allocates coroutine frames through the default allocator of the thread that calls the coroutine, so
+ * PushDefaultAllocator() picks the allocator for the coroutines created in its scope. The frame remembers its allocator
+ * and is freed through it on whichever thread the coroutine finishes, so the allocator must be thread-safe if the
+ * coroutine moves between threads.
+ */
+struct CoroFrameAllocation
+{
+    static void* operator new(size_t size) { return AllocateCoroFrame(size); }
+    static void operator delete(void* frame) { FreeCoroFrame(frame); }
+};
+
+/** Resumes the coroutine that awaits the finished one, if any. */
+struct CoroFinalAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct CoroPromiseBase : CoroFrameAllocation
+{
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    CoroFinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    void RethrowIfFailed() const
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+};
+
+template <typename T>
+struct CoroPromise final : CoroPromiseBase
+{
+    ~CoroPromise()
+    {
+        if (has_value)
+        {
+            GetValue().~T();
+        }
+    }
+
+    Coro<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value)
+    {
+        new (storage) T(std::forward<U>(value));
+        has_value = true;
+    }
+
+    T& GetValue() { return *std::launder(reinterpret_cast<T*>(storage)); }
+
+    T TakeResult()
+    {
+        RethrowIfFailed();
+        return std::move(GetValue());
+    }
+
+    alignas(T) unsigned char storage[sizeof(T)];
+    bool has_value = false;
+};
+
+template <>
+struct CoroPromise<void> final : CoroPromiseBase
+{
+    Coro<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void TakeResult() const { RethrowIfFailed(); }
+};
+
+}  // namespace Impl
+
+/**
+ * Coroutine that produces a value of type T.
+ *
+ * The coroutine is lazy: it starts when it is awaited with co_await, on the thread of the awaiting coroutine, and the
+ * awaiting coroutine continues right where the awaited one finished, without going through a pool. Await
+ * ThreadPool::Schedule() inside the coroutine to move it onto a worker, and use Spawn() to start a coroutine from code
+ * that is not a coroutine itself. While a coroutine is suspended it holds no thread.
+ *
+ * Frames are allocated through an AllocatorBase, see Impl::CoroFrameAllocation.
+ *
+ * @code
+ * Opal::Coro<Opal::i32> Add(Opal::ThreadPool& pool, Opal::i32 a, Opal::i32 b)
+ * {
+ *     co_await pool.Schedule();
+ *     co_return a + b;
+ * }
+ * @endcode
+ *
+ * @tparam T Type of the value. Can be void.
+ */
+template <typename T = void>
+class [[nodiscard]] Coro
+{
+public:
+    using promise_type = Impl::CoroPromise<T>;
+    using HandleType = std::coroutine_handle<promise_type>;
+
+    /** Creates an invalid coroutine. */
+    Coro() = default;
+
+    explicit Coro(HandleType handle) : m_handle(handle) {}
+
+    ~Coro()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    Coro(const Coro&) = delete;
+    Coro& operator=(const Coro&) = delete;
+
+    Coro(Coro&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Coro& operator=(Coro&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] bool IsValid() const { return static_cast<bool>(m_handle); }
+
+    /** Returns true if the coroutine ran to completion. */
+    [[nodiscard]] bool IsDone() const { return m_handle && m_handle.done(); }
+
+    /**
+     * Starts the coroutine and suspends the awaiting coroutine until it finished. Returns the value, or rethrows the
+     * exception that escaped the coroutine.
+     */
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept { return handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().TakeResult(); }
+
+            HandleType handle;
+        };
+        OPAL_ASSERT(m_handle, "Coroutine must be valid");
+        return Awaiter{m_handle};
+    }
+
+private:
+    HandleType m_handle;
+};
+
+template <typename T>
+Coro<T> Impl::CoroPromise<T>::get_return_object() noexcept
+{
+    return Coro<T>(Coro<T>::HandleType::from_promise(*this));
+}
+
+inline Coro<void> Impl::CoroPromise<void>::get_return_object() noexcept
+{
+    return Coro<void>(Coro<void>::HandleType::from_promise(*this));
+}
+
+namespace Impl
+{
+
+/** Coroutine that starts right away and frees its frame when it finishes. Nobody awaits it. */
+struct CoroDetached
+{
+    struct promise_type : CoroFrameAllocation
+    {
+        CoroDetached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        /** The body catches everything itself. */
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+template <typename T>
+CoroDetached RunSpawned(ThreadPool& pool, Coro<T> coro, Promise<T> promise)
+{
+    co_await pool.Schedule();
+    try
+    {
+        if constexpr (k_is_void_value<T>)
+        {
+            co_await std::move(coro);
+            promise.SetValue();
+        }
+        else
+        {
+            promise.SetValue(co_await std::move(coro));
+        }
+    }
+    catch (...)
+    {
+        promise.SetException(std::current_exception());
+    }
+}
+
+}  // namespace Impl
+
+/**
+ * Start @p coro on a worker of @p pool and return a future for its result. This is how code that is not a coroutine
+ * starts one. An exception that escapes the coroutine ends up in the future.
+ */
+template <typename T>
+Future<T> Spawn(ThreadPool& pool, Coro<T> coro)
+{
+    OPAL_ASSERT(coro.IsValid(), "Coroutine must be valid");
+    Promise<T> promise(pool.GetAllocator());
+    Future<T> future = promise.GetFuture();
+    // The driver frame is freed on a worker, so it comes from the thread-safe allocator of the pool
+    PushDefaultAllocator(pool.GetAllocator());
+    Impl::RunSpawned(pool, std::move(coro), std::move(promise));
+    PopDefaultAllocator();
+    return future;
+}
+
+}  // namespace Opal
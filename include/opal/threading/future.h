@@ -0,0 +1,628 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <utility>
+
+#include "opal/allocator.h"
+#include "opal/container/array-view.h"
+#include "opal/container/dynamic-array.h"
+#include "opal/container/intrusive-ptr.h"
+#include "opal/exceptions.h"
+#include "opal/threading/thread-pool.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+template <typename T>
+Future<void> WhenAll(ArrayView<const Future<T>> futures, AllocatorBase* allocator = nullptr);
+
+template <typename T>
+Future<u64> WhenAny(ArrayView<const Future<T>> futures, AllocatorBase* allocator = nullptr);
+
+namespace Impl
+{
+
+/** Stands in for the value of a Future<void>. */
+struct FutureVoid
+{
+};
+
+/**
+ * Called once when a future gets its value or exception. Callbacks form an intrusive list in the future state, so
+ * registering one does not allocate on top of the object that holds it.
+ */
+struct FutureCallback
+{
+    /** Called on the thread that completed the future, or right away if the future is already complete. */
+    virtual void Invoke() = 0;
+
+    FutureCallback* next_callback = nullptr;
+
+protected:
+    ~FutureCallback() = default;
+};
+
+enum class FutureStatus : u32
+{
+    Pending,
+    /** A value is being stored. Waiters keep waiting. */
+    Setting,
+    Ready,
+    Failed
+};
+
+/**
+ * State shared by a Promise and its futures.
+ */
+template <typename T>
+struct FutureState : RefCounted<>
+{
+    using ValueType = ConditionalType<k_is_void_value<T>, FutureVoid, T>;
+
+    ~FutureState()
+    {
+        if (GetStatus() == FutureStatus::Ready)
+        {
+            GetValue().~ValueType();
+        }
+    }
+
+    [[nodiscard]] FutureStatus GetStatus() const { return static_cast<FutureStatus>(status.load(std::memory_order_acquire)); }
+    [[nodiscard]] bool IsComplete() const { return GetStatus() >= FutureStatus::Ready; }
+
+    ValueType& GetValue() { return *std::launder(reinterpret_cast<ValueType*>(storage)); }
+    const ValueType& GetValue() const { return *std::launder(reinterpret_cast<const ValueType*>(storage)); }
+
+    template <typename... Args>
+    void SetValue(Args&&... args)
+    {
+        Claim();
+        try
+        {
+            new (storage) ValueType(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+            Complete(FutureStatus::Failed);
+            throw;
+        }
+        Complete(FutureStatus::Ready);
+    }
+
+    void SetException(std::exception_ptr in_exception)
+    {
+        Claim();
+        exception = std::move(in_exception);
+        Complete(FutureStatus::Failed);
+    }
+
+    /** Blocks until the state is complete. Uses std::atomic::wait, which is a futex on Linux. */
+    void Wait() const
+    {
+        u32 current = status.load(std::memory_order_acquire);
+        while (current < static_cast<u32>(FutureStatus::Ready))
+        {
+            status.wait(current, std::memory_order_acquire);
+            current = status.load(std::memory_order_acquire);
+        }
+    }
+
+    /** Runs @p callback once the state is complete, right away if it already is. */
+    void AddCallback(FutureCallback* callback)
+    {
+        if (!TryAddCallback(callback))
+        {
+            callback->Invoke();
+        }
+    }
+
+    /**
+     * Registers @p callback to run once the state is complete.
+     * @return False if the state is already complete. The callback is not registered then.
+     */
+    bool TryAddCallback(FutureCallback* callback)
+    {
+        FutureCallback* head = callbacks.load(std::memory_order_acquire);
+        do
+        {
+            if (head == GetCompletedMarker())
+            {
+                return false;
+            }
+            callback->next_callback = head;
+        } while (!callbacks.compare_exchange_weak(head, callback, std::memory_order_acq_rel, std::memory_order_acquire));
+        return true;
+    }
+
+    std::atomic<u32> status = static_cast<u32>(FutureStatus::Pending);
+    std::atomic<FutureCallback*> callbacks = nullptr;
+    std::exception_ptr exception;
+    alignas(ValueType) unsigned char storage[sizeof(ValueType)];
+
+private:
+    static FutureCallback* GetCompletedMarker() { return reinterpret_cast<FutureCallback*>(static_cast<uintptr_t>(1)); }
+
+    void Claim()
+    {
+        u32 expected = static_cast<u32>(FutureStatus::Pending);
+        if (!status.compare_exchange_strong(expected, static_cast<u32>(FutureStatus::Setting), std::memory_order_acquire))
+        {
+            throw PromiseAlreadySatisfiedException();
+        }
+    }
+
+    void Complete(FutureStatus final_status)
+    {
+        status.store(static_cast<u32>(final_status), std::memory_order_release);
+        status.notify_all();
+        // Callbacks were pushed to the front of the list, reverse it so they run in the order they were added
+        FutureCallback* callback = callbacks.exchange(GetCompletedMarker(), std::memory_order_acq_rel);
+        FutureCallback* ordered = nullptr;
+        while (callback != nullptr)
+        {
+            FutureCallback* next = callback->next_callback;
+            callback->next_callback = ordered;
+            ordered = callback;
+            callback = next;
+        }
+        while (ordered != nullptr)
+        {
+            // The callback can free itself
+            FutureCallback* next = ordered->next_callback;
+            ordered->Invoke();
+            ordered = next;
+        }
+    }
+};
+
+/**
+ * Awaitable that suspends a coroutine until a future completes.
+ * @tparam ReturnsCopy If true, co_await returns a copy of the value, for futures that are destroyed right after.
+ */
+template <typename T, bool ReturnsCopy>
+struct FutureAwaiter final : FutureCallback
+{
+    explicit FutureAwaiter(IntrusivePtr<FutureState<T>> in_state) : state(std::move(in_state)) {}
+
+    bool await_ready() const { return state->IsComplete(); }
+
+    bool await_suspend(std::coroutine_handle<> in_handle)
+    {
+        handle = in_handle;
+        return state->TryAddCallback(this);
+    }
+
+    decltype(auto) await_resume() const
+    {
+        if (state->GetStatus() == FutureStatus::Failed)
+        {
+            std::rethrow_exception(state->exception);
+        }
+        if constexpr (k_is_void_value<T>)
+        {
+            return;
+        }
+        else if constexpr (ReturnsCopy)
+        {
+            return T(state->GetValue());
+        }
+        else
+        {
+            return static_cast<const T&>(state->GetValue());
+        }
+    }
+
+    void Invoke() override { handle.resume(); }
+
+    IntrusivePtr<FutureState<T>> state;
+    std::coroutine_handle<> handle;
+};
+
+}  // namespace Impl
+
+/**
+ * Result of an asynchronous operation that will be available later.
+ *
+ * Futures share the state with the Promise that produces the result and can be cloned, all clones see the same value.
+ * Waiting blocks on the state with std::atomic::wait, the same way as Task::WaitForCompletion().
+ *
+ * A coroutine can co_await a future instead of blocking. It continues on the thread that completes the future, or
+ * right away if the future is already complete. Await ThreadPool::Schedule() afterwards to move back to a pool.
+ *
+ * @tparam T Type of the value. Can be void.
+ */
+template <typename T>
+class Future
+{
+public:
+    using value_type = T;
+
+    /** Creates an invalid future that has no state. */
+    Future() = default;
+
+    explicit Future(IntrusivePtr<Impl::FutureState<T>> state) : m_state(std::move(state)) {}
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+    Future(Future&&) noexcept = default;
+    Future& operator=(Future&&) noexcept = default;
+    ~Future() = default;
+
+    /**
+     * Create another future that refers to the same result.
+     * @param allocator Ignored. The clone shares the existing state, so nothing is allocated. This parameter exists for
+     *        API compatibility with Opal::Clone(source, allocator).
+     */
+    [[nodiscard]] Future Clone([[maybe_unused]] AllocatorBase* allocator = nullptr) const { return Future(m_state.Clone()); }
+
+    [[nodiscard]] bool IsValid() const { return m_state.IsValid(); }
+
+    /** Returns true if the value or an exception is available. */
+    [[nodiscard]] bool IsReady() const { return m_state->IsComplete(); }
+
+    /** Returns true if the future is ready and holds an exception. */
+    [[nodiscard]] bool HasException() const { return m_state->GetStatus() == Impl::FutureStatus::Failed; }
+
+    /** Blocks until the value or an exception is available. */
+    void Wait() const { m_state->Wait(); }
+
+    /**
+     * Blocks until the result is available and returns it.
+     * @return Reference to the value, which lives as long as any future or promise of the same state. Nothing for
+     * Future<void>.
+     * @throw Rethrows the exception set on the promise.
+     */
+    decltype(auto) Get() const
+    {
+        m_state->Wait();
+        if (m_state->GetStatus() == Impl::FutureStatus::Failed)
+        {
+            std::rethrow_exception(m_state->exception);
+        }
+        if constexpr (!k_is_void_value<T>)
+        {
+            return static_cast<const T&>(m_state->GetValue());
+        }
+    }
+
+    /**
+     * Run @p function on @p pool with the value of this future once it is available.
+     *
+     * If this future holds an exception, @p function is not called and the returned future gets the same exception.
+     * An exception thrown by @p function ends up in the returned future as well.
+     *
+     * @param function Callable with signature U(const T&), or U() for Future<void>.
+     * @return Future for the result of @p function.
+     */
+    template <typename Function>
+    auto Then(ThreadPool& pool, Function function) const;
+
+    /** co_await returns a reference to the value, which lives as long as this future. */
+    Impl::FutureAwaiter<T, false> operator co_await() const& { return Impl::FutureAwaiter<T, false>(m_state.Clone()); }
+
+    /** co_await on a temporary future returns a copy of the value. */
+    Impl::FutureAwaiter<T, true> operator co_await() const&& { return Impl::FutureAwaiter<T, true>(m_state.Clone()); }
+
+private:
+    template <typename U>
+    friend Future<void> WhenAll(ArrayView<const Future<U>> futures, AllocatorBase* allocator);
+    template <typename U>
+    friend Future<u64> WhenAny(ArrayView<const Future<U>> futures, AllocatorBase* allocator);
+
+    IntrusivePtr<Impl::FutureState<T>> m_state;
+};
+
+/**
+ * Producer side of a Future. Set a value or an exception exactly once.
+ *
+ * A promise that is destroyed without a value completes its futures with BrokenPromiseException, so waiters never hang.
+ *
+ * @tparam T Type of the value. Can be void.
+ */
+template <typename T>
+class Promise
+{
+public:
+    /**
+     * @param allocator Allocator for the shared state. Must be thread-safe. If nullptr, the default allocator is used.
+     */
+    explicit Promise(AllocatorBase* allocator = nullptr) : m_state(allocator) {}
+
+    ~Promise() { Abandon(); }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+    Promise(Promise&&) noexcept = default;
+    Promise& operator=(Promise&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Abandon();
+            m_state = std::move(other.m_state);
+        }
+        return *this;
+    }
+
+    /** Returns a future for the value of this promise. Can be called more than once. */
+    [[nodiscard]] Future<T> GetFuture() const { return Future<T>(m_state.Clone()); }
+
+    /**
+     * Store the value and wake all waiters.
+     * @param args Arguments for the constructor of T. None for Promise<void>.
+     * @throw PromiseAlreadySatisfiedException When a value or an exception was already set.
+     */
+    template <typename... Args>
+    void SetValue(Args&&... args)
+    {
+        m_state->SetValue(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Store an exception and wake all waiters. Future::Get() rethrows it.
+     * @throw PromiseAlreadySatisfiedException When a value or an exception was already set.
+     */
+    void SetException(std::exception_ptr exception) { m_state->SetException(std::move(exception)); }
+
+private:
+    void Abandon()
+    {
+        if (m_state.IsValid() && m_state->GetStatus() == Impl::FutureStatus::Pending)
+        {
+            m_state->SetException(std::make_exception_ptr(BrokenPromiseException()));
+        }
+    }
+
+    IntrusivePtr<Impl::FutureState<T>> m_state;
+};
+
+namespace Impl
+{
+
+template <typename T, typename Function>
+struct FutureThenResult
+{
+    using Type = decltype(std::declval<Function&>()(std::declval<const T&>()));
+};
+
+template <typename Function>
+struct FutureThenResult<void, Function>
+{
+    using Type = decltype(std::declval<Function&>()());
+};
+
+/** Calls @p function and stores its result or exception in @p promise. */
+template <typename R, typename Function, typename... Args>
+void FulfillPromise(Promise<R>& promise, Function& function, Args&... args)
+{
+    try
+    {
+        if constexpr (k_is_void_value<R>)
+        {
+            function(args...);
+            promise.SetValue();
+        }
+        else
+        {
+            promise.SetValue(function(args...));
+        }
+    }
+    catch (...)
+    {
+        promise.SetException(std::current_exception());
+    }
+}
+
+template <typename R, typename Function>
+struct AsyncTask final : Task
+{
+    AsyncTask(AllocatorBase* allocator, Function in_function) : promise(allocator), function(std::move(in_function)) {}
+
+    void Execute(TransmitterType&) override { FulfillPromise(promise, function); }
+
+    Promise<R> promise;
+    Function function;
+};
+
+/**
+ * Task that waits in the callback list of a future and submits itself to the pool once the future completes.
+ */
+template <typename T, typename R, typename Function>
+struct FutureThenTask final : Task, FutureCallback
+{
+    FutureThenTask(ThreadPool& in_pool, IntrusivePtr<FutureState<T>> in_source, Function in_function)
+        : pool(&in_pool), source(std::move(in_source)), promise(in_pool.GetAllocator()), function(std::move(in_function))
+    {
+    }
+
+    /** Runs on the thread that completes the source, which can be a worker of the pool, so it must not block. */
+    void Invoke() override { pool->AddTaskNonBlocking(IntrusivePtr<Task>::Adopt(this)); }
+
+    void Execute(TransmitterType&) override
+    {
+        if (source->GetStatus() == FutureStatus::Failed)
+        {
+            promise.SetException(source->exception);
+        }
+        else if constexpr (k_is_void_value<T>)
+        {
+            FulfillPromise(promise, function);
+        }
+        else
+        {
+            const T& value = source->GetValue();
+            FulfillPromise(promise, function, value);
+        }
+        source.Reset();
+    }
+
+    ThreadPool* pool;
+    IntrusivePtr<FutureState<T>> source;
+    Promise<R> promise;
+    Function function;
+};
+
+/**
+ * Shared state of WhenAll and WhenAny. Holds one callback per input and one reference per callback that did not run yet.
+ */
+template <typename T, typename R>
+struct FutureCombinator : RefCounted<>
+{
+    struct Callback final : FutureCallback
+    {
+        void Invoke() override { owner->OnInputComplete(*this); }
+
+        FutureCombinator* owner = nullptr;
+        FutureState<T>* input = nullptr;
+        u64 index = 0;
+    };
+
+    FutureCombinator(u64 count, AllocatorBase* allocator) : callbacks(count, allocator), promise(allocator), remaining(count) {}
+
+    /**
+     * Registers the callback for input @p index.
+     * @param self Reference to this combinator, released by the callback once it ran. The input itself is kept alive by
+     * its promise until it completes.
+     */
+    void Watch(u64 index, IntrusivePtr<FutureState<T>> state, IntrusivePtr<FutureCombinator> self)
+    {
+        Callback& callback = callbacks[index];
+        callback.owner = self.Detach();
+        callback.input = state.Get();
+        callback.index = index;
+        state->AddCallback(&callback);
+    }
+
+    void OnInputComplete(Callback& callback)
+    {
+        if constexpr (k_is_void_value<R>)
+        {
+            // WhenAll: remember the first failure and complete after the last input
+            if (callback.input->GetStatus() == FutureStatus::Failed)
+            {
+                bool has_failure = false;
+                if (has_result.compare_exchange_strong(has_failure, true, std::memory_order_acq_rel))
+                {
+                    first_exception = callback.input->exception;
+                }
+            }
+            // Decrement only after recording the failure, so the input that completes last sees first_exception
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if (first_exception)
+                {
+                    promise.SetException(first_exception);
+                }
+                else
+                {
+                    promise.SetValue();
+                }
+            }
+        }
+        else
+        {
+            // WhenAny: the first input to complete wins
+            bool has_winner = false;
+            if (has_result.compare_exchange_strong(has_winner, true, std::memory_order_acq_rel))
+            {
+                promise.SetValue(callback.index);
+            }
+        }
+        IntrusivePtr<FutureCombinator>::Adopt(this).Reset();
+    }
+
+    DynamicArray<Callback> callbacks;
+    Promise<R> promise;
+    std::atomic<u64> remaining;
+    std::atomic<bool> has_result = false;
+    std::exception_ptr first_exception;
+};
+
+}  // namespace Impl
+
+template <typename T>
+template <typename Function>
+auto Future<T>::Then(ThreadPool& pool, Function function) const
+{
+    using R = typename Impl::FutureThenResult<T, Function>::Type;
+    using TaskType = Impl::FutureThenTask<T, R, Function>;
+    IntrusivePtr<TaskType> task(pool.GetAllocator(), pool, m_state.Clone(), std::move(function));
+    Future<R> result = task->promise.GetFuture();
+    // The callback list owns the task until the future completes, then the pool owns it
+    TaskType* raw_task = task.Detach();
+    raw_task->source->AddCallback(raw_task);
+    return result;
+}
+
+/**
+ * Run @p function on @p pool and return a future for its result. An exception thrown by @p function is stored in the
+ * future instead of reaching the worker.
+ * @param function Callable with signature R().
+ */
+template <typename Function>
+auto Async(ThreadPool& pool, Function function) -> Future<decltype(function())>
+{
+    using R = decltype(function());
+    IntrusivePtr<Impl::AsyncTask<R, Function>> task(pool.GetAllocator(), pool.GetAllocator(), std::move(function));
+    Future<R> result = task->promise.GetFuture();
+    pool.AddTask(IntrusivePtr<Task>(std::move(task)));
+    return result;
+}
+
+/**
+ * Returns a future that completes once all @p futures completed. It holds the first exception among the inputs, in the
+ * order they completed, or no value if all succeeded. Get the values from the input futures.
+ * @param allocator Allocator for the combinator state. If nullptr, the default allocator is used.
+ */
+template <typename T>
+Future<void> WhenAll(ArrayView<const Future<T>> futures, AllocatorBase* allocator)
+{
+    IntrusivePtr<Impl::FutureCombinator<T, void>> combinator(allocator, futures.GetSize(), allocator);
+    Future<void> result = combinator->promise.GetFuture();
+    if (futures.IsEmpty())
+    {
+        combinator->promise.SetValue();
+        return result;
+    }
+    for (u64 i = 0; i < futures.GetSize(); ++i)
+    {
+        combinator->Watch(i, futures[i].m_state.Clone(), combinator.Clone());
+    }
+    return result;
+}
+
+/**
+ * Returns a future with the index of the first of @p futures that completed, with a value or with an exception.
+ * @param futures Must not be empty.
+ * @param allocator Allocator for the combinator state. If nullptr, the default allocator is used.
+ * @throw InvalidArgumentException When @p futures is empty.
+ */
+template <typename T>
+Future<u64> WhenAny(ArrayView<const Future<T>> futures, AllocatorBase* allocator)
+{
+    if (futures.IsEmpty())
+    {
+        throw InvalidArgumentException("WhenAny", "Needs at least one future");
+    }
+    IntrusivePtr<Impl::FutureCombinator<T, u64>> combinator(allocator, futures.GetSize(), allocator);
+    Future<u64> result = combinator->promise.GetFuture();
+    for (u64 i = 0; i < futures.GetSize(); ++i)
+    {
+        combinator->Watch(i, futures[i].m_state.Clone(), combinator.Clone());
+    }
+    return result;
+}
+
+}  // namespace Opal
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+
+#include "opal/container/array-view.h"
+#include "opal/container/dynamic-array.h"
+#include "opal/container/intrusive-ptr.h"
+#include "opal/math-base.h"
+#include "opal/threading/thread-pool.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+namespace Impl
+{
+
+/**
+ * Shared state of one parallel loop. The calling thread and a few helper tasks claim chunks of the range until it is
+ * exhausted. Chunks shrink as the range runs out, so participants that start late or run slowly still finish at about
+ * the same time. The job counts processed indices instead of tasks, and whoever processes the last index wakes the
+ * caller. All helpers share this single task object.
+ * @tparam Body Callable with signature void(u64 first, u64 last, u32 participant). The participant index is unique per
+ * thread taking part in the loop and smaller than the participant count.
+ */
+template <typename Body>
+struct ParallelJob final : Task
+{
+    ParallelJob(Body& body, u64 begin, u64 end, u64 grain, u32 participant_count)
+        : m_body(&body), m_end(end), m_grain(grain), m_participant_count(participant_count), m_next(begin), m_remaining(end - begin)
+    {
+    }
+
+    void Execute(TransmitterType&) override { Participate(); }
+
+    /** Processes chunks until none are left to claim. */
+    void Participate()
+    {
+        const u32 participant = m_next_participant.fetch_add(1, std::memory_order_relaxed);
+        OPAL_ASSERT(participant < m_participant_count, "More participants than expected");
+        u64 first = m_next.load(std::memory_order_relaxed);
+        while (true)
+        {
+            u64 count = 0;
+            do
+            {
+                if (first >= m_end)
+                {
+                    return;
+                }
+                const u64 left = m_end - first;
+                count = Min(Max(m_grain, left / (2 * static_cast<u64>(m_participant_count))), left);
+            } while (!m_next.compare_exchange_weak(first, first + count, std::memory_order_relaxed, std::memory_order_relaxed));
+
+            try
+            {
+                (*m_body)(first, first + count, participant);
+            }
+            catch (...)
+            {
+                Abort(std::current_exception());
+            }
+            FinishIndices(count);
+            first = m_next.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Blocks until every index was processed, then rethrows the first exception thrown by the body, if any.
+     */
+    void Wait()
+    {
+        while (!m_is_done.load(std::memory_order_acquire))
+        {
+            m_is_done.wait(false, std::memory_order_acquire);
+        }
+        if (m_exception)
+        {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+private:
+    void FinishIndices(u64 count)
+    {
+        if (m_remaining.fetch_sub(count, std::memory_order_acq_rel) == count)
+        {
+            m_is_done.store(true, std::memory_order_release);
+            m_is_done.notify_all();
+        }
+    }
+
+    /** Keeps the first exception and gives up on all indices that nobody claimed yet. */
+    void Abort(std::exception_ptr exception)
+    {
+        bool has_exception = false;
+        if (m_has_exception.compare_exchange_strong(has_exception, true, std::memory_order_relaxed))
+        {
+            m_exception = std::move(exception);
+        }
+        const u64 first = m_next.exchange(m_end, std::memory_order_relaxed);
+        if (first < m_end)
+        {
+            FinishIndices(m_end - first);
+        }
+    }
+
+    /** Only dereferenced while indices are left, so it does not outlive the caller even when helpers start late. */
+    Body* m_body;
+    u64 m_end;
+    u64 m_grain;
+    u32 m_participant_count;
+    std::atomic<u32> m_next_participant = 0;
+    std::atomic<u64> m_next;
+    std::atomic<u64> m_remaining;
+    std::atomic<bool> m_is_done = false;
+    std::atomic<bool> m_has_exception = false;
+    std::exception_ptr m_exception;
+};
+
+/** Grain used when the caller passes zero: about eight chunks per participant. */
+inline u64 GetParallelGrain(const ThreadPool& pool, u64 count, u64 grain)
+{
+    if (grain != 0)
+    {
+        return grain;
+    }
+    return Max<u64>(1, count / (8 * (pool.GetThreadCount() + 1)));
+}
+
+/** Number of threads worth involving: the caller plus one helper per worker, but never more than there are chunks. */
+inline u32 GetParallelParticipantCount(const ThreadPool& pool, u64 count, u64 grain)
+{
+    const u64 chunk_count = (count + grain - 1) / grain;
+    return static_cast<u32>(Min<u64>(pool.GetThreadCount() + 1, chunk_count));
+}
+
+/**
+ * Runs @p body over [begin, end) on the calling thread and participant_count - 1 helper tasks. Returns once the whole
+ * range was processed.
+ */
+template <typename Body>
+void RunParallel(ThreadPool& pool, u64 begin, u64 end, u64 grain, u32 participant_count, Body& body)
+{
+    if (participant_count <= 1)
+    {
+        if (begin < end)
+        {
+            body(begin, end, 0u);
+        }
+        return;
+    }
+    IntrusivePtr<ParallelJob<Body>> job(pool.GetAllocator(), body, begin, end, grain, participant_count);
+    for (u32 i = 1; i < participant_count; ++i)
+    {
+        pool.AddTask(IntrusivePtr<Task>(job.Clone()));
+    }
+    job->Participate();
+    job->Wait();
+}
+
+}  // namespace Impl
+
+/**
+ * Calls @p function for every index in [begin, end), spread over the workers of @p pool and the calling thread.
+ *
+ * The calling thread takes part in the loop and returns once every index was processed. Participants claim chunks of
+ * the range from a shared counter. Chunks start large and shrink towards @p grain as the range runs out, which keeps
+ * the overhead low and still balances the load at the end. Only one task object is allocated per call, and none when
+ * the range fits into a single chunk.
+ *
+ * If the function throws, indices that were not claimed yet are skipped and the first exception is rethrown on the
+ * calling thread once the chunks that are already running have finished.
+ *
+ * @param pool Pool that provides the helper threads.
+ * @param begin First index.
+ * @param end One past the last index.
+ * @param grain Smallest number of indices processed in one chunk. Zero picks a grain that gives about eight chunks per
+ * participant.
+ * @param function Callable with signature void(u64 index) or void(u64 first, u64 last). The second form gets whole
+ * chunks, which lets the compiler vectorize the inner loop.
+ */
+template <typename Function>
+void ParallelFor(ThreadPool& pool, u64 begin, u64 end, u64 grain, Function&& function)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    const u64 count = end - begin;
+    grain = Impl::GetParallelGrain(pool, count, grain);
+    constexpr bool k_takes_chunks = requires(Function& f, u64 index) { f(index, index); };
+    auto body = [&function](u64 first, u64 last, u32)
+    {
+        if constexpr (k_takes_chunks)
+        {
+            function(first, last);
+        }
+        else
+        {
+            for (u64 index = first; index < last; ++index)
+            {
+                function(index);
+            }
+        }
+    };
+    Impl::RunParallel(pool, begin, end, grain, Impl::GetParallelParticipantCount(pool, count, grain), body);
+}
+
+/**
+ * Calls @p function for every element of @p view in parallel. See ParallelFor.
+ * @param function Callable with signature void(T& element).
+ * @param grain Smallest number of elements processed in one chunk. Zero picks one automatically.
+ */
+template <typename T, typename Function>
+void ParallelForEach(ThreadPool& pool, ArrayView<T> view, Function&& function, u64 grain = 0)
+{
+    T* data = view.GetData();
+    ParallelFor(pool, 0, view.GetSize(), grain,
+                [data, &function](u64 first, u64 last)
+                {
+                    for (u64 index = first; index < last; ++index)
+                    {
+                        function(data[index]);
+                    }
+                });
+}
+
+/**
+ * Transforms every element of @p view and combines the results, in parallel. See ParallelFor for how the work is
+ * split.
+ *
+ * Every participant folds its chunks into its own partial result, and the partial results are combined on the calling
+ * thread at the end. Since chunks are handed out dynamically, the grouping of the reduction changes from run to run,
+ * so @p reduce must be associative and commutative. Floating point sums can differ in the last bits between runs.
+ *
+ * @param identity Value that does not change the result when combined with any other value. Starts every partial result.
+ * @param reduce Callable with signature U(U, U).
+ * @param transform Callable with signature U(const T&).
+ * @param grain Smallest number of elements processed in one chunk. Zero picks one automatically.
+ * @return Combination of @p identity and all transformed elements.
+ */
+template <typename T, typename U, typename Reduce, typename Transform>
+U ParallelTransformReduce(ThreadPool& pool, ArrayView<T> view, U identity, Reduce&& reduce, Transform&& transform, u64 grain = 0)
+{
+    const u64 count = view.GetSize();
+    if (count == 0)
+    {
+        return identity;
+    }
+    grain = Impl::GetParallelGrain(pool, count, grain);
+    const u32 participant_count = Impl::GetParallelParticipantCount(pool, count, grain);
+    DynamicArray<U> partials(participant_count, identity, pool.GetAllocator());
+    T* data = view.GetData();
+    auto body = [data, &partials, &reduce, &transform](u64 first, u64 last, u32 participant)
+    {
+        U value = partials[participant];
+        for (u64 index = first; index < last; ++index)
+        {
+            value = reduce(value, transform(data[index]));
+        }
+        partials[participant] = value;
+    };
+    Impl::RunParallel(pool, 0, count, grain, participant_count, body);
+    U result = partials[0];
+    for (u32 i = 1; i < participant_count; ++i)
+    {
+        result = reduce(result, partials[i]);
+    }
+    return result;
+}
+
+/**
+ * Combines all elements of @p view in parallel. See ParallelTransformReduce.
+ * @param identity Value that does not change the result when combined with any other value.
+ * @param reduce Callable with signature T(T, T). Must be associative and commutative.
+ * @param grain Smallest number of elements processed in one chunk. Zero picks one automatically.
+ */
+template <typename T, typename Reduce>
+typename RemoveConstVolatile<T>::Type ParallelReduce(ThreadPool& pool, ArrayView<T> view, typename RemoveConstVolatile<T>::Type identity,
+                                                     Reduce&& reduce, u64 grain = 0)
+{
+    return ParallelTransformReduce(pool, view, std::move(identity), reduce, [](const T& element) { return element; }, grain);
+}
+
+}  // namespace Opal
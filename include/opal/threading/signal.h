@@ -3,6 +3,7 @@
 #include <atomic>
 
 #include "opal/defines.h"
+#include "opal/threading/spin-wait.h"
 #include "opal/types.h"
 
 namespace Opal
@@ -11,7 +12,8 @@ namespace Opal
 /**
  * Lightweight synchronization primitive for signaling changes between threads.
  * Uses WaitOnAddress on Windows and futex on Linux. Does not require a mutex or an allocator.
- * Internally uses a monotonic u32 counter to avoid lost notifications.
+ * Internally uses a monotonic u32 counter to avoid lost notifications. Waiting spins for a short while before it
+ * parks the thread, see SpinWaitPolicy.
  */
 OPAL_START_DISABLE_WARNINGS
 OPAL_DISABLE_MSVC_WARNING(4324)
@@ -19,6 +21,10 @@ class alignas(OPAL_CACHE_LINE_SIZE) Signal
 {
 public:
     Signal();
+    /**
+     * @param spin_wait How long Wait() and WaitFor() spin before they park the thread.
+     */
+    explicit Signal(const SpinWaitPolicy& spin_wait);
     ~Signal();
 
     Signal(const Signal&) = delete;
@@ -58,8 +64,11 @@ public:
      */
     void NotifyAll();
 
+    [[nodiscard]] const SpinWaitPolicy& GetSpinWaitPolicy() const { return m_spin_wait; }
+
 private:
     std::atomic<u32> m_state{0};
+    SpinWaitPolicy m_spin_wait;
 };
 OPAL_END_DISABLE_WARNINGS
 
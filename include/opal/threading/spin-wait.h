@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+
+#include "opal/threading/cpu-pause.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+/**
+ * How long a blocking wait spins before it parks the thread in the OS. Spinning wakes the waiter within a few hundred
+ * nanoseconds when the other side answers quickly, parking keeps a thread that waits for long from burning a core.
+ */
+struct SpinWaitPolicy
+{
+    /** Number of times the condition is checked while spinning. Zero parks right away. */
+    u32 spin_count = 10;
+    /** The number of CpuPause() calls between two checks starts at one and doubles up to this limit. */
+    u32 max_pause_count = 64;
+};
+
+/**
+ * Exponential backoff for spin loops that give up after the spin budget of a SpinWaitPolicy.
+ * @code
+ * Opal::SpinWait spin(policy);
+ * while (!IsReady())
+ * {
+ *     if (!spin.Spin())
+ *     {
+ *         Park();
+ *     }
+ * }
+ * @endcode
+ */
+class SpinWait
+{
+public:
+    explicit SpinWait(const SpinWaitPolicy& policy = {}) : m_policy(policy) {}
+
+    /**
+     * Pauses the CPU for the current backoff and doubles the backoff for the next call.
+     * @return False, without pausing, once the spin budget is used up and the caller should park.
+     */
+    bool Spin()
+    {
+        if (m_spin_index >= m_policy.spin_count)
+        {
+            return false;
+        }
+        ++m_spin_index;
+        for (u32 i = 0; i < m_pause_count; ++i)
+        {
+            CpuPause();
+        }
+        m_pause_count = m_pause_count < m_policy.max_pause_count / 2 ? m_pause_count * 2 : m_policy.max_pause_count;
+        return true;
+    }
+
+    /** Start over with a full spin budget and the shortest backoff. */
+    void Reset()
+    {
+        m_spin_index = 0;
+        m_pause_count = 1;
+    }
+
+private:
+    SpinWaitPolicy m_policy;
+    u32 m_spin_index = 0;
+    u32 m_pause_count = 1;
+};
+
+/**
+ * Blocks until @p value differs from @p old_value. Spins according to @p policy first, then parks with
+ * std::atomic::wait(), so the writer must call notify_one() or notify_all() after changing the value.
+ */
+template <typename T>
+void SpinThenWait(const std::atomic<T>& value, T old_value, std::memory_order order, const SpinWaitPolicy& policy)
+{
+    SpinWait spin(policy);
+    while (value.load(order) == old_value)
+    {
+        if (!spin.Spin())
+        {
+            value.wait(old_value, order);
+        }
+    }
+}
+
+}  // namespace Opal
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+
+#include "opal/allocator.h"
+#include "opal/container/array-view.h"
+#include "opal/container/dynamic-array.h"
+#include "opal/container/intrusive-ptr.h"
+#include "opal/export.h"
+#include "opal/threading/thread-pool.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+class TaskGraph;
+
+namespace Impl
+{
+
+/**
+ * Node of a TaskGraph. The node is a Task itself, so dispatching it to a pool allocates nothing.
+ */
+struct OPAL_EXPORT TaskGraphNode : Task
+{
+    TaskGraphNode(TaskGraph* in_graph, AllocatorBase* allocator) : graph(in_graph), successors(allocator) {}
+
+    /** Runs the node, then submits every successor whose last predecessor this was. */
+    void Execute(TransmitterType& transmitter) override;
+
+    /** Work of the node. Join nodes do nothing. */
+    virtual void Run() {}
+
+    TaskGraph* graph;
+    DynamicArray<u32> successors;
+    u32 predecessor_count = 0;
+    /** Reset to predecessor_count when the graph starts. The node is ready once it drops to zero. */
+    std::atomic<u32> remaining_predecessors = 0;
+};
+
+template <typename Function>
+struct TaskGraphFunctionNode final : TaskGraphNode
+{
+    TaskGraphFunctionNode(TaskGraph* in_graph, AllocatorBase* allocator, Function in_function)
+        : TaskGraphNode(in_graph, allocator), function(std::move(in_function))
+    {
+    }
+
+    void Run() override { function(); }
+
+    Function function;
+};
+
+/** Flag that tells whether a graph run is in progress. Reference counted so the last node can still notify the waiter
+ * after the waiter returned and destroyed the graph. */
+struct TaskGraphCompletion : RefCounted<>
+{
+    std::atomic<bool> is_running = false;
+};
+
+}  // namespace Impl
+
+/**
+ * Directed acyclic graph of tasks that runs on a ThreadPool.
+ *
+ * Nodes are added once with AddNode() and connected with AddDependency(). When the graph runs, every node keeps an
+ * atomic count of predecessors that did not finish yet. A node is submitted to the pool as soon as that count drops to
+ * zero, by the worker that finished its last predecessor, so there are no barriers between stages. Successors are
+ * pushed to the deque of that worker when the pool uses work stealing, so they most likely run on the same core.
+ *
+ * A built graph can be run any number of times. Running resets the counters and submits the nodes themselves, so after
+ * the first run it does not allocate.
+ *
+ * If a node throws, the nodes that did not start yet are skipped and Wait() rethrows the first exception.
+ *
+ * The graph must not be modified or destroyed while it runs.
+ */
+class OPAL_EXPORT TaskGraph
+{
+public:
+    using NodeId = u32;
+
+    /**
+     * @param allocator Allocator for the nodes. Must be thread-safe. If nullptr, the default allocator is used.
+     */
+    explicit TaskGraph(AllocatorBase* allocator = nullptr);
+
+    /** Waits for a run that is still in progress. */
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = delete;
+    TaskGraph& operator=(TaskGraph&&) = delete;
+
+    /**
+     * Add a node that calls @p function when it runs.
+     * @param function Callable with signature void().
+     * @return Id of the new node.
+     */
+    template <typename Function>
+    NodeId AddNode(Function function)
+    {
+        return AddNodeImpl(MakeIntrusive<Impl::TaskGraphNode, Impl::TaskGraphFunctionNode<Function>>(m_allocator, this, m_allocator,
+                                                                                                      std::move(function)));
+    }
+
+    /**
+     * Add a node that does nothing and runs after all @p predecessors. Use it to wait for a group of nodes with a
+     * single dependency instead of connecting every node of the group to every node of the next group.
+     * @return Id of the new node.
+     * @throw OutOfBoundsException When a predecessor does not exist.
+     */
+    NodeId AddJoinNode(ArrayView<const NodeId> predecessors);
+
+    /**
+     * Add a node that calls @p function after @p predecessor finished.
+     * @return Id of the new node.
+     * @throw OutOfBoundsException When the predecessor does not exist.
+     */
+    template <typename Function>
+    NodeId AddContinuation(NodeId predecessor, Function function)
+    {
+        const NodeId node = AddNode(std::move(function));
+        AddDependency(predecessor, node);
+        return node;
+    }
+
+    /**
+     * Make @p successor wait for @p predecessor.
+     * @throw OutOfBoundsException When one of the nodes does not exist.
+     */
+    void AddDependency(NodeId predecessor, NodeId successor);
+
+    /**
+     * Start running the graph on @p pool and return immediately. The first run after the graph was modified checks
+     * that the graph has no cycles.
+     * @throw InvalidArgumentException When the graph has a cycle.
+     */
+    void Submit(ThreadPool& pool);
+
+    /**
+     * Block until the run started with Submit() finished. Returns immediately if the graph does not run.
+     * @throw Rethrows the first exception thrown by a node.
+     */
+    void Wait();
+
+    /** Submit the graph and wait for it to finish. */
+    void Run(ThreadPool& pool)
+    {
+        Submit(pool);
+        Wait();
+    }
+
+    /** Remove all nodes. */
+    void Clear();
+
+    [[nodiscard]] bool IsRunning() const { return m_completion->is_running.load(std::memory_order_acquire); }
+    [[nodiscard]] u32 GetNodeCount() const { return static_cast<u32>(m_nodes.GetSize()); }
+    [[nodiscard]] AllocatorBase* GetAllocator() const { return m_allocator; }
+
+private:
+    friend struct Impl::TaskGraphNode;
+
+    NodeId AddNodeImpl(IntrusivePtr<Impl::TaskGraphNode> node);
+    void Validate();
+    void SetException(std::exception_ptr exception);
+    void FinishNode();
+
+    AllocatorBase* m_allocator = nullptr;
+    DynamicArray<IntrusivePtr<Impl::TaskGraphNode>> m_nodes;
+    /** Nodes without predecessors. Filled in by Validate(). */
+    DynamicArray<NodeId> m_roots;
+    IntrusivePtr<Impl::TaskGraphCompletion> m_completion;
+    std::atomic<u32> m_pending_count = 0;
+    std::atomic<bool> m_has_exception = false;
+    std::exception_ptr m_exception;
+    bool m_is_validated = false;
+};
+
+}  // namespace Opal
@@ -1,23 +1,74 @@
 #pragma once
 
+#include <coroutine>
+#include <exception>
+
 #include "opal/allocator.h"
 #include "opal/container/dynamic-array.h"
-#include "opal/container/shared-ptr.h"
-#include "opal/threading/channel-mpmc.h"
+#include "opal/container/intrusive-ptr.h"
+#include "opal/export.h"
+#include "opal/threading/signal.h"
+#include "opal/threading/spin-wait.h"
 #include "opal/threading/thread.h"
 #include "opal/type-traits.h"
 
 namespace Opal
 {
 
+class ThreadPool;
+struct Task;
+
+namespace Impl
+{
+struct ThreadPoolWorker;
+struct ThreadPoolLane;
+struct ThreadPoolTimers;
+class ThreadPoolScheduleAwaiter;
+class ThreadPoolTimerAwaiter;
+}  // namespace Impl
+
+/**
+ * Lane a task is queued in. Workers take tasks from the highest lane that has work, see ThreadPoolDesc::starvation_limit
+ * for how the lower lanes still make progress.
+ */
+enum class TaskPriority : u8
+{
+    /** Latency-critical work, for example handling an interactive request. */
+    High,
+    Normal,
+    /** Bulk work that only needs to finish eventually. */
+    Background
+};
+
+/**
+ * Submits follow-up tasks to the pool that runs the current task. Passed to Task::Execute().
+ */
+class TaskTransmitter
+{
+public:
+    explicit TaskTransmitter(ThreadPool& pool) : m_pool(&pool) {}
+
+    /**
+     * Submits a task to the pool. With ThreadPoolScheduling::WorkStealing a task with normal priority is pushed to the
+     * deque of the current worker, so it most likely runs on the same core as its parent.
+     */
+    void Send(IntrusivePtr<Task> task, TaskPriority priority = TaskPriority::Normal);
+
+    [[nodiscard]] ThreadPool& GetPool() { return *m_pool; }
+
+private:
+    ThreadPool* m_pool = nullptr;
+};
+
 /**
  * Base class for tasks that can be submitted to a ThreadPool.
  * Subclass and override Execute() to define the work. Tasks can submit follow-up tasks
- * via the transmitter reference passed to Execute().
+ * via the transmitter passed to Execute().
+ * Tasks carry their own reference count and are owned through IntrusivePtr<Task>.
  */
-struct Task
+struct Task : RefCounted<ThreadingPolicy::ThreadSafe>
 {
-    using TransmitterType = TransmitterMPMC<SharedPtr<Task>, true>;
+    using TransmitterType = TaskTransmitter;
 
     virtual ~Task() {}
 
@@ -36,24 +87,34 @@ struct Task
         m_is_completed.notify_all();
     }
 
+    /**
+     * Stores an exception thrown by Execute(). Called by the worker before SetCompleted().
+     */
+    void SetException(std::exception_ptr exception) { m_exception = std::move(exception); }
+
+    /**
+     * Returns the exception thrown by Execute(), or nullptr if it returned normally. Only valid once the task is completed.
+     */
+    [[nodiscard]] std::exception_ptr GetException() const { return m_exception; }
+
     /**
      * Returns true if the task has been completed.
      */
     bool IsCompleted() const { return m_is_completed.load(std::memory_order_acquire); }
 
     /**
-     * Blocks the calling thread until the task is completed. Uses OS signaling, not busy-waiting.
+     * Blocks the calling thread until the task is completed. Spins for a short while, since small tasks often finish
+     * within microseconds, then parks the thread until the task signals completion.
+     * @param spin_wait How long to spin before parking.
      */
-    void WaitForCompletion()
+    void WaitForCompletion(const SpinWaitPolicy& spin_wait = {})
     {
-        while (!m_is_completed.load(std::memory_order_acquire))
-        {
-            m_is_completed.wait(false, std::memory_order_acquire);
-        }
+        SpinThenWait(m_is_completed, false, std::memory_order_acquire, spin_wait);
     }
 
 protected:
     std::atomic<bool> m_is_completed = false;
+    std::exception_ptr m_exception;
 };
 
 /**
@@ -72,50 +133,413 @@ protected:
     Function m_function;
 };
 
+namespace Impl
+{
+
+/**
+ * Task that resumes a suspended coroutine on the worker that runs it.
+ */
+struct CoroutineResumeTask final : Task
+{
+    explicit CoroutineResumeTask(std::coroutine_handle<> in_handle) : handle(in_handle) {}
+
+    void Execute(TransmitterType&) override { handle.resume(); }
+
+    std::coroutine_handle<> handle;
+};
+
+}  // namespace Impl
+
+/**
+ * How a ThreadPool hands tasks to its workers.
+ */
+enum class ThreadPoolScheduling : u8
+{
+    /** All tasks go through one FIFO queue that is shared by all workers. */
+    SharedQueue,
+    /**
+     * Every worker has its own Chase-Lev deque. Tasks submitted from a worker are pushed to its deque and popped in LIFO
+     * order, idle workers steal the oldest tasks of random other workers, nearest first when the pool is pinned, see
+     * ThreadPoolPinning. Tasks submitted from other threads go through the shared queues of the priority lanes. Scales
+     * much better for fine-grained recursive work.
+     */
+    WorkStealing
+};
+
+/**
+ * How the workers of a ThreadPool are pinned to the cores reported by GetCpuInfo(). Every policy defines an order of
+ * logical cores, worker i is pinned to the i-th core of that order. When there are more workers than cores in the order,
+ * it starts over from the beginning.
+ */
+enum class ThreadPoolPinning : u8
+{
+    /** Workers are not pinned, the OS moves them around freely. */
+    None,
+    /**
+     * One worker per physical core, pinned to its first logical core. SMT siblings stay free, so every worker gets a
+     * core with its own caches and execution units. Good for compute-bound work.
+     */
+    PhysicalCores,
+    /** One worker per logical core, in logical core order. */
+    LogicalCores,
+    /**
+     * Workers fill all logical cores of a physical core before moving to the next one, and all cores of a package before
+     * moving to the next package. Workers with neighboring indices share caches, which suits work that shares data.
+     */
+    Compact,
+    /**
+     * Workers are spread as far apart as possible: first one per physical core, alternating between packages, then the
+     * SMT siblings. Every worker gets as much cache and memory bandwidth as possible.
+     */
+    Scatter
+};
+
+/**
+ * When a ThreadPool resets the scratch allocator of a worker.
+ */
+enum class ThreadPoolScratchReset : u8
+{
+    /** After every task, so a task always starts with an empty scratch allocator. */
+    AfterEachTask,
+    /**
+     * Never. Scratch allocations live until the task frees them with a ScratchScope, so a task can leave data on the
+     * scratch allocator of its worker for the tasks that follow.
+     */
+    Manual
+};
+
+/**
+ * Configuration of a ThreadPool.
+ */
+struct ThreadPoolDesc
+{
+    /**
+     * Number of worker threads to spawn. Zero spawns one worker per core of the pinning order, that is one per physical
+     * core for ThreadPoolPinning::PhysicalCores and one per logical core otherwise.
+     */
+    size_t thread_count = 0;
+    /** How tasks are distributed across the workers. */
+    ThreadPoolScheduling scheduling = ThreadPoolScheduling::SharedQueue;
+    /** Which cores the workers are pinned to. */
+    ThreadPoolPinning pinning = ThreadPoolPinning::None;
+    /**
+     * Capacity of the queue of every priority lane. Must be a power of two. Submitting blocks while the queue is full.
+     * Worker deques grow as needed.
+     */
+    size_t channel_capacity = 128;
+    /**
+     * Every starvation_limit-th task a worker picks is taken from the lowest priority lane that has work instead of the
+     * highest one, so a steady stream of high priority tasks can delay background tasks but never starve them. Zero
+     * gives strict priority ordering. Otherwise the limit is at least two, so that every other pick still prefers the
+     * highest lane. One is raised to two, since it would take every task from the lowest lane and invert the priorities.
+     */
+    u32 starvation_limit = 16;
+    /**
+     * Memory of the LinearAllocator that every worker pushes as its scratch allocator, so tasks can use
+     * GetScratchAllocator() for temporary allocations without locking. Reserved when the pool is created, committed as
+     * needed.
+     */
+    SystemMemoryAllocatorDesc scratch_allocator_desc = {};
+    /** When the scratch allocator of a worker is reset. */
+    ThreadPoolScratchReset scratch_reset = ThreadPoolScratchReset::AfterEachTask;
+    /**
+     * How long a worker that ran out of tasks spins, looking for new ones, before it goes to sleep. A spinning worker
+     * picks up a new task without the cost of a wake-up, and submitters don't have to wake it.
+     */
+    SpinWaitPolicy idle_spin_wait = {};
+    /** Allocator for internal storage. Must be thread-safe. If null, uses the default allocator. */
+    AllocatorBase* allocator = nullptr;
+};
+
+/**
+ * Compute the logical core every worker of a pool is pinned to.
+ * @param cpu_info Topology, usually from GetCpuInfo().
+ * @param pinning Policy that defines the order of the cores.
+ * @param thread_count Number of workers. Zero picks the number of cores in the order of the policy.
+ * @param allocator Allocator for the result. If null, uses the default allocator.
+ * @return Logical core id per worker. Empty for ThreadPoolPinning::None or when @p cpu_info has no cores.
+ */
+OPAL_EXPORT DynamicArray<u32> GetThreadPoolPlacement(const CpuInfo& cpu_info, ThreadPoolPinning pinning, size_t thread_count,
+                                                     AllocatorBase* allocator = nullptr);
+
 /**
  * Thread pool that distributes tasks across a fixed number of worker threads.
- * Workers block when idle using OS signaling (no busy-waiting). Shutdown is handled
- * by sending sentinel values through the channel to unblock and terminate each worker.
+ * Workers that run out of work spin for a short while, then block on a Signal and are woken when a task is submitted
+ * while some of them sleep. An exception thrown by a task is stored in the task and does not stop the worker. On shutdown the
+ * workers finish all submitted tasks before they exit.
+ *
+ * Tasks are queued in one of three priority lanes. Tasks submitted with a deadline run before the tasks without one in
+ * the same lane, earliest deadline first.
+ *
+ * Every worker owns a LinearAllocator that is its scratch allocator while it runs tasks, see
+ * ThreadPoolDesc::scratch_allocator_desc. Memory from it must not outlive the task unless the pool uses
+ * ThreadPoolScratchReset::Manual.
  */
-class ThreadPool
+class OPAL_EXPORT ThreadPool
 {
 public:
     /**
-     * Creates a thread pool with the given number of worker threads.
-     * @param thread_count Number of worker threads to spawn.
-     * @param channel_capacity Capacity of the internal task channel. Defaults to 128.
-     * @param allocator Allocator for internal storage. If null, uses the default allocator.
+     * Creates a thread pool with the given number of worker threads and a shared task queue.
+     * @param thread_count Number of worker threads to spawn. Zero spawns one worker per logical core, see
+     * ThreadPoolDesc::thread_count.
+     * @param channel_capacity Capacity of the queue of every priority lane. Must be a power of two. Defaults to 128.
+     * @param allocator Allocator for internal storage. Must be thread-safe. If null, uses the default allocator.
      */
     explicit ThreadPool(size_t thread_count, size_t channel_capacity = 128, AllocatorBase* allocator = nullptr);
+
+    /**
+     * Creates a thread pool with the given number of worker threads.
+     * @param thread_count Number of worker threads to spawn. Zero spawns one worker per logical core, see
+     * ThreadPoolDesc::thread_count.
+     * @param scheduling How tasks are distributed across the workers.
+     * @param channel_capacity Capacity of the queue of every priority lane. Must be a power of two.
+     * Submitting blocks while this queue is full. Worker deques grow as needed.
+     * @param allocator Allocator for internal storage. Must be thread-safe. If null, uses the default allocator.
+     */
+    ThreadPool(size_t thread_count, ThreadPoolScheduling scheduling, size_t channel_capacity = 128,
+               AllocatorBase* allocator = nullptr);
+
+    /**
+     * Creates a thread pool from a full configuration.
+     */
+    explicit ThreadPool(const ThreadPoolDesc& desc);
     ~ThreadPool();
 
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
     /**
-     * Submits a callable as a task. Returns a SharedPtr<Task> that can be used to wait for completion.
+     * Submits a callable as a task. Returns an IntrusivePtr<Task> that can be used to wait for completion.
+     * The task is created with a single allocation and handed to the worker without extra reference counting.
      * @param function Callable that accepts a Task::TransmitterType& parameter.
-     * @return SharedPtr<Task> handle to the submitted task.
+     * @param priority Lane to queue the task in.
+     * @return IntrusivePtr<Task> handle to the submitted task.
      */
     template <typename Function>
-    SharedPtr<Task> AddFunctionTask(Function function)
+    IntrusivePtr<Task> AddFunctionTask(Function function, TaskPriority priority = TaskPriority::Normal)
     {
-        SharedPtr<FunctionTask<Function>> task(m_allocator, std::move(function));
-        m_communicator.transmitter.Send(SharedPtr<Task>{task.Clone()});
-        return SharedPtr<Task>{std::move(task)};
+        IntrusivePtr<Task> task = MakeIntrusive<Task, FunctionTask<Function>>(m_allocator, std::move(function));
+        AddTask(task.Clone(), priority);
+        return task;
     }
 
     /**
-     * Shuts down the thread pool. Sends sentinel tasks to unblock all workers and joins all threads.
-     * Safe to call multiple times. Called automatically by the destructor.
+     * Submits a callable as a task that is due at @p deadline. See AddTaskWithDeadline().
+     * @return IntrusivePtr<Task> handle to the submitted task.
+     */
+    template <typename Function>
+    IntrusivePtr<Task> AddFunctionTaskWithDeadline(Function function, f64 deadline, TaskPriority priority = TaskPriority::Normal)
+    {
+        IntrusivePtr<Task> task = MakeIntrusive<Task, FunctionTask<Function>>(m_allocator, std::move(function));
+        AddTaskWithDeadline(task.Clone(), deadline, priority);
+        return task;
+    }
+
+    /**
+     * Submits a task. Thread-safe. When a task with normal priority is submitted from one of the workers of a
+     * work-stealing pool, it is pushed to the deque of that worker. After Close() the task does not run, it completes
+     * right away with a ThreadPoolClosedException. This holds for all the Add functions.
+     * @param task Task to run. Must be valid.
+     * @param priority Lane to queue the task in.
+     */
+    void AddTask(IntrusivePtr<Task> task, TaskPriority priority = TaskPriority::Normal);
+
+    /**
+     * Same as AddTask(), but never blocks. When the lane queue is full, the task waits in an overflow list of the lane
+     * that grows as needed, and workers move it to the queue as slots free up. Meant for code that must not wait for
+     * the workers, like callbacks that resume coroutines or continuations, which can run on a worker of this pool.
+     * @param task Task to run. Must be valid.
+     * @param priority Lane to queue the task in.
+     */
+    void AddTaskNonBlocking(IntrusivePtr<Task> task, TaskPriority priority = TaskPriority::Normal);
+
+    /**
+     * Submits a task that is due at @p deadline. Thread-safe. Within a lane, tasks with a deadline run before tasks
+     * without one, earliest deadline first. Tasks with equal deadlines run in submission order. The deadline only
+     * orders the tasks, a task that is overdue is neither dropped nor moved to a higher lane.
+     * @param task Task to run. Must be valid.
+     * @param deadline Due time in milliseconds on the clock of GetMilliSeconds().
+     * @param priority Lane to queue the task in.
+     */
+    void AddTaskWithDeadline(IntrusivePtr<Task> task, f64 deadline, TaskPriority priority = TaskPriority::Normal);
+
+    /**
+     * Submits a task that runs once @p time has passed. Thread-safe. Due tasks run before the tasks of all lanes. Idle
+     * workers sleep until the earliest due time, so waiting tasks hold no thread. Close() waits for them to run.
+     * @param task Task to run. Must be valid.
+     * @param time Time in milliseconds on the clock of GetMilliSeconds().
+     */
+    void AddTaskAt(IntrusivePtr<Task> task, f64 time);
+
+    /**
+     * Submits a callable that runs once @p time has passed. See AddTaskAt().
+     * @return IntrusivePtr<Task> handle to the submitted task.
+     */
+    template <typename Function>
+    IntrusivePtr<Task> AddFunctionTaskAt(Function function, f64 time)
+    {
+        IntrusivePtr<Task> task = MakeIntrusive<Task, FunctionTask<Function>>(m_allocator, std::move(function));
+        AddTaskAt(task.Clone(), time);
+        return task;
+    }
+
+    /**
+     * Returns an awaitable that moves the awaiting coroutine onto a worker of this pool.
+     * @code
+     * co_await pool.Schedule();
+     * // Runs on a worker now
+     * @endcode
+     * @param priority Lane the coroutine is queued in.
+     */
+    [[nodiscard]] Impl::ThreadPoolScheduleAwaiter Schedule(TaskPriority priority = TaskPriority::Normal);
+
+    /**
+     * Returns an awaitable that resumes the awaiting coroutine on a worker of this pool once @p time has passed. The
+     * coroutine holds no thread while it waits. See AddTaskAt().
+     * @param time Time in milliseconds on the clock of GetMilliSeconds().
+     */
+    [[nodiscard]] Impl::ThreadPoolTimerAwaiter ScheduleAt(f64 time);
+
+    /**
+     * Returns an awaitable that resumes the awaiting coroutine on a worker of this pool after @p milliseconds.
+     */
+    [[nodiscard]] Impl::ThreadPoolTimerAwaiter Delay(f64 milliseconds);
+
+    /**
+     * Shuts down the thread pool. Wakes all workers, lets them finish the submitted tasks and joins all threads.
+     * Safe to call multiple times. Called automatically by the destructor. Tasks that other threads submit while the
+     * workers exit don't run, they complete with a ThreadPoolClosedException like tasks submitted after Close().
      */
     void Close();
 
     [[nodiscard]] size_t GetThreadCount() const { return m_threads.GetSize(); }
     [[nodiscard]] AllocatorBase* GetAllocator() const { return m_allocator; }
+    [[nodiscard]] ThreadPoolScheduling GetScheduling() const { return m_scheduling; }
+    [[nodiscard]] u32 GetStarvationLimit() const { return m_starvation_limit; }
+    [[nodiscard]] ThreadPoolPinning GetPinning() const { return m_pinning; }
+    [[nodiscard]] ThreadPoolScratchReset GetScratchReset() const { return m_scratch_reset; }
+    [[nodiscard]] const SpinWaitPolicy& GetIdleSpinWaitPolicy() const { return m_idle_spin_wait; }
+
+    /**
+     * Returns the logical core the worker with index @p worker_index is pinned to, or k_invalid_core when the pool is
+     * not pinned.
+     */
+    [[nodiscard]] u32 GetWorkerCore(size_t worker_index) const;
+
+    static constexpr u32 k_invalid_core = 0xFFFFFFFF;
 
 private:
+    static constexpr u32 k_lane_count = 3;
+
+    static void RunWorker(Impl::ThreadPoolWorker* worker, Ref<AllocatorBase> default_allocator);
+
+    Task* FindTask(Impl::ThreadPoolWorker& worker);
+    Task* FindTaskHighestFirst(Impl::ThreadPoolWorker& worker);
+    Task* FindTaskLowestFirst(Impl::ThreadPoolWorker& worker);
+    Task* PopLane(TaskPriority priority);
+    void RefillLane(Impl::ThreadPoolLane& lane);
+    Task* PopDueTimer();
+    Task* PopLocal(Impl::ThreadPoolWorker& worker);
+    Task* StealTask(Impl::ThreadPoolWorker& worker);
+    Task* StealFrom(Impl::ThreadPoolWorker& worker, u32 begin, u32 end);
+    void AssignVictims(const CpuInfo& cpu_info);
+    void CancelPendingTasks();
+    [[nodiscard]] bool HasPendingTasks() const;
+    [[nodiscard]] bool SpinForWork() const;
+    [[nodiscard]] bool HasTimers() const;
+    void WakeWorker();
+    void WaitForWork(u32 state);
+
     AllocatorBase* m_allocator = nullptr;
+    ThreadPoolScheduling m_scheduling = ThreadPoolScheduling::SharedQueue;
+    ThreadPoolPinning m_pinning = ThreadPoolPinning::None;
+    ThreadPoolScratchReset m_scratch_reset = ThreadPoolScratchReset::AfterEachTask;
+    u32 m_starvation_limit = 0;
+    SpinWaitPolicy m_idle_spin_wait;
     DynamicArray<ThreadHandle> m_threads;
-    ChannelMPMC<SharedPtr<Task>, true> m_communicator;
-    bool m_is_closed = false;
+    DynamicArray<Impl::ThreadPoolWorker*> m_workers;
+    /**
+     * One lane per TaskPriority. Holds the tasks submitted from outside the pool, and all tasks that don't go to a worker
+     * deque.
+     */
+    DynamicArray<Impl::ThreadPoolLane*> m_lanes;
+    /** Tasks submitted with AddTaskAt() that are not due yet. */
+    Impl::ThreadPoolTimers* m_timers = nullptr;
+    /** Does not spin, workers spin in SpinForWork() before they wait on it. */
+    Signal m_wake_signal;
+    OPAL_START_DISABLE_WARNINGS
+    OPAL_DISABLE_MSVC_WARNING(4324)
+    alignas(OPAL_CACHE_LINE_SIZE) std::atomic<u32> m_sleeping_count = 0;
+    OPAL_END_DISABLE_WARNINGS
+    std::atomic<bool> m_is_stopping = false;
+    /** Set once the workers are joined. From then on submitted tasks are canceled instead of queued. */
+    std::atomic<bool> m_is_closed = false;
+};
+
+namespace Impl
+{
+
+/**
+ * Awaitable returned by ThreadPool::Schedule().
+ */
+class ThreadPoolScheduleAwaiter
+{
+public:
+    ThreadPoolScheduleAwaiter(ThreadPool& pool, TaskPriority priority) : m_pool(&pool), m_priority(priority) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        // The coroutine can resume on a worker and destroy this awaiter before AddTaskNonBlocking returns. A worker that
+        // schedules itself must not wait for a full lane, only other workers could empty it.
+        ThreadPool* pool = m_pool;
+        pool->AddTaskNonBlocking(MakeIntrusive<Task, CoroutineResumeTask>(pool->GetAllocator(), handle), m_priority);
+    }
+    void await_resume() const noexcept {}
+
+private:
+    ThreadPool* m_pool;
+    TaskPriority m_priority;
+};
+
+/**
+ * Awaitable returned by ThreadPool::ScheduleAt() and ThreadPool::Delay().
+ */
+class ThreadPoolTimerAwaiter
+{
+public:
+    ThreadPoolTimerAwaiter(ThreadPool& pool, f64 time) : m_pool(&pool), m_time(time) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        ThreadPool* pool = m_pool;
+        pool->AddTaskAt(MakeIntrusive<Task, CoroutineResumeTask>(pool->GetAllocator(), handle), m_time);
+    }
+    void await_resume() const noexcept {}
+
+private:
+    ThreadPool* m_pool;
+    f64 m_time;
 };
 
+}  // namespace Impl
+
+inline Impl::ThreadPoolScheduleAwaiter ThreadPool::Schedule(TaskPriority priority)
+{
+    return {*this, priority};
+}
+
+inline Impl::ThreadPoolTimerAwaiter ThreadPool::ScheduleAt(f64 time)
+{
+    return {*this, time};
+}
+
+inline void TaskTransmitter::Send(IntrusivePtr<Task> task, TaskPriority priority)
+{
+    m_pool->AddTask(std::move(task), priority);
+}
+
 }  // namespace Opal
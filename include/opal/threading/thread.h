@@ -8,6 +8,7 @@
 #include "opal/allocator.h"
 #include "opal/bit.h"
 #include "opal/container/dynamic-array.h"
+#include "opal/container/dynamic-bit-set.h"
 
 namespace Opal
 {
@@ -110,32 +111,81 @@ void DetachThread(ThreadHandle handle);
  */
 ThreadHandle GetCurrentThreadHandle();
 
+/**
+ * Sets of logical cores in CpuInfo are DynamicBitSets with one bit per logical core id, all of the same size.
+ */
 struct PhysicalCoreInfo
 {
     u32 id = 0;
-    BitMask<u64> logical_cores;
+    /** Socket the core belongs to. Cores with the same package id share the last level cache and the memory controller. */
+    u32 package_id = 0;
+    DynamicBitSet logical_cores;
     bool is_hyperthreaded = false;
 
     [[nodiscard]] bool operator==(const PhysicalCoreInfo& other) const { return id == other.id; }
 };
 
+enum class CacheType : u8
+{
+    Data,
+    Instruction,
+    /** Holds both data and instructions. */
+    Unified
+};
+
+struct CacheInfo
+{
+    /** 1 for L1, 2 for L2 and so on. */
+    u32 level = 0;
+    CacheType type = CacheType::Unified;
+    /** Size in bytes. */
+    u64 size = 0;
+    /** Size of a cache line in bytes. */
+    u32 line_size = 0;
+    /** Number of ways, zero if unknown or fully associative. */
+    u32 associativity = 0;
+    /** Logical cores that share this cache. */
+    DynamicBitSet shared_logical_cores;
+};
+
+struct NumaNodeInfo
+{
+    u32 id = 0;
+    /** Logical cores that are local to the memory of this node. */
+    DynamicBitSet logical_cores;
+};
+
 struct CpuInfo
 {
     u32 logical_cores_count = 0;
     DynamicArray<PhysicalCoreInfo> physical_processors;
+    /** Every cache of the system once, ordered by level. */
+    DynamicArray<CacheInfo> caches;
+    /** Machines without NUMA report a single node with all logical cores. */
+    DynamicArray<NumaNodeInfo> numa_nodes;
+
+    /**
+     * Find the data or unified cache of the given level that serves a logical core.
+     * @param level Cache level, 1 for L1.
+     * @param logical_core_id Logical core id.
+     * @return Cache info, or nullptr if the cache is not known.
+     */
+    [[nodiscard]] const CacheInfo* FindDataCache(u32 level, u32 logical_core_id = 0) const;
 };
 
 /**
- * Get info about the physical and logical cores of the processor. It returns the total number of logical
- * cores in the system, as well as a list of physical cores. Each physical core has a bit mask representing
- * logical cores that belong to it. Logical cores are indexed starting from 0.
+ * Get info about the physical and logical cores of the processor, its caches and NUMA nodes. It returns the total
+ * number of logical cores in the system, a list of physical cores with the logical cores that belong to each of them, a
+ * list of caches with the logical cores that share each of them, and a list of NUMA nodes. Logical cores are indexed
+ * starting from 0. There is no limit on the number of logical cores.
  *
- * On Windows, this uses GetLogicalProcessorInformationEx to enumerate processor cores and their
- * SMT relationships. On Linux, this reads per-CPU topology files from sysfs
- * (/sys/devices/system/cpu/cpuN/topology/) and groups logical CPUs by their (package_id, core_id) pair.
+ * On Windows, this uses GetLogicalProcessorInformationEx to enumerate processor cores, caches and NUMA nodes. Logical
+ * core ids are the processor group times 64 plus the index inside the group. On Linux, this reads per-CPU topology and
+ * cache files from sysfs (/sys/devices/system/cpu/cpuN/topology/ and /sys/devices/system/cpu/cpuN/cache/), groups
+ * logical CPUs by their (package_id, core_id) pair and reads the NUMA nodes from /sys/devices/system/node/.
+ * Physical cores are sorted by package, then by their lowest logical core.
  *
- * @return CpuInfo containing the logical core count and an array of PhysicalCoreInfo entries.
- * @note Limited to 64 logical cores due to BitMask<u64>.
+ * @return CpuInfo with the cores, caches and NUMA nodes of the system.
  */
 CpuInfo GetCpuInfo();
 
@@ -147,8 +197,7 @@ void PrintCpuInfo();
 /**
  * Pin the thread to a specific logical core.
  * @param handle Handle to a thread to pin.
- * @param logical_core_id Logical core id. Values always start from 0 and go to number of logical
- * cores minus one.
+ * @param logical_core_id Logical core id as reported by GetCpuInfo().
  */
 void SetThreadAffinity(ThreadHandle handle, u32 logical_core_id);
 
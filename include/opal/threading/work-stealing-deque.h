@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+
+#include "opal/allocator.h"
+#include "opal/defines.h"
+#include "opal/type-traits.h"
+#include "opal/types.h"
+
+namespace Opal
+{
+
+/**
+ * Chase-Lev work-stealing deque.
+ *
+ * The owner thread pushes and pops at the bottom, so it gets back the item it pushed last. Any other thread can steal
+ * from the top, which hands out the oldest item. Push and Pop do not use atomic read-modify-write operations except when
+ * the owner and a thief race for the last item. The memory orders follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" by Lê, Pop, Cohen and Zappa Nardelli.
+ *
+ * The buffer grows when it is full. Thieves can still be reading from the old buffer, so old buffers are kept until the
+ * deque is destroyed. Since every buffer is twice the size of the previous one, they never take more memory than the
+ * current buffer.
+ *
+ * @tparam T Type of items. Must be trivially copyable, typically a pointer.
+ */
+template <typename T>
+    requires IsTriviallyCopyable<T>
+class WorkStealingDeque
+{
+public:
+    /**
+     * @param capacity Initial capacity. Rounded up to a power of two.
+     * @param allocator Allocator for the buffers. Must be thread-safe. If nullptr, the default allocator is used.
+     */
+    explicit WorkStealingDeque(u64 capacity = 256, AllocatorBase* allocator = nullptr)
+        : m_allocator(allocator != nullptr ? allocator : GetDefaultAllocator())
+    {
+        u64 rounded_capacity = 2;
+        while (rounded_capacity < capacity)
+        {
+            rounded_capacity *= 2;
+        }
+        m_buffer.store(AllocateBuffer(rounded_capacity, nullptr), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingDeque()
+    {
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        while (buffer != nullptr)
+        {
+            Buffer* previous = buffer->previous;
+            m_allocator->Free(buffer);
+            buffer = previous;
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    /**
+     * Add an item at the bottom. Can only be called by the owner thread.
+     */
+    void Push(T item)
+    {
+        const i64 bottom = m_bottom.load(std::memory_order_relaxed);
+        const i64 top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<i64>(buffer->mask))
+        {
+            buffer = Grow(buffer, top, bottom);
+        }
+        buffer->Store(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Remove the item that was pushed last. Can only be called by the owner thread.
+     * @param out_item Receives the item. Left untouched when the deque is empty.
+     * @return True if an item was removed.
+     */
+    bool Pop(T& out_item)
+    {
+        const i64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 top = m_top.load(std::memory_order_relaxed);
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        const T item = buffer->Load(bottom);
+        if (top == bottom)
+        {
+            // Last item, race against thieves for it
+            const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won)
+            {
+                return false;
+            }
+        }
+        out_item = item;
+        return true;
+    }
+
+    /**
+     * Remove the oldest item. Can be called by any thread.
+     * @param out_item Receives the item. Left untouched when nothing was stolen.
+     * @return True if an item was removed. False when the deque is empty or another thread took the item first.
+     */
+    bool Steal(T& out_item)
+    {
+        i64 top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const i64 bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+        {
+            return false;
+        }
+        Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+        const T item = buffer->Load(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        out_item = item;
+        return true;
+    }
+
+    /**
+     * Returns the number of items. Only exact when no other thread uses the deque at the same time.
+     */
+    [[nodiscard]] u64 GetSize() const
+    {
+        const i64 bottom = m_bottom.load(std::memory_order_seq_cst);
+        const i64 top = m_top.load(std::memory_order_seq_cst);
+        return bottom > top ? static_cast<u64>(bottom - top) : 0;
+    }
+
+    [[nodiscard]] bool IsEmpty() const { return GetSize() == 0; }
+
+    /** Returns the capacity of the current buffer. */
+    [[nodiscard]] u64 GetCapacity() const { return m_buffer.load(std::memory_order_relaxed)->mask + 1; }
+
+private:
+    struct Buffer
+    {
+        u64 mask;
+        Buffer* previous;
+
+        std::atomic<T>* GetItems() { return reinterpret_cast<std::atomic<T>*>(this + 1); }
+
+        T Load(i64 index) { return GetItems()[static_cast<u64>(index) & mask].load(std::memory_order_relaxed); }
+        void Store(i64 index, T item) { GetItems()[static_cast<u64>(index) & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    Buffer* AllocateBuffer(u64 capacity, Buffer* previous)
+    {
+        static_assert(alignof(std::atomic<T>) <= alignof(Buffer), "Items would be misaligned");
+        void* memory = m_allocator->Alloc(sizeof(Buffer) + capacity * sizeof(std::atomic<T>), alignof(Buffer));
+        Buffer* buffer = new (memory) Buffer{capacity - 1, previous};
+        std::atomic<T>* items = buffer->GetItems();
+        for (u64 i = 0; i < capacity; ++i)
+        {
+            new (items + i) std::atomic<T>();
+        }
+        return buffer;
+    }
+
+    Buffer* Grow(Buffer* buffer, i64 top, i64 bottom)
+    {
+        Buffer* new_buffer = AllocateBuffer((buffer->mask + 1) * 2, buffer);
+        for (i64 i = top; i < bottom; ++i)
+        {
+            new_buffer->Store(i, buffer->Load(i));
+        }
+        m_buffer.store(new_buffer, std::memory_order_release);
+        return new_buffer;
+    }
+
+    OPAL_START_DISABLE_WARNINGS
+    OPAL_DISABLE_MSVC_WARNING(4324)
+    alignas(OPAL_CACHE_LINE_SIZE) std::atomic<i64> m_top = 0;
+    alignas(OPAL_CACHE_LINE_SIZE) std::atomic<i64> m_bottom = 0;
+    alignas(OPAL_CACHE_LINE_SIZE) std::atomic<Buffer*> m_buffer = nullptr;
+    OPAL_END_DISABLE_WARNINGS
+    AllocatorBase* m_allocator = nullptr;
+};
+
+}  // namespace Opal
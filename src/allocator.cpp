@@ -312,3 +312,10 @@ Opal::PushScratch::~PushScratch()
 {
     PopScratchAllocator();
 }
+
+Opal::ScratchScope::ScratchScope() : m_allocator(GetScratchAllocator()), m_mark(m_allocator->Mark()) {}
+
+Opal::ScratchScope::~ScratchScope()
+{
+    m_allocator->Reset(m_mark);
+}
@@ -0,0 +1,457 @@
+#include "opal/container/dynamic-bit-set.h"
+
+#include <cstring>
+
+#include "opal/defines.h"
+
+#if defined(OPAL_SIMD_AVX2) || defined(OPAL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+#include "opal/exceptions.h"
+
+namespace Opal
+{
+
+// ------------------------------------------------------------------------------------------------
+// Word kernels.
+// ------------------------------------------------------------------------------------------------
+
+namespace
+{
+
+// Word capacity is kept at a multiple of a cache line, which is also a multiple of every SIMD width used below.
+constexpr u64 k_words_per_cache_line = OPAL_CACHE_LINE_SIZE / sizeof(u64);
+
+enum class BitOperation
+{
+    And,
+    Or,
+    Xor,
+    AndNot
+};
+
+template <BitOperation Operation>
+u64 ApplyToWord(u64 a, u64 b)
+{
+    if constexpr (Operation == BitOperation::And)
+    {
+        return a & b;
+    }
+    else if constexpr (Operation == BitOperation::Or)
+    {
+        return a | b;
+    }
+    else if constexpr (Operation == BitOperation::Xor)
+    {
+        return a ^ b;
+    }
+    else
+    {
+        return a & ~b;
+    }
+}
+
+#if defined(OPAL_SIMD_AVX2)
+template <BitOperation Operation>
+__m256i ApplyToVector(__m256i a, __m256i b)
+{
+    if constexpr (Operation == BitOperation::And)
+    {
+        return _mm256_and_si256(a, b);
+    }
+    else if constexpr (Operation == BitOperation::Or)
+    {
+        return _mm256_or_si256(a, b);
+    }
+    else if constexpr (Operation == BitOperation::Xor)
+    {
+        return _mm256_xor_si256(a, b);
+    }
+    else
+    {
+        // andnot computes ~first & second
+        return _mm256_andnot_si256(b, a);
+    }
+}
+#elif defined(OPAL_SIMD_SSE2)
+template <BitOperation Operation>
+__m128i ApplyToVector(__m128i a, __m128i b)
+{
+    if constexpr (Operation == BitOperation::And)
+    {
+        return _mm_and_si128(a, b);
+    }
+    else if constexpr (Operation == BitOperation::Or)
+    {
+        return _mm_or_si128(a, b);
+    }
+    else if constexpr (Operation == BitOperation::Xor)
+    {
+        return _mm_xor_si128(a, b);
+    }
+    else
+    {
+        // andnot computes ~first & second
+        return _mm_andnot_si128(b, a);
+    }
+}
+#endif
+
+template <BitOperation Operation>
+void ApplyToWords(u64* dst, const u64* src, u64 count)
+{
+    u64 index = 0;
+#if defined(OPAL_SIMD_AVX2)
+    for (; index + 4 <= count; index += 4)
+    {
+        __m256i* dst_vector = reinterpret_cast<__m256i*>(dst + index);
+        const __m256i* src_vector = reinterpret_cast<const __m256i*>(src + index);
+        _mm256_storeu_si256(dst_vector, ApplyToVector<Operation>(_mm256_loadu_si256(dst_vector), _mm256_loadu_si256(src_vector)));
+    }
+#elif defined(OPAL_SIMD_SSE2)
+    for (; index + 2 <= count; index += 2)
+    {
+        __m128i* dst_vector = reinterpret_cast<__m128i*>(dst + index);
+        const __m128i* src_vector = reinterpret_cast<const __m128i*>(src + index);
+        _mm_storeu_si128(dst_vector, ApplyToVector<Operation>(_mm_loadu_si128(dst_vector), _mm_loadu_si128(src_vector)));
+    }
+#endif
+    for (; index < count; ++index)
+    {
+        dst[index] = ApplyToWord<Operation>(dst[index], src[index]);
+    }
+}
+
+u64 CountSetBitsInWords(const u64* words, u64 count)
+{
+    u64 result = 0;
+    u64 index = 0;
+#if defined(OPAL_SIMD_AVX2)
+    // Nibble lookup popcount (Mula et al.). Per byte counts are summed into 64-bit lanes with sad_epu8.
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i accumulator = _mm256_setzero_si256();
+    for (; index + 4 <= count; index += 4)
+    {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index));
+        const __m256i low = _mm256_and_si256(value, low_mask);
+        const __m256i high = _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask);
+        const __m256i byte_counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        accumulator = _mm256_add_epi64(accumulator, _mm256_sad_epu8(byte_counts, _mm256_setzero_si256()));
+    }
+    result += static_cast<u64>(_mm256_extract_epi64(accumulator, 0)) + static_cast<u64>(_mm256_extract_epi64(accumulator, 1)) +
+              static_cast<u64>(_mm256_extract_epi64(accumulator, 2)) + static_cast<u64>(_mm256_extract_epi64(accumulator, 3));
+#endif
+    for (; index < count; ++index)
+    {
+        result += CountSetBits(words[index]);
+    }
+    return result;
+}
+
+/**
+ * @return Index of the first non-zero word in [begin, count) or count if all of them are zero.
+ */
+u64 FindNonZeroWord(const u64* words, u64 begin, u64 count)
+{
+    u64 index = begin;
+#if defined(OPAL_SIMD_AVX2)
+    for (; index + 4 <= count; index += 4)
+    {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index));
+        if (!_mm256_testz_si256(value, value))
+        {
+            break;
+        }
+    }
+#elif defined(OPAL_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; index + 2 <= count; index += 2)
+    {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + index));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(value, zero)) != 0xFFFF)
+        {
+            break;
+        }
+    }
+#endif
+    for (; index < count; ++index)
+    {
+        if (words[index] != 0)
+        {
+            return index;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------------------------------
+// SetBitIterator.
+// ------------------------------------------------------------------------------------------------
+
+DynamicBitSet::SetBitIterator::SetBitIterator(const word_type* words, size_type word_index, size_type word_count)
+    : m_words(words), m_word_index(word_index), m_word_count(word_count)
+{
+    if (m_word_index < m_word_count)
+    {
+        m_current_word = m_words[m_word_index];
+        SkipEmptyWords();
+    }
+}
+
+DynamicBitSet::SetBitIterator& DynamicBitSet::SetBitIterator::operator++()
+{
+    // Clear the lowest set bit
+    m_current_word &= m_current_word - 1;
+    SkipEmptyWords();
+    return *this;
+}
+
+void DynamicBitSet::SetBitIterator::SkipEmptyWords()
+{
+    if (m_current_word != 0)
+    {
+        return;
+    }
+    m_word_index = FindNonZeroWord(m_words, m_word_index + 1, m_word_count);
+    m_current_word = m_word_index < m_word_count ? m_words[m_word_index] : 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+// DynamicBitSet.
+// ------------------------------------------------------------------------------------------------
+
+DynamicBitSet::DynamicBitSet(allocator_type* allocator) : m_allocator(allocator == nullptr ? GetDefaultAllocator() : allocator) {}
+
+DynamicBitSet::DynamicBitSet(size_type size, bool value, allocator_type* allocator)
+    : m_allocator(allocator == nullptr ? GetDefaultAllocator() : allocator)
+{
+    Resize(size, value);
+}
+
+DynamicBitSet::DynamicBitSet(DynamicBitSet&& other) noexcept
+    : m_allocator(other.m_allocator), m_words(other.m_words), m_size(other.m_size), m_word_capacity(other.m_word_capacity)
+{
+    other.m_words = nullptr;
+    other.m_size = 0;
+    other.m_word_capacity = 0;
+}
+
+DynamicBitSet::~DynamicBitSet()
+{
+    if (m_words != nullptr)
+    {
+        m_allocator->Free(m_words);
+        m_words = nullptr;
+    }
+}
+
+DynamicBitSet& DynamicBitSet::operator=(DynamicBitSet&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    if (m_words != nullptr)
+    {
+        m_allocator->Free(m_words);
+    }
+    m_allocator = other.m_allocator;
+    m_words = other.m_words;
+    m_size = other.m_size;
+    m_word_capacity = other.m_word_capacity;
+    other.m_words = nullptr;
+    other.m_size = 0;
+    other.m_word_capacity = 0;
+    return *this;
+}
+
+DynamicBitSet DynamicBitSet::Clone(allocator_type* allocator) const
+{
+    DynamicBitSet clone(allocator == nullptr ? m_allocator : allocator);
+    clone.Reserve(m_size);
+    if (m_size > 0)
+    {
+        std::memcpy(clone.m_words, m_words, GetWordCount() * sizeof(word_type));
+    }
+    clone.m_size = m_size;
+    return clone;
+}
+
+bool DynamicBitSet::operator==(const DynamicBitSet& other) const
+{
+    if (m_size != other.m_size)
+    {
+        return false;
+    }
+    return m_size == 0 || std::memcmp(m_words, other.m_words, GetWordCount() * sizeof(word_type)) == 0;
+}
+
+void DynamicBitSet::Reserve(size_type capacity)
+{
+    size_type word_capacity = GetWordCount(capacity);
+    if (word_capacity <= m_word_capacity)
+    {
+        return;
+    }
+    word_capacity = (word_capacity + k_words_per_cache_line - 1) / k_words_per_cache_line * k_words_per_cache_line;
+    word_type* new_words = static_cast<word_type*>(m_allocator->Alloc(word_capacity * sizeof(word_type), OPAL_CACHE_LINE_SIZE));
+    if (m_words != nullptr)
+    {
+        std::memcpy(new_words, m_words, GetWordCount() * sizeof(word_type));
+        m_allocator->Free(m_words);
+    }
+    m_words = new_words;
+    m_word_capacity = word_capacity;
+}
+
+void DynamicBitSet::Resize(size_type size, bool value)
+{
+    if (size <= m_size)
+    {
+        m_size = size;
+        ClearUnusedBits();
+        return;
+    }
+    Reserve(size);
+    const size_type old_word_count = GetWordCount();
+    const size_type new_word_count = GetWordCount(size);
+    if (value && m_size % k_bits_per_word != 0)
+    {
+        m_words[old_word_count - 1] |= ~0ull << (m_size % k_bits_per_word);
+    }
+    std::memset(m_words + old_word_count, value ? 0xFF : 0, (new_word_count - old_word_count) * sizeof(word_type));
+    m_size = size;
+    ClearUnusedBits();
+}
+
+void DynamicBitSet::SetAll()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    std::memset(m_words, 0xFF, GetWordCount() * sizeof(word_type));
+    ClearUnusedBits();
+}
+
+void DynamicBitSet::ResetAll()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    std::memset(m_words, 0, GetWordCount() * sizeof(word_type));
+}
+
+void DynamicBitSet::FlipAll()
+{
+    const size_type word_count = GetWordCount();
+    for (size_type i = 0; i < word_count; ++i)
+    {
+        m_words[i] = ~m_words[i];
+    }
+    ClearUnusedBits();
+}
+
+DynamicBitSet& DynamicBitSet::And(const DynamicBitSet& other)
+{
+    ThrowIfSizeMismatch(other, __FUNCTION__);
+    ApplyToWords<BitOperation::And>(m_words, other.m_words, GetWordCount());
+    return *this;
+}
+
+DynamicBitSet& DynamicBitSet::Or(const DynamicBitSet& other)
+{
+    ThrowIfSizeMismatch(other, __FUNCTION__);
+    ApplyToWords<BitOperation::Or>(m_words, other.m_words, GetWordCount());
+    return *this;
+}
+
+DynamicBitSet& DynamicBitSet::Xor(const DynamicBitSet& other)
+{
+    ThrowIfSizeMismatch(other, __FUNCTION__);
+    ApplyToWords<BitOperation::Xor>(m_words, other.m_words, GetWordCount());
+    return *this;
+}
+
+DynamicBitSet& DynamicBitSet::AndNot(const DynamicBitSet& other)
+{
+    ThrowIfSizeMismatch(other, __FUNCTION__);
+    ApplyToWords<BitOperation::AndNot>(m_words, other.m_words, GetWordCount());
+    return *this;
+}
+
+DynamicBitSet::size_type DynamicBitSet::PopCount() const
+{
+    return CountSetBitsInWords(m_words, GetWordCount());
+}
+
+DynamicBitSet::size_type DynamicBitSet::PopCount(size_type begin, size_type end) const
+{
+    if (end > m_size)
+    {
+        throw OutOfBoundsException(end, 0, m_size);
+    }
+    if (begin > end)
+    {
+        throw OutOfBoundsException(begin, 0, end);
+    }
+    if (begin == end)
+    {
+        return 0;
+    }
+    const size_type first_word = begin / k_bits_per_word;
+    const size_type last_word = (end - 1) / k_bits_per_word;
+    const word_type first_mask = ~0ull << (begin % k_bits_per_word);
+    const word_type last_mask = ~0ull >> (k_bits_per_word - 1 - (end - 1) % k_bits_per_word);
+    if (first_word == last_word)
+    {
+        return CountSetBits(m_words[first_word] & first_mask & last_mask);
+    }
+    return CountSetBits(m_words[first_word] & first_mask) + CountSetBitsInWords(m_words + first_word + 1, last_word - first_word - 1) +
+           CountSetBits(m_words[last_word] & last_mask);
+}
+
+DynamicBitSet::size_type DynamicBitSet::FindNextSet(size_type index) const
+{
+    if (index >= m_size)
+    {
+        return k_npos;
+    }
+    const size_type word_count = GetWordCount();
+    size_type word_index = index / k_bits_per_word;
+    word_type word = m_words[word_index] & (~0ull << (index % k_bits_per_word));
+    if (word == 0)
+    {
+        word_index = FindNonZeroWord(m_words, word_index + 1, word_count);
+        if (word_index == word_count)
+        {
+            return k_npos;
+        }
+        word = m_words[word_index];
+    }
+    return word_index * k_bits_per_word + CountTrailingZeros(word);
+}
+
+void DynamicBitSet::ClearUnusedBits()
+{
+    const size_type used_bits = m_size % k_bits_per_word;
+    if (used_bits != 0)
+    {
+        m_words[m_size / k_bits_per_word] &= ~(~0ull << used_bits);
+    }
+}
+
+void DynamicBitSet::ThrowIfSizeMismatch(const DynamicBitSet& other, const char* function) const
+{
+    if (other.m_size != m_size)
+    {
+        throw InvalidArgumentException(function, "other", other.m_size);
+    }
+}
+
+}  // namespace Opal
@@ -592,7 +592,8 @@ namespace
 {
 
 #if defined(OPAL_PLATFORM_WINDOWS)
-void WriteToFileWin32(const Opal::StringUtf8& path, const void* data, Opal::u64 size, DWORD creation_disposition)
+void WriteToFileWin32(const Opal::StringUtf8& path, Opal::ArrayView<const Opal::ArrayView<const Opal::u8>> chunks,
+                      DWORD creation_disposition)
 {
     using namespace Opal;
 
@@ -624,10 +625,14 @@ void WriteToFileWin32(const Opal::StringUtf8& path, const void* data, Opal::u64
         }
     }
 
-    if (size > 0)
+    for (const ArrayView<const u8>& chunk : chunks)
     {
+        if (chunk.IsEmpty())
+        {
+            continue;
+        }
         DWORD bytes_written = 0;
-        if (WriteFile(file_handle, data, static_cast<DWORD>(size), &bytes_written, nullptr) == 0)
+        if (WriteFile(file_handle, chunk.GetData(), static_cast<DWORD>(chunk.GetSize()), &bytes_written, nullptr) == 0)
         {
             CloseHandle(file_handle);
             throw Exception("Failed to write to file!");
@@ -637,7 +642,7 @@ void WriteToFileWin32(const Opal::StringUtf8& path, const void* data, Opal::u64
     CloseHandle(file_handle);
 }
 #elif defined(OPAL_PLATFORM_LINUX)
-void WriteToFileLinux(const Opal::StringUtf8& path, const void* data, Opal::u64 size, const char* mode)
+void WriteToFileLinux(const Opal::StringUtf8& path, Opal::ArrayView<const Opal::ArrayView<const Opal::u8>> chunks, const char* mode)
 {
     using namespace Opal;
 
@@ -651,10 +656,14 @@ void WriteToFileLinux(const Opal::StringUtf8& path, const void* data, Opal::u64
         throw Exception("Failed to open file for writing!");
     }
 
-    if (size > 0)
+    for (const ArrayView<const u8>& chunk : chunks)
     {
-        const u64 write_count = fwrite(data, 1, size, file);
-        if (write_count != size)
+        if (chunk.IsEmpty())
+        {
+            continue;
+        }
+        const u64 write_count = fwrite(chunk.GetData(), 1, chunk.GetSize(), file);
+        if (write_count != chunk.GetSize())
         {
             fclose(file);
             throw Exception("Failed to write to file!");
@@ -669,10 +678,11 @@ void WriteToFileLinux(const Opal::StringUtf8& path, const void* data, Opal::u64
 
 void Opal::WriteStringToFile(const StringUtf8& path, const StringUtf8& content)
 {
+    const ArrayView<const u8> bytes(reinterpret_cast<const u8*>(content.GetData()), content.GetSize());
 #if defined(OPAL_PLATFORM_WINDOWS)
-    WriteToFileWin32(path, content.GetData(), content.GetSize(), CREATE_ALWAYS);
+    WriteToFileWin32(path, ArrayView<const ArrayView<const u8>>(&bytes, 1), CREATE_ALWAYS);
 #elif defined(OPAL_PLATFORM_LINUX)
-    WriteToFileLinux(path, content.GetData(), content.GetSize(), "wb");
+    WriteToFileLinux(path, ArrayView<const ArrayView<const u8>>(&bytes, 1), "wb");
 #else
     throw NotImplementedException(__FUNCTION__);
 #endif
@@ -681,9 +691,20 @@ void Opal::WriteStringToFile(const StringUtf8& path, const StringUtf8& content)
 void Opal::WriteBytesToFile(const StringUtf8& path, ArrayView<const u8> content)
 {
 #if defined(OPAL_PLATFORM_WINDOWS)
-    WriteToFileWin32(path, content.GetData(), content.GetSize(), CREATE_ALWAYS);
+    WriteToFileWin32(path, ArrayView<const ArrayView<const u8>>(&content, 1), CREATE_ALWAYS);
+#elif defined(OPAL_PLATFORM_LINUX)
+    WriteToFileLinux(path, ArrayView<const ArrayView<const u8>>(&content, 1), "wb");
+#else
+    throw NotImplementedException(__FUNCTION__);
+#endif
+}
+
+void Opal::WriteChunksToFile(const StringUtf8& path, ArrayView<const ArrayView<const u8>> chunks)
+{
+#if defined(OPAL_PLATFORM_WINDOWS)
+    WriteToFileWin32(path, chunks, CREATE_ALWAYS);
 #elif defined(OPAL_PLATFORM_LINUX)
-    WriteToFileLinux(path, content.GetData(), content.GetSize(), "wb");
+    WriteToFileLinux(path, chunks, "wb");
 #else
     throw NotImplementedException(__FUNCTION__);
 #endif
@@ -691,10 +712,11 @@ void Opal::WriteBytesToFile(const StringUtf8& path, ArrayView<const u8> content)
 
 void Opal::AppendStringToFile(const StringUtf8& path, const StringUtf8& content)
 {
+    const ArrayView<const u8> bytes(reinterpret_cast<const u8*>(content.GetData()), content.GetSize());
 #if defined(OPAL_PLATFORM_WINDOWS)
-    WriteToFileWin32(path, content.GetData(), content.GetSize(), OPEN_ALWAYS);
+    WriteToFileWin32(path, ArrayView<const ArrayView<const u8>>(&bytes, 1), OPEN_ALWAYS);
 #elif defined(OPAL_PLATFORM_LINUX)
-    WriteToFileLinux(path, content.GetData(), content.GetSize(), "ab");
+    WriteToFileLinux(path, ArrayView<const ArrayView<const u8>>(&bytes, 1), "ab");
 #else
     throw NotImplementedException(__FUNCTION__);
 #endif
@@ -703,9 +725,9 @@ void Opal::AppendStringToFile(const StringUtf8& path, const StringUtf8& content)
 void Opal::AppendBytesToFile(const StringUtf8& path, ArrayView<const u8> content)
 {
 #if defined(OPAL_PLATFORM_WINDOWS)
-    WriteToFileWin32(path, content.GetData(), content.GetSize(), OPEN_ALWAYS);
+    WriteToFileWin32(path, ArrayView<const ArrayView<const u8>>(&content, 1), OPEN_ALWAYS);
 #elif defined(OPAL_PLATFORM_LINUX)
-    WriteToFileLinux(path, content.GetData(), content.GetSize(), "ab");
+    WriteToFileLinux(path, ArrayView<const ArrayView<const u8>>(&content, 1), "ab");
 #else
     throw NotImplementedException(__FUNCTION__);
 #endif
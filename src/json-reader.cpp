@@ -1,8 +1,8 @@
 #include "opal/container/json-reader.h"
 
-#include <cerrno>
 #include <cstdlib>
 
+#include "opal/char-conv.h"
 #include "opal/container/dynamic-array.h"
 #include "opal/container/in-place-array.h"
 
@@ -688,39 +688,26 @@ private:
             }
         }
 
-        // Copy number substring into a null-terminated buffer.
-        constexpr u64 k_buf_size = 64;
-        InPlaceArray<char, k_buf_size> buf;
-        const u64 len = m_pos - start;
-        if (len >= k_buf_size)
-        {
-            ThrowError("Number literal too long");
-        }
-        for (u64 i = 0; i < len; ++i)
-        {
-            buf[i] = static_cast<char>(m_input[start + i]);
-        }
-        buf[len] = '\0';
+        const char8* first = m_input + start;
+        const char8* last = m_input + m_pos;
 
         // Integer literals (no '.' or 'e'/'E') are stored as i64 when they fit.
         if (!is_float)
         {
-            char* end_ptr = nullptr;
-            errno = 0;
-            const i64 result = strtoll(buf.GetData(), &end_ptr, 10);
-            if (end_ptr == buf.GetData() + len && errno != ERANGE)
+            i64 integer = 0;
+            if (FromChars(first, last, integer).HasValue())
             {
-                return JsonValue(result);
+                return JsonValue(integer);
             }
         }
 
-        char* end_ptr = nullptr;
-        const f64 result = strtod(buf.GetData(), &end_ptr);
-        if (end_ptr != buf.GetData() + len)
+        f64 number = 0;
+        Expected<const char8*, ErrorCode> result = FromChars(first, last, number);
+        if (!result.HasValue())
         {
-            ThrowError("Invalid number");
+            ThrowError(result.GetError() == ErrorCode::OutOfBounds ? "Number out of range" : "Invalid number");
         }
-        return JsonValue(result);
+        return JsonValue(number);
     }
 
     // -- String --
@@ -2,6 +2,7 @@
 
 #include <cmath>
 
+#include "opal/char-conv.h"
 #include "opal/container/dynamic-array.h"
 #include "opal/container/string-format.h"
 
@@ -25,10 +26,14 @@ struct Frame
     bool is_object;
 };
 
+/**
+ * @tparam OutputType StringUtf8 or StringBuilder.
+ */
+template <typename OutputType>
 class JsonSerializer
 {
 public:
-    JsonSerializer(StringUtf8& output, const JsonWriteOptions& options) : m_output(output), m_options(options) {}
+    JsonSerializer(OutputType& output, const JsonWriteOptions& options) : m_output(output), m_options(options) {}
 
     void Serialize(const JsonValue& root)
     {
@@ -129,10 +134,18 @@ private:
         {
             throw JsonSerializeException("Infinity is not a valid JSON number");
         }
-        AppendFormat(m_output, "{:.17g}", value);
+        // Shortest representation that parses back to the same value.
+        char8 buffer[k_max_to_chars_size];
+        const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, value).GetValue();
+        m_output->Append(buffer, static_cast<u64>(end - buffer));
     }
 
-    void WriteInteger(i64 value) const { AppendFormat(m_output, "{}", value); }
+    void WriteInteger(i64 value) const
+    {
+        char8 buffer[k_max_to_chars_size];
+        const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, value).GetValue();
+        m_output->Append(buffer, static_cast<u64>(end - buffer));
+    }
 
     void WriteString(StringViewUtf8 value) const
     {
@@ -191,7 +204,7 @@ private:
                         {
                             m_output->Append(data + flush_start, i - flush_start);
                         }
-                        AppendFormat(m_output, "\\u{:04x}", c);
+                        AppendFormat<"\\u{:04x}">(m_output.Get(), c);
                         flush_start = i + 1;
                     }
                     continue;
@@ -298,7 +311,7 @@ private:
         }
     }
 
-    Ref<StringUtf8> m_output;
+    Ref<OutputType> m_output;
     Ref<const JsonWriteOptions> m_options;
     DynamicArray<Frame> m_stack;
     u32 m_depth = 0;
@@ -318,9 +331,15 @@ StringUtf8 JsonWriter::Serialize(const JsonValue& value, AllocatorBase* allocato
 StringUtf8 JsonWriter::Serialize(const JsonValue& value, const JsonWriteOptions& options, AllocatorBase* allocator)
 {
     StringUtf8 output(allocator);
-    JsonSerializer serializer(output, options);
+    JsonSerializer<StringUtf8> serializer(output, options);
     serializer.Serialize(value);
     return output;
 }
 
+void JsonWriter::Serialize(const JsonValue& value, StringBuilder& output, const JsonWriteOptions& options)
+{
+    JsonSerializer<StringBuilder> serializer(output, options);
+    serializer.Serialize(value);
+}
+
 }  // namespace Opal
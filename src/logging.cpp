@@ -131,6 +131,19 @@ Opal::LogLevel Opal::Logger::GetCategoryLevel(StringViewUtf8 category) const
     return m_categories.GetValue(key);
 }
 
+bool Opal::Logger::IsEnabled(LogLevel level, StringViewUtf8 category) const
+{
+    if (level > m_log_level)
+    {
+        return false;
+    }
+    if (!IsCategoryRegistered(category))
+    {
+        throw UnregisteredCategoryException(category.GetData());
+    }
+    return level <= GetCategoryLevel(category);
+}
+
 void Opal::Logger::AddSink(const SharedPtr<LogSink>& sink)
 {
     m_sinks.PushBack(sink.Clone());
@@ -0,0 +1,450 @@
+#include "opal/container/rope.h"
+
+#include <cstring>
+
+#include "opal/exceptions.h"
+#include "opal/math-base.h"
+
+// ------------------------------------------------------------------------------------------------
+// Tree operations.
+// ------------------------------------------------------------------------------------------------
+
+namespace
+{
+
+using Opal::AllocatorBase;
+using Opal::char8;
+using Opal::IntrusivePtr;
+using Opal::Rope;
+using Opal::StringUtf8;
+using Opal::StringViewUtf8;
+using Opal::u32;
+using Opal::u64;
+using Opal::Impl::RopeBuffer;
+using Opal::Impl::RopeNode;
+using NodePtr = IntrusivePtr<RopeNode>;
+
+u32 GetHeight(const NodePtr& node)
+{
+    return node.IsValid() ? node->height : 0;
+}
+
+NodePtr MakeLeaf(AllocatorBase* allocator, IntrusivePtr<RopeBuffer> buffer, const char8* data, u64 size)
+{
+    return NodePtr(allocator, std::move(buffer), data, size);
+}
+
+NodePtr MakeInner(AllocatorBase* allocator, NodePtr left, NodePtr right)
+{
+    return NodePtr(allocator, std::move(left), std::move(right));
+}
+
+/**
+ * Create a node from two subtrees whose heights differ by at most two, rotating once or twice when they differ by two.
+ */
+NodePtr Balance(AllocatorBase* allocator, NodePtr left, NodePtr right)
+{
+    const u32 left_height = GetHeight(left);
+    const u32 right_height = GetHeight(right);
+    if (left_height > right_height + 1)
+    {
+        const RopeNode* node = left.Get();
+        if (GetHeight(node->left) >= GetHeight(node->right))
+        {
+            return MakeInner(allocator, node->left.Clone(), MakeInner(allocator, node->right.Clone(), std::move(right)));
+        }
+        const RopeNode* inner = node->right.Get();
+        return MakeInner(allocator, MakeInner(allocator, node->left.Clone(), inner->left.Clone()),
+                         MakeInner(allocator, inner->right.Clone(), std::move(right)));
+    }
+    if (right_height > left_height + 1)
+    {
+        const RopeNode* node = right.Get();
+        if (GetHeight(node->right) >= GetHeight(node->left))
+        {
+            return MakeInner(allocator, MakeInner(allocator, std::move(left), node->left.Clone()), node->right.Clone());
+        }
+        const RopeNode* inner = node->left.Get();
+        return MakeInner(allocator, MakeInner(allocator, std::move(left), inner->left.Clone()),
+                         MakeInner(allocator, inner->right.Clone(), node->right.Clone()));
+    }
+    return MakeInner(allocator, std::move(left), std::move(right));
+}
+
+/**
+ * Small neighbouring leaves are merged so that single character edits do not fill the tree with tiny leaves. Leaves
+ * that are adjacent in the same buffer are merged without copying.
+ */
+NodePtr MergeLeaves(AllocatorBase* allocator, const RopeNode* left, const RopeNode* right)
+{
+    const u64 size = left->size + right->size;
+    if (left->buffer == right->buffer && left->data + left->size == right->data && size <= Rope::k_max_leaf_size)
+    {
+        return MakeLeaf(allocator, left->buffer.Clone(), left->data, size);
+    }
+    if (size > Rope::k_merge_leaf_size)
+    {
+        return {};
+    }
+    StringUtf8 text(allocator);
+    text.Reserve(size);
+    text.Append(left->data, left->size);
+    text.Append(right->data, right->size);
+    IntrusivePtr<RopeBuffer> buffer(allocator, std::move(text));
+    const char8* data = buffer->text.GetData();
+    return MakeLeaf(allocator, std::move(buffer), data, size);
+}
+
+/**
+ * Concatenate two balanced trees. The shorter tree is attached to the spine of the taller one at the level of its own
+ * height, and the nodes on the way back up are rebalanced, so the cost is proportional to the difference in height.
+ */
+NodePtr JoinTrees(AllocatorBase* allocator, NodePtr left, NodePtr right)
+{
+    if (!left.IsValid())
+    {
+        return right;
+    }
+    if (!right.IsValid())
+    {
+        return left;
+    }
+    const u32 left_height = GetHeight(left);
+    const u32 right_height = GetHeight(right);
+    if (left_height > right_height + 1)
+    {
+        const RopeNode* node = left.Get();
+        return Balance(allocator, node->left.Clone(), JoinTrees(allocator, node->right.Clone(), std::move(right)));
+    }
+    if (right_height > left_height + 1)
+    {
+        const RopeNode* node = right.Get();
+        return Balance(allocator, JoinTrees(allocator, std::move(left), node->left.Clone()), node->right.Clone());
+    }
+    if (left->IsLeaf() && right->IsLeaf())
+    {
+        NodePtr merged = MergeLeaves(allocator, left.Get(), right.Get());
+        if (merged.IsValid())
+        {
+            return merged;
+        }
+    }
+    return MakeInner(allocator, std::move(left), std::move(right));
+}
+
+/**
+ * Split a tree into the first @p pos code units and the rest. Leaves that contain the split position are cut into two
+ * leaves that share the buffer.
+ */
+void SplitTree(AllocatorBase* allocator, const NodePtr& node, u64 pos, NodePtr& out_left, NodePtr& out_right)
+{
+    if (!node.IsValid() || pos == 0)
+    {
+        out_left = NodePtr();
+        out_right = node.Clone();
+        return;
+    }
+    if (pos >= node->size)
+    {
+        out_left = node.Clone();
+        out_right = NodePtr();
+        return;
+    }
+    if (node->IsLeaf())
+    {
+        out_left = MakeLeaf(allocator, node->buffer.Clone(), node->data, pos);
+        out_right = MakeLeaf(allocator, node->buffer.Clone(), node->data + pos, node->size - pos);
+        return;
+    }
+    const u64 left_size = node->left->size;
+    if (pos < left_size)
+    {
+        NodePtr right_part;
+        SplitTree(allocator, node->left, pos, out_left, right_part);
+        out_right = JoinTrees(allocator, std::move(right_part), node->right.Clone());
+    }
+    else if (pos > left_size)
+    {
+        NodePtr left_part;
+        SplitTree(allocator, node->right, pos - left_size, left_part, out_right);
+        out_left = JoinTrees(allocator, node->left.Clone(), std::move(left_part));
+    }
+    else
+    {
+        out_left = node->left.Clone();
+        out_right = node->right.Clone();
+    }
+}
+
+/** Build a perfectly balanced tree over leaves [first, last) of @p buffer. */
+NodePtr BuildBalanced(AllocatorBase* allocator, const IntrusivePtr<RopeBuffer>& buffer, u64 first, u64 last)
+{
+    if (last - first == 1)
+    {
+        const u64 offset = first * Rope::k_max_leaf_size;
+        const u64 size = Opal::Min(Rope::k_max_leaf_size, buffer->text.GetSize() - offset);
+        return MakeLeaf(allocator, buffer.Clone(), buffer->text.GetData() + offset, size);
+    }
+    const u64 middle = first + (last - first) / 2;
+    return MakeInner(allocator, BuildBalanced(allocator, buffer, first, middle), BuildBalanced(allocator, buffer, middle, last));
+}
+
+void CheckPosition(u64 pos, u64 size)
+{
+    if (pos > size)
+    {
+        throw Opal::OutOfBoundsException(pos, 0, size);
+    }
+}
+
+}  // namespace
+
+Opal::Impl::RopeNode::RopeNode(IntrusivePtr<RopeNode> in_left, IntrusivePtr<RopeNode> in_right)
+    : left(std::move(in_left)),
+      right(std::move(in_right)),
+      size(left->size + right->size),
+      height(Max(left->height, right->height) + 1)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+// RopeChunkIterator.
+// ------------------------------------------------------------------------------------------------
+
+Opal::RopeChunkIterator::RopeChunkIterator(const Impl::RopeNode* root)
+{
+    if (root != nullptr)
+    {
+        DescendLeft(root);
+    }
+}
+
+Opal::RopeChunkIterator& Opal::RopeChunkIterator::operator++()
+{
+    --m_depth;
+    if (m_depth > 0)
+    {
+        --m_depth;
+        DescendLeft(m_stack[m_depth]);
+    }
+    return *this;
+}
+
+bool Opal::RopeChunkIterator::operator==(const RopeChunkIterator& other) const
+{
+    return m_depth == other.m_depth && std::memcmp(m_stack, other.m_stack, m_depth * sizeof(m_stack[0])) == 0;
+}
+
+void Opal::RopeChunkIterator::DescendLeft(const Impl::RopeNode* node)
+{
+    // The stack holds the right subtrees that are still to be visited and the current leaf on top
+    while (!node->IsLeaf())
+    {
+        OPAL_ASSERT(m_depth + 1 < k_max_height, "Rope is too high");
+        m_stack[m_depth++] = node->right.Get();
+        node = node->left.Get();
+    }
+    m_stack[m_depth++] = node;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Rope.
+// ------------------------------------------------------------------------------------------------
+
+Opal::Rope::Rope(allocator_type* allocator) : m_allocator(allocator != nullptr ? allocator : GetDefaultAllocator())
+{
+    if (!m_allocator->IsThreadSafe())
+    {
+        throw InvalidArgumentException("Rope", "Allocator should be thread-safe");
+    }
+}
+
+Opal::Rope::Rope(StringViewUtf8 str, allocator_type* allocator) : Rope(allocator)
+{
+    m_root = MakeTree(str);
+}
+
+Opal::Rope Opal::Rope::Clone(allocator_type* allocator) const
+{
+    Rope clone(allocator != nullptr ? allocator : m_allocator);
+    clone.m_root = m_root.Clone();
+    return clone;
+}
+
+Opal::char8 Opal::Rope::At(size_type pos) const
+{
+    if (pos >= GetSize())
+    {
+        throw OutOfBoundsException(pos, 0, GetSize());
+    }
+    const Impl::RopeNode* node = m_root.Get();
+    while (!node->IsLeaf())
+    {
+        const u64 left_size = node->left->size;
+        if (pos < left_size)
+        {
+            node = node->left.Get();
+        }
+        else
+        {
+            pos -= left_size;
+            node = node->right.Get();
+        }
+    }
+    return node->data[pos];
+}
+
+void Opal::Rope::Insert(size_type pos, StringViewUtf8 str)
+{
+    CheckPosition(pos, GetSize());
+    NodePtr left;
+    NodePtr right;
+    SplitTree(m_allocator, m_root, pos, left, right);
+    m_root = JoinTrees(m_allocator, JoinTrees(m_allocator, std::move(left), MakeTree(str)), std::move(right));
+}
+
+void Opal::Rope::Insert(size_type pos, const Rope& other)
+{
+    CheckPosition(pos, GetSize());
+    NodePtr left;
+    NodePtr right;
+    SplitTree(m_allocator, m_root, pos, left, right);
+    m_root = JoinTrees(m_allocator, JoinTrees(m_allocator, std::move(left), other.m_root.Clone()), std::move(right));
+}
+
+void Opal::Rope::Erase(size_type pos, size_type count)
+{
+    CheckPosition(pos, GetSize());
+    count = Min(count, GetSize() - pos);
+    if (count == 0)
+    {
+        return;
+    }
+    NodePtr left;
+    NodePtr rest;
+    SplitTree(m_allocator, m_root, pos, left, rest);
+    NodePtr erased;
+    NodePtr right;
+    SplitTree(m_allocator, rest, count, erased, right);
+    m_root = JoinTrees(m_allocator, std::move(left), std::move(right));
+}
+
+void Opal::Rope::Append(StringViewUtf8 str)
+{
+    m_root = JoinTrees(m_allocator, std::move(m_root), MakeTree(str));
+}
+
+void Opal::Rope::Append(const Rope& other)
+{
+    m_root = JoinTrees(m_allocator, std::move(m_root), other.m_root.Clone());
+}
+
+Opal::Rope Opal::Rope::SubRope(size_type pos, size_type count) const
+{
+    CheckPosition(pos, GetSize());
+    count = Min(count, GetSize() - pos);
+    NodePtr left;
+    NodePtr rest;
+    SplitTree(m_allocator, m_root, pos, left, rest);
+    Rope result(m_allocator);
+    NodePtr right;
+    SplitTree(m_allocator, rest, count, result.m_root, right);
+    return result;
+}
+
+Opal::StringUtf8 Opal::Rope::ToString(allocator_type* allocator) const
+{
+    StringUtf8 result(allocator);
+    if (IsEmpty())
+    {
+        return result;
+    }
+    result.Reserve(GetSize());
+    for (StringViewUtf8 chunk : GetChunks())
+    {
+        result.Append(chunk.GetData(), chunk.GetSize());
+    }
+    return result;
+}
+
+Opal::Rope::NodePtr Opal::Rope::MakeTree(StringViewUtf8 str) const
+{
+    if (str.IsEmpty())
+    {
+        return {};
+    }
+    IntrusivePtr<RopeBuffer> buffer(m_allocator, StringUtf8(str.GetData(), str.GetSize(), m_allocator));
+    const u64 leaf_count = (str.GetSize() + k_max_leaf_size - 1) / k_max_leaf_size;
+    return BuildBalanced(m_allocator, buffer, 0, leaf_count);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Searching.
+// ------------------------------------------------------------------------------------------------
+
+Opal::Rope::size_type Opal::Find(const Rope& haystack, StringViewUtf8 needle, Rope::size_type start_pos)
+{
+    const u64 size = haystack.GetSize();
+    if (start_pos >= size || needle.GetSize() > size - start_pos)
+    {
+        return Rope::k_npos;
+    }
+    if (needle.IsEmpty())
+    {
+        return start_pos;
+    }
+    const auto* needle_data = reinterpret_cast<const u8*>(needle.GetData());
+    const u64 needle_size = needle.GetSize();
+    // The last needle_size - 1 code units that were searched, a match that starts there can end in a later chunk
+    StringUtf8 carry;
+    u64 carry_pos = start_pos;
+    StringUtf8 window;
+    u64 chunk_pos = 0;
+    for (StringViewUtf8 chunk : haystack.GetChunks())
+    {
+        const u64 chunk_end = chunk_pos + chunk.GetSize();
+        if (chunk_end <= start_pos)
+        {
+            chunk_pos = chunk_end;
+            continue;
+        }
+        const u64 skip = start_pos > chunk_pos ? start_pos - chunk_pos : 0;
+        const auto* data = reinterpret_cast<const u8*>(chunk.GetData()) + skip;
+        const u64 data_size = chunk.GetSize() - skip;
+        const u64 data_pos = chunk_pos + skip;
+        if (!carry.IsEmpty())
+        {
+            window.Resize(0);
+            window.Append(carry);
+            window.Append(chunk.GetData() + skip, Min(data_size, needle_size - 1));
+            const u64 pos = Impl::FindBytes(reinterpret_cast<const u8*>(window.GetData()), window.GetSize(), needle_data, needle_size);
+            if (pos < carry.GetSize())
+            {
+                return carry_pos + pos;
+            }
+        }
+        const u64 pos = Impl::FindBytes(data, data_size, needle_data, needle_size);
+        if (pos != Rope::k_npos)
+        {
+            return data_pos + pos;
+        }
+        // Keep the last needle_size - 1 code units of everything searched so far
+        const u64 keep = needle_size - 1;
+        if (data_size >= keep)
+        {
+            carry.Resize(0);
+            carry.Append(chunk.GetData() + skip + data_size - keep, keep);
+        }
+        else
+        {
+            carry.Append(chunk.GetData() + skip, data_size);
+            if (carry.GetSize() > keep)
+            {
+                carry.Erase(0, carry.GetSize() - keep);
+            }
+        }
+        carry_pos = chunk_end - carry.GetSize();
+        chunk_pos = chunk_end;
+    }
+    return Rope::k_npos;
+}
@@ -14,9 +14,11 @@
 
 Opal::Signal::Signal() = default;
 
+Opal::Signal::Signal(const SpinWaitPolicy& spin_wait) : m_spin_wait(spin_wait) {}
+
 Opal::Signal::~Signal() = default;
 
-Opal::Signal::Signal(Signal&& other) noexcept
+Opal::Signal::Signal(Signal&& other) noexcept : m_spin_wait(other.m_spin_wait)
 {
     m_state.store(other.m_state.load(std::memory_order_relaxed), std::memory_order_relaxed);
     other.m_state.store(0, std::memory_order_relaxed);
@@ -30,6 +32,7 @@ Opal::Signal& Opal::Signal::operator=(Signal&& other) noexcept
     }
     m_state.store(other.m_state.load(std::memory_order_relaxed), std::memory_order_relaxed);
     other.m_state.store(0, std::memory_order_relaxed);
+    m_spin_wait = other.m_spin_wait;
     return *this;
 }
 
@@ -40,8 +43,13 @@ Opal::u32 Opal::Signal::GetState() const
 
 void Opal::Signal::Wait(u32 expected_state)
 {
+    SpinWait spin(m_spin_wait);
     while (m_state.load(std::memory_order_acquire) == expected_state)
     {
+        if (spin.Spin())
+        {
+            continue;
+        }
 #if defined(OPAL_PLATFORM_WINDOWS)
         u32 compare_value = expected_state;
         WaitOnAddress(&m_state, &compare_value, sizeof(u32), INFINITE);
@@ -56,8 +64,13 @@ void Opal::Signal::Wait(u32 expected_state)
 bool Opal::Signal::WaitFor(u32 expected_state, u64 timeout_ms)
 {
     const f64 deadline_ms = GetMilliSeconds() + static_cast<f64>(timeout_ms);
+    SpinWait spin(m_spin_wait);
     while (m_state.load(std::memory_order_acquire) == expected_state)
     {
+        if (spin.Spin())
+        {
+            continue;
+        }
         const f64 remaining_ms = deadline_ms - GetMilliSeconds();
         if (remaining_ms <= 0)
         {
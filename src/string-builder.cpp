@@ -0,0 +1,140 @@
+#include "opal/container/string-builder.h"
+
+#include "opal/container/dynamic-array.h"
+#include "opal/file-system.h"
+#include "opal/math-base.h"
+
+Opal::StringBuilder::StringBuilder(allocator_type* allocator)
+    : m_allocator(allocator != nullptr ? allocator : GetDefaultAllocator())
+{
+}
+
+Opal::StringBuilder::~StringBuilder()
+{
+    Clear();
+}
+
+Opal::StringBuilder::StringBuilder(StringBuilder&& other) noexcept
+    : m_allocator(other.m_allocator), m_head(other.m_head), m_tail(other.m_tail), m_size(other.m_size)
+{
+    other.m_head = nullptr;
+    other.m_tail = nullptr;
+    other.m_size = 0;
+}
+
+Opal::StringBuilder& Opal::StringBuilder::operator=(StringBuilder&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    Clear();
+    m_allocator = other.m_allocator;
+    m_head = other.m_head;
+    m_tail = other.m_tail;
+    m_size = other.m_size;
+    other.m_head = nullptr;
+    other.m_tail = nullptr;
+    other.m_size = 0;
+    return *this;
+}
+
+void Opal::StringBuilder::Append(size_type count, char8 value)
+{
+    while (count > 0)
+    {
+        if (m_tail == nullptr || m_tail->size == m_tail->capacity)
+        {
+            AllocateChunk(count);
+        }
+        const size_type fill_size = Min(count, m_tail->capacity - m_tail->size);
+        std::memset(m_tail->GetData() + m_tail->size, value, fill_size);
+        m_tail->size += fill_size;
+        m_size += fill_size;
+        count -= fill_size;
+    }
+}
+
+void Opal::StringBuilder::Clear()
+{
+    Impl::StringBuilderChunk* chunk = m_head;
+    while (chunk != nullptr)
+    {
+        Impl::StringBuilderChunk* next = chunk->next;
+        m_allocator->Free(chunk);
+        chunk = next;
+    }
+    m_head = nullptr;
+    m_tail = nullptr;
+    m_size = 0;
+}
+
+Opal::StringUtf8 Opal::StringBuilder::ToString(allocator_type* allocator) const
+{
+    StringUtf8 result(allocator);
+    AppendTo(result);
+    return result;
+}
+
+void Opal::StringBuilder::AppendTo(StringUtf8& output) const
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    output.Reserve(output.GetSize() + m_size);
+    for (const Impl::StringBuilderChunk* chunk = m_head; chunk != nullptr; chunk = chunk->next)
+    {
+        output.Append(chunk->GetData(), chunk->size);
+    }
+}
+
+void Opal::StringBuilder::WriteToFile(const StringUtf8& path) const
+{
+    DynamicArray<ArrayView<const u8>> chunks(m_allocator);
+    for (const Impl::StringBuilderChunk* chunk = m_head; chunk != nullptr; chunk = chunk->next)
+    {
+        chunks.PushBack(ArrayView<const u8>(reinterpret_cast<const u8*>(chunk->GetData()), chunk->size));
+    }
+    WriteChunksToFile(path, ArrayView<const ArrayView<const u8>>(chunks));
+}
+
+void Opal::StringBuilder::AppendSlow(const char8* data, size_type size)
+{
+    if (m_tail != nullptr)
+    {
+        // Fill the rest of the last chunk so that chunks other than the last one are always full
+        const size_type fill_size = Min(size, m_tail->capacity - m_tail->size);
+        std::memcpy(m_tail->GetData() + m_tail->size, data, fill_size);
+        m_tail->size += fill_size;
+        m_size += fill_size;
+        data += fill_size;
+        size -= fill_size;
+    }
+    if (size == 0)
+    {
+        return;
+    }
+    Impl::StringBuilderChunk* chunk = AllocateChunk(size);
+    std::memcpy(chunk->GetData(), data, size);
+    chunk->size = size;
+    m_size += size;
+}
+
+Opal::Impl::StringBuilderChunk* Opal::StringBuilder::AllocateChunk(size_type min_capacity)
+{
+    const size_type next_capacity = m_tail != nullptr ? Min(m_tail->capacity * 2, k_max_chunk_size) : k_min_chunk_size;
+    const size_type capacity = Max(next_capacity, min_capacity);
+    void* memory = m_allocator->Alloc(sizeof(Impl::StringBuilderChunk) + capacity, alignof(Impl::StringBuilderChunk));
+    auto* chunk = new (memory) Impl::StringBuilderChunk{.next = nullptr, .size = 0, .capacity = capacity};
+    if (m_tail != nullptr)
+    {
+        m_tail->next = chunk;
+    }
+    else
+    {
+        m_head = chunk;
+    }
+    m_tail = chunk;
+    return chunk;
+}
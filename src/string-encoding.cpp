@@ -1,9 +1,16 @@
 #include "opal/container/string-encoding.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <cuchar>
 #include <cwchar>
 
+#include "opal/defines.h"
+
+#if defined(OPAL_SIMD_AVX2) || defined(OPAL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
 Opal::EncodingLocale::EncodingLocale() : m_encoding_state(), m_decoding_state()
 {
     OPAL_ASSERT(std::mbsinit(&m_encoding_state) != 0, "Encoding state is not initialized!");
@@ -53,3 +60,428 @@ Opal::ErrorCode Opal::EncodingLocale::DecodeOne(ArrayView<const CodeUnitType>& i
     input = ArrayView<const CodeUnitType>(input.begin() + static_cast<i64>(count), input.end());
     return ErrorCode::Success;
 }
+
+// ------------------------------------------------------------------------------------------------
+// Unicode helpers.
+// ------------------------------------------------------------------------------------------------
+
+namespace
+{
+
+using Opal::ErrorCode;
+using Opal::i16;
+using Opal::i32;
+using Opal::u16;
+using Opal::u32;
+using Opal::u64;
+using Opal::u8;
+
+bool IsContinuation(u8 value)
+{
+    return (value & 0xC0) == 0x80;
+}
+
+bool IsSurrogate(u32 code_point)
+{
+    return code_point >= 0xD800 && code_point <= 0xDFFF;
+}
+
+/**
+ * Decode one UTF-8 sequence that starts with a non-ASCII byte. Accepts only the shortest form of code points up to
+ * U+10FFFF that are not surrogates, following the table of well-formed byte sequences in the Unicode standard.
+ */
+ErrorCode DecodeUtf8Sequence(const u8* data, u64 size, u64& pos, u32& code_point)
+{
+    const u8 lead = data[pos];
+    u64 length = 0;
+    u8 second_min = 0x80;
+    u8 second_max = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        code_point = lead & 0x1Fu;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        code_point = lead & 0x0Fu;
+        second_min = lead == 0xE0 ? u8{0xA0} : u8{0x80};
+        second_max = lead == 0xED ? u8{0x9F} : u8{0xBF};
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        code_point = lead & 0x07u;
+        second_min = lead == 0xF0 ? u8{0x90} : u8{0x80};
+        second_max = lead == 0xF4 ? u8{0x8F} : u8{0xBF};
+    }
+    else
+    {
+        return ErrorCode::InvalidArgument;
+    }
+    if (size - pos < length)
+    {
+        return ErrorCode::IncompleteSequence;
+    }
+    const u8 second = data[pos + 1];
+    if (second < second_min || second > second_max)
+    {
+        return ErrorCode::InvalidArgument;
+    }
+    code_point = (code_point << 6) | (second & 0x3Fu);
+    for (u64 i = 2; i < length; ++i)
+    {
+        const u8 next = data[pos + i];
+        if (!IsContinuation(next))
+        {
+            return ErrorCode::InvalidArgument;
+        }
+        code_point = (code_point << 6) | (next & 0x3Fu);
+    }
+    pos += length;
+    return ErrorCode::Success;
+}
+
+/** Write a code point that is known to be valid. */
+ErrorCode EncodeUtf8(u32 code_point, u8* output, u64 output_size, u64& out_pos)
+{
+    if (code_point < 0x80)
+    {
+        if (out_pos + 1 > output_size)
+        {
+            return ErrorCode::InsufficientSpace;
+        }
+        output[out_pos++] = static_cast<u8>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        if (out_pos + 2 > output_size)
+        {
+            return ErrorCode::InsufficientSpace;
+        }
+        output[out_pos++] = static_cast<u8>(0xC0 | (code_point >> 6));
+        output[out_pos++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+        if (out_pos + 3 > output_size)
+        {
+            return ErrorCode::InsufficientSpace;
+        }
+        output[out_pos++] = static_cast<u8>(0xE0 | (code_point >> 12));
+        output[out_pos++] = static_cast<u8>(0x80 | ((code_point >> 6) & 0x3F));
+        output[out_pos++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        if (out_pos + 4 > output_size)
+        {
+            return ErrorCode::InsufficientSpace;
+        }
+        output[out_pos++] = static_cast<u8>(0xF0 | (code_point >> 18));
+        output[out_pos++] = static_cast<u8>(0x80 | ((code_point >> 12) & 0x3F));
+        output[out_pos++] = static_cast<u8>(0x80 | ((code_point >> 6) & 0x3F));
+        output[out_pos++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+    }
+    return ErrorCode::Success;
+}
+
+/** Returns true if the 16 bytes at @p data are all ASCII. */
+bool IsAscii16(const u8* data)
+{
+#if defined(OPAL_SIMD_SSE2)
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))) == 0;
+#else
+    u64 first = 0;
+    u64 second = 0;
+    std::memcpy(&first, data, sizeof(u64));
+    std::memcpy(&second, data + sizeof(u64), sizeof(u64));
+    return ((first | second) & 0x8080808080808080ull) == 0;
+#endif
+}
+
+/** Skip the run of ASCII bytes that starts at @p pos, one vector at a time. */
+u64 SkipAscii(const u8* data, u64 size, u64 pos)
+{
+#if defined(OPAL_SIMD_AVX2)
+    for (; pos + 32 <= size; pos += 32)
+    {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos))) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    for (; pos + 16 <= size; pos += 16)
+    {
+        if (!IsAscii16(data + pos))
+        {
+            break;
+        }
+    }
+    while (pos < size && data[pos] < 0x80)
+    {
+        ++pos;
+    }
+    return pos;
+}
+
+/** Advance @p output past the @p written code units and return @p error. */
+template <typename T>
+ErrorCode Finish(ErrorCode error, u64 written, Opal::ArrayView<T>& output)
+{
+    output = Opal::ArrayView<T>(output.GetData() + written, output.GetSize() - written);
+    return error;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------------------------------
+// Validation and bulk transcoding.
+// ------------------------------------------------------------------------------------------------
+
+bool Opal::ValidateUtf8(ArrayView<const u8> input)
+{
+    const u8* data = input.GetData();
+    const u64 size = input.GetSize();
+    u64 pos = 0;
+    while (true)
+    {
+        pos = SkipAscii(data, size, pos);
+        if (pos == size)
+        {
+            return true;
+        }
+        u32 code_point = 0;
+        if (DecodeUtf8Sequence(data, size, pos, code_point) != ErrorCode::Success)
+        {
+            return false;
+        }
+    }
+}
+
+Opal::ErrorCode Opal::TranscodeUtf8ToUtf16(ArrayView<const u8> input, ArrayView<u16>& output)
+{
+    const u8* in = input.GetData();
+    const u64 in_size = input.GetSize();
+    u16* out = output.GetData();
+    const u64 out_size = output.GetSize();
+    u64 in_pos = 0;
+    u64 out_pos = 0;
+    while (in_pos < in_size)
+    {
+#if defined(OPAL_SIMD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        while (in_pos + 16 <= in_size && out_pos + 16 <= out_size)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + in_pos));
+            if (_mm_movemask_epi8(chunk) != 0)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + out_pos), _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + out_pos + 8), _mm_unpackhi_epi8(chunk, zero));
+            in_pos += 16;
+            out_pos += 16;
+        }
+        if (in_pos == in_size)
+        {
+            break;
+        }
+#endif
+        u32 code_point = in[in_pos];
+        if (code_point < 0x80)
+        {
+            ++in_pos;
+        }
+        else
+        {
+            const ErrorCode error = DecodeUtf8Sequence(in, in_size, in_pos, code_point);
+            if (error != ErrorCode::Success)
+            {
+                return Finish(error, out_pos, output);
+            }
+        }
+        if (code_point < 0x10000)
+        {
+            if (out_pos + 1 > out_size)
+            {
+                return Finish(ErrorCode::InsufficientSpace, out_pos, output);
+            }
+            out[out_pos++] = static_cast<u16>(code_point);
+        }
+        else
+        {
+            if (out_pos + 2 > out_size)
+            {
+                return Finish(ErrorCode::InsufficientSpace, out_pos, output);
+            }
+            const u32 offset = code_point - 0x10000;
+            out[out_pos++] = static_cast<u16>(0xD800 + (offset >> 10));
+            out[out_pos++] = static_cast<u16>(0xDC00 + (offset & 0x3FF));
+        }
+    }
+    return Finish(ErrorCode::Success, out_pos, output);
+}
+
+Opal::ErrorCode Opal::TranscodeUtf16ToUtf8(ArrayView<const u16> input, ArrayView<u8>& output)
+{
+    const u16* in = input.GetData();
+    const u64 in_size = input.GetSize();
+    u8* out = output.GetData();
+    const u64 out_size = output.GetSize();
+    u64 in_pos = 0;
+    u64 out_pos = 0;
+    while (in_pos < in_size)
+    {
+#if defined(OPAL_SIMD_SSE2)
+        const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<i16>(0xFF80));
+        while (in_pos + 16 <= in_size && out_pos + 16 <= out_size)
+        {
+            const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + in_pos));
+            const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + in_pos + 8));
+            const __m128i non_ascii = _mm_and_si128(_mm_or_si128(first, second), non_ascii_bits);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, _mm_setzero_si128())) != 0xFFFF)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + out_pos), _mm_packus_epi16(first, second));
+            in_pos += 16;
+            out_pos += 16;
+        }
+        if (in_pos == in_size)
+        {
+            break;
+        }
+#endif
+        u32 code_point = in[in_pos++];
+        if (code_point >= 0xD800 && code_point <= 0xDBFF)
+        {
+            if (in_pos == in_size)
+            {
+                return Finish(ErrorCode::IncompleteSequence, out_pos, output);
+            }
+            const u32 low = in[in_pos];
+            if (low < 0xDC00 || low > 0xDFFF)
+            {
+                return Finish(ErrorCode::InvalidArgument, out_pos, output);
+            }
+            ++in_pos;
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if (IsSurrogate(code_point))
+        {
+            return Finish(ErrorCode::InvalidArgument, out_pos, output);
+        }
+        const ErrorCode error = EncodeUtf8(code_point, out, out_size, out_pos);
+        if (error != ErrorCode::Success)
+        {
+            return Finish(error, out_pos, output);
+        }
+    }
+    return Finish(ErrorCode::Success, out_pos, output);
+}
+
+Opal::ErrorCode Opal::TranscodeUtf8ToUtf32(ArrayView<const u8> input, ArrayView<u32>& output)
+{
+    const u8* in = input.GetData();
+    const u64 in_size = input.GetSize();
+    u32* out = output.GetData();
+    const u64 out_size = output.GetSize();
+    u64 in_pos = 0;
+    u64 out_pos = 0;
+    while (in_pos < in_size)
+    {
+#if defined(OPAL_SIMD_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        while (in_pos + 16 <= in_size && out_pos + 16 <= out_size)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + in_pos));
+            if (_mm_movemask_epi8(chunk) != 0)
+            {
+                break;
+            }
+            const __m128i low = _mm_unpacklo_epi8(chunk, zero);
+            const __m128i high = _mm_unpackhi_epi8(chunk, zero);
+            __m128i* destination = reinterpret_cast<__m128i*>(out + out_pos);
+            _mm_storeu_si128(destination, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(destination + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(destination + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(destination + 3, _mm_unpackhi_epi16(high, zero));
+            in_pos += 16;
+            out_pos += 16;
+        }
+        if (in_pos == in_size)
+        {
+            break;
+        }
+#endif
+        u32 code_point = in[in_pos];
+        if (code_point < 0x80)
+        {
+            ++in_pos;
+        }
+        else
+        {
+            const ErrorCode error = DecodeUtf8Sequence(in, in_size, in_pos, code_point);
+            if (error != ErrorCode::Success)
+            {
+                return Finish(error, out_pos, output);
+            }
+        }
+        if (out_pos == out_size)
+        {
+            return Finish(ErrorCode::InsufficientSpace, out_pos, output);
+        }
+        out[out_pos++] = code_point;
+    }
+    return Finish(ErrorCode::Success, out_pos, output);
+}
+
+Opal::ErrorCode Opal::TranscodeUtf32ToUtf8(ArrayView<const u32> input, ArrayView<u8>& output)
+{
+    const u32* in = input.GetData();
+    const u64 in_size = input.GetSize();
+    u8* out = output.GetData();
+    const u64 out_size = output.GetSize();
+    u64 in_pos = 0;
+    u64 out_pos = 0;
+    while (in_pos < in_size)
+    {
+#if defined(OPAL_SIMD_SSE2)
+        const __m128i non_ascii_bits = _mm_set1_epi32(static_cast<i32>(0xFFFFFF80));
+        while (in_pos + 16 <= in_size && out_pos + 16 <= out_size)
+        {
+            const __m128i* source = reinterpret_cast<const __m128i*>(in + in_pos);
+            const __m128i a = _mm_loadu_si128(source);
+            const __m128i b = _mm_loadu_si128(source + 1);
+            const __m128i c = _mm_loadu_si128(source + 2);
+            const __m128i d = _mm_loadu_si128(source + 3);
+            const __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, non_ascii_bits), _mm_setzero_si128())) != 0xFFFF)
+            {
+                break;
+            }
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + out_pos), packed);
+            in_pos += 16;
+            out_pos += 16;
+        }
+        if (in_pos == in_size)
+        {
+            break;
+        }
+#endif
+        const u32 code_point = in[in_pos++];
+        if (code_point > 0x10FFFF || IsSurrogate(code_point))
+        {
+            return Finish(ErrorCode::InvalidArgument, out_pos, output);
+        }
+        const ErrorCode error = EncodeUtf8(code_point, out, out_size, out_pos);
+        if (error != ErrorCode::Success)
+        {
+            return Finish(error, out_pos, output);
+        }
+    }
+    return Finish(ErrorCode::Success, out_pos, output);
+}
@@ -0,0 +1,69 @@
+#include "opal/container/string-pool.h"
+
+#include <cstring>
+
+bool Opal::Impl::StringPoolKey::operator==(const StringPoolKey& other) const
+{
+    if (hash != other.hash || size != other.size)
+    {
+        return false;
+    }
+    return data == other.data || std::memcmp(data, other.data, size) == 0;
+}
+
+Opal::StringPool::StringPool(const SystemMemoryAllocatorDesc& desc) : m_state(desc) {}
+
+Opal::InternedString Opal::StringPool::Intern(StringViewUtf8 str)
+{
+    if (str.IsEmpty())
+    {
+        return {};
+    }
+    const Impl::StringPoolKey key{.hash = Hash::CalcRawArray(reinterpret_cast<const u8*>(str.GetData()), str.GetSize()),
+                                  .size = str.GetSize(),
+                                  .data = str.GetData()};
+    MutexGuard<State> guard = m_state.Lock();
+    State* state = guard.Deref();
+    auto it = state->lookup.Find(key);
+    if (it != state->lookup.end())
+    {
+        return InternedString(reinterpret_cast<const Impl::InternedStringData*>(it->data) - 1);
+    }
+
+    void* memory = state->arena.Alloc(sizeof(Impl::InternedStringData) + key.size + 1, alignof(Impl::InternedStringData));
+    Impl::InternedStringData* entry = new (memory) Impl::InternedStringData{.hash = key.hash, .size = key.size};
+    char8* data = reinterpret_cast<char8*>(entry + 1);
+    std::memcpy(data, key.data, key.size);
+    data[key.size] = 0;
+    const ErrorCode error = state->lookup.Insert(Impl::StringPoolKey{.hash = key.hash, .size = key.size, .data = data});
+    if (error != ErrorCode::Success)
+    {
+        throw OutOfMemoryException("StringPool::Intern");
+    }
+    return InternedString(entry);
+}
+
+Opal::Expected<Opal::InternedString, Opal::ErrorCode> Opal::StringPool::Find(StringViewUtf8 str) const
+{
+    if (str.IsEmpty())
+    {
+        return Expected<InternedString, ErrorCode>(InternedString());
+    }
+    const Impl::StringPoolKey key{.hash = Hash::CalcRawArray(reinterpret_cast<const u8*>(str.GetData()), str.GetSize()),
+                                  .size = str.GetSize(),
+                                  .data = str.GetData()};
+    MutexGuard<State> guard = m_state.Lock();
+    const State* state = guard.Deref();
+    auto it = state->lookup.Find(key);
+    if (it == state->lookup.cend())
+    {
+        return Expected<InternedString, ErrorCode>(ErrorCode::StringNotFound);
+    }
+    return Expected<InternedString, ErrorCode>(InternedString(reinterpret_cast<const Impl::InternedStringData*>((*it).data) - 1));
+}
+
+Opal::u64 Opal::StringPool::GetSize() const
+{
+    MutexGuard<State> guard = m_state.Lock();
+    return guard.Deref()->lookup.GetSize();
+}
@@ -1 +1,943 @@
 #include "opal/container/string.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "opal/bit.h"
+#include "opal/container/string-view.h"
+#include "opal/defines.h"
+#include "opal/hash.h"
+
+#if defined(OPAL_SIMD_AVX2) || defined(OPAL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace Opal
+{
+
+// ------------------------------------------------------------------------------------------------
+// Byte vectors.
+// ------------------------------------------------------------------------------------------------
+
+namespace
+{
+
+constexpr u64 k_not_found = static_cast<u64>(-1);
+
+// Needles of at least this size are searched with Boyer-Moore-Horspool, shorter ones with the first and last byte filter.
+constexpr u64 k_horspool_min_needle_size = 32;
+
+#if defined(OPAL_SIMD_AVX2)
+#define OPAL_STRING_SIMD
+constexpr u64 k_vector_width = 32;
+using ByteVector = __m256i;
+
+ByteVector Splat(u8 value)
+{
+    return _mm256_set1_epi8(static_cast<char>(value));
+}
+
+ByteVector Load(const u8* data)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+/** Bit i of the result is set when byte i of @p a equals byte i of @p b. */
+u32 EqualMask(ByteVector a, ByteVector b)
+{
+    return static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+}
+
+void Store(u8* out, ByteVector value)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), value);
+}
+
+/** Bit i of the result is set when byte i of @p value is not ASCII. */
+u32 NonAsciiMask(ByteVector value)
+{
+    return static_cast<u32>(_mm256_movemask_epi8(value));
+}
+
+/** Converts 'A' to 'Z' to lower case and leaves all other bytes as they are. */
+ByteVector ToLowerAscii(ByteVector value)
+{
+    // Moves 'A' to 'Z' to the bottom of the signed range, so that a single signed compare finds them.
+    const __m256i shifted = _mm256_add_epi8(value, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+    const __m256i is_upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), shifted);
+    return _mm256_or_si256(value, _mm256_and_si256(is_upper, _mm256_set1_epi8(0x20)));
+}
+#elif defined(OPAL_SIMD_SSE2)
+#define OPAL_STRING_SIMD
+constexpr u64 k_vector_width = 16;
+using ByteVector = __m128i;
+
+ByteVector Splat(u8 value)
+{
+    return _mm_set1_epi8(static_cast<char>(value));
+}
+
+ByteVector Load(const u8* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+/** Bit i of the result is set when byte i of @p a equals byte i of @p b. */
+u32 EqualMask(ByteVector a, ByteVector b)
+{
+    return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+}
+
+void Store(u8* out, ByteVector value)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), value);
+}
+
+/** Bit i of the result is set when byte i of @p value is not ASCII. */
+u32 NonAsciiMask(ByteVector value)
+{
+    return static_cast<u32>(_mm_movemask_epi8(value));
+}
+
+/** Converts 'A' to 'Z' to lower case and leaves all other bytes as they are. */
+ByteVector ToLowerAscii(ByteVector value)
+{
+    // Moves 'A' to 'Z' to the bottom of the signed range, so that a single signed compare finds them.
+    const __m128i shifted = _mm_add_epi8(value, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+    const __m128i is_upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+    return _mm_or_si128(value, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+#if defined(OPAL_STRING_SIMD)
+/** EqualMask of two equal vectors. */
+constexpr u32 k_all_equal_mask = static_cast<u32>((1ull << k_vector_width) - 1);
+
+u64 GetHighestSetBit(u32 mask)
+{
+    return 31 - CountLeadingZeros(mask);
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
+// Substring kernels.
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * Candidates are positions where both the first and the last byte of the needle match, which rules out almost every
+ * position in real text with two compares per vector. The bytes in between are checked with memcmp.
+ */
+u64 FindWithFilter(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    const u64 last = needle_size - 1;
+    const u64 candidate_count = size - last;
+    u64 pos = 0;
+#if defined(OPAL_STRING_SIMD)
+    const ByteVector first_byte = Splat(needle[0]);
+    const ByteVector last_byte = Splat(needle[last]);
+    for (; pos + k_vector_width <= candidate_count; pos += k_vector_width)
+    {
+        u32 mask = EqualMask(Load(data + pos), first_byte) & EqualMask(Load(data + pos + last), last_byte);
+        while (mask != 0)
+        {
+            const u64 candidate = pos + CountTrailingZeros(mask);
+            if (std::memcmp(data + candidate + 1, needle + 1, needle_size - 2) == 0)
+            {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; pos < candidate_count; ++pos)
+    {
+        if (data[pos] == needle[0] && data[pos + last] == needle[last] && std::memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0)
+        {
+            return pos;
+        }
+    }
+    return k_not_found;
+}
+
+u64 ReverseFindWithFilter(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    const u64 last = needle_size - 1;
+    u64 end = size - last;
+#if defined(OPAL_STRING_SIMD)
+    const ByteVector first_byte = Splat(needle[0]);
+    const ByteVector last_byte = Splat(needle[last]);
+    for (; end >= k_vector_width; end -= k_vector_width)
+    {
+        const u64 pos = end - k_vector_width;
+        u32 mask = EqualMask(Load(data + pos), first_byte) & EqualMask(Load(data + pos + last), last_byte);
+        while (mask != 0)
+        {
+            const u64 bit = GetHighestSetBit(mask);
+            if (std::memcmp(data + pos + bit + 1, needle + 1, needle_size - 2) == 0)
+            {
+                return pos + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+    }
+#endif
+    for (u64 pos = end; pos-- > 0;)
+    {
+        if (data[pos] == needle[0] && data[pos + last] == needle[last] && std::memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0)
+        {
+            return pos;
+        }
+    }
+    return k_not_found;
+}
+
+/**
+ * Boyer-Moore-Horspool. The window is shifted by the distance between the last occurrence of the byte under the end
+ * of the window and the end of the needle, which is close to the needle size for long needles.
+ */
+u64 FindWithHorspool(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    u64 shift[256];
+    for (u64& value : shift)
+    {
+        value = needle_size;
+    }
+    const u64 last = needle_size - 1;
+    for (u64 i = 0; i < last; ++i)
+    {
+        shift[needle[i]] = last - i;
+    }
+    for (u64 pos = 0; pos + needle_size <= size;)
+    {
+        const u8 end_byte = data[pos + last];
+        if (end_byte == needle[last] && std::memcmp(data + pos, needle, last) == 0)
+        {
+            return pos;
+        }
+        pos += shift[end_byte];
+    }
+    return k_not_found;
+}
+
+/** Mirror image of FindWithHorspool that moves the window towards the start of the data. */
+u64 ReverseFindWithHorspool(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    u64 shift[256];
+    for (u64& value : shift)
+    {
+        value = needle_size;
+    }
+    for (u64 i = needle_size - 1; i > 0; --i)
+    {
+        shift[needle[i]] = i;
+    }
+    u64 pos = size - needle_size;
+    while (true)
+    {
+        const u8 start_byte = data[pos];
+        if (start_byte == needle[0] && std::memcmp(data + pos + 1, needle + 1, needle_size - 1) == 0)
+        {
+            return pos;
+        }
+        if (pos < shift[start_byte])
+        {
+            return k_not_found;
+        }
+        pos -= shift[start_byte];
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Any-of kernels.
+// ------------------------------------------------------------------------------------------------
+
+// Sets up to this size are compared against every byte of a vector, larger ones use a lookup table.
+constexpr u64 k_max_vector_set_size = 8;
+
+u64 FindAnyWithTable(const u8* data, u64 size, const u8* set, u64 set_size)
+{
+    bool is_in_set[256] = {};
+    for (u64 i = 0; i < set_size; ++i)
+    {
+        is_in_set[set[i]] = true;
+    }
+    for (u64 pos = 0; pos < size; ++pos)
+    {
+        if (is_in_set[data[pos]])
+        {
+            return pos;
+        }
+    }
+    return k_not_found;
+}
+
+u64 FindAnyWithVectors(const u8* data, u64 size, const u8* set, u64 set_size)
+{
+    u64 pos = 0;
+#if defined(OPAL_STRING_SIMD)
+    ByteVector patterns[k_max_vector_set_size];
+    for (u64 i = 0; i < set_size; ++i)
+    {
+        patterns[i] = Splat(set[i]);
+    }
+    for (; pos + k_vector_width <= size; pos += k_vector_width)
+    {
+        const ByteVector chunk = Load(data + pos);
+        u32 mask = 0;
+        for (u64 i = 0; i < set_size; ++i)
+        {
+            mask |= EqualMask(chunk, patterns[i]);
+        }
+        if (mask != 0)
+        {
+            return pos + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; pos < size; ++pos)
+    {
+        for (u64 i = 0; i < set_size; ++i)
+        {
+            if (data[pos] == set[i])
+            {
+                return pos;
+            }
+        }
+    }
+    return k_not_found;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Case folding.
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * Code points that fold to a single code point, as runs of code points with the same distance to their folded form.
+ * Only every stride-th code point of a run is folded. Generated from CaseFolding.txt of Unicode 14.0, status C.
+ */
+struct CaseFoldRun
+{
+    u32 first;
+    u32 last;
+    u32 stride;
+    i32 delta;
+};
+
+constexpr CaseFoldRun k_case_fold_runs[] = {
+    {0x00B5, 0x00B5, 1, 775}, {0x00C0, 0x00D6, 1, 32}, {0x00D8, 0x00DE, 1, 32}, {0x0100, 0x012E, 2, 1},
+    {0x0132, 0x0136, 2, 1}, {0x0139, 0x0147, 2, 1}, {0x014A, 0x0176, 2, 1}, {0x0178, 0x0178, 1, -121},
+    {0x0179, 0x017D, 2, 1}, {0x017F, 0x017F, 1, -268}, {0x0181, 0x0181, 1, 210}, {0x0182, 0x0184, 2, 1},
+    {0x0186, 0x0186, 1, 206}, {0x0187, 0x0187, 1, 1}, {0x0189, 0x018A, 1, 205}, {0x018B, 0x018B, 1, 1},
+    {0x018E, 0x018E, 1, 79}, {0x018F, 0x018F, 1, 202}, {0x0190, 0x0190, 1, 203}, {0x0191, 0x0191, 1, 1},
+    {0x0193, 0x0193, 1, 205}, {0x0194, 0x0194, 1, 207}, {0x0196, 0x0196, 1, 211}, {0x0197, 0x0197, 1, 209},
+    {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 1, 211}, {0x019D, 0x019D, 1, 213}, {0x019F, 0x019F, 1, 214},
+    {0x01A0, 0x01A4, 2, 1}, {0x01A6, 0x01A6, 1, 218}, {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 1, 218},
+    {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 1, 218}, {0x01AF, 0x01AF, 1, 1}, {0x01B1, 0x01B2, 1, 217},
+    {0x01B3, 0x01B5, 2, 1}, {0x01B7, 0x01B7, 1, 219}, {0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1},
+    {0x01C4, 0x01C4, 1, 2}, {0x01C5, 0x01C5, 1, 1}, {0x01C7, 0x01C7, 1, 2}, {0x01C8, 0x01C8, 1, 1},
+    {0x01CA, 0x01CA, 1, 2}, {0x01CB, 0x01DB, 2, 1}, {0x01DE, 0x01EE, 2, 1}, {0x01F1, 0x01F1, 1, 2},
+    {0x01F2, 0x01F4, 2, 1}, {0x01F6, 0x01F6, 1, -97}, {0x01F7, 0x01F7, 1, -56}, {0x01F8, 0x021E, 2, 1},
+    {0x0220, 0x0220, 1, -130}, {0x0222, 0x0232, 2, 1}, {0x023A, 0x023A, 1, 10795}, {0x023B, 0x023B, 1, 1},
+    {0x023D, 0x023D, 1, -163}, {0x023E, 0x023E, 1, 10792}, {0x0241, 0x0241, 1, 1}, {0x0243, 0x0243, 1, -195},
+    {0x0244, 0x0244, 1, 69}, {0x0245, 0x0245, 1, 71}, {0x0246, 0x024E, 2, 1}, {0x0345, 0x0345, 1, 116},
+    {0x0370, 0x0372, 2, 1}, {0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 1, 116}, {0x0386, 0x0386, 1, 38},
+    {0x0388, 0x038A, 1, 37}, {0x038C, 0x038C, 1, 64}, {0x038E, 0x038F, 1, 63}, {0x0391, 0x03A1, 1, 32},
+    {0x03A3, 0x03AB, 1, 32}, {0x03C2, 0x03C2, 1, 1}, {0x03CF, 0x03CF, 1, 8}, {0x03D0, 0x03D0, 1, -30},
+    {0x03D1, 0x03D1, 1, -25}, {0x03D5, 0x03D5, 1, -15}, {0x03D6, 0x03D6, 1, -22}, {0x03D8, 0x03EE, 2, 1},
+    {0x03F0, 0x03F0, 1, -54}, {0x03F1, 0x03F1, 1, -48}, {0x03F4, 0x03F4, 1, -60}, {0x03F5, 0x03F5, 1, -64},
+    {0x03F7, 0x03F7, 1, 1}, {0x03F9, 0x03F9, 1, -7}, {0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, 1, -130},
+    {0x0400, 0x040F, 1, 80}, {0x0410, 0x042F, 1, 32}, {0x0460, 0x0480, 2, 1}, {0x048A, 0x04BE, 2, 1},
+    {0x04C0, 0x04C0, 1, 15}, {0x04C1, 0x04CD, 2, 1}, {0x04D0, 0x052E, 2, 1}, {0x0531, 0x0556, 1, 48},
+    {0x10A0, 0x10C5, 1, 7264}, {0x10C7, 0x10C7, 1, 7264}, {0x10CD, 0x10CD, 1, 7264}, {0x13F8, 0x13FD, 1, -8},
+    {0x1C80, 0x1C80, 1, -6222}, {0x1C81, 0x1C81, 1, -6221}, {0x1C82, 0x1C82, 1, -6212}, {0x1C83, 0x1C84, 1, -6210},
+    {0x1C85, 0x1C85, 1, -6211}, {0x1C86, 0x1C86, 1, -6204}, {0x1C87, 0x1C87, 1, -6180}, {0x1C88, 0x1C88, 1, 35267},
+    {0x1C90, 0x1CBA, 1, -3008}, {0x1CBD, 0x1CBF, 1, -3008}, {0x1E00, 0x1E94, 2, 1}, {0x1E9B, 0x1E9B, 1, -58},
+    {0x1EA0, 0x1EFE, 2, 1}, {0x1F08, 0x1F0F, 1, -8}, {0x1F18, 0x1F1D, 1, -8}, {0x1F28, 0x1F2F, 1, -8},
+    {0x1F38, 0x1F3F, 1, -8}, {0x1F48, 0x1F4D, 1, -8}, {0x1F59, 0x1F5F, 2, -8}, {0x1F68, 0x1F6F, 1, -8},
+    {0x1FB8, 0x1FB9, 1, -8}, {0x1FBA, 0x1FBB, 1, -74}, {0x1FBE, 0x1FBE, 1, -7173}, {0x1FC8, 0x1FCB, 1, -86},
+    {0x1FD8, 0x1FD9, 1, -8}, {0x1FDA, 0x1FDB, 1, -100}, {0x1FE8, 0x1FE9, 1, -8}, {0x1FEA, 0x1FEB, 1, -112},
+    {0x1FEC, 0x1FEC, 1, -7}, {0x1FF8, 0x1FF9, 1, -128}, {0x1FFA, 0x1FFB, 1, -126}, {0x2126, 0x2126, 1, -7517},
+    {0x212A, 0x212A, 1, -8383}, {0x212B, 0x212B, 1, -8262}, {0x2132, 0x2132, 1, 28}, {0x2160, 0x216F, 1, 16},
+    {0x2183, 0x2183, 1, 1}, {0x24B6, 0x24CF, 1, 26}, {0x2C00, 0x2C2F, 1, 48}, {0x2C60, 0x2C60, 1, 1},
+    {0x2C62, 0x2C62, 1, -10743}, {0x2C63, 0x2C63, 1, -3814}, {0x2C64, 0x2C64, 1, -10727}, {0x2C67, 0x2C6B, 2, 1},
+    {0x2C6D, 0x2C6D, 1, -10780}, {0x2C6E, 0x2C6E, 1, -10749}, {0x2C6F, 0x2C6F, 1, -10783}, {0x2C70, 0x2C70, 1, -10782},
+    {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, 1, -10815}, {0x2C80, 0x2CE2, 2, 1},
+    {0x2CEB, 0x2CED, 2, 1}, {0x2CF2, 0x2CF2, 1, 1}, {0xA640, 0xA66C, 2, 1}, {0xA680, 0xA69A, 2, 1},
+    {0xA722, 0xA72E, 2, 1}, {0xA732, 0xA76E, 2, 1}, {0xA779, 0xA77B, 2, 1}, {0xA77D, 0xA77D, 1, -35332},
+    {0xA77E, 0xA786, 2, 1}, {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, 1, -42280}, {0xA790, 0xA792, 2, 1},
+    {0xA796, 0xA7A8, 2, 1}, {0xA7AA, 0xA7AA, 1, -42308}, {0xA7AB, 0xA7AB, 1, -42319}, {0xA7AC, 0xA7AC, 1, -42315},
+    {0xA7AD, 0xA7AD, 1, -42305}, {0xA7AE, 0xA7AE, 1, -42308}, {0xA7B0, 0xA7B0, 1, -42258}, {0xA7B1, 0xA7B1, 1, -42282},
+    {0xA7B2, 0xA7B2, 1, -42261}, {0xA7B3, 0xA7B3, 1, 928}, {0xA7B4, 0xA7C2, 2, 1}, {0xA7C4, 0xA7C4, 1, -48},
+    {0xA7C5, 0xA7C5, 1, -42307}, {0xA7C6, 0xA7C6, 1, -35384}, {0xA7C7, 0xA7C9, 2, 1}, {0xA7D0, 0xA7D0, 1, 1},
+    {0xA7D6, 0xA7D8, 2, 1}, {0xA7F5, 0xA7F5, 1, 1}, {0xAB70, 0xABBF, 1, -38864}, {0xFF21, 0xFF3A, 1, 32},
+    {0x10400, 0x10427, 1, 40}, {0x104B0, 0x104D3, 1, 40}, {0x10570, 0x1057A, 1, 39}, {0x1057C, 0x1058A, 1, 39},
+    {0x1058C, 0x10592, 1, 39}, {0x10594, 0x10595, 1, 39}, {0x10C80, 0x10CB2, 1, 64}, {0x118A0, 0x118BF, 1, 32},
+    {0x16E40, 0x16E5F, 1, 32}, {0x1E900, 0x1E921, 1, 34},
+};
+
+/** Code points that fold to more than one code point, CaseFolding.txt status F. Unused entries are zero. */
+struct CaseFoldExpansion
+{
+    u32 code_point;
+    u32 folded[3];
+};
+
+constexpr CaseFoldExpansion k_case_fold_expansions[] = {
+    {0x00DF, {0x0073, 0x0073, 0x0000}},
+    {0x0130, {0x0069, 0x0307, 0x0000}},
+    {0x0149, {0x02BC, 0x006E, 0x0000}},
+    {0x01F0, {0x006A, 0x030C, 0x0000}},
+    {0x0390, {0x03B9, 0x0308, 0x0301}},
+    {0x03B0, {0x03C5, 0x0308, 0x0301}},
+    {0x0587, {0x0565, 0x0582, 0x0000}},
+    {0x1E96, {0x0068, 0x0331, 0x0000}},
+    {0x1E97, {0x0074, 0x0308, 0x0000}},
+    {0x1E98, {0x0077, 0x030A, 0x0000}},
+    {0x1E99, {0x0079, 0x030A, 0x0000}},
+    {0x1E9A, {0x0061, 0x02BE, 0x0000}},
+    {0x1E9E, {0x0073, 0x0073, 0x0000}},
+    {0x1F50, {0x03C5, 0x0313, 0x0000}},
+    {0x1F52, {0x03C5, 0x0313, 0x0300}},
+    {0x1F54, {0x03C5, 0x0313, 0x0301}},
+    {0x1F56, {0x03C5, 0x0313, 0x0342}},
+    {0x1F80, {0x1F00, 0x03B9, 0x0000}},
+    {0x1F81, {0x1F01, 0x03B9, 0x0000}},
+    {0x1F82, {0x1F02, 0x03B9, 0x0000}},
+    {0x1F83, {0x1F03, 0x03B9, 0x0000}},
+    {0x1F84, {0x1F04, 0x03B9, 0x0000}},
+    {0x1F85, {0x1F05, 0x03B9, 0x0000}},
+    {0x1F86, {0x1F06, 0x03B9, 0x0000}},
+    {0x1F87, {0x1F07, 0x03B9, 0x0000}},
+    {0x1F88, {0x1F00, 0x03B9, 0x0000}},
+    {0x1F89, {0x1F01, 0x03B9, 0x0000}},
+    {0x1F8A, {0x1F02, 0x03B9, 0x0000}},
+    {0x1F8B, {0x1F03, 0x03B9, 0x0000}},
+    {0x1F8C, {0x1F04, 0x03B9, 0x0000}},
+    {0x1F8D, {0x1F05, 0x03B9, 0x0000}},
+    {0x1F8E, {0x1F06, 0x03B9, 0x0000}},
+    {0x1F8F, {0x1F07, 0x03B9, 0x0000}},
+    {0x1F90, {0x1F20, 0x03B9, 0x0000}},
+    {0x1F91, {0x1F21, 0x03B9, 0x0000}},
+    {0x1F92, {0x1F22, 0x03B9, 0x0000}},
+    {0x1F93, {0x1F23, 0x03B9, 0x0000}},
+    {0x1F94, {0x1F24, 0x03B9, 0x0000}},
+    {0x1F95, {0x1F25, 0x03B9, 0x0000}},
+    {0x1F96, {0x1F26, 0x03B9, 0x0000}},
+    {0x1F97, {0x1F27, 0x03B9, 0x0000}},
+    {0x1F98, {0x1F20, 0x03B9, 0x0000}},
+    {0x1F99, {0x1F21, 0x03B9, 0x0000}},
+    {0x1F9A, {0x1F22, 0x03B9, 0x0000}},
+    {0x1F9B, {0x1F23, 0x03B9, 0x0000}},
+    {0x1F9C, {0x1F24, 0x03B9, 0x0000}},
+    {0x1F9D, {0x1F25, 0x03B9, 0x0000}},
+    {0x1F9E, {0x1F26, 0x03B9, 0x0000}},
+    {0x1F9F, {0x1F27, 0x03B9, 0x0000}},
+    {0x1FA0, {0x1F60, 0x03B9, 0x0000}},
+    {0x1FA1, {0x1F61, 0x03B9, 0x0000}},
+    {0x1FA2, {0x1F62, 0x03B9, 0x0000}},
+    {0x1FA3, {0x1F63, 0x03B9, 0x0000}},
+    {0x1FA4, {0x1F64, 0x03B9, 0x0000}},
+    {0x1FA5, {0x1F65, 0x03B9, 0x0000}},
+    {0x1FA6, {0x1F66, 0x03B9, 0x0000}},
+    {0x1FA7, {0x1F67, 0x03B9, 0x0000}},
+    {0x1FA8, {0x1F60, 0x03B9, 0x0000}},
+    {0x1FA9, {0x1F61, 0x03B9, 0x0000}},
+    {0x1FAA, {0x1F62, 0x03B9, 0x0000}},
+    {0x1FAB, {0x1F63, 0x03B9, 0x0000}},
+    {0x1FAC, {0x1F64, 0x03B9, 0x0000}},
+    {0x1FAD, {0x1F65, 0x03B9, 0x0000}},
+    {0x1FAE, {0x1F66, 0x03B9, 0x0000}},
+    {0x1FAF, {0x1F67, 0x03B9, 0x0000}},
+    {0x1FB2, {0x1F70, 0x03B9, 0x0000}},
+    {0x1FB3, {0x03B1, 0x03B9, 0x0000}},
+    {0x1FB4, {0x03AC, 0x03B9, 0x0000}},
+    {0x1FB6, {0x03B1, 0x0342, 0x0000}},
+    {0x1FB7, {0x03B1, 0x0342, 0x03B9}},
+    {0x1FBC, {0x03B1, 0x03B9, 0x0000}},
+    {0x1FC2, {0x1F74, 0x03B9, 0x0000}},
+    {0x1FC3, {0x03B7, 0x03B9, 0x0000}},
+    {0x1FC4, {0x03AE, 0x03B9, 0x0000}},
+    {0x1FC6, {0x03B7, 0x0342, 0x0000}},
+    {0x1FC7, {0x03B7, 0x0342, 0x03B9}},
+    {0x1FCC, {0x03B7, 0x03B9, 0x0000}},
+    {0x1FD2, {0x03B9, 0x0308, 0x0300}},
+    {0x1FD3, {0x03B9, 0x0308, 0x0301}},
+    {0x1FD6, {0x03B9, 0x0342, 0x0000}},
+    {0x1FD7, {0x03B9, 0x0308, 0x0342}},
+    {0x1FE2, {0x03C5, 0x0308, 0x0300}},
+    {0x1FE3, {0x03C5, 0x0308, 0x0301}},
+    {0x1FE4, {0x03C1, 0x0313, 0x0000}},
+    {0x1FE6, {0x03C5, 0x0342, 0x0000}},
+    {0x1FE7, {0x03C5, 0x0308, 0x0342}},
+    {0x1FF2, {0x1F7C, 0x03B9, 0x0000}},
+    {0x1FF3, {0x03C9, 0x03B9, 0x0000}},
+    {0x1FF4, {0x03CE, 0x03B9, 0x0000}},
+    {0x1FF6, {0x03C9, 0x0342, 0x0000}},
+    {0x1FF7, {0x03C9, 0x0342, 0x03B9}},
+    {0x1FFC, {0x03C9, 0x03B9, 0x0000}},
+    {0xFB00, {0x0066, 0x0066, 0x0000}},
+    {0xFB01, {0x0066, 0x0069, 0x0000}},
+    {0xFB02, {0x0066, 0x006C, 0x0000}},
+    {0xFB03, {0x0066, 0x0066, 0x0069}},
+    {0xFB04, {0x0066, 0x0066, 0x006C}},
+    {0xFB05, {0x0073, 0x0074, 0x0000}},
+    {0xFB06, {0x0073, 0x0074, 0x0000}},
+    {0xFB13, {0x0574, 0x0576, 0x0000}},
+    {0xFB14, {0x0574, 0x0565, 0x0000}},
+    {0xFB15, {0x0574, 0x056B, 0x0000}},
+    {0xFB16, {0x057E, 0x0576, 0x0000}},
+    {0xFB17, {0x0574, 0x056D, 0x0000}},
+};
+
+// Bytes that are not part of valid UTF-8 decode to this value plus the byte, above the highest code point, so that they
+// only ever match the same byte.
+constexpr u32 k_invalid_byte_base = 0x110000;
+
+constexpr u64 k_max_folded_size = 3;
+
+u8 ToLowerAscii(u8 value)
+{
+    return value >= 'A' && value <= 'Z' ? static_cast<u8>(value + ('a' - 'A')) : value;
+}
+
+/** Folds @p code_point with full case folding. @return Number of code points written to @p out_folded. */
+u64 FoldCodePoint(u32 code_point, u32 (&out_folded)[k_max_folded_size])
+{
+    if (code_point < 0x80)
+    {
+        out_folded[0] = ToLowerAscii(static_cast<u8>(code_point));
+        return 1;
+    }
+    out_folded[0] = code_point;
+    const CaseFoldExpansion* expansion =
+        std::upper_bound(std::begin(k_case_fold_expansions), std::end(k_case_fold_expansions), code_point,
+                         [](u32 value, const CaseFoldExpansion& entry) { return value < entry.code_point; });
+    if (expansion != std::begin(k_case_fold_expansions) && (expansion - 1)->code_point == code_point)
+    {
+        const u32* folded = (expansion - 1)->folded;
+        const u64 count = folded[2] != 0 ? 3 : 2;
+        for (u64 i = 0; i < count; ++i)
+        {
+            out_folded[i] = folded[i];
+        }
+        return count;
+    }
+    const CaseFoldRun* run = std::upper_bound(std::begin(k_case_fold_runs), std::end(k_case_fold_runs), code_point,
+                                              [](u32 value, const CaseFoldRun& entry) { return value < entry.first; });
+    if (run != std::begin(k_case_fold_runs))
+    {
+        --run;
+        if (code_point <= run->last && (code_point - run->first) % run->stride == 0)
+        {
+            out_folded[0] = static_cast<u32>(static_cast<i32>(code_point) + run->delta);
+        }
+    }
+    return 1;
+}
+
+/**
+ * Decodes one code point and advances @p data past it. Anything that is not a valid sequence decodes one byte to
+ * k_invalid_byte_base plus the byte.
+ */
+u32 DecodeUtf8(const u8*& data, const u8* end)
+{
+    const u8 lead = *data;
+    u64 size = 0;
+    u32 code_point = 0;
+    u32 min_code_point = 0;
+    if (lead < 0x80)
+    {
+        ++data;
+        return lead;
+    }
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        size = 2;
+        code_point = lead & 0x1Fu;
+        min_code_point = 0x80;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        size = 3;
+        code_point = lead & 0x0Fu;
+        min_code_point = 0x800;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        size = 4;
+        code_point = lead & 0x07u;
+        min_code_point = 0x10000;
+    }
+    if (size == 0 || static_cast<u64>(end - data) < size)
+    {
+        ++data;
+        return k_invalid_byte_base + lead;
+    }
+    for (u64 i = 1; i < size; ++i)
+    {
+        if ((data[i] & 0xC0u) != 0x80)
+        {
+            ++data;
+            return k_invalid_byte_base + lead;
+        }
+        code_point = (code_point << 6) | (data[i] & 0x3Fu);
+    }
+    if (code_point < min_code_point || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+    {
+        ++data;
+        return k_invalid_byte_base + lead;
+    }
+    data += size;
+    return code_point;
+}
+
+/** Produces the case folded code points of UTF-8 text one at a time. */
+class CaseFoldIterator
+{
+public:
+    CaseFoldIterator(const u8* data, const u8* end) : m_data(data), m_end(end) {}
+
+    /** True while code points of the last decoded code point are still to be returned. */
+    [[nodiscard]] bool HasPending() const { return m_pending_pos < m_pending_size; }
+
+    [[nodiscard]] const u8* GetPosition() const { return m_data; }
+    [[nodiscard]] u64 GetRemainingSize() const { return static_cast<u64>(m_end - m_data); }
+
+    /** Skips @p size bytes of input. Only valid when nothing is pending. */
+    void Skip(u64 size) { m_data += size; }
+
+    bool Next(u32& out_code_point)
+    {
+        if (m_pending_pos == m_pending_size)
+        {
+            if (m_data == m_end)
+            {
+                return false;
+            }
+            m_pending_size = FoldCodePoint(DecodeUtf8(m_data, m_end), m_pending);
+            m_pending_pos = 0;
+        }
+        out_code_point = m_pending[m_pending_pos++];
+        return true;
+    }
+
+private:
+    const u8* m_data;
+    const u8* m_end;
+    u32 m_pending[k_max_folded_size] = {};
+    u64 m_pending_pos = 0;
+    u64 m_pending_size = 0;
+};
+
+/**
+ * Compares ASCII bytes of two buffers ignoring case, a vector at a time. Stops at the first vector, or byte for the
+ * tail, that contains a non-ASCII byte in either buffer.
+ * @return Number of bytes that are equal ignoring case, or k_not_found if ASCII bytes differ.
+ */
+u64 MatchAsciiIgnoreCase(const u8* first, const u8* second, u64 size)
+{
+    u64 pos = 0;
+#if defined(OPAL_STRING_SIMD)
+    for (; pos + k_vector_width <= size; pos += k_vector_width)
+    {
+        const ByteVector a = Load(first + pos);
+        const ByteVector b = Load(second + pos);
+        if (NonAsciiMask(a) != 0 || NonAsciiMask(b) != 0)
+        {
+            return pos;
+        }
+        if (EqualMask(ToLowerAscii(a), ToLowerAscii(b)) != k_all_equal_mask)
+        {
+            return k_not_found;
+        }
+    }
+#endif
+    for (; pos < size; ++pos)
+    {
+        if (first[pos] >= 0x80 || second[pos] >= 0x80)
+        {
+            return pos;
+        }
+        if (ToLowerAscii(first[pos]) != ToLowerAscii(second[pos]))
+        {
+            return k_not_found;
+        }
+    }
+    return pos;
+}
+
+/**
+ * Hashes the UTF-8 encoding of case folded text. The text is hashed in blocks of k_block_size bytes of folded text
+ * that are chained through the seed, so the result only depends on the folded text and not on how it was produced.
+ */
+class CaseFoldHasher
+{
+public:
+    explicit CaseFoldHasher(u64 seed) : m_hash(seed) {}
+
+    void Append(const u8* data, u64 size)
+    {
+        while (size > 0)
+        {
+            const u64 count = k_block_size - m_size < size ? k_block_size - m_size : size;
+            std::memcpy(m_block + m_size, data, count);
+            m_size += count;
+            data += count;
+            size -= count;
+            if (m_size == k_block_size)
+            {
+                m_hash = Hash::CalcRawArray(m_block, k_block_size, m_hash);
+                m_size = 0;
+            }
+        }
+    }
+
+    void AppendCodePoint(u32 code_point)
+    {
+        u8 bytes[4];
+        u64 size = 0;
+        if (code_point >= k_invalid_byte_base)
+        {
+            bytes[size++] = static_cast<u8>(code_point - k_invalid_byte_base);
+        }
+        else if (code_point < 0x80)
+        {
+            bytes[size++] = static_cast<u8>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            bytes[size++] = static_cast<u8>(0xC0 | (code_point >> 6));
+            bytes[size++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000)
+        {
+            bytes[size++] = static_cast<u8>(0xE0 | (code_point >> 12));
+            bytes[size++] = static_cast<u8>(0x80 | ((code_point >> 6) & 0x3F));
+            bytes[size++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            bytes[size++] = static_cast<u8>(0xF0 | (code_point >> 18));
+            bytes[size++] = static_cast<u8>(0x80 | ((code_point >> 12) & 0x3F));
+            bytes[size++] = static_cast<u8>(0x80 | ((code_point >> 6) & 0x3F));
+            bytes[size++] = static_cast<u8>(0x80 | (code_point & 0x3F));
+        }
+        Append(bytes, size);
+    }
+
+    /** Hashes the last, possibly empty, block. */
+    u64 Finish() { return Hash::CalcRawArray(m_block, m_size, m_hash); }
+
+private:
+    static constexpr u64 k_block_size = 256;
+
+    u8 m_block[k_block_size];
+    u64 m_size = 0;
+    u64 m_hash;
+};
+
+/** Appends lower case ASCII to @p hasher until the first non-ASCII byte. @return Number of bytes consumed. */
+u64 HashAsciiIgnoreCase(CaseFoldHasher& hasher, const u8* data, u64 size)
+{
+    u64 pos = 0;
+#if defined(OPAL_STRING_SIMD)
+    u8 lowered[k_vector_width];
+    for (; pos + k_vector_width <= size; pos += k_vector_width)
+    {
+        const ByteVector chunk = Load(data + pos);
+        if (NonAsciiMask(chunk) != 0)
+        {
+            break;
+        }
+        Store(lowered, ToLowerAscii(chunk));
+        hasher.Append(lowered, k_vector_width);
+    }
+#endif
+    for (; pos < size && data[pos] < 0x80; ++pos)
+    {
+        const u8 value = ToLowerAscii(data[pos]);
+        hasher.Append(&value, 1);
+    }
+    return pos;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------------------------------
+// Search entry points.
+// ------------------------------------------------------------------------------------------------
+
+u64 Impl::FindByte(const u8* data, u64 size, u8 value)
+{
+    // The C library version is already vectorized and is hard to beat for a single byte
+    const void* match = size > 0 ? std::memchr(data, value, size) : nullptr;
+    return match != nullptr ? static_cast<u64>(static_cast<const u8*>(match) - data) : k_not_found;
+}
+
+u64 Impl::ReverseFindByte(const u8* data, u64 size, u8 value)
+{
+    u64 end = size;
+#if defined(OPAL_STRING_SIMD)
+    const ByteVector pattern = Splat(value);
+    for (; end >= k_vector_width; end -= k_vector_width)
+    {
+        const u32 mask = EqualMask(Load(data + end - k_vector_width), pattern);
+        if (mask != 0)
+        {
+            return end - k_vector_width + GetHighestSetBit(mask);
+        }
+    }
+#endif
+    while (end-- > 0)
+    {
+        if (data[end] == value)
+        {
+            return end;
+        }
+    }
+    return k_not_found;
+}
+
+u64 Impl::FindBytes(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    if (needle_size > size)
+    {
+        return k_not_found;
+    }
+    if (needle_size == 1)
+    {
+        return FindByte(data, size, needle[0]);
+    }
+    if (needle_size >= k_horspool_min_needle_size)
+    {
+        return FindWithHorspool(data, size, needle, needle_size);
+    }
+    return FindWithFilter(data, size, needle, needle_size);
+}
+
+u64 Impl::ReverseFindBytes(const u8* data, u64 size, const u8* needle, u64 needle_size)
+{
+    if (needle_size > size)
+    {
+        return k_not_found;
+    }
+    if (needle_size == 1)
+    {
+        return ReverseFindByte(data, size, needle[0]);
+    }
+    if (needle_size >= k_horspool_min_needle_size)
+    {
+        return ReverseFindWithHorspool(data, size, needle, needle_size);
+    }
+    return ReverseFindWithFilter(data, size, needle, needle_size);
+}
+
+u64 Impl::FindAnyByte(const u8* data, u64 size, const u8* set, u64 set_size)
+{
+    if (set_size == 0)
+    {
+        return k_not_found;
+    }
+    if (set_size == 1)
+    {
+        return FindByte(data, size, set[0]);
+    }
+    if (set_size <= k_max_vector_set_size)
+    {
+        return FindAnyWithVectors(data, size, set, set_size);
+    }
+    return FindAnyWithTable(data, size, set, set_size);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Comparison entry points.
+// ------------------------------------------------------------------------------------------------
+
+u64 Impl::FindFirstMismatch(const u8* first, const u8* second, u64 size)
+{
+    u64 pos = 0;
+#if defined(OPAL_STRING_SIMD)
+    for (; pos + k_vector_width <= size; pos += k_vector_width)
+    {
+        const u32 mask = EqualMask(Load(first + pos), Load(second + pos));
+        if (mask != k_all_equal_mask)
+        {
+            return pos + CountTrailingZeros(~mask & k_all_equal_mask);
+        }
+    }
+#endif
+    for (; pos < size; ++pos)
+    {
+        if (first[pos] != second[pos])
+        {
+            return pos;
+        }
+    }
+    return k_not_found;
+}
+
+bool EqualsIgnoreCase(StringViewUtf8 first, StringViewUtf8 second)
+{
+    const u8* first_data = reinterpret_cast<const u8*>(first.GetData());
+    const u8* second_data = reinterpret_cast<const u8*>(second.GetData());
+    CaseFoldIterator first_it(first_data, first_data + first.GetSize());
+    CaseFoldIterator second_it(second_data, second_data + second.GetSize());
+    for (;;)
+    {
+        // Runs of ASCII are compared a vector at a time. Both iterators are at the same position of the folded text
+        // here, so the runs line up even when the byte offsets differ.
+        if (!first_it.HasPending() && !second_it.HasPending())
+        {
+            const u64 common_size = first_it.GetRemainingSize() < second_it.GetRemainingSize() ? first_it.GetRemainingSize()
+                                                                                                 : second_it.GetRemainingSize();
+            const u64 matched = MatchAsciiIgnoreCase(first_it.GetPosition(), second_it.GetPosition(), common_size);
+            if (matched == k_not_found)
+            {
+                return false;
+            }
+            first_it.Skip(matched);
+            second_it.Skip(matched);
+        }
+        u32 first_code_point = 0;
+        u32 second_code_point = 0;
+        const bool has_first = first_it.Next(first_code_point);
+        const bool has_second = second_it.Next(second_code_point);
+        if (has_first != has_second)
+        {
+            return false;
+        }
+        if (!has_first)
+        {
+            return true;
+        }
+        if (first_code_point != second_code_point)
+        {
+            return false;
+        }
+    }
+}
+
+u64 HashIgnoreCase(StringViewUtf8 str, u64 seed)
+{
+    const u8* data = reinterpret_cast<const u8*>(str.GetData());
+    const u8* end = data + str.GetSize();
+    CaseFoldHasher hasher(seed);
+    while (data != end)
+    {
+        data += HashAsciiIgnoreCase(hasher, data, static_cast<u64>(end - data));
+        if (data == end)
+        {
+            break;
+        }
+        u32 folded[k_max_folded_size];
+        const u64 count = FoldCodePoint(DecodeUtf8(data, end), folded);
+        for (u64 i = 0; i < count; ++i)
+        {
+            hasher.AppendCodePoint(folded[i]);
+        }
+    }
+    return hasher.Finish();
+}
+
+}  // namespace Opal
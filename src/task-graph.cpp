@@ -0,0 +1,181 @@
+#include "opal/threading/task-graph.h"
+
+#include "opal/exceptions.h"
+
+void Opal::Impl::TaskGraphNode::Execute(TransmitterType& transmitter)
+{
+    if (!graph->m_has_exception.load(std::memory_order_relaxed))
+    {
+        try
+        {
+            Run();
+        }
+        catch (...)
+        {
+            graph->SetException(std::current_exception());
+        }
+    }
+    for (const u32 successor : successors)
+    {
+        IntrusivePtr<TaskGraphNode>& node = graph->m_nodes[successor];
+        if (node->remaining_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            transmitter.Send(IntrusivePtr<Task>(node.Clone()));
+        }
+    }
+    // The graph can be destroyed as soon as the last node finished, so it must not be touched after this
+    graph->FinishNode();
+}
+
+Opal::TaskGraph::TaskGraph(AllocatorBase* allocator)
+    : m_allocator(allocator != nullptr ? allocator : GetDefaultAllocator()),
+      m_nodes(m_allocator),
+      m_roots(m_allocator),
+      m_completion(m_allocator)
+{
+}
+
+Opal::TaskGraph::~TaskGraph()
+{
+    while (IsRunning())
+    {
+        m_completion->is_running.wait(true, std::memory_order_acquire);
+    }
+}
+
+Opal::TaskGraph::NodeId Opal::TaskGraph::AddJoinNode(ArrayView<const NodeId> predecessors)
+{
+    const NodeId node = AddNodeImpl(MakeIntrusive<Impl::TaskGraphNode>(m_allocator, this, m_allocator));
+    for (const NodeId predecessor : predecessors)
+    {
+        AddDependency(predecessor, node);
+    }
+    return node;
+}
+
+void Opal::TaskGraph::AddDependency(NodeId predecessor, NodeId successor)
+{
+    OPAL_ASSERT(!IsRunning(), "Graph can't be modified while it runs");
+    if (predecessor >= m_nodes.GetSize())
+    {
+        throw OutOfBoundsException(u64{predecessor}, u64{0}, m_nodes.GetSize());
+    }
+    if (successor >= m_nodes.GetSize())
+    {
+        throw OutOfBoundsException(u64{successor}, u64{0}, m_nodes.GetSize());
+    }
+    m_nodes[predecessor]->successors.PushBack(successor);
+    m_nodes[successor]->predecessor_count++;
+    m_is_validated = false;
+}
+
+void Opal::TaskGraph::Submit(ThreadPool& pool)
+{
+    OPAL_ASSERT(!IsRunning(), "Graph is already running");
+    if (!m_is_validated)
+    {
+        Validate();
+    }
+    if (m_nodes.IsEmpty())
+    {
+        return;
+    }
+    m_has_exception.store(false, std::memory_order_relaxed);
+    m_exception = nullptr;
+    for (IntrusivePtr<Impl::TaskGraphNode>& node : m_nodes)
+    {
+        node->remaining_predecessors.store(node->predecessor_count, std::memory_order_relaxed);
+    }
+    m_pending_count.store(static_cast<u32>(m_nodes.GetSize()), std::memory_order_relaxed);
+    m_completion->is_running.store(true, std::memory_order_relaxed);
+    // Submitting publishes the stores above to the workers
+    for (const NodeId root : m_roots)
+    {
+        pool.AddTask(IntrusivePtr<Task>(m_nodes[root].Clone()));
+    }
+}
+
+void Opal::TaskGraph::Wait()
+{
+    while (IsRunning())
+    {
+        m_completion->is_running.wait(true, std::memory_order_acquire);
+    }
+    if (m_exception)
+    {
+        std::rethrow_exception(m_exception);
+    }
+}
+
+void Opal::TaskGraph::Clear()
+{
+    OPAL_ASSERT(!IsRunning(), "Graph can't be modified while it runs");
+    m_nodes.Clear();
+    m_roots.Clear();
+    m_exception = nullptr;
+    m_is_validated = false;
+}
+
+Opal::TaskGraph::NodeId Opal::TaskGraph::AddNodeImpl(IntrusivePtr<Impl::TaskGraphNode> node)
+{
+    OPAL_ASSERT(!IsRunning(), "Graph can't be modified while it runs");
+    m_nodes.PushBack(std::move(node));
+    m_is_validated = false;
+    return static_cast<NodeId>(m_nodes.GetSize() - 1);
+}
+
+void Opal::TaskGraph::Validate()
+{
+    // Kahn's algorithm: if repeatedly removing nodes without predecessors does not remove every node, the rest is a cycle
+    m_roots.Clear();
+    DynamicArray<u32> remaining(m_nodes.GetSize(), m_allocator);
+    DynamicArray<NodeId> ready(m_allocator);
+    for (u64 i = 0; i < m_nodes.GetSize(); ++i)
+    {
+        remaining[i] = m_nodes[i]->predecessor_count;
+        if (remaining[i] == 0)
+        {
+            m_roots.PushBack(static_cast<NodeId>(i));
+            ready.PushBack(static_cast<NodeId>(i));
+        }
+    }
+    u64 visited_count = 0;
+    while (!ready.IsEmpty())
+    {
+        const NodeId node = ready.Back();
+        ready.PopBack();
+        ++visited_count;
+        for (const u32 successor : m_nodes[node]->successors)
+        {
+            if (--remaining[successor] == 0)
+            {
+                ready.PushBack(successor);
+            }
+        }
+    }
+    if (visited_count != m_nodes.GetSize())
+    {
+        throw InvalidArgumentException("TaskGraph::Submit", "Task graph has a cycle");
+    }
+    m_is_validated = true;
+}
+
+void Opal::TaskGraph::SetException(std::exception_ptr exception)
+{
+    bool has_exception = false;
+    if (m_has_exception.compare_exchange_strong(has_exception, true, std::memory_order_relaxed))
+    {
+        m_exception = std::move(exception);
+    }
+}
+
+void Opal::TaskGraph::FinishNode()
+{
+    if (m_pending_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // Keep the flag alive, the waiter may return and destroy the graph before notify_all is done
+        IntrusivePtr<Impl::TaskGraphCompletion> completion = m_completion.Clone();
+        completion->is_running.store(false, std::memory_order_release);
+        completion->is_running.notify_all();
+    }
+}
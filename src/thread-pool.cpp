@@ -1,37 +1,320 @@
 #include "opal/threading/thread-pool.h"
 
-using ReceiverType = Opal::ReceiverMPMC<Opal::SharedPtr<Opal::Task>, true>;
-using TransmitterType = Opal::TransmitterMPMC<Opal::SharedPtr<Opal::Task>, true>;
-static void ThreadFunction(ReceiverType receiver, TransmitterType transmitter, Opal::Ref<Opal::AllocatorBase> default_allocator)
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "opal/container/deque.h"
+#include "opal/exceptions.h"
+#include "opal/rng.h"
+#include "opal/threading/channel-mpmc.h"
+#include "opal/threading/mutex.h"
+#include "opal/threading/work-stealing-deque.h"
+#include "opal/time.h"
+
+namespace Opal::Impl
 {
-    OPAL_ASSERT(default_allocator->IsThreadSafe(), "Allocator must be thread safe");
-    Opal::PushDefaultAllocator(default_allocator.GetPtr());
-    while (true)
+
+struct ThreadPoolWorker
+{
+    ThreadPoolWorker(ThreadPool* in_pool, u32 in_index, const SystemMemoryAllocatorDesc& scratch_desc, AllocatorBase* allocator)
+        : pool(in_pool),
+          index(in_index),
+          deque(256, allocator),
+          rng(in_index),
+          victims(allocator),
+          scratch("ThreadPoolScratch", scratch_desc)
+    {
+    }
+
+    ThreadPool* pool;
+    u32 index;
+    /** Logical core the worker is pinned to. */
+    u32 core = ThreadPool::k_invalid_core;
+    WorkStealingDeque<Task*> deque;
+    RNG rng;
+    /**
+     * Indices of the workers to steal from, nearest first: workers on the same physical core, then on the same package,
+     * then all others. Empty unless the pool uses work stealing.
+     */
+    DynamicArray<u32> victims;
+    u32 sibling_victims_end = 0;
+    u32 package_victims_end = 0;
+    /** Tasks picked since the last pick that favored the lowest lane. */
+    u32 pick_count = 0;
+    /** Scratch allocator of the worker thread. Only touched by that thread. */
+    LinearAllocator scratch;
+};
+
+struct ThreadPoolDeadlineEntry
+{
+    f64 deadline;
+    /** Keeps tasks with equal deadlines in submission order. */
+    u64 sequence;
+    Task* task;
+};
+
+struct ThreadPoolDeadlineHeap
+{
+    explicit ThreadPoolDeadlineHeap(AllocatorBase* allocator) : entries(allocator) {}
+
+    /** Binary min-heap ordered by deadline, then sequence. */
+    DynamicArray<ThreadPoolDeadlineEntry> entries;
+    u64 next_sequence = 0;
+};
+
+struct ThreadPoolLane
+{
+    ThreadPoolLane(size_t capacity, AllocatorBase* allocator)
+        : queue(capacity, allocator), deadline_heap(allocator), overflow(allocator)
+    {
+    }
+
+    QueueMPMC<Task*, true> queue;
+    Mutex<ThreadPoolDeadlineHeap> deadline_heap;
+    /** Number of entries in the heap. Lets workers skip the lock when no task has a deadline. */
+    std::atomic<u64> deadline_count = 0;
+    /** Tasks of AddTaskNonBlocking() that did not fit in the queue, oldest first. */
+    Mutex<Deque<Task*>> overflow;
+    /** Number of tasks in the overflow. Lets workers and submitters skip the lock while the queue has room. */
+    std::atomic<u64> overflow_count = 0;
+};
+
+struct ThreadPoolTimers
+{
+    explicit ThreadPoolTimers(AllocatorBase* allocator) : heap(allocator) {}
+
+    /** Ordered by due time. */
+    Mutex<ThreadPoolDeadlineHeap> heap;
+    std::atomic<u64> count = 0;
+    /** Due time of the top of the heap, infinity when empty. Lets workers skip the lock while nothing is due. */
+    std::atomic<f64> next_time = std::numeric_limits<f64>::infinity();
+};
+
+}  // namespace Opal::Impl
+
+namespace
+{
+thread_local Opal::Impl::ThreadPoolWorker* t_current_worker = nullptr;
+
+/** Completes a task that will never run, and releases the reference the pool held. */
+void CancelTask(Opal::Task* raw_task)
+{
+    Opal::IntrusivePtr<Opal::Task> task = Opal::IntrusivePtr<Opal::Task>::Adopt(raw_task);
+    task->SetException(std::make_exception_ptr(Opal::ThreadPoolClosedException()));
+    task->SetCompleted();
+}
+
+/** Heap comparator, puts the entry that is due first on top. */
+bool IsDueLater(const Opal::Impl::ThreadPoolDeadlineEntry& a, const Opal::Impl::ThreadPoolDeadlineEntry& b)
+{
+    if (a.deadline != b.deadline)
     {
-        auto result = receiver.Receive();
-        if (!result.HasValue())
+        return a.deadline > b.deadline;
+    }
+    return a.sequence > b.sequence;
+}
+
+/** Physical cores with at least one logical core, ordered by package, then by their lowest logical core. */
+Opal::DynamicArray<const Opal::PhysicalCoreInfo*> SortCoresByPackage(const Opal::CpuInfo& cpu_info, Opal::AllocatorBase* allocator)
+{
+    Opal::DynamicArray<const Opal::PhysicalCoreInfo*> cores(allocator);
+    for (const Opal::PhysicalCoreInfo& core : cpu_info.physical_processors)
+    {
+        if (core.logical_cores.Any())
         {
-            // Channel closed, exit the thread
+            cores.PushBack(&core);
+        }
+    }
+    std::sort(cores.begin(), cores.end(),
+              [](const Opal::PhysicalCoreInfo* a, const Opal::PhysicalCoreInfo* b)
+              {
+                  if (a->package_id != b->package_id)
+                  {
+                      return a->package_id < b->package_id;
+                  }
+                  return a->logical_cores.FindFirstSet() < b->logical_cores.FindFirstSet();
+              });
+    return cores;
+}
+
+/** Returns the @p rank-th logical core of @p core, or k_invalid_core if it has fewer. */
+Opal::u32 GetLogicalCore(const Opal::PhysicalCoreInfo& core, Opal::u32 rank)
+{
+    for (const Opal::u64 logical_core : core.logical_cores)
+    {
+        if (rank-- == 0)
+        {
+            return static_cast<Opal::u32>(logical_core);
+        }
+    }
+    return Opal::ThreadPool::k_invalid_core;
+}
+
+const Opal::PhysicalCoreInfo* FindPhysicalCore(const Opal::CpuInfo& cpu_info, Opal::u32 logical_core)
+{
+    for (const Opal::PhysicalCoreInfo& core : cpu_info.physical_processors)
+    {
+        if (logical_core < core.logical_cores.GetSize() && core.logical_cores.Test(logical_core))
+        {
+            return &core;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+Opal::DynamicArray<Opal::u32> Opal::GetThreadPoolPlacement(const CpuInfo& cpu_info, ThreadPoolPinning pinning, size_t thread_count,
+                                                         AllocatorBase* allocator)
+{
+    DynamicArray<u32> order(allocator);
+    const DynamicArray<const PhysicalCoreInfo*> cores = SortCoresByPackage(cpu_info, allocator);
+    switch (pinning)
+    {
+        case ThreadPoolPinning::None:
+        {
+            return order;
+        }
+        case ThreadPoolPinning::PhysicalCores:
+        {
+            for (const PhysicalCoreInfo* core : cores)
+            {
+                order.PushBack(static_cast<u32>(core->logical_cores.FindFirstSet()));
+            }
             break;
         }
-        Opal::SharedPtr<Opal::Task> task = std::move(result.GetValue());
-        if (!task.IsValid())
+        case ThreadPoolPinning::LogicalCores:
         {
-            // Sentinel received, exit the thread
+            for (const PhysicalCoreInfo* core : cores)
+            {
+                for (const u64 logical_core : core->logical_cores)
+                {
+                    order.PushBack(static_cast<u32>(logical_core));
+                }
+            }
+            std::sort(order.begin(), order.end());
             break;
         }
-        task->Execute(transmitter);
-        task->SetCompleted();
+        case ThreadPoolPinning::Compact:
+        {
+            for (const PhysicalCoreInfo* core : cores)
+            {
+                for (const u64 logical_core : core->logical_cores)
+                {
+                    order.PushBack(static_cast<u32>(logical_core));
+                }
+            }
+            break;
+        }
+        case ThreadPoolPinning::Scatter:
+        {
+            // Split the sorted cores into one range per package, then deal the cores out round-robin over the packages,
+            // first the first logical core of every physical core, then the second, and so on
+            DynamicArray<u32> package_starts(allocator);
+            u32 max_siblings = 0;
+            for (u32 i = 0; i < cores.GetSize(); ++i)
+            {
+                if (i == 0 || cores[i]->package_id != cores[i - 1]->package_id)
+                {
+                    package_starts.PushBack(i);
+                }
+                max_siblings = std::max(max_siblings, static_cast<u32>(cores[i]->logical_cores.PopCount()));
+            }
+            package_starts.PushBack(static_cast<u32>(cores.GetSize()));
+            for (u32 rank = 0; rank < max_siblings; ++rank)
+            {
+                for (u32 offset = 0; offset < cores.GetSize(); ++offset)
+                {
+                    for (u32 package = 0; package + 1 < package_starts.GetSize(); ++package)
+                    {
+                        const u32 index = package_starts[package] + offset;
+                        if (index >= package_starts[package + 1])
+                        {
+                            continue;
+                        }
+                        const u32 logical_core = GetLogicalCore(*cores[index], rank);
+                        if (logical_core != ThreadPool::k_invalid_core)
+                        {
+                            order.PushBack(logical_core);
+                        }
+                    }
+                }
+            }
+            break;
+        }
+    }
+    if (order.IsEmpty())
+    {
+        return order;
     }
+    const size_t count = thread_count != 0 ? thread_count : order.GetSize();
+    DynamicArray<u32> placement(allocator);
+    placement.Reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        placement.PushBack(order[i % order.GetSize()]);
+    }
+    return placement;
 }
 
 Opal::ThreadPool::ThreadPool(size_t thread_count, size_t channel_capacity, AllocatorBase* allocator)
-    : m_allocator(allocator != nullptr ? allocator : GetDefaultAllocator()), m_communicator(channel_capacity, m_allocator)
+    : ThreadPool(thread_count, ThreadPoolScheduling::SharedQueue, channel_capacity, allocator)
+{
+}
+
+Opal::ThreadPool::ThreadPool(size_t thread_count, ThreadPoolScheduling scheduling, size_t channel_capacity, AllocatorBase* allocator)
+    : ThreadPool(ThreadPoolDesc{.thread_count = thread_count,
+                                .scheduling = scheduling,
+                                .channel_capacity = channel_capacity,
+                                .allocator = allocator})
 {
+}
+
+Opal::ThreadPool::ThreadPool(const ThreadPoolDesc& desc)
+    : m_allocator(desc.allocator != nullptr ? desc.allocator : GetDefaultAllocator()),
+      m_scheduling(desc.scheduling),
+      m_pinning(desc.pinning),
+      m_scratch_reset(desc.scratch_reset),
+      m_starvation_limit(desc.starvation_limit == 1 ? 2 : desc.starvation_limit),
+      m_idle_spin_wait(desc.idle_spin_wait),
+      m_threads(m_allocator),
+      m_workers(m_allocator),
+      m_lanes(m_allocator),
+      m_wake_signal(SpinWaitPolicy{.spin_count = 0})
+{
+    OPAL_ASSERT(m_allocator->IsThreadSafe(), "Allocator must be thread safe");
+    m_timers = New<Impl::ThreadPoolTimers>(m_allocator, m_allocator);
+    for (u32 i = 0; i < k_lane_count; ++i)
+    {
+        m_lanes.PushBack(New<Impl::ThreadPoolLane>(m_allocator, desc.channel_capacity, m_allocator));
+    }
+    CpuInfo cpu_info;
+    DynamicArray<u32> placement(m_allocator);
+    if (m_pinning != ThreadPoolPinning::None)
+    {
+        cpu_info = GetCpuInfo();
+        placement = GetThreadPoolPlacement(cpu_info, m_pinning, desc.thread_count, m_allocator);
+    }
+    size_t thread_count = desc.thread_count;
+    if (thread_count == 0)
+    {
+        thread_count = !placement.IsEmpty() ? placement.GetSize() : std::max(1u, std::thread::hardware_concurrency());
+    }
     for (size_t i = 0; i < thread_count; ++i)
     {
-        ThreadHandle thread_handle = CreateThread(ThreadFunction, m_communicator.receiver.Clone(), m_communicator.transmitter.Clone(),
-                                                        Opal::GetDefaultAllocator());
+        Impl::ThreadPoolWorker* worker =
+            New<Impl::ThreadPoolWorker>(m_allocator, this, static_cast<u32>(i), desc.scratch_allocator_desc, m_allocator);
+        worker->core = !placement.IsEmpty() ? placement[i] : k_invalid_core;
+        m_workers.PushBack(worker);
+    }
+    if (m_scheduling == ThreadPoolScheduling::WorkStealing)
+    {
+        AssignVictims(cpu_info);
+    }
+    for (Impl::ThreadPoolWorker* worker : m_workers)
+    {
+        ThreadHandle thread_handle = CreateThread(RunWorker, worker, Ref<AllocatorBase>(GetDefaultAllocator()));
         m_threads.PushBack(std::move(thread_handle));
     }
 }
@@ -39,23 +322,545 @@ Opal::ThreadPool::ThreadPool(size_t thread_count, size_t channel_capacity, Alloc
 Opal::ThreadPool::~ThreadPool()
 {
     Close();
+    // Catches tasks that raced with an earlier Close()
+    CancelPendingTasks();
+    for (Impl::ThreadPoolWorker* worker : m_workers)
+    {
+        Delete(m_allocator, worker);
+    }
+    for (Impl::ThreadPoolLane* lane : m_lanes)
+    {
+        Delete(m_allocator, lane);
+    }
+    Delete(m_allocator, m_timers);
 }
 
-void Opal::ThreadPool::Close()
+void Opal::ThreadPool::AddTask(IntrusivePtr<Task> task, TaskPriority priority)
+{
+    OPAL_ASSERT(task.IsValid(), "Task must be valid");
+    Task* raw_task = task.Detach();
+    if (m_is_closed.load(std::memory_order_acquire))
+    {
+        CancelTask(raw_task);
+        return;
+    }
+    Impl::ThreadPoolWorker* worker = t_current_worker;
+    if (m_scheduling == ThreadPoolScheduling::WorkStealing && priority == TaskPriority::Normal && worker != nullptr &&
+        worker->pool == this)
+    {
+        worker->deque.Push(raw_task);
+    }
+    else
+    {
+        m_lanes[static_cast<u32>(priority)]->queue.Push(raw_task);
+    }
+    WakeWorker();
+}
+
+void Opal::ThreadPool::AddTaskNonBlocking(IntrusivePtr<Task> task, TaskPriority priority)
+{
+    OPAL_ASSERT(task.IsValid(), "Task must be valid");
+    Task* raw_task = task.Detach();
+    if (m_is_closed.load(std::memory_order_acquire))
+    {
+        CancelTask(raw_task);
+        return;
+    }
+    Impl::ThreadPoolWorker* worker = t_current_worker;
+    if (m_scheduling == ThreadPoolScheduling::WorkStealing && priority == TaskPriority::Normal && worker != nullptr &&
+        worker->pool == this)
+    {
+        worker->deque.Push(raw_task);
+        WakeWorker();
+        return;
+    }
+    Impl::ThreadPoolLane& lane = *m_lanes[static_cast<u32>(priority)];
+    // Tasks that already overflowed go first, so the queue only takes the task while the overflow is empty
+    if (lane.overflow_count.load(std::memory_order_acquire) != 0 || !lane.queue.TryPush(raw_task))
+    {
+        MutexGuard<Deque<Task*>> guard = lane.overflow.Lock();
+        guard.Deref()->PushBack(raw_task);
+        lane.overflow_count.fetch_add(1, std::memory_order_seq_cst);
+    }
+    WakeWorker();
+}
+
+void Opal::ThreadPool::AddTaskWithDeadline(IntrusivePtr<Task> task, f64 deadline, TaskPriority priority)
+{
+    OPAL_ASSERT(task.IsValid(), "Task must be valid");
+    if (m_is_closed.load(std::memory_order_acquire))
+    {
+        CancelTask(task.Detach());
+        return;
+    }
+    Impl::ThreadPoolLane& lane = *m_lanes[static_cast<u32>(priority)];
+    {
+        MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = lane.deadline_heap.Lock();
+        Impl::ThreadPoolDeadlineHeap& heap = *guard.Deref();
+        heap.entries.PushBack({.deadline = deadline, .sequence = heap.next_sequence++, .task = task.Detach()});
+        std::push_heap(heap.entries.GetData(), heap.entries.GetData() + heap.entries.GetSize(), IsDueLater);
+        // Counted under the lock so that a worker popping the entry right away can't decrement first
+        lane.deadline_count.fetch_add(1, std::memory_order_seq_cst);
+    }
+    WakeWorker();
+}
+
+void Opal::ThreadPool::AddTaskAt(IntrusivePtr<Task> task, f64 time)
 {
-    if (m_is_closed)
+    OPAL_ASSERT(task.IsValid(), "Task must be valid");
+    if (m_is_closed.load(std::memory_order_acquire))
     {
+        CancelTask(task.Detach());
         return;
     }
-    m_is_closed = true;
-    // Send one sentinel per thread to unblock all workers
-    for (size_t i = 0; i < m_threads.GetSize(); ++i)
     {
-        m_communicator.transmitter.Send(SharedPtr<Task>{});
+        MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = m_timers->heap.Lock();
+        Impl::ThreadPoolDeadlineHeap& heap = *guard.Deref();
+        heap.entries.PushBack({.deadline = time, .sequence = heap.next_sequence++, .task = task.Detach()});
+        std::push_heap(heap.entries.GetData(), heap.entries.GetData() + heap.entries.GetSize(), IsDueLater);
+        m_timers->next_time.store(heap.entries[0].deadline, std::memory_order_seq_cst);
+        m_timers->count.fetch_add(1, std::memory_order_seq_cst);
     }
+    // A sleeping worker might wait for a later timer, wake it so it picks up the new due time
+    WakeWorker();
+}
+
+Opal::u32 Opal::ThreadPool::GetWorkerCore(size_t worker_index) const
+{
+    if (worker_index >= m_workers.GetSize())
+    {
+        throw OutOfBoundsException(u64{worker_index}, u64{0}, m_workers.GetSize());
+    }
+    return m_workers[worker_index]->core;
+}
+
+Opal::Impl::ThreadPoolTimerAwaiter Opal::ThreadPool::Delay(f64 milliseconds)
+{
+    return {*this, GetMilliSeconds() + milliseconds};
+}
+
+void Opal::ThreadPool::Close()
+{
+    if (m_is_closed.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    m_is_stopping.store(true, std::memory_order_seq_cst);
+    m_wake_signal.NotifyAll();
     for (const ThreadHandle& thread : m_threads)
     {
         JoinThread(thread);
     }
     m_threads.Clear();
+    m_is_closed.store(true, std::memory_order_seq_cst);
+    CancelPendingTasks();
+}
+
+void Opal::ThreadPool::CancelPendingTasks()
+{
+    // Another thread can submit a task after the last worker found the pool empty but before m_is_closed was set
+    Task* task = nullptr;
+    for (Impl::ThreadPoolLane* lane : m_lanes)
+    {
+        while (lane->queue.TryPop(task))
+        {
+            CancelTask(task);
+        }
+        {
+            MutexGuard<Deque<Task*>> guard = lane->overflow.Lock();
+            for (Task* overflow_task : *guard.Deref())
+            {
+                CancelTask(overflow_task);
+            }
+            guard.Deref()->Clear();
+            lane->overflow_count.store(0, std::memory_order_relaxed);
+        }
+        MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = lane->deadline_heap.Lock();
+        for (const Impl::ThreadPoolDeadlineEntry& entry : guard.Deref()->entries)
+        {
+            CancelTask(entry.task);
+        }
+        guard.Deref()->entries.Clear();
+        lane->deadline_count.store(0, std::memory_order_relaxed);
+    }
+    {
+        MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = m_timers->heap.Lock();
+        for (const Impl::ThreadPoolDeadlineEntry& entry : guard.Deref()->entries)
+        {
+            CancelTask(entry.task);
+        }
+        guard.Deref()->entries.Clear();
+        m_timers->count.store(0, std::memory_order_relaxed);
+        m_timers->next_time.store(std::numeric_limits<f64>::infinity(), std::memory_order_relaxed);
+    }
+    for (Impl::ThreadPoolWorker* worker : m_workers)
+    {
+        while (worker->deque.Pop(task))
+        {
+            CancelTask(task);
+        }
+    }
+}
+
+void Opal::ThreadPool::RunWorker(Impl::ThreadPoolWorker* worker, Ref<AllocatorBase> default_allocator)
+{
+    OPAL_ASSERT(default_allocator->IsThreadSafe(), "Allocator must be thread safe");
+    PushDefaultAllocator(default_allocator.GetPtr());
+    if (worker->core != k_invalid_core)
+    {
+        // Pinned by the worker itself so that no task runs before the thread sits on its core
+        SetThreadAffinity(GetCurrentThreadHandle(), worker->core);
+    }
+    PushScratchAllocator(&worker->scratch);
+    t_current_worker = worker;
+    ThreadPool& pool = *worker->pool;
+    TaskTransmitter transmitter(pool);
+    while (true)
+    {
+        Task* raw_task = pool.FindTask(*worker);
+        if (raw_task != nullptr)
+        {
+            IntrusivePtr<Task> task = IntrusivePtr<Task>::Adopt(raw_task);
+            try
+            {
+                task->Execute(transmitter);
+            }
+            catch (...)
+            {
+                task->SetException(std::current_exception());
+            }
+            if (pool.m_scratch_reset == ThreadPoolScratchReset::AfterEachTask)
+            {
+                worker->scratch.Reset();
+            }
+            task->SetCompleted();
+            continue;
+        }
+
+        // New work often shows up right after a worker ran dry. Spinning for it is cheaper than sleeping and being woken.
+        if (pool.SpinForWork())
+        {
+            continue;
+        }
+
+        // Announce that this worker is going to sleep before checking for work one last time. Submitters publish the
+        // task before they look at the sleeping count, so either we see the task or they see us and bump the signal.
+        const u32 state = pool.m_wake_signal.GetState();
+        pool.m_sleeping_count.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pool.HasPendingTasks())
+        {
+            pool.m_sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (pool.m_is_stopping.load(std::memory_order_seq_cst) && !pool.HasTimers())
+        {
+            pool.m_sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        pool.WaitForWork(state);
+        pool.m_sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    t_current_worker = nullptr;
+    PopScratchAllocator();
+}
+
+Opal::Task* Opal::ThreadPool::FindTask(Impl::ThreadPoolWorker& worker)
+{
+    // Due timers are late already, so they go first and don't count as picks
+    if (Task* task = PopDueTimer())
+    {
+        return task;
+    }
+    const bool is_lowest_first = m_starvation_limit != 0 && worker.pick_count + 1 >= m_starvation_limit;
+    Task* task = is_lowest_first ? FindTaskLowestFirst(worker) : FindTaskHighestFirst(worker);
+    if (task != nullptr)
+    {
+        worker.pick_count = is_lowest_first ? 0 : worker.pick_count + 1;
+    }
+    return task;
+}
+
+Opal::Task* Opal::ThreadPool::FindTaskHighestFirst(Impl::ThreadPoolWorker& worker)
+{
+    // The local deque only holds normal priority tasks, so it comes after the high lane. Stealing is more expensive
+    // than popping a shared lane, so it comes last among the normal priority sources.
+    if (Task* task = PopLane(TaskPriority::High))
+    {
+        return task;
+    }
+    if (Task* task = PopLocal(worker))
+    {
+        return task;
+    }
+    if (Task* task = PopLane(TaskPriority::Normal))
+    {
+        return task;
+    }
+    if (Task* task = StealTask(worker))
+    {
+        return task;
+    }
+    return PopLane(TaskPriority::Background);
+}
+
+Opal::Task* Opal::ThreadPool::FindTaskLowestFirst(Impl::ThreadPoolWorker& worker)
+{
+    if (Task* task = PopLane(TaskPriority::Background))
+    {
+        return task;
+    }
+    if (Task* task = PopLocal(worker))
+    {
+        return task;
+    }
+    if (Task* task = PopLane(TaskPriority::Normal))
+    {
+        return task;
+    }
+    if (Task* task = StealTask(worker))
+    {
+        return task;
+    }
+    return PopLane(TaskPriority::High);
+}
+
+Opal::Task* Opal::ThreadPool::PopLane(TaskPriority priority)
+{
+    Impl::ThreadPoolLane& lane = *m_lanes[static_cast<u32>(priority)];
+    if (lane.deadline_count.load(std::memory_order_relaxed) > 0)
+    {
+        MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = lane.deadline_heap.Lock();
+        DynamicArray<Impl::ThreadPoolDeadlineEntry>& entries = guard.Deref()->entries;
+        if (!entries.IsEmpty())
+        {
+            std::pop_heap(entries.GetData(), entries.GetData() + entries.GetSize(), IsDueLater);
+            Task* task = entries.Back().task;
+            entries.PopBack();
+            lane.deadline_count.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    Task* task = nullptr;
+    if (lane.queue.TryPop(task))
+    {
+        if (lane.overflow_count.load(std::memory_order_acquire) != 0)
+        {
+            RefillLane(lane);
+        }
+        return task;
+    }
+    if (lane.overflow_count.load(std::memory_order_acquire) != 0)
+    {
+        MutexGuard<Deque<Task*>> guard = lane.overflow.Lock();
+        Deque<Task*>& overflow = *guard.Deref();
+        if (!overflow.IsEmpty())
+        {
+            task = overflow[0];
+            overflow.PopFront();
+            lane.overflow_count.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Opal::ThreadPool::RefillLane(Impl::ThreadPoolLane& lane)
+{
+    // Moves the oldest overflowed tasks into the slots that popping freed up. Tasks that fit in the queue are visible to
+    // all workers without taking the overflow lock.
+    MutexGuard<Deque<Task*>> guard = lane.overflow.Lock();
+    Deque<Task*>& overflow = *guard.Deref();
+    while (!overflow.IsEmpty() && lane.queue.TryPush(overflow[0]))
+    {
+        overflow.PopFront();
+        lane.overflow_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+Opal::Task* Opal::ThreadPool::PopDueTimer()
+{
+    if (m_timers->count.load(std::memory_order_relaxed) == 0)
+    {
+        return nullptr;
+    }
+    const f64 now = GetMilliSeconds();
+    if (now < m_timers->next_time.load(std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+    MutexGuard<Impl::ThreadPoolDeadlineHeap> guard = m_timers->heap.Lock();
+    DynamicArray<Impl::ThreadPoolDeadlineEntry>& entries = guard.Deref()->entries;
+    if (entries.IsEmpty() || now < entries[0].deadline)
+    {
+        return nullptr;
+    }
+    std::pop_heap(entries.GetData(), entries.GetData() + entries.GetSize(), IsDueLater);
+    Task* task = entries.Back().task;
+    entries.PopBack();
+    m_timers->next_time.store(entries.IsEmpty() ? std::numeric_limits<f64>::infinity() : entries[0].deadline, std::memory_order_relaxed);
+    m_timers->count.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+Opal::Task* Opal::ThreadPool::PopLocal(Impl::ThreadPoolWorker& worker)
+{
+    Task* task = nullptr;
+    if (m_scheduling == ThreadPoolScheduling::WorkStealing && worker.deque.Pop(task))
+    {
+        return task;
+    }
+    return nullptr;
+}
+
+Opal::Task* Opal::ThreadPool::StealTask(Impl::ThreadPoolWorker& worker)
+{
+    if (m_scheduling != ThreadPoolScheduling::WorkStealing)
+    {
+        return nullptr;
+    }
+    // Tasks of a worker on the same physical core or package find their data in a shared cache, so they are cheaper
+    // to take over than tasks from the other side of the machine
+    if (Task* task = StealFrom(worker, 0, worker.sibling_victims_end))
+    {
+        return task;
+    }
+    if (Task* task = StealFrom(worker, worker.sibling_victims_end, worker.package_victims_end))
+    {
+        return task;
+    }
+    return StealFrom(worker, worker.package_victims_end, static_cast<u32>(worker.victims.GetSize()));
+}
+
+Opal::Task* Opal::ThreadPool::StealFrom(Impl::ThreadPoolWorker& worker, u32 begin, u32 end)
+{
+    const u32 count = end - begin;
+    if (count == 0)
+    {
+        return nullptr;
+    }
+    // Start at a random victim so that thieves spread out instead of all hammering the same deque
+    const u32 start = count > 1 ? worker.rng.RandomU32(0, count) : 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const u32 victim = worker.victims[begin + (start + i) % count];
+        Task* task = nullptr;
+        if (m_workers[victim]->deque.Steal(task))
+        {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Opal::ThreadPool::AssignVictims(const CpuInfo& cpu_info)
+{
+    for (Impl::ThreadPoolWorker* thief : m_workers)
+    {
+        const PhysicalCoreInfo* thief_core = thief->core != k_invalid_core ? FindPhysicalCore(cpu_info, thief->core) : nullptr;
+        DynamicArray<u32> package_victims(m_allocator);
+        DynamicArray<u32> other_victims(m_allocator);
+        for (const Impl::ThreadPoolWorker* victim : m_workers)
+        {
+            if (victim == thief)
+            {
+                continue;
+            }
+            const PhysicalCoreInfo* victim_core = victim->core != k_invalid_core ? FindPhysicalCore(cpu_info, victim->core) : nullptr;
+            if (thief_core == nullptr || victim_core == nullptr)
+            {
+                other_victims.PushBack(victim->index);
+            }
+            else if (victim_core == thief_core)
+            {
+                thief->victims.PushBack(victim->index);
+            }
+            else if (victim_core->package_id == thief_core->package_id)
+            {
+                package_victims.PushBack(victim->index);
+            }
+            else
+            {
+                other_victims.PushBack(victim->index);
+            }
+        }
+        thief->sibling_victims_end = static_cast<u32>(thief->victims.GetSize());
+        thief->victims.Append(package_victims);
+        thief->package_victims_end = static_cast<u32>(thief->victims.GetSize());
+        thief->victims.Append(other_victims);
+    }
+}
+
+bool Opal::ThreadPool::HasPendingTasks() const
+{
+    for (const Impl::ThreadPoolLane* lane : m_lanes)
+    {
+        if (!lane->queue.IsEmpty() || lane->deadline_count.load(std::memory_order_seq_cst) > 0 ||
+            lane->overflow_count.load(std::memory_order_seq_cst) > 0)
+        {
+            return true;
+        }
+    }
+    if (HasTimers() && GetMilliSeconds() >= m_timers->next_time.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    if (m_scheduling == ThreadPoolScheduling::WorkStealing)
+    {
+        for (const Impl::ThreadPoolWorker* worker : m_workers)
+        {
+            if (!worker->deque.IsEmpty())
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Opal::ThreadPool::SpinForWork() const
+{
+    SpinWait spin(m_idle_spin_wait);
+    while (spin.Spin())
+    {
+        if (m_is_stopping.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        if (HasPendingTasks())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Opal::ThreadPool::HasTimers() const
+{
+    return m_timers->count.load(std::memory_order_seq_cst) > 0;
+}
+
+void Opal::ThreadPool::WaitForWork(u32 state)
+{
+    const f64 next_time = m_timers->next_time.load(std::memory_order_seq_cst);
+    if (next_time == std::numeric_limits<f64>::infinity())
+    {
+        m_wake_signal.Wait(state);
+        return;
+    }
+    // Wake up at the next due time, new earlier timers bump the signal
+    const f64 timeout = std::ceil(next_time - GetMilliSeconds());
+    if (timeout > 0)
+    {
+        m_wake_signal.WaitFor(state, static_cast<u64>(timeout));
+    }
+}
+
+void Opal::ThreadPool::WakeWorker()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping_count.load(std::memory_order_relaxed) > 0)
+    {
+        m_wake_signal.NotifyOne();
+    }
 }
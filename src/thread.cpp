@@ -1,5 +1,7 @@
 #include "opal/threading/thread.h"
 
+#include <algorithm>
+
 #include "opal/container/scope-ptr.h"
 #include "opal/logging.h"
 
@@ -118,10 +120,276 @@ Opal::ThreadHandle Opal::GetCurrentThreadHandle()
 #endif
 }
 
+namespace
+{
+
+/** Sorts the cores, caches and nodes and fills in what the platform did not report. */
+void FinishCpuInfo(Opal::CpuInfo& info, Opal::u64 bit_count)
+{
+    std::sort(info.physical_processors.begin(), info.physical_processors.end(),
+              [](const Opal::PhysicalCoreInfo& a, const Opal::PhysicalCoreInfo& b)
+              {
+                  if (a.package_id != b.package_id)
+                  {
+                      return a.package_id < b.package_id;
+                  }
+                  return a.logical_cores.FindFirstSet() < b.logical_cores.FindFirstSet();
+              });
+    for (Opal::u64 i = 0; i < info.physical_processors.GetSize(); ++i)
+    {
+        info.physical_processors[i].id = static_cast<Opal::u32>(i);
+    }
+    std::sort(info.caches.begin(), info.caches.end(),
+              [](const Opal::CacheInfo& a, const Opal::CacheInfo& b)
+              {
+                  if (a.level != b.level)
+                  {
+                      return a.level < b.level;
+                  }
+                  if (a.type != b.type)
+                  {
+                      return a.type < b.type;
+                  }
+                  return a.shared_logical_cores.FindFirstSet() < b.shared_logical_cores.FindFirstSet();
+              });
+    std::sort(info.numa_nodes.begin(), info.numa_nodes.end(),
+              [](const Opal::NumaNodeInfo& a, const Opal::NumaNodeInfo& b) { return a.id < b.id; });
+    if (info.numa_nodes.IsEmpty() && !info.physical_processors.IsEmpty())
+    {
+        Opal::NumaNodeInfo node;
+        node.logical_cores.Resize(bit_count);
+        for (const Opal::PhysicalCoreInfo& core : info.physical_processors)
+        {
+            node.logical_cores.Or(core.logical_cores);
+        }
+        info.numa_nodes.PushBack(std::move(node));
+    }
+}
+
+/** Formats a set of logical cores as a list of ranges, like "0-3,8". */
+void FormatCpuList(const Opal::DynamicBitSet& set, char* buffer, size_t size)
+{
+    buffer[0] = '\0';
+    size_t offset = 0;
+    Opal::u64 first = set.FindFirstSet();
+    while (first != Opal::DynamicBitSet::k_npos && offset < size)
+    {
+        Opal::u64 last = first;
+        while (last + 1 < set.GetSize() && set.Test(last + 1))
+        {
+            ++last;
+        }
+        const char* separator = offset == 0 ? "" : ",";
+        const unsigned long long first_id = first;
+        const unsigned long long last_id = last;
+        const int written = first == last ? snprintf(buffer + offset, size - offset, "%s%llu", separator, first_id)
+                                          : snprintf(buffer + offset, size - offset, "%s%llu-%llu", separator, first_id, last_id);
+        if (written < 0)
+        {
+            break;
+        }
+        offset += static_cast<size_t>(written);
+        first = set.FindNextSet(last + 1);
+    }
+}
+
+const char* GetCacheTypeName(Opal::CacheType type)
+{
+    switch (type)
+    {
+        case Opal::CacheType::Data:
+            return "data";
+        case Opal::CacheType::Instruction:
+            return "instruction";
+        case Opal::CacheType::Unified:
+            return "unified";
+    }
+    return "unknown";
+}
+
+#if defined(OPAL_PLATFORM_WINDOWS)
+/** Logical core ids are the processor group times 64 plus the index inside the group. */
+constexpr Opal::u64 k_processor_group_size = 64;
+
+void SetGroupAffinity(Opal::DynamicBitSet& set, const GROUP_AFFINITY& affinity)
+{
+    for (const Opal::u32 bit : Opal::BitMask<Opal::u64>(static_cast<Opal::u64>(affinity.Mask)))
+    {
+        set.Set(affinity.Group * k_processor_group_size + bit);
+    }
+}
+#elif defined(OPAL_PLATFORM_LINUX)
+bool ReadSysFile(const char* path, char* buffer, size_t size)
+{
+    FILE* f = fopen(path, "r");
+    if (f == nullptr)
+    {
+        return false;
+    }
+    const bool is_read = fgets(buffer, static_cast<int>(size), f) != nullptr;
+    fclose(f);
+    return is_read;
+}
+
+/** Parses a cpu list like "0-3,8,10-11" into @p set. Ids that don't fit into the set are ignored. */
+void ParseCpuList(const char* text, Opal::DynamicBitSet& set)
+{
+    const char* it = text;
+    while (*it >= '0' && *it <= '9')
+    {
+        char* next = nullptr;
+        const Opal::u64 first = strtoull(it, &next, 10);
+        Opal::u64 last = first;
+        if (*next == '-')
+        {
+            last = strtoull(next + 1, &next, 10);
+        }
+        for (Opal::u64 id = first; id <= last && id < set.GetSize(); ++id)
+        {
+            set.Set(id);
+        }
+        it = *next == ',' ? next + 1 : next;
+    }
+}
+
+/** Parses a size like "48K" into bytes. */
+Opal::u64 ParseCacheSize(const char* text)
+{
+    char* suffix = nullptr;
+    const Opal::u64 size = strtoull(text, &suffix, 10);
+    switch (*suffix)
+    {
+        case 'K':
+            return size << 10;
+        case 'M':
+            return size << 20;
+        case 'G':
+            return size << 30;
+        default:
+            return size;
+    }
+}
+
+/** Adds the caches of a logical core that are not in @p caches yet. */
+void ReadCaches(Opal::u32 logical_id, Opal::u64 bit_count, Opal::DynamicArray<Opal::CacheInfo>& caches)
+{
+    char path[128];
+    // Large enough for the shared cpu list of a cache that is shared by thousands of cores
+    char buf[4096];
+    for (Opal::u32 index = 0;; ++index)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", logical_id, index);
+        if (!ReadSysFile(path, buf, sizeof(buf)))
+        {
+            break;
+        }
+        Opal::CacheInfo cache;
+        cache.level = static_cast<Opal::u32>(atoi(buf));
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/type", logical_id, index);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            cache.type = strncmp(buf, "Data", 4) == 0          ? Opal::CacheType::Data
+                         : strncmp(buf, "Instruction", 11) == 0 ? Opal::CacheType::Instruction
+                                                                : Opal::CacheType::Unified;
+        }
+
+        cache.shared_logical_cores.Resize(bit_count);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", logical_id, index);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            ParseCpuList(buf, cache.shared_logical_cores);
+        }
+        if (logical_id < bit_count)
+        {
+            cache.shared_logical_cores.Set(logical_id);
+        }
+
+        // Every core that shares the cache lists it, so only the first one reads the rest
+        bool is_known = false;
+        for (const Opal::CacheInfo& known : caches)
+        {
+            if (known.level == cache.level && known.type == cache.type && known.shared_logical_cores == cache.shared_logical_cores)
+            {
+                is_known = true;
+                break;
+            }
+        }
+        if (is_known)
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/size", logical_id, index);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            cache.size = ParseCacheSize(buf);
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/coherency_line_size", logical_id, index);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            cache.line_size = static_cast<Opal::u32>(atoi(buf));
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/ways_of_associativity", logical_id, index);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            cache.associativity = static_cast<Opal::u32>(atoi(buf));
+        }
+        caches.PushBack(std::move(cache));
+    }
+}
+
+void ReadNumaNodes(Opal::u64 bit_count, Opal::DynamicArray<Opal::NumaNodeInfo>& nodes)
+{
+    DIR* node_dir = opendir("/sys/devices/system/node");
+    if (node_dir == nullptr)
+    {
+        return;
+    }
+    char path[310];
+    char buf[4096];
+    struct dirent* entry;
+    while ((entry = readdir(node_dir)) != nullptr)
+    {
+        // Looking for directories which names start with node<number>
+        if (strncmp(entry->d_name, "node", 4) != 0 || entry->d_name[4] < '0' || entry->d_name[4] > '9')
+        {
+            continue;
+        }
+        Opal::NumaNodeInfo node;
+        node.id = static_cast<Opal::u32>(atoi(entry->d_name + 4));
+        node.logical_cores.Resize(bit_count);
+        snprintf(path, sizeof(path), "/sys/devices/system/node/%s/cpulist", entry->d_name);
+        if (ReadSysFile(path, buf, sizeof(buf)))
+        {
+            ParseCpuList(buf, node.logical_cores);
+        }
+        nodes.PushBack(std::move(node));
+    }
+    closedir(node_dir);
+}
+#endif
+
+}  // namespace
+
+const Opal::CacheInfo* Opal::CpuInfo::FindDataCache(u32 level, u32 logical_core_id) const
+{
+    for (const CacheInfo& cache : caches)
+    {
+        if (cache.level == level && cache.type != CacheType::Instruction && logical_core_id < cache.shared_logical_cores.GetSize() &&
+            cache.shared_logical_cores.Test(logical_core_id))
+        {
+            return &cache;
+        }
+    }
+    return nullptr;
+}
+
 Opal::CpuInfo Opal::GetCpuInfo()
 {
 #if defined(OPAL_PLATFORM_WINDOWS)
     CpuInfo info;
+    const u64 bit_count = u64{GetMaximumProcessorGroupCount()} * k_processor_group_size;
     DWORD buffer_size = 0;
     PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX buffer = NULL;
     GetLogicalProcessorInformationEx(RelationAll, NULL, &buffer_size);
@@ -133,6 +401,7 @@ Opal::CpuInfo Opal::GetCpuInfo()
     }
     BYTE* ptr = reinterpret_cast<BYTE*>(buffer);
     const BYTE* end = ptr + buffer_size;
+    DynamicArray<DynamicBitSet> packages;
 
     while (ptr < end)
     {
@@ -142,13 +411,55 @@ Opal::CpuInfo Opal::GetCpuInfo()
             case RelationProcessorCore:
             {
                 PhysicalCoreInfo pp_info;
-                pp_info.id = static_cast<u32>(info.physical_processors.GetSize());
-                pp_info.logical_cores = BitMask<u64>(lp_info->Processor.GroupMask[0].Mask);
+                pp_info.logical_cores.Resize(bit_count);
+                for (WORD i = 0; i < lp_info->Processor.GroupCount; ++i)
+                {
+                    SetGroupAffinity(pp_info.logical_cores, lp_info->Processor.GroupMask[i]);
+                }
                 pp_info.is_hyperthreaded = lp_info->Processor.Flags == LTP_PC_SMT;
-                info.logical_cores_count += pp_info.logical_cores.GetSetBitCount();
+                info.logical_cores_count += static_cast<u32>(pp_info.logical_cores.PopCount());
                 info.physical_processors.PushBack(std::move(pp_info));
                 break;
             }
+            case RelationProcessorPackage:
+            {
+                DynamicBitSet package(bit_count);
+                for (WORD i = 0; i < lp_info->Processor.GroupCount; ++i)
+                {
+                    SetGroupAffinity(package, lp_info->Processor.GroupMask[i]);
+                }
+                packages.PushBack(std::move(package));
+                break;
+            }
+            case RelationCache:
+            {
+                const CACHE_RELATIONSHIP& relationship = lp_info->Cache;
+                if (relationship.Type == CacheTrace)
+                {
+                    break;
+                }
+                CacheInfo cache;
+                cache.level = relationship.Level;
+                cache.type = relationship.Type == CacheData          ? CacheType::Data
+                             : relationship.Type == CacheInstruction ? CacheType::Instruction
+                                                                     : CacheType::Unified;
+                cache.size = relationship.CacheSize;
+                cache.line_size = relationship.LineSize;
+                cache.associativity = relationship.Associativity == CACHE_FULLY_ASSOCIATIVE ? 0 : relationship.Associativity;
+                cache.shared_logical_cores.Resize(bit_count);
+                SetGroupAffinity(cache.shared_logical_cores, relationship.GroupMask);
+                info.caches.PushBack(std::move(cache));
+                break;
+            }
+            case RelationNumaNode:
+            {
+                NumaNodeInfo node;
+                node.id = static_cast<u32>(lp_info->NumaNode.NodeNumber);
+                node.logical_cores.Resize(bit_count);
+                SetGroupAffinity(node.logical_cores, lp_info->NumaNode.GroupMask);
+                info.numa_nodes.PushBack(std::move(node));
+                break;
+            }
             default:
             {
                 // Ignore other info
@@ -159,6 +470,18 @@ Opal::CpuInfo Opal::GetCpuInfo()
     }
 
     GetDefaultAllocator()->Free(buffer);
+    for (PhysicalCoreInfo& core : info.physical_processors)
+    {
+        for (u64 i = 0; i < packages.GetSize(); ++i)
+        {
+            if (packages[i].Test(core.logical_cores.FindFirstSet()))
+            {
+                core.package_id = static_cast<u32>(i);
+                break;
+            }
+        }
+    }
+    FinishCpuInfo(info, bit_count);
     return info;
 #elif defined(OPAL_PLATFORM_LINUX)
     CpuInfo info;
@@ -169,14 +492,7 @@ Opal::CpuInfo Opal::GetCpuInfo()
         return info;
     }
 
-    struct CoreAccum
-    {
-        u32 package_id;
-        u32 core_id;
-        u64 mask;
-    };
-    DynamicArray<CoreAccum> accums;
-
+    DynamicArray<u32> logical_ids;
     struct dirent* entry;
     while ((entry = readdir(cpu_dir)) != nullptr)
     {
@@ -185,73 +501,75 @@ Opal::CpuInfo Opal::GetCpuInfo()
         {
             continue;
         }
+        logical_ids.PushBack(static_cast<u32>(atoi(entry->d_name + 3)));
+    }
+    closedir(cpu_dir);
+    if (logical_ids.IsEmpty())
+    {
+        return info;
+    }
+    std::sort(logical_ids.begin(), logical_ids.end());
+    const u64 bit_count = u64{logical_ids.Back()} + 1;
 
-        // Extract logical core id from the directory name
-        u32 logical_id = static_cast<u32>(atoi(entry->d_name + 3));
-        if (logical_id >= 64)
-        {
-            continue;
-        }
+    struct CoreAccum
+    {
+        u32 package_id;
+        u32 core_id;
+        DynamicBitSet logical_cores;
+    };
+    DynamicArray<CoreAccum> accums;
 
-        char path[310];
+    for (const u32 logical_id : logical_ids)
+    {
+        char path[128];
         char buf[32];
 
         // Extract physical core id inside the package
-        snprintf(path, sizeof(path), "/sys/devices/system/cpu/%s/topology/core_id", entry->d_name);
-        FILE* f = fopen(path, "r");
-        if (f == nullptr)
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", logical_id);
+        if (!ReadSysFile(path, buf, sizeof(buf)))
         {
             continue;
         }
-        if (fgets(buf, sizeof(buf), f) == nullptr)
-        {
-            fclose(f);
-            continue;
-        }
-        fclose(f);
-        u32 core_id = static_cast<u32>(atoi(buf));
+        const u32 core_id = static_cast<u32>(atoi(buf));
 
         // Extract package id
-        snprintf(path, sizeof(path), "/sys/devices/system/cpu/%s/topology/physical_package_id", entry->d_name);
-        f = fopen(path, "r");
-        if (f == nullptr)
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", logical_id);
+        if (!ReadSysFile(path, buf, sizeof(buf)))
         {
             continue;
         }
-        if (fgets(buf, sizeof(buf), f) == nullptr)
-        {
-            fclose(f);
-            continue;
-        }
-        fclose(f);
-        u32 package_id = static_cast<u32>(atoi(buf));
+        const u32 package_id = static_cast<u32>(atoi(buf));
 
         bool found = false;
-        for (u64 i = 0; i < accums.GetSize(); ++i)
+        for (CoreAccum& accum : accums)
         {
-            if (accums[i].package_id == package_id && accums[i].core_id == core_id)
+            if (accum.package_id == package_id && accum.core_id == core_id)
             {
-                accums[i].mask |= (1ULL << logical_id);
+                accum.logical_cores.Set(logical_id);
                 found = true;
                 break;
             }
         }
         if (!found)
         {
-            accums.PushBack({package_id, core_id, 1ULL << logical_id});
+            accums.PushBack({package_id, core_id, DynamicBitSet(bit_count)});
+            accums.Back().logical_cores.Set(logical_id);
         }
+
+        ReadCaches(logical_id, bit_count, info.caches);
     }
-    closedir(cpu_dir);
 
-    for (u64 i = 0; i < accums.GetSize(); ++i)
+    for (CoreAccum& accum : accums)
     {
         PhysicalCoreInfo pp_info;
-        pp_info.id = static_cast<u32>(i);
-        pp_info.logical_cores = BitMask<u64>(accums[i].mask);
-        pp_info.is_hyperthreaded = pp_info.logical_cores.GetSetBitCount() > 1;
-        info.logical_cores_count += pp_info.logical_cores.GetSetBitCount();
+        pp_info.package_id = accum.package_id;
+        pp_info.logical_cores = std::move(accum.logical_cores);
+        pp_info.is_hyperthreaded = pp_info.logical_cores.PopCount() > 1;
+        info.logical_cores_count += static_cast<u32>(pp_info.logical_cores.PopCount());
         info.physical_processors.PushBack(std::move(pp_info));
     }
+    ReadNumaNodes(bit_count, info.numa_nodes);
+    FinishCpuInfo(info, bit_count);
 
     return info;
 #else
@@ -263,6 +581,7 @@ void Opal::PrintCpuInfo()
 {
     const CpuInfo info = GetCpuInfo();
     Logger& logger = GetLogger();
+    char cpu_list[4096];
     logger.Info("General", "CPU Info:");
     logger.Info("General", "  Logical cores count: {}", info.logical_cores_count);
     logger.Info("General", "  Physical cores count: {}", static_cast<u32>(info.physical_processors.GetSize()));
@@ -270,15 +589,21 @@ void Opal::PrintCpuInfo()
     {
         const PhysicalCoreInfo& core = info.physical_processors[i];
         logger.Info("General", "  Physical core {}:", core.id);
+        logger.Info("General", "    Package: {}", core.package_id);
         logger.Info("General", "    Hyperthreaded: {}", core.is_hyperthreaded ? "yes" : "no");
-        char logical_cores_str[300] = {};
-        size_t offset = 0;
-        for (const u32 bit : core.logical_cores)
-        {
-            const size_t max_length = sizeof(logical_cores_str) - offset;
-            offset += static_cast<u32>(snprintf(logical_cores_str + offset, max_length, "%u ", bit));
-        }
-        logger.Info("General", "    Logical cores: {}", logical_cores_str);
+        FormatCpuList(core.logical_cores, cpu_list, sizeof(cpu_list));
+        logger.Info("General", "    Logical cores: {}", cpu_list);
+    }
+    for (const CacheInfo& cache : info.caches)
+    {
+        FormatCpuList(cache.shared_logical_cores, cpu_list, sizeof(cpu_list));
+        logger.Info("General", "  L{} {} cache: {} bytes, {} byte lines, {} ways, shared by {}", cache.level,
+                    GetCacheTypeName(cache.type), cache.size, cache.line_size, cache.associativity, cpu_list);
+    }
+    for (const NumaNodeInfo& node : info.numa_nodes)
+    {
+        FormatCpuList(node.logical_cores, cpu_list, sizeof(cpu_list));
+        logger.Info("General", "  NUMA node {}: {}", node.id, cpu_list);
     }
 }
 
@@ -287,14 +612,19 @@ void Opal::SetThreadAffinity(ThreadHandle handle, u32 logical_core_id)
     if (handle.native_handle != nullptr)
     {
 #if defined(OPAL_PLATFORM_WINDOWS)
-        const DWORD_PTR mask = 1ULL << logical_core_id;
-        SetThreadAffinityMask(handle.native_handle, mask);
+        GROUP_AFFINITY affinity = {};
+        affinity.Group = static_cast<WORD>(logical_core_id / k_processor_group_size);
+        affinity.Mask = static_cast<KAFFINITY>(1ULL << (logical_core_id % k_processor_group_size));
+        SetThreadGroupAffinity(handle.native_handle, &affinity, nullptr);
 #elif defined(OPAL_PLATFORM_LINUX)
-        cpu_set_t cpu_set;
-        CPU_ZERO(&cpu_set);
-        CPU_SET(logical_core_id, &cpu_set);
+        // cpu_set_t only has room for CPU_SETSIZE cores
+        cpu_set_t* cpu_set = CPU_ALLOC(logical_core_id + 1);
+        const size_t set_size = CPU_ALLOC_SIZE(logical_core_id + 1);
+        CPU_ZERO_S(set_size, cpu_set);
+        CPU_SET_S(logical_core_id, set_size, cpu_set);
         pthread_t native_handle = reinterpret_cast<pthread_t>(handle.native_handle);
-        pthread_setaffinity_np(native_handle, sizeof(cpu_set), &cpu_set);
+        pthread_setaffinity_np(native_handle, set_size, cpu_set);
+        CPU_FREE(cpu_set);
 #else
         throw NotImplementedException(__FUNCTION__);
 #endif
@@ -256,6 +256,27 @@ TEST_CASE("ScratchAsDefault", "[Allocator]")
     }
 }
 
+TEST_CASE("ScratchScope", "[Allocator]")
+{
+    Opal::LinearAllocator linear_allocator("Linear Allocator");
+    Opal::PushScratch push_scratch(&linear_allocator);
+    linear_allocator.Alloc(64, 8);
+    const Opal::u64 mark_outer = linear_allocator.Mark();
+    {
+        Opal::ScratchScope outer;
+        Opal::GetScratchAllocator()->Alloc(128, 8);
+        const Opal::u64 mark_inner = linear_allocator.Mark();
+        {
+            Opal::ScratchScope inner;
+            Opal::GetScratchAllocator()->Alloc(256, 8);
+            REQUIRE(linear_allocator.Mark() > mark_inner);
+        }
+        REQUIRE(linear_allocator.Mark() == mark_inner);
+    }
+    REQUIRE(linear_allocator.Mark() == mark_outer);
+    REQUIRE(Opal::GetDefaultAllocator() != static_cast<Opal::AllocatorBase*>(&linear_allocator));
+}
+
 struct ThreadAllocatorResult
 {
     bool threw = false;
@@ -0,0 +1,164 @@
+#include "test-helpers.h"
+
+#include "opal/container/dynamic-array.h"
+#include "opal/exceptions.h"
+#include "opal/threading/atomic-shared-ptr.h"
+#include "opal/threading/thread.h"
+
+using namespace Opal;
+
+namespace
+{
+
+std::atomic<i32> g_live_count = 0;
+
+struct Config
+{
+    explicit Config(i32 in_version) : version(in_version), checksum(in_version * 3) { ++g_live_count; }
+    ~Config() { --g_live_count; }
+
+    i32 version;
+    i32 checksum;
+};
+
+struct Base
+{
+    virtual ~Base() = default;
+};
+
+struct OtherBase
+{
+    virtual ~OtherBase() = default;
+    i64 padding = 0;
+};
+
+struct OffsetDerived : OtherBase, Base
+{
+};
+
+}  // namespace
+
+TEST_CASE("Load and Store", "[AtomicSharedPtr]")
+{
+    g_live_count = 0;
+    {
+        AtomicSharedPtr<Config> atomic;
+        REQUIRE_FALSE(atomic.IsValid());
+        REQUIRE_FALSE(atomic.Load().IsValid());
+
+        atomic.Store(SharedPtr<Config>(nullptr, 1));
+        REQUIRE(atomic.IsValid());
+        SharedPtr<Config> first = atomic.Load();
+        REQUIRE(first->version == 1);
+        REQUIRE(first.GetReferenceCount() > 1);
+
+        SharedPtr<Config> old = atomic.Exchange(SharedPtr<Config>(nullptr, 2));
+        REQUIRE(old == first);
+        REQUIRE(first.GetReferenceCount() == 2);
+        REQUIRE(atomic.Load()->version == 2);
+        old.Reset();
+        first.Reset();
+        REQUIRE(g_live_count == 1);
+
+        atomic.Store(SharedPtr<Config>());
+        REQUIRE_FALSE(atomic.IsValid());
+        REQUIRE(g_live_count == 0);
+        atomic.Store(SharedPtr<Config>(nullptr, 3));
+    }
+    REQUIRE(g_live_count == 0);
+}
+
+TEST_CASE("Many loads refill the reserved references", "[AtomicSharedPtr]")
+{
+    g_live_count = 0;
+    {
+        AtomicSharedPtr<Config> atomic(SharedPtr<Config>(nullptr, 1));
+        DynamicArray<SharedPtr<Config>> loaded;
+        for (i32 i = 0; i < 100000; ++i)
+        {
+            loaded.PushBack(atomic.Load());
+        }
+        REQUIRE(loaded[0].GetReferenceCount() > 100000);
+        atomic.Store(SharedPtr<Config>(nullptr, 2));
+        REQUIRE(loaded[0].GetReferenceCount() == 100000);
+        loaded.Clear();
+        REQUIRE(g_live_count == 1);
+    }
+    REQUIRE(g_live_count == 0);
+}
+
+TEST_CASE("CompareExchange", "[AtomicSharedPtr]")
+{
+    g_live_count = 0;
+    {
+        AtomicSharedPtr<Config> atomic(SharedPtr<Config>(nullptr, 1));
+        SharedPtr<Config> expected = atomic.Load();
+        REQUIRE(atomic.CompareExchange(expected, SharedPtr<Config>(nullptr, 2)));
+        REQUIRE(atomic.Load()->version == 2);
+
+        REQUIRE_FALSE(atomic.CompareExchange(expected, SharedPtr<Config>(nullptr, 3)));
+        REQUIRE(expected->version == 2);
+        REQUIRE(expected.GetReferenceCount() > 1);
+        REQUIRE(g_live_count == 1);
+
+        SharedPtr<Config> empty;
+        REQUIRE_FALSE(atomic.CompareExchange(empty, SharedPtr<Config>(nullptr, 4)));
+        REQUIRE(empty->version == 2);
+    }
+    REQUIRE(g_live_count == 0);
+}
+
+TEST_CASE("Object pointer must match the control block", "[AtomicSharedPtr]")
+{
+    AtomicSharedPtr<Base> atomic;
+    SharedPtr<Base> shifted = MakeShared<Base, OffsetDerived>(nullptr);
+    REQUIRE_THROWS_AS(atomic.Store(std::move(shifted)), InvalidArgumentException);
+}
+
+TEST_CASE("Concurrent readers and writer", "[AtomicSharedPtr]")
+{
+    g_live_count = 0;
+    constexpr i32 k_versions = 2000;
+    {
+        AtomicSharedPtr<Config> atomic(SharedPtr<Config>(nullptr, 0));
+        std::atomic<bool> done = false;
+        std::atomic<i32> errors = 0;
+        auto read = [&atomic, &done, &errors]()
+        {
+            i32 last_version = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                SharedPtr<Config> config = atomic.Load();
+                if (config->checksum != config->version * 3 || config->version < last_version)
+                {
+                    ++errors;
+                }
+                last_version = config->version;
+            }
+        };
+        DynamicArray<ThreadHandle> readers;
+        for (i32 i = 0; i < 4; ++i)
+        {
+            readers.PushBack(CreateThread(read));
+        }
+        for (i32 version = 1; version <= k_versions; ++version)
+        {
+            if (version % 2 == 0)
+            {
+                atomic.Store(SharedPtr<Config>(nullptr, version));
+                continue;
+            }
+            SharedPtr<Config> expected = atomic.Load();
+            REQUIRE(atomic.CompareExchange(expected, SharedPtr<Config>(nullptr, version)));
+        }
+        done = true;
+        for (ThreadHandle& reader : readers)
+        {
+            JoinThread(reader);
+        }
+        REQUIRE(errors == 0);
+        REQUIRE(atomic.Load()->version == k_versions);
+        REQUIRE(g_live_count == 1);
+    }
+    REQUIRE(g_live_count == 0);
+}
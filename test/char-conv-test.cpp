@@ -0,0 +1,257 @@
+#include "test-helpers.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "opal/char-conv.h"
+#include "opal/container/string-view.h"
+#include "opal/container/string.h"
+#include "opal/rng.h"
+
+using namespace Opal;
+
+namespace
+{
+template <typename T>
+StringUtf8 ToCharsString(T value)
+{
+    char8 buffer[k_max_to_chars_size];
+    Expected<char8*, ErrorCode> result = ToChars(buffer, buffer + k_max_to_chars_size, value);
+    REQUIRE(result.HasValue());
+    return StringUtf8(buffer, static_cast<u64>(result.GetValue() - buffer));
+}
+
+template <typename T>
+T FromCharsValue(const char8* str)
+{
+    T value = 0;
+    Expected<const char8*, ErrorCode> result = FromChars(str, str + std::strlen(str), value);
+    REQUIRE(result.HasValue());
+    REQUIRE(result.GetValue() == str + std::strlen(str));
+    return value;
+}
+}  // namespace
+
+TEST_CASE("Integer ToChars", "[CharConv]")
+{
+    REQUIRE(ToCharsString(0) == "0");
+    REQUIRE(ToCharsString(7) == "7");
+    REQUIRE(ToCharsString(42) == "42");
+    REQUIRE(ToCharsString(-1234567) == "-1234567");
+    REQUIRE(ToCharsString(std::numeric_limits<i8>::min()) == "-128");
+    REQUIRE(ToCharsString(std::numeric_limits<u16>::max()) == "65535");
+    REQUIRE(ToCharsString(std::numeric_limits<i32>::min()) == "-2147483648");
+    REQUIRE(ToCharsString(std::numeric_limits<i64>::min()) == "-9223372036854775808");
+    REQUIRE(ToCharsString(std::numeric_limits<i64>::max()) == "9223372036854775807");
+    REQUIRE(ToCharsString(std::numeric_limits<u64>::max()) == "18446744073709551615");
+
+    char8 buffer[k_max_to_chars_size];
+    Expected<char8*, ErrorCode> hex = ToChars(buffer, buffer + k_max_to_chars_size, -255, 16);
+    REQUIRE(StringViewUtf8(buffer, static_cast<u64>(hex.GetValue() - buffer)) == "-ff");
+    Expected<char8*, ErrorCode> binary = ToChars(buffer, buffer + k_max_to_chars_size, 10u, 2);
+    REQUIRE(StringViewUtf8(buffer, static_cast<u64>(binary.GetValue() - buffer)) == "1010");
+    REQUIRE(ToChars(buffer, buffer + k_max_to_chars_size, 10, 37).GetError() == ErrorCode::InvalidArgument);
+
+    REQUIRE(ToChars(buffer, buffer + 3, 1234).GetError() == ErrorCode::InsufficientSpace);
+    REQUIRE(ToChars(buffer, buffer + 3, -123).GetError() == ErrorCode::InsufficientSpace);
+    REQUIRE(ToChars(buffer, buffer + 4, -123).HasValue());
+}
+
+TEST_CASE("Integer FromChars", "[CharConv]")
+{
+    REQUIRE(FromCharsValue<i32>("0") == 0);
+    REQUIRE(FromCharsValue<i32>("-42") == -42);
+    REQUIRE(FromCharsValue<u64>("18446744073709551615") == std::numeric_limits<u64>::max());
+    REQUIRE(FromCharsValue<i64>("-9223372036854775808") == std::numeric_limits<i64>::min());
+    REQUIRE(FromCharsValue<i8>("-128") == -128);
+    REQUIRE(FromCharsValue<u32>("0000000000000000000000001234") == 1234);
+    REQUIRE(FromCharsValue<u64>("12345678901234567") == 12345678901234567ull);
+
+    const char8* str = "123abc";
+    i32 value = 0;
+    Expected<const char8*, ErrorCode> result = FromChars(str, str + 6, value);
+    REQUIRE(result.GetValue() == str + 3);
+    REQUIRE(value == 123);
+
+    str = "7fFF";
+    result = FromChars(str, str + 4, value, 16);
+    REQUIRE(result.GetValue() == str + 4);
+    REQUIRE(value == 0x7FFF);
+
+    value = 5;
+    str = "-1";
+    u32 unsigned_value = 5;
+    REQUIRE(FromChars(str, str + 2, unsigned_value).GetError() == ErrorCode::InvalidArgument);
+    REQUIRE(unsigned_value == 5);
+    str = "+1";
+    REQUIRE(FromChars(str, str + 2, value).GetError() == ErrorCode::InvalidArgument);
+    str = "";
+    REQUIRE(FromChars(str, str, value).GetError() == ErrorCode::InvalidArgument);
+    str = "2147483648";
+    REQUIRE(FromChars(str, str + 10, value).GetError() == ErrorCode::OutOfBounds);
+    REQUIRE(value == 5);
+    str = "18446744073709551616";
+    u64 wide = 0;
+    REQUIRE(FromChars(str, str + 20, wide).GetError() == ErrorCode::OutOfBounds);
+    str = "99999999999999999999999";
+    REQUIRE(FromChars(str, str + 23, wide).GetError() == ErrorCode::OutOfBounds);
+    str = "256";
+    u8 narrow = 0;
+    REQUIRE(FromChars(str, str + 3, narrow).GetError() == ErrorCode::OutOfBounds);
+}
+
+TEST_CASE("Float ToChars writes the shortest representation", "[CharConv]")
+{
+    REQUIRE(ToCharsString(0.0) == "0");
+    REQUIRE(ToCharsString(-0.0) == "-0");
+    REQUIRE(ToCharsString(0.1) == "0.1");
+    REQUIRE(ToCharsString(0.3) == "0.3");
+    REQUIRE(ToCharsString(0.1 + 0.2) == "0.30000000000000004");
+    REQUIRE(ToCharsString(-2.5) == "-2.5");
+    REQUIRE(ToCharsString(100.0) == "100");
+    REQUIRE(ToCharsString(123456.0) == "123456");
+    REQUIRE(ToCharsString(1e5) == "1e+05");
+    REQUIRE(ToCharsString(1e-7) == "1e-07");
+    REQUIRE(ToCharsString(0.001) == "0.001");
+    REQUIRE(ToCharsString(1.5e300) == "1.5e+300");
+    REQUIRE(ToCharsString(1e22) == "1e+22");
+    REQUIRE(ToCharsString(9223372036854775808.0) == "9223372036854775808");
+    REQUIRE(ToCharsString(std::numeric_limits<f64>::max()) == "1.7976931348623157e+308");
+    REQUIRE(ToCharsString(std::numeric_limits<f64>::min()) == "2.2250738585072014e-308");
+    REQUIRE(ToCharsString(std::numeric_limits<f64>::denorm_min()) == "5e-324");
+    REQUIRE(ToCharsString(std::numeric_limits<f64>::infinity()) == "inf");
+    REQUIRE(ToCharsString(-std::numeric_limits<f64>::infinity()) == "-inf");
+    REQUIRE(ToCharsString(std::numeric_limits<f64>::quiet_NaN()) == "nan");
+
+    REQUIRE(ToCharsString(0.1f) == "0.1");
+    REQUIRE(ToCharsString(16777216.0f) == "16777216");
+    REQUIRE(ToCharsString(std::numeric_limits<f32>::max()) == "3.4028235e+38");
+    REQUIRE(ToCharsString(std::numeric_limits<f32>::denorm_min()) == "1e-45");
+
+    char8 buffer[k_max_to_chars_size];
+    REQUIRE(ToChars(buffer, buffer + 3, 0.125).GetError() == ErrorCode::InsufficientSpace);
+    REQUIRE(ToChars(buffer, buffer + 5, 0.125).HasValue());
+    REQUIRE(ToChars(buffer, buffer + 2, -std::numeric_limits<f64>::infinity()).GetError() == ErrorCode::InsufficientSpace);
+}
+
+TEST_CASE("Float FromChars rounds correctly", "[CharConv]")
+{
+    REQUIRE(FromCharsValue<f64>("0") == 0.0);
+    REQUIRE(std::signbit(FromCharsValue<f64>("-0")));
+    REQUIRE(FromCharsValue<f64>("0.1") == 0.1);
+    REQUIRE(FromCharsValue<f64>("-2.5e-3") == -2.5e-3);
+    REQUIRE(FromCharsValue<f64>(".5") == 0.5);
+    REQUIRE(FromCharsValue<f64>("5.") == 5.0);
+    REQUIRE(FromCharsValue<f64>("1E+22") == 1e22);
+    REQUIRE(FromCharsValue<f64>("0.000000000000000000000000000000000000000000000000001") == 1e-51);
+    REQUIRE(FromCharsValue<f64>("1.7976931348623157e308") == std::numeric_limits<f64>::max());
+    REQUIRE(FromCharsValue<f64>("4.9406564584124654e-324") == std::numeric_limits<f64>::denorm_min());
+    REQUIRE(FromCharsValue<f64>("1e-400") == 0.0);
+    // Exactly halfway between two doubles rounds to the even one.
+    REQUIRE(FromCharsValue<f64>("9007199254740993") == 9007199254740992.0);
+    REQUIRE(FromCharsValue<f64>("9007199254740995") == 9007199254740996.0);
+    REQUIRE(FromCharsValue<f64>("90071992547409930e-1") == 9007199254740992.0);
+    // Digits past the nineteenth decide the rounding.
+    REQUIRE(FromCharsValue<f64>("9007199254740993.0000000000000000000001") == 9007199254740994.0);
+    REQUIRE(FromCharsValue<f64>("123456789012345678901234567890") == 123456789012345678901234567890.0);
+    REQUIRE(FromCharsValue<f32>("0.1") == 0.1f);
+    REQUIRE(FromCharsValue<f32>("16777217") == 16777216.0f);
+    REQUIRE(FromCharsValue<f32>("1e-46") == 0.0f);
+
+    REQUIRE(std::isinf(FromCharsValue<f64>("inf")));
+    REQUIRE(FromCharsValue<f64>("-Infinity") == -std::numeric_limits<f64>::infinity());
+    REQUIRE(std::isnan(FromCharsValue<f64>("NaN")));
+
+    const char8* str = "1.5e";
+    f64 value = 3;
+    Expected<const char8*, ErrorCode> result = FromChars(str, str + 4, value);
+    REQUIRE(result.GetValue() == str + 3);
+    REQUIRE(value == 1.5);
+    str = "2e+x";
+    result = FromChars(str, str + 4, value);
+    REQUIRE(result.GetValue() == str + 1);
+
+    value = 3;
+    str = "1e400";
+    REQUIRE(FromChars(str, str + 5, value).GetError() == ErrorCode::OutOfBounds);
+    str = "-1e400";
+    REQUIRE(FromChars(str, str + 6, value).GetError() == ErrorCode::OutOfBounds);
+    f32 float_value = 0;
+    str = "1e39";
+    REQUIRE(FromChars(str, str + 4, float_value).GetError() == ErrorCode::OutOfBounds);
+    str = "abc";
+    REQUIRE(FromChars(str, str + 3, value).GetError() == ErrorCode::InvalidArgument);
+    str = "-.";
+    REQUIRE(FromChars(str, str + 2, value).GetError() == ErrorCode::InvalidArgument);
+    str = "+1";
+    REQUIRE(FromChars(str, str + 2, value).GetError() == ErrorCode::InvalidArgument);
+    REQUIRE(value == 3);
+}
+
+TEST_CASE("Float ToChars matches std::to_chars and round trips", "[CharConv]")
+{
+    RNG rng(7);
+    char8 buffer[k_max_to_chars_size];
+    char expected[64];
+    for (i32 i = 0; i < 100000; ++i)
+    {
+        const u64 bits = (static_cast<u64>(rng.RandomU32()) << 32) | rng.RandomU32();
+        f64 value = 0;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isnan(value))
+        {
+            continue;
+        }
+        const char8* end = ToChars(buffer, buffer + k_max_to_chars_size, value).GetValue();
+        const std::to_chars_result expected_result = std::to_chars(expected, expected + 64, value);
+        REQUIRE(StringViewUtf8(buffer, static_cast<u64>(end - buffer)) ==
+                StringViewUtf8(expected, static_cast<u64>(expected_result.ptr - expected)));
+
+        f64 parsed = 0;
+        REQUIRE(FromChars(buffer, end, parsed).GetValue() == end);
+        REQUIRE(std::memcmp(&parsed, &value, sizeof(value)) == 0);
+
+        const u32 float_bits = rng.RandomU32();
+        f32 float_value = 0;
+        std::memcpy(&float_value, &float_bits, sizeof(float_value));
+        if (std::isnan(float_value))
+        {
+            continue;
+        }
+        end = ToChars(buffer, buffer + k_max_to_chars_size, float_value).GetValue();
+        f32 float_parsed = 0;
+        REQUIRE(FromChars(buffer, end, float_parsed).GetValue() == end);
+        REQUIRE(std::memcmp(&float_parsed, &float_value, sizeof(float_value)) == 0);
+    }
+}
+
+TEST_CASE("Float ToCharsFixed", "[CharConv]")
+{
+    char8 buffer[k_max_fixed_to_chars_size + 20];
+    char8* const buffer_end = buffer + sizeof(buffer);
+    const auto to_string = [&buffer](Expected<char8*, ErrorCode> result)
+    { return StringUtf8(buffer, static_cast<u64>(result.GetValue() - buffer)); };
+
+    REQUIRE(to_string(ToCharsFixed(buffer, buffer_end, 2.33, 6)) == "2.330000");
+    REQUIRE(to_string(ToCharsFixed(buffer, buffer_end, 2.33f, 1)) == "2.3");
+    REQUIRE(to_string(ToCharsFixed(buffer, buffer_end, 0.5, 0)) == "0");
+    REQUIRE(to_string(ToCharsFixed(buffer, buffer_end, -std::numeric_limits<f64>::infinity(), 3)) == "-inf");
+    REQUIRE(ToCharsFixed(buffer, buffer_end, 1.0, -1).GetError() == ErrorCode::InvalidArgument);
+    REQUIRE(ToCharsFixed(buffer, buffer + 3, 1234.0, 0).GetError() == ErrorCode::InsufficientSpace);
+    const Expected<char8*, ErrorCode> lowest = ToCharsFixed(buffer, buffer_end, std::numeric_limits<f64>::lowest(), 20);
+    REQUIRE(lowest.HasValue());
+    REQUIRE(static_cast<u64>(lowest.GetValue() - buffer) <= k_max_fixed_to_chars_size + 20);
+
+    // Same digits as printf in the "C" locale
+    RNG rng(11);
+    char expected[k_max_fixed_to_chars_size + 20];
+    for (i32 i = 0; i < 1000; ++i)
+    {
+        const f64 value = (static_cast<f64>(rng.RandomU32()) - 2147483648.0) / static_cast<f64>(1u + (rng.RandomU32() & 0xFFFF));
+        const i32 precision = static_cast<i32>(rng.RandomU32() % 12);
+        const i32 size = std::snprintf(expected, sizeof(expected), "%.*f", precision, value);
+        REQUIRE(to_string(ToCharsFixed(buffer, buffer_end, value, precision)) == StringViewUtf8(expected, static_cast<u64>(size)));
+    }
+}
@@ -1,5 +1,6 @@
 #include "test-helpers.h"
 
+#include "opal/container/dynamic-array.h"
 #include "opal/delegate.h"
 
 using namespace Opal;
@@ -66,6 +67,98 @@ TEST_CASE("Delegate with reference arguments", "[Delegate]")
     REQUIRE(value == 99);
 }
 
+// InplaceDelegate tests
+
+namespace
+{
+
+struct CountedFunctor
+{
+    explicit CountedFunctor(i32* in_live_count) : live_count(in_live_count) { ++(*live_count); }
+    CountedFunctor(CountedFunctor&& other) noexcept : live_count(other.live_count) { ++(*live_count); }
+    ~CountedFunctor() { --(*live_count); }
+
+    i32 operator()(i32 value) const { return value + *live_count; }
+
+    i32* live_count;
+};
+
+}  // namespace
+
+TEST_CASE("InplaceDelegate bind and execute", "[InplaceDelegate]")
+{
+    InplaceDelegate<i32(i32, i32)> delegate;
+    REQUIRE_FALSE(delegate.IsBound());
+    REQUIRE(delegate.Execute(1, 2) == 0);
+
+    delegate.Bind([](i32 a, i32 b) { return a + b; });
+    REQUIRE(delegate.IsBound());
+    REQUIRE(delegate.Execute(3, 4) == 7);
+
+    const i64 offset = 100;
+    delegate.Bind([offset](i32 a, i32 b) { return static_cast<i32>(offset) + a * b; });
+    REQUIRE(delegate.Execute(3, 4) == 112);
+
+    delegate.Unbind();
+    REQUIRE_FALSE(delegate.IsBound());
+}
+
+TEST_CASE("InplaceDelegate stores captures inline", "[InplaceDelegate]")
+{
+    struct Payload
+    {
+        i64 values[6] = {1, 2, 3, 4, 5, 6};
+    };
+    Payload payload;
+    InplaceDelegate<i64(), 64> delegate(
+        [payload]()
+        {
+            i64 sum = 0;
+            for (i64 value : payload.values)
+            {
+                sum += value;
+            }
+            return sum;
+        });
+    REQUIRE(sizeof(delegate) == 64 + 2 * sizeof(void*));
+    REQUIRE(delegate.Execute() == 21);
+
+    InplaceDelegate<i64(), 64> moved(std::move(delegate));
+    REQUIRE_FALSE(delegate.IsBound());
+    REQUIRE(moved.Execute() == 21);
+}
+
+TEST_CASE("InplaceDelegate destroys non-trivial callables", "[InplaceDelegate]")
+{
+    i32 live_count = 0;
+    {
+        InplaceDelegate<i32(i32)> delegate{CountedFunctor(&live_count)};
+        REQUIRE(live_count == 1);
+        REQUIRE(delegate.Execute(10) == 11);
+
+        InplaceDelegate<i32(i32)> moved;
+        moved = std::move(delegate);
+        REQUIRE(live_count == 1);
+        REQUIRE(moved.Execute(10) == 11);
+
+        moved.Bind([](i32 value) { return value; });
+        REQUIRE(live_count == 0);
+
+        moved.Bind(CountedFunctor(&live_count));
+        REQUIRE(live_count == 1);
+    }
+    REQUIRE(live_count == 0);
+}
+
+TEST_CASE("InplaceDelegate with void return and reference arguments", "[InplaceDelegate]")
+{
+    InplaceDelegate<void(i32&)> delegate;
+    delegate.Bind([](i32& value) { value = 99; });
+    i32 value = 0;
+    delegate.Execute(value);
+    REQUIRE(value == 99);
+}
+
 // MultiDelegate tests
 
 TEST_CASE("MultiDelegate default state has no bindings", "[MultiDelegate]")
@@ -160,7 +253,35 @@ TEST_CASE("MultiDelegate with reference arguments", "[MultiDelegate]")
 
     i32 value = 5;
     delegate.Execute(value);
-    // Both callbacks are called, order depends on iteration over HashMap
-    // After both: value should be modified by both callbacks
-    REQUIRE(value != 5);
-}
\ No newline at end of file
+    // Callbacks are called in the order they were bound
+    REQUIRE(value == 30);
+}
+
+TEST_CASE("MultiDelegate keeps order after unbinding", "[MultiDelegate]")
+{
+    DynamicArray<i32> calls;
+    MultiDelegate<void(i32)> delegate;
+    DynamicArray<DelegateHandle> handles;
+    for (i32 i = 0; i < 300; ++i)
+    {
+        handles.PushBack(delegate.Bind([&calls, i](i32 offset) { calls.PushBack(i + offset); }));
+    }
+    for (i32 i = 0; i < 300; i += 3)
+    {
+        delegate.Unbind(handles[static_cast<u64>(i)]);
+    }
+    REQUIRE_FALSE(delegate.IsBound(handles[0]));
+    REQUIRE(delegate.IsBound(handles[1]));
+    REQUIRE(delegate.IsBound(handles[299]));
+
+    delegate.Execute(1000);
+    REQUIRE(calls.GetSize() == 200);
+    u64 index = 0;
+    for (i32 i = 0; i < 300; ++i)
+    {
+        if (i % 3 != 0)
+        {
+            REQUIRE(calls[index++] == i + 1000);
+        }
+    }
+}
@@ -0,0 +1,231 @@
+#include "test-helpers.h"
+
+#include "opal/container/dynamic-array.h"
+#include "opal/container/dynamic-bit-set.h"
+
+using namespace Opal;
+
+TEST_CASE("Constructor", "[DynamicBitSet]")
+{
+    SECTION("Default constructor")
+    {
+        DynamicBitSet bits;
+        REQUIRE(bits.GetSize() == 0);
+        REQUIRE(bits.GetCapacity() == 0);
+        REQUIRE(bits.IsEmpty());
+        REQUIRE(bits.None());
+        REQUIRE(bits.GetAllocator() == GetDefaultAllocator());
+    }
+    SECTION("Size and value")
+    {
+        DynamicBitSet zeros(100);
+        REQUIRE(zeros.GetSize() == 100);
+        REQUIRE(zeros.GetWordCount() == 2);
+        REQUIRE(zeros.GetCapacity() == 512);
+        REQUIRE(zeros.PopCount() == 0);
+
+        DynamicBitSet ones(100, true);
+        REQUIRE(ones.PopCount() == 100);
+        REQUIRE(ones.All());
+        REQUIRE(ones.GetData()[1] == (1ull << 36) - 1);
+    }
+    SECTION("Custom allocator")
+    {
+        MallocAllocator allocator;
+        DynamicBitSet bits(10, false, &allocator);
+        REQUIRE(bits.GetAllocator() == &allocator);
+        REQUIRE(reinterpret_cast<u64>(bits.GetData()) % OPAL_CACHE_LINE_SIZE == 0);
+    }
+    SECTION("Move")
+    {
+        DynamicBitSet bits(70);
+        bits.Set(69);
+        DynamicBitSet moved(std::move(bits));
+        REQUIRE(moved.Test(69));
+        REQUIRE(bits.IsEmpty());
+        DynamicBitSet assigned(5);
+        assigned = std::move(moved);
+        REQUIRE(assigned.GetSize() == 70);
+        REQUIRE(assigned.Test(69));
+    }
+}
+
+TEST_CASE("Single bit access", "[DynamicBitSet]")
+{
+    DynamicBitSet bits(130);
+    bits.Set(0);
+    bits.Set(64);
+    bits.Set(129, true);
+    REQUIRE(bits.Test(0));
+    REQUIRE(bits[64]);
+    REQUIRE(bits.Test(129));
+    REQUIRE(!bits.Test(1));
+    REQUIRE(bits.PopCount() == 3);
+
+    bits.Reset(64);
+    bits.Flip(1);
+    bits.Set(0, false);
+    REQUIRE(!bits.Test(0));
+    REQUIRE(bits.Test(1));
+    REQUIRE(!bits.Test(64));
+    REQUIRE(bits.PopCount() == 2);
+}
+
+TEST_CASE("Resize and Reserve", "[DynamicBitSet]")
+{
+    DynamicBitSet bits;
+    bits.Reserve(1);
+    REQUIRE(bits.GetCapacity() == 512);
+    bits.Reserve(513);
+    REQUIRE(bits.GetCapacity() == 1024);
+
+    SECTION("Grow with ones keeps existing bits")
+    {
+        bits.Resize(10);
+        bits.Set(3);
+        bits.Resize(2000, true);
+        REQUIRE(bits.GetSize() == 2000);
+        REQUIRE(bits.Test(3));
+        REQUIRE(!bits.Test(4));
+        REQUIRE(bits.Test(10));
+        REQUIRE(bits.Test(1999));
+        REQUIRE(bits.PopCount() == 1991);
+    }
+    SECTION("Shrink clears the tail")
+    {
+        bits.Resize(200, true);
+        bits.Resize(65);
+        REQUIRE(bits.PopCount() == 65);
+        bits.Resize(200);
+        REQUIRE(bits.PopCount() == 65);
+        REQUIRE(!bits.Test(65));
+        REQUIRE(bits.FindNextSet(65) == DynamicBitSet::k_npos);
+    }
+    SECTION("Clear")
+    {
+        bits.Resize(100, true);
+        const u64 capacity = bits.GetCapacity();
+        bits.Clear();
+        REQUIRE(bits.IsEmpty());
+        REQUIRE(bits.GetCapacity() == capacity);
+        bits.Resize(100);
+        REQUIRE(bits.None());
+    }
+}
+
+TEST_CASE("Bulk operations", "[DynamicBitSet]")
+{
+    // Sizes cover the SIMD body and the scalar tail
+    const u64 size = 1000;
+    DynamicBitSet a(size);
+    DynamicBitSet b(size);
+    for (u64 i = 0; i < size; ++i)
+    {
+        a.Set(i, i % 2 == 0);
+        b.Set(i, i % 3 == 0);
+    }
+
+    SECTION("And")
+    {
+        a.And(b);
+        for (u64 i = 0; i < size; ++i)
+        {
+            REQUIRE(a.Test(i) == (i % 6 == 0));
+        }
+    }
+    SECTION("Or")
+    {
+        a.Or(b);
+        for (u64 i = 0; i < size; ++i)
+        {
+            REQUIRE(a.Test(i) == (i % 2 == 0 || i % 3 == 0));
+        }
+    }
+    SECTION("Xor")
+    {
+        a.Xor(b);
+        for (u64 i = 0; i < size; ++i)
+        {
+            REQUIRE(a.Test(i) == ((i % 2 == 0) != (i % 3 == 0)));
+        }
+    }
+    SECTION("AndNot")
+    {
+        a.AndNot(b);
+        for (u64 i = 0; i < size; ++i)
+        {
+            REQUIRE(a.Test(i) == (i % 2 == 0 && i % 3 != 0));
+        }
+    }
+    SECTION("Size mismatch")
+    {
+        DynamicBitSet c(size + 1);
+        REQUIRE_THROWS_AS(a.And(c), InvalidArgumentException);
+    }
+    SECTION("SetAll, ResetAll and FlipAll")
+    {
+        a.SetAll();
+        REQUIRE(a.All());
+        REQUIRE(a.PopCount() == size);
+        a.ResetAll();
+        REQUIRE(a.None());
+        b.FlipAll();
+        REQUIRE(b.PopCount() == size - 334);
+        REQUIRE(!b.Test(0));
+        REQUIRE(b.Test(1));
+    }
+    SECTION("Clone and equality")
+    {
+        DynamicBitSet clone = a.Clone();
+        REQUIRE(clone == a);
+        clone.Flip(999);
+        REQUIRE(!(clone == a));
+        REQUIRE(!(a == b));
+    }
+}
+
+TEST_CASE("PopCount range", "[DynamicBitSet]")
+{
+    DynamicBitSet bits(1000, true);
+    REQUIRE(bits.PopCount(0, 1000) == 1000);
+    REQUIRE(bits.PopCount(10, 20) == 10);
+    REQUIRE(bits.PopCount(60, 70) == 10);
+    REQUIRE(bits.PopCount(1, 999) == 998);
+    REQUIRE(bits.PopCount(64, 128) == 64);
+    REQUIRE(bits.PopCount(500, 500) == 0);
+    bits.Reset(65);
+    REQUIRE(bits.PopCount(64, 128) == 63);
+    REQUIRE(bits.PopCount(0, 65) == 65);
+    REQUIRE_THROWS_AS(bits.PopCount(0, 1001), OutOfBoundsException);
+    REQUIRE_THROWS_AS(bits.PopCount(10, 5), OutOfBoundsException);
+}
+
+TEST_CASE("Find and iterate set bits", "[DynamicBitSet]")
+{
+    DynamicBitSet bits(5000);
+    REQUIRE(bits.FindFirstSet() == DynamicBitSet::k_npos);
+    REQUIRE(bits.begin() == bits.end());
+
+    const u64 expected[] = {3, 63, 64, 700, 4095, 4999};
+    for (u64 index : expected)
+    {
+        bits.Set(index);
+    }
+    REQUIRE(bits.FindFirstSet() == 3);
+    REQUIRE(bits.FindNextSet(4) == 63);
+    REQUIRE(bits.FindNextSet(65) == 700);
+    REQUIRE(bits.FindNextSet(701) == 4095);
+    REQUIRE(bits.FindNextSet(4999) == 4999);
+    REQUIRE(bits.FindNextSet(5000) == DynamicBitSet::k_npos);
+
+    DynamicArray<u64> found;
+    for (u64 index : bits)
+    {
+        found.PushBack(index);
+    }
+    REQUIRE(found.GetSize() == 6);
+    for (u64 i = 0; i < found.GetSize(); ++i)
+    {
+        REQUIRE(found[i] == expected[i]);
+    }
+}
@@ -495,6 +495,37 @@ TEST_CASE("WriteBytesToFile", "[FileSystem]")
     }
 }
 
+TEST_CASE("WriteChunksToFile", "[FileSystem]")
+{
+    StringUtf8 path;
+    REQUIRE_NOTHROW(path = Paths::GetCurrentWorkingDirectory());
+
+    SECTION("Write to non-existent directory")
+    {
+        StringUtf8 file_path = Paths::Combine(path, "no-such-dir", "file.bin");
+        REQUIRE_THROWS_AS(WriteChunksToFile(file_path, ArrayView<const ArrayView<const u8>>()), PathNotFoundException);
+    }
+    SECTION("Chunks are written in order and replace existing bytes")
+    {
+        StringUtf8 file_path = Paths::Combine(path, "write-chunks.bin");
+        const u8 original[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+        REQUIRE_NOTHROW(WriteBytesToFile(file_path, ArrayView<const u8>(original)));
+
+        const u8 first[] = {0xAA, 0xBB};
+        const u8 second[] = {0xCC};
+        const ArrayView<const u8> chunks[] = {ArrayView<const u8>(first), ArrayView<const u8>(), ArrayView<const u8>(second)};
+        REQUIRE_NOTHROW(WriteChunksToFile(file_path, ArrayView<const ArrayView<const u8>>(chunks)));
+
+        DynamicArray<u8> read_back;
+        REQUIRE_NOTHROW(read_back = ReadFileAsBytes(file_path));
+        REQUIRE(read_back.GetSize() == 3);
+        REQUIRE(read_back[0] == 0xAA);
+        REQUIRE(read_back[1] == 0xBB);
+        REQUIRE(read_back[2] == 0xCC);
+        REQUIRE_NOTHROW(DeleteFile(file_path));
+    }
+}
+
 TEST_CASE("AppendStringToFile", "[FileSystem]")
 {
     StringUtf8 path;
@@ -0,0 +1,163 @@
+#include "test-helpers.h"
+
+#include "opal/container/intrusive-ptr.h"
+#include "opal/exceptions.h"
+#include "opal/threading/thread.h"
+
+using namespace Opal;
+
+namespace
+{
+
+i32 g_destroyed_count = 0;
+
+struct Node : RefCounted<>
+{
+    explicit Node(i32 in_value = 0) : value(in_value) {}
+    virtual ~Node() { ++g_destroyed_count; }
+
+    i32 value;
+};
+
+struct DerivedNode : Node
+{
+    DerivedNode(i32 in_value, i32 in_extra) : Node(in_value), extra(in_extra) {}
+
+    i32 extra;
+};
+
+struct LocalNode : RefCounted<ThreadingPolicy::SingleThread>
+{
+    i32 value = 7;
+};
+
+}  // namespace
+
+TEST_CASE("Construction", "[IntrusivePtr]")
+{
+    g_destroyed_count = 0;
+    SECTION("Default")
+    {
+        IntrusivePtr<Node> ptr;
+        REQUIRE_FALSE(ptr.IsValid());
+        REQUIRE(ptr.Get() == nullptr);
+    }
+    SECTION("In-place")
+    {
+        IntrusivePtr<Node> ptr(nullptr, 42);
+        REQUIRE(ptr.IsValid());
+        REQUIRE(ptr->value == 42);
+        REQUIRE((*ptr).value == 42);
+        REQUIRE(ptr->GetReferenceCount() == 1);
+        REQUIRE(ptr->GetOwningAllocator() == GetDefaultAllocator());
+    }
+    SECTION("Pointer is the size of a raw pointer")
+    {
+        REQUIRE(sizeof(IntrusivePtr<Node>) == sizeof(Node*));
+    }
+    SECTION("Thread-safe count requires a thread-safe allocator")
+    {
+        LinearAllocator allocator("NonThreadSafe");
+        REQUIRE_THROWS_AS(IntrusivePtr<Node>(&allocator, 1), InvalidArgumentException);
+        IntrusivePtr<LocalNode> local(&allocator);
+        REQUIRE(local->value == 7);
+        REQUIRE(local->GetOwningAllocator() == &allocator);
+    }
+}
+
+TEST_CASE("Shared ownership", "[IntrusivePtr]")
+{
+    g_destroyed_count = 0;
+    IntrusivePtr<Node> ptr(nullptr, 5);
+    IntrusivePtr<Node> clone = ptr.Clone();
+    REQUIRE(clone.Get() == ptr.Get());
+    REQUIRE(clone == ptr);
+    REQUIRE(ptr->GetReferenceCount() == 2);
+
+    SECTION("Reset releases one reference")
+    {
+        ptr.Reset();
+        REQUIRE_FALSE(ptr.IsValid());
+        REQUIRE(clone->GetReferenceCount() == 1);
+        REQUIRE(g_destroyed_count == 0);
+        clone.Reset();
+        REQUIRE(g_destroyed_count == 1);
+    }
+    SECTION("Move does not touch the count")
+    {
+        IntrusivePtr<Node> moved(std::move(ptr));
+        REQUIRE_FALSE(ptr.IsValid());
+        REQUIRE(moved->GetReferenceCount() == 2);
+        IntrusivePtr<Node> other(nullptr, 9);
+        other = std::move(moved);
+        REQUIRE(g_destroyed_count == 1);
+        REQUIRE(other->value == 5);
+        REQUIRE(other->GetReferenceCount() == 2);
+    }
+    SECTION("Clone of invalid pointer")
+    {
+        IntrusivePtr<Node> empty;
+        REQUIRE_FALSE(empty.Clone().IsValid());
+    }
+    SECTION("Detach and Adopt keep the reference")
+    {
+        Node* raw = clone.Detach();
+        REQUIRE_FALSE(clone.IsValid());
+        REQUIRE(raw == ptr.Get());
+        REQUIRE(ptr->GetReferenceCount() == 2);
+        IntrusivePtr<Node> adopted = IntrusivePtr<Node>::Adopt(raw);
+        REQUIRE(adopted == ptr);
+        REQUIRE(ptr->GetReferenceCount() == 2);
+        adopted.Reset();
+        ptr.Reset();
+        REQUIRE(g_destroyed_count == 1);
+        REQUIRE(IntrusivePtr<Node>().Detach() == nullptr);
+    }
+}
+
+TEST_CASE("MakeIntrusive", "[IntrusivePtr]")
+{
+    g_destroyed_count = 0;
+    SECTION("Same type")
+    {
+        IntrusivePtr<Node> ptr = MakeIntrusive<Node>(nullptr, 3);
+        REQUIRE(ptr->value == 3);
+    }
+    SECTION("Derived type")
+    {
+        IntrusivePtr<Node> ptr = MakeIntrusive<Node, DerivedNode>(nullptr, 1, 2);
+        REQUIRE(ptr->value == 1);
+        REQUIRE(static_cast<DerivedNode*>(ptr.Get())->extra == 2);
+        ptr.Reset();
+        REQUIRE(g_destroyed_count == 1);
+    }
+    SECTION("Converting move")
+    {
+        IntrusivePtr<DerivedNode> derived(nullptr, 4, 5);
+        IntrusivePtr<Node> base(std::move(derived));
+        REQUIRE_FALSE(derived.IsValid());
+        REQUIRE(base->value == 4);
+        REQUIRE(base->GetReferenceCount() == 1);
+    }
+}
+
+TEST_CASE("Concurrent Clone and Reset", "[IntrusivePtr]")
+{
+    g_destroyed_count = 0;
+    constexpr i32 k_iterations = 10000;
+    IntrusivePtr<Node> ptr(nullptr, 1);
+    auto work = [](const IntrusivePtr<Node>& shared)
+    {
+        for (i32 i = 0; i < k_iterations; ++i)
+        {
+            IntrusivePtr<Node> clone = shared.Clone();
+            clone.Reset();
+        }
+    };
+    ThreadHandle first = CreateThread(work, Ref<const IntrusivePtr<Node>>(ptr));
+    ThreadHandle second = CreateThread(work, Ref<const IntrusivePtr<Node>>(ptr));
+    JoinThread(first);
+    JoinThread(second);
+    REQUIRE(ptr->GetReferenceCount() == 1);
+    REQUIRE(g_destroyed_count == 0);
+}
@@ -48,6 +48,20 @@ TEST_CASE("JsonReader parse exponent number", "[JsonReader]")
     REQUIRE(reader.GetRoot().GetNumber() == Catch::Approx(1.5e10));
 }
 
+TEST_CASE("JsonReader parses numbers exactly", "[JsonReader]")
+{
+    JsonReader reader = JsonReader::Parse("[0.1, 9223372036854775807, 9223372036854775808, -0.0, 2.2250738585072014e-308]");
+    const JsonValue& root = reader.GetRoot();
+    REQUIRE(root[0].GetNumber() == 0.1);
+    REQUIRE(root[1].GetIntegerNumber() == 9223372036854775807ll);
+    REQUIRE(!root[2].IsIntegerNumber());
+    REQUIRE(root[2].GetNumber() == 9223372036854775808.0);
+    REQUIRE(std::signbit(root[3].GetNumber()));
+    REQUIRE(root[4].GetNumber() == 2.2250738585072014e-308);
+
+    REQUIRE_THROWS_AS(JsonReader::Parse("1e400"), JsonParseException);
+}
+
 TEST_CASE("JsonReader parse string", "[JsonReader]")
 {
     JsonReader reader = JsonReader::Parse(R"("hello")");
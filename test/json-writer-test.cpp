@@ -60,6 +60,13 @@ TEST_CASE("Serialize float", "[JsonWriter]")
     REQUIRE(reader2.GetRoot().GetNumber() == Catch::Approx(3.14));
 }
 
+TEST_CASE("Serialize float uses the shortest round trip representation", "[JsonWriter]")
+{
+    JsonReader reader = JsonReader::Parse("[0.1, -2.5e-8, 1e300, 123456.5]");
+    StringUtf8 result = JsonWriter::Serialize(reader.GetRoot());
+    REQUIRE(StringViewUtf8(result) == StringViewUtf8("[0.1,-2.5e-08,1e+300,123456.5]"));
+}
+
 TEST_CASE("Serialize empty string", "[JsonWriter]")
 {
     JsonReader reader = JsonReader::Parse(R"("")");
@@ -365,3 +372,13 @@ TEST_CASE("Round-trip large integer", "[JsonWriter]")
     JsonReader reader2 = JsonReader::Parse(serialized);
     REQUIRE(reader2.GetRoot().GetIntegerNumber() == 9007199254740993LL);
 }
+
+TEST_CASE("Serialize into StringBuilder", "[JsonWriter]")
+{
+    JsonReader reader = JsonReader::Parse(R"({"a": [1, 2.5, "x\n"], "b": {"c": null}})");
+    StringBuilder builder;
+    builder.Append("prefix:");
+    JsonWriter::Serialize(reader.GetRoot(), builder, JsonWriteOptions{.pretty = true});
+    const StringUtf8 expected = StringUtf8("prefix:") + JsonWriter::Serialize(reader.GetRoot(), JsonWriteOptions{.pretty = true});
+    REQUIRE(builder.ToString() == expected);
+}
@@ -215,6 +215,18 @@ TEST_CASE("Message formatting", "[Logging]")
         REQUIRE(test_sink->m_entries.GetSize() == 1);
     }
 
+    SECTION("Compile-time format string")
+    {
+        logger.Info<"Value: {} ms, {:#x}">("General", 42, 255u);
+        logger.Verbose<"Filtered {}">("General", 1);
+        REQUIRE(test_sink->m_entries.GetSize() == 1);
+
+        StringViewUtf8 msg(test_sink->m_entries[0].message);
+        std::string_view sv(msg.GetData(), msg.GetSize());
+        REQUIRE(sv.find("[Info]") != std::string_view::npos);
+        REQUIRE(sv.find("Value: 42 ms, 0xff") != std::string_view::npos);
+    }
+
     SECTION("Output format contains timestamp, level, category, and message")
     {
         logger.Info("General", "Test message");
@@ -360,6 +360,46 @@ TEST_CASE("Multiple optional arguments partially provided", "[ProgramArguments]"
     SetLogger(nullptr);
 }
 
+TEST_CASE("Numeric arguments", "[ProgramArguments]")
+{
+    Logger logger;
+    SetLogger(&logger);
+
+    SECTION("Floating point and prefixed integer arguments")
+    {
+        f64 ratio = 0;
+        f32 scale = 0;
+        u32 mask = 0;
+
+        ProgramArgumentsBuilder builder;
+        builder.AddArgument("ratio", "Ratio", Ref{ratio}, false);
+        builder.AddArgument("scale", "Scale", Ref{scale}, false);
+        builder.AddArgument("mask", "Mask", Ref{mask}, false);
+
+        const char* arguments[] = {"program-name", "ratio=-0.125", "scale=1e3", "mask=0xff"};
+        REQUIRE_NOTHROW(builder.Build(arguments, 4));
+        REQUIRE(ratio == -0.125);
+        REQUIRE(scale == 1000.0f);
+        REQUIRE(mask == 255);
+    }
+    SECTION("Invalid numbers throw")
+    {
+        f64 ratio = 0;
+        i32 count = 0;
+
+        ProgramArgumentsBuilder builder;
+        builder.AddArgument("ratio", "Ratio", Ref{ratio}, true);
+        builder.AddArgument("count", "Count", Ref{count}, true);
+
+        const char* bad_float[] = {"program-name", "ratio=1.5x"};
+        REQUIRE_THROWS_AS(builder.Build(bad_float, 2), InvalidArgumentException);
+        const char* bad_integer[] = {"program-name", "count=99999999999"};
+        REQUIRE_THROWS_AS(builder.Build(bad_integer, 2), InvalidArgumentException);
+    }
+
+    SetLogger(nullptr);
+}
+
 TEST_CASE("DynamicArray<i32> argument", "[ProgramArguments]")
 {
     Logger logger;
@@ -0,0 +1,198 @@
+#include "test-helpers.h"
+
+#include "opal/container/dynamic-array.h"
+#include "opal/container/ring-buffer.h"
+
+using namespace Opal;
+
+TEST_CASE("Constructor", "[RingBuffer]")
+{
+    SECTION("Capacity is rounded to power of two")
+    {
+        RingBuffer<i32> buffer(5);
+        REQUIRE(buffer.GetCapacity() == 8);
+        REQUIRE(buffer.GetSize() == 0);
+        REQUIRE(buffer.IsEmpty());
+        REQUIRE(!buffer.IsFull());
+        REQUIRE(buffer.GetOverflowPolicy() == RingBufferOverflowPolicy::OverwriteOldest);
+    }
+    SECTION("Zero capacity")
+    {
+        REQUIRE_THROWS_AS(RingBuffer<i32>(0), InvalidArgumentException);
+    }
+    SECTION("Custom allocator")
+    {
+        MallocAllocator allocator;
+        RingBuffer<i32> buffer(4, RingBufferOverflowPolicy::Reject, &allocator);
+        REQUIRE(buffer.GetAllocator() == &allocator);
+        REQUIRE(buffer.GetOverflowPolicy() == RingBufferOverflowPolicy::Reject);
+    }
+    SECTION("Move")
+    {
+        RingBuffer<i32> buffer(4);
+        buffer.PushBack(1);
+        RingBuffer<i32> moved(std::move(buffer));
+        REQUIRE(moved.GetSize() == 1);
+        REQUIRE(moved[0] == 1);
+        RingBuffer<i32> assigned(2);
+        assigned = std::move(moved);
+        REQUIRE(assigned.GetCapacity() == 4);
+        REQUIRE(assigned.Front().GetValue() == 1);
+    }
+}
+
+TEST_CASE("PushBack and PopFront", "[RingBuffer]")
+{
+    SECTION("Overwrite oldest")
+    {
+        RingBuffer<i32> buffer(4);
+        for (i32 i = 0; i < 6; ++i)
+        {
+            REQUIRE(buffer.PushBack(i) == ErrorCode::Success);
+        }
+        REQUIRE(buffer.IsFull());
+        REQUIRE(buffer.GetOverwrittenCount() == 2);
+        REQUIRE(buffer.Front().GetValue() == 2);
+        REQUIRE(buffer.Back().GetValue() == 5);
+        REQUIRE(buffer.PopFront().GetValue() == 2);
+        REQUIRE(buffer.PopFront().GetValue() == 3);
+        REQUIRE(buffer.GetSize() == 2);
+    }
+    SECTION("Reject")
+    {
+        RingBuffer<i32> buffer(2, RingBufferOverflowPolicy::Reject);
+        REQUIRE(buffer.PushBack(1) == ErrorCode::Success);
+        REQUIRE(buffer.PushBack(2) == ErrorCode::Success);
+        REQUIRE(buffer.PushBack(3) == ErrorCode::InsufficientSpace);
+        REQUIRE(buffer.GetOverwrittenCount() == 0);
+        REQUIRE(buffer[0] == 1);
+        REQUIRE(buffer[1] == 2);
+    }
+    SECTION("Empty")
+    {
+        RingBuffer<i32> buffer(2);
+        REQUIRE(buffer.PopFront().GetError() == ErrorCode::OutOfBounds);
+        REQUIRE(buffer.Front().GetError() == ErrorCode::OutOfBounds);
+        REQUIRE(buffer.Back().GetError() == ErrorCode::OutOfBounds);
+    }
+}
+
+TEST_CASE("PushRange and PopRange", "[RingBuffer]")
+{
+    i32 values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    i32 out[10] = {};
+
+    SECTION("Wrapped region")
+    {
+        RingBuffer<i32> buffer(8);
+        REQUIRE(buffer.PushRange(ArrayView<const i32>(values, 6)) == 6);
+        REQUIRE(buffer.PopRange(ArrayView<i32>(out, 4)) == 4);
+        REQUIRE(out[0] == 0);
+        REQUIRE(out[3] == 3);
+        REQUIRE(buffer.PushRange(ArrayView<const i32>(values, 5)) == 5);
+        REQUIRE(buffer.GetSize() == 7);
+        REQUIRE(buffer.PopRange(ArrayView<i32>(out)) == 7);
+        REQUIRE(out[0] == 4);
+        REQUIRE(out[1] == 5);
+        REQUIRE(out[2] == 0);
+        REQUIRE(out[6] == 4);
+        REQUIRE(buffer.IsEmpty());
+    }
+    SECTION("Overwrite with range")
+    {
+        RingBuffer<i32> buffer(4);
+        buffer.PushBack(100);
+        buffer.PushBack(101);
+        REQUIRE(buffer.PushRange(ArrayView<const i32>(values, 3)) == 3);
+        REQUIRE(buffer.GetOverwrittenCount() == 1);
+        REQUIRE(buffer[0] == 101);
+        REQUIRE(buffer[3] == 2);
+    }
+    SECTION("Range larger than capacity keeps the newest elements")
+    {
+        RingBuffer<i32> buffer(4);
+        buffer.PushBack(100);
+        REQUIRE(buffer.PushRange(ArrayView<const i32>(values)) == 10);
+        REQUIRE(buffer.GetOverwrittenCount() == 7);
+        REQUIRE(buffer.GetSize() == 4);
+        REQUIRE(buffer[0] == 6);
+        REQUIRE(buffer[3] == 9);
+    }
+    SECTION("Reject with range")
+    {
+        RingBuffer<i32> buffer(4, RingBufferOverflowPolicy::Reject);
+        buffer.PushBack(100);
+        REQUIRE(buffer.PushRange(ArrayView<const i32>(values)) == 3);
+        REQUIRE(buffer.GetSize() == 4);
+        REQUIRE(buffer[3] == 2);
+    }
+}
+
+TEST_CASE("Read views", "[RingBuffer]")
+{
+    RingBuffer<i32> buffer(8);
+    SECTION("Empty")
+    {
+        RingBufferViews<i32> views = buffer.GetReadViews();
+        REQUIRE(views.first.IsEmpty());
+        REQUIRE(views.second.IsEmpty());
+        REQUIRE(views.GetSize() == 0);
+    }
+    SECTION("Contiguous and wrapped")
+    {
+        for (i32 i = 0; i < 6; ++i)
+        {
+            buffer.PushBack(i);
+        }
+        RingBufferViews<i32> views = buffer.GetReadViews();
+        REQUIRE(views.first.GetSize() == 6);
+        REQUIRE(views.second.IsEmpty());
+
+        REQUIRE(buffer.Consume(5) == 5);
+        for (i32 i = 6; i < 12; ++i)
+        {
+            buffer.PushBack(i);
+        }
+        const RingBuffer<i32>& const_buffer = buffer;
+        RingBufferViews<const i32> const_views = const_buffer.GetReadViews();
+        REQUIRE(const_views.GetSize() == 7);
+        REQUIRE(const_views.first.GetSize() == 3);
+        REQUIRE(const_views.second.GetSize() == 4);
+
+        DynamicArray<i32> drained;
+        for (i32 value : const_views.first)
+        {
+            drained.PushBack(value);
+        }
+        for (i32 value : const_views.second)
+        {
+            drained.PushBack(value);
+        }
+        REQUIRE(drained.GetSize() == 7);
+        for (u64 i = 0; i < drained.GetSize(); ++i)
+        {
+            REQUIRE(drained[i] == static_cast<i32>(i) + 5);
+        }
+        REQUIRE(buffer.Consume(100) == 7);
+        REQUIRE(buffer.IsEmpty());
+    }
+}
+
+TEST_CASE("Clone and Clear", "[RingBuffer]")
+{
+    RingBuffer<i32> buffer(4);
+    for (i32 i = 0; i < 6; ++i)
+    {
+        buffer.PushBack(i);
+    }
+    RingBuffer<i32> clone = buffer.Clone();
+    REQUIRE(clone.GetSize() == 4);
+    REQUIRE(clone.GetOverwrittenCount() == 2);
+    REQUIRE(clone[0] == 2);
+    REQUIRE(clone[3] == 5);
+
+    buffer.Clear();
+    REQUIRE(buffer.IsEmpty());
+    REQUIRE(buffer.GetOverwrittenCount() == 0);
+    REQUIRE(clone.GetSize() == 4);
+}
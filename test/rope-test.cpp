@@ -0,0 +1,171 @@
+#include "test-helpers.h"
+
+#include "opal/bit.h"
+#include "opal/container/rope.h"
+#include "opal/exceptions.h"
+#include "opal/math-base.h"
+#include "opal/rng.h"
+
+using namespace Opal;
+
+namespace
+{
+
+StringUtf8 MakeText(u64 size)
+{
+    StringUtf8 text;
+    for (u64 i = 0; i < size; ++i)
+    {
+        text += static_cast<char8>('a' + (i * 7 + i / 26) % 26);
+    }
+    return text;
+}
+
+u64 CountChunks(const Rope& rope)
+{
+    u64 count = 0;
+    for (StringViewUtf8 chunk : rope.GetChunks())
+    {
+        REQUIRE(!chunk.IsEmpty());
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST_CASE("Construction", "[Rope]")
+{
+    SECTION("Empty")
+    {
+        Rope rope;
+        REQUIRE(rope.IsEmpty());
+        REQUIRE(rope.GetSize() == 0);
+        REQUIRE(rope.ToString().IsEmpty());
+        REQUIRE(rope.GetChunks().begin() == rope.GetChunks().end());
+        REQUIRE_THROWS_AS(rope.At(0), OutOfBoundsException);
+    }
+    SECTION("Large text is split into balanced leaves")
+    {
+        const StringUtf8 text = MakeText(100 * Rope::k_max_leaf_size + 17);
+        Rope rope(text);
+        REQUIRE(rope.GetSize() == text.GetSize());
+        REQUIRE(rope.ToString() == text);
+        REQUIRE(CountChunks(rope) == 101);
+        REQUIRE(rope.GetHeight() == 7);
+        REQUIRE(rope.At(0) == text[0]);
+        REQUIRE(rope.At(5000) == text[5000]);
+        REQUIRE(rope.At(text.GetSize() - 1) == text[text.GetSize() - 1]);
+    }
+    SECTION("Allocator must be thread-safe")
+    {
+        LinearAllocator allocator("NonThreadSafe");
+        REQUIRE_THROWS_AS(Rope(&allocator), InvalidArgumentException);
+    }
+}
+
+TEST_CASE("Insert and Erase", "[Rope]")
+{
+    Rope rope("Hello World");
+    rope.Insert(5, ",");
+    rope.Insert(rope.GetSize(), "!");
+    rope.Insert(0, ">> ");
+    REQUIRE(rope.ToString() == ">> Hello, World!");
+    rope.Erase(0, 3);
+    rope.Erase(5, 1);
+    REQUIRE(rope.ToString() == "Hello World!");
+    rope.Erase(5);
+    REQUIRE(rope.ToString() == "Hello");
+    REQUIRE_THROWS_AS(rope.Insert(6, "x"), OutOfBoundsException);
+    REQUIRE_THROWS_AS(rope.Erase(6, 1), OutOfBoundsException);
+    // Small neighbouring leaves are merged
+    REQUIRE(CountChunks(rope) == 1);
+}
+
+TEST_CASE("Sharing", "[Rope]")
+{
+    const StringUtf8 text = MakeText(10 * Rope::k_max_leaf_size);
+    Rope rope(text);
+    Rope clone = rope.Clone();
+    clone.Insert(100, "inserted");
+    REQUIRE(rope.ToString() == text);
+    REQUIRE(clone.GetSize() == text.GetSize() + 8);
+
+    SECTION("SubRope")
+    {
+        Rope sub = rope.SubRope(3000, 5000);
+        REQUIRE(sub.ToString() == StringUtf8(text.GetData() + 3000, 5000));
+        REQUIRE(rope.SubRope(text.GetSize()).IsEmpty());
+        REQUIRE(rope.SubRope(10).GetSize() == text.GetSize() - 10);
+    }
+    SECTION("Append ropes")
+    {
+        Rope doubled = rope.Clone();
+        doubled.Append(rope);
+        REQUIRE(doubled.GetSize() == 2 * text.GetSize());
+        REQUIRE(doubled.ToString() == text + text);
+        REQUIRE(CountChunks(doubled) == 20);
+        doubled.Insert(text.GetSize(), rope);
+        REQUIRE(doubled.GetSize() == 3 * text.GetSize());
+    }
+}
+
+TEST_CASE("Random edits match StringUtf8", "[Rope]")
+{
+    RNG rng(42);
+    StringUtf8 expected = MakeText(20000);
+    Rope rope(expected);
+    for (i32 i = 0; i < 2000; ++i)
+    {
+        const u64 pos = rng.RandomU32(0, static_cast<u32>(expected.GetSize()));
+        const u32 operation = rng.RandomU32(0, 3);
+        if (operation == 0 && pos < expected.GetSize())
+        {
+            const u64 count = Min<u64>(rng.RandomU32(1, 300), expected.GetSize() - pos);
+            rope.Erase(pos, count);
+            REQUIRE(expected.Erase(pos, count).HasValue());
+        }
+        else if (operation == 1)
+        {
+            const StringUtf8 text = MakeText(rng.RandomU32(1, 3000));
+            rope.Insert(pos, text);
+            REQUIRE(expected.Insert(pos, text).HasValue());
+        }
+        else
+        {
+            rope.Insert(pos, "x");
+            REQUIRE(expected.Insert(pos, "x").HasValue());
+        }
+        REQUIRE(rope.GetSize() == expected.GetSize());
+    }
+    REQUIRE(rope.ToString() == expected);
+    // AVL trees are never more than 1.45 log2(n) high
+    REQUIRE(rope.GetHeight() <= 2 * (64 - CountLeadingZeros(CountChunks(rope))));
+}
+
+TEST_CASE("Find", "[Rope]")
+{
+    Rope rope;
+    for (i32 i = 0; i < 200; ++i)
+    {
+        rope.Append("abc");
+        rope.Append(Rope(MakeText(700)));
+    }
+    rope.Insert(rope.GetSize() / 2, "needle");
+    const StringUtf8 text = rope.ToString();
+    const char8* needles[] = {"needle", "ca", "bcab", "a", "zzzz", ""};
+    for (const char8* needle : needles)
+    {
+        for (u64 start_pos : {u64{0}, u64{1}, u64{701}, text.GetSize() / 2, text.GetSize() - 1, text.GetSize()})
+        {
+            REQUIRE(Find(rope, needle, start_pos) == Find(text, needle, start_pos));
+        }
+    }
+    // Match that crosses leaves that were merged and split by edits
+    Rope split("hello");
+    split.Append(Rope(StringUtf8(Rope::k_merge_leaf_size, ' ')));
+    split.Append(Rope("world"));
+    split.Erase(5, Rope::k_merge_leaf_size - 1);
+    REQUIRE(split.ToString() == "hello world");
+    REQUIRE(Find(split, "o w") == 4);
+}
@@ -16,6 +16,46 @@ struct Derived : public Base
     i32 extra = 0;
 };
 
+namespace
+{
+
+struct CountingAllocator final : AllocatorBase
+{
+    CountingAllocator() : AllocatorBase("Counting") {}
+
+    void* Alloc(u64 size, u64 alignment) override
+    {
+        ++alloc_count;
+        last_alignment = alignment;
+        return malloc_allocator.Alloc(size, alignment);
+    }
+    void Free(void* ptr) override
+    {
+        ++free_count;
+        malloc_allocator.Free(ptr);
+    }
+    [[nodiscard]] bool IsThreadSafe() const override { return true; }
+
+    MallocAllocator malloc_allocator;
+    i32 alloc_count = 0;
+    i32 free_count = 0;
+    u64 last_alignment = 0;
+};
+
+i32 g_destroyed_count = 0;
+
+struct PlainBase
+{
+    i32 value = 0;
+};
+
+struct TrackedDerived : PlainBase
+{
+    ~TrackedDerived() { ++g_destroyed_count; }
+};
+
+}  // namespace
+
 TEMPLATE_TEST_CASE("SharedPtr default construction", "[SharedPtr]",
                     (std::integral_constant<ThreadingPolicy, ThreadingPolicy::ThreadSafe>),
                     (std::integral_constant<ThreadingPolicy, ThreadingPolicy::SingleThread>))
@@ -476,3 +516,105 @@ TEMPLATE_TEST_CASE("MakeShared with constructor arguments", "[SharedPtr]",
     REQUIRE(ptr->a == 3);
     REQUIRE(ptr->b == 7);
 }
+
+TEMPLATE_TEST_CASE("SharedPtr object and reference count share one allocation", "[SharedPtr]",
+                    (std::integral_constant<ThreadingPolicy, ThreadingPolicy::ThreadSafe>),
+                    (std::integral_constant<ThreadingPolicy, ThreadingPolicy::SingleThread>))
+{
+    constexpr ThreadingPolicy k_policy = TestType::value;
+
+    CountingAllocator allocator;
+    SECTION("In-place construction")
+    {
+        SharedPtr<i32, k_policy> ptr(&allocator, 5);
+        REQUIRE(allocator.alloc_count == 1);
+        // Block is 40 bytes, so it is aligned to 64 and never crosses a cache line
+        REQUIRE(allocator.last_alignment == 64);
+        SharedPtr<i32, k_policy> clone = ptr.Clone();
+        REQUIRE(allocator.alloc_count == 1);
+        ptr.Reset();
+        REQUIRE(allocator.free_count == 0);
+        clone.Reset();
+        REQUIRE(allocator.free_count == 1);
+    }
+    SECTION("MakeShared")
+    {
+        auto ptr = MakeShared<Base, Derived, k_policy>(&allocator);
+        REQUIRE(allocator.alloc_count == 1);
+        ptr.Reset();
+        REQUIRE(allocator.free_count == 1);
+    }
+    SECTION("Raw pointer needs a separate control block")
+    {
+        i32* raw = New<i32>(&allocator, 10);
+        SharedPtr<i32, k_policy> ptr(&allocator, raw);
+        REQUIRE(allocator.alloc_count == 2);
+        ptr.Reset();
+        REQUIRE(allocator.free_count == 2);
+    }
+}
+
+TEST_CASE("MakeShared destroys the object as the derived type", "[SharedPtr]")
+{
+    g_destroyed_count = 0;
+    SharedPtr<PlainBase> ptr = MakeShared<PlainBase, TrackedDerived>(nullptr);
+    SharedPtr<PlainBase> clone = ptr.Clone();
+    ptr.Reset();
+    REQUIRE(g_destroyed_count == 0);
+    clone.Reset();
+    REQUIRE(g_destroyed_count == 1);
+}
+
+TEMPLATE_TEST_CASE("WeakPtr", "[SharedPtr]",
+                    (std::integral_constant<ThreadingPolicy, ThreadingPolicy::ThreadSafe>),
+                    (std::integral_constant<ThreadingPolicy, ThreadingPolicy::SingleThread>))
+{
+    constexpr ThreadingPolicy k_policy = TestType::value;
+
+    SECTION("Default is expired")
+    {
+        WeakPtr<i32, k_policy> weak;
+        REQUIRE(weak.IsExpired());
+        REQUIRE_FALSE(weak.Lock().IsValid());
+    }
+    SECTION("Lock shares ownership")
+    {
+        SharedPtr<i32, k_policy> ptr(nullptr, 42);
+        WeakPtr<i32, k_policy> weak(ptr);
+        REQUIRE(ptr.GetReferenceCount() == 1);
+        REQUIRE_FALSE(weak.IsExpired());
+        SharedPtr<i32, k_policy> locked = weak.Lock();
+        REQUIRE(locked == ptr);
+        REQUIRE(*locked.Get() == 42);
+        REQUIRE(ptr.GetReferenceCount() == 2);
+    }
+    SECTION("Object is destroyed while weak pointers remain")
+    {
+        g_destroyed_count = 0;
+        CountingAllocator allocator;
+        SharedPtr<PlainBase, k_policy> ptr = MakeShared<PlainBase, TrackedDerived, k_policy>(&allocator);
+        WeakPtr<PlainBase, k_policy> weak(ptr);
+        WeakPtr<PlainBase, k_policy> weak_clone = weak.Clone();
+        ptr.Reset();
+        REQUIRE(g_destroyed_count == 1);
+        REQUIRE(weak.IsExpired());
+        REQUIRE(weak_clone.IsExpired());
+        REQUIRE_FALSE(weak.Lock().IsValid());
+        REQUIRE(allocator.free_count == 0);
+        weak.Reset();
+        REQUIRE(allocator.free_count == 0);
+        WeakPtr<PlainBase, k_policy> moved(std::move(weak_clone));
+        moved.Reset();
+        REQUIRE(allocator.free_count == 1);
+    }
+    SECTION("Raw pointer object is freed before the control block")
+    {
+        CountingAllocator allocator;
+        SharedPtr<i32, k_policy> ptr(&allocator, New<i32>(&allocator, 1));
+        WeakPtr<i32, k_policy> weak(ptr);
+        ptr.Reset();
+        REQUIRE(allocator.free_count == 1);
+        weak.Reset();
+        REQUIRE(allocator.free_count == 2);
+    }
+}
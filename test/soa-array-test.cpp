@@ -0,0 +1,181 @@
+#include "test-helpers.h"
+
+#include "opal/container/soa-array.h"
+#include "opal/container/string.h"
+#include "opal/math/point3.h"
+#include "opal/math/vector3.h"
+
+using namespace Opal;
+
+TEST_CASE("Constructor", "[SoaArray]")
+{
+    SECTION("Default constructor")
+    {
+        SoaArray<f32, i32> array;
+        REQUIRE(array.GetSize() == 0);
+        REQUIRE(array.GetCapacity() == 0);
+        REQUIRE(array.IsEmpty());
+        REQUIRE(array.GetAllocator() == GetDefaultAllocator());
+    }
+    SECTION("Custom allocator")
+    {
+        MallocAllocator allocator;
+        SoaArray<f32, i32> array(&allocator);
+        REQUIRE(array.GetAllocator() == &allocator);
+    }
+    SECTION("Move constructor")
+    {
+        SoaArray<f32, i32> array;
+        array.PushBack(1.0f, 2);
+        SoaArray<f32, i32> moved(std::move(array));
+        REQUIRE(moved.GetSize() == 1);
+        REQUIRE(moved.Get<0>(0) == 1.0f);
+        REQUIRE(moved.Get<1>(0) == 2);
+        REQUIRE(array.GetSize() == 0);
+        REQUIRE(array.GetCapacity() == 0);
+    }
+    SECTION("Move assignment")
+    {
+        SoaArray<f32, i32> array;
+        array.PushBack(1.0f, 2);
+        SoaArray<f32, i32> other;
+        other.PushBack(3.0f, 4);
+        other.PushBack(5.0f, 6);
+        other = std::move(array);
+        REQUIRE(other.GetSize() == 1);
+        REQUIRE(other.Get<1>(0) == 2);
+    }
+}
+
+TEST_CASE("Capacity granularity", "[SoaArray]")
+{
+    REQUIRE(SoaArray<f32>::k_capacity_granularity == 16);
+    REQUIRE(SoaArray<f64>::k_capacity_granularity == 8);
+    REQUIRE(SoaArray<u8, f64>::k_capacity_granularity == 64);
+    REQUIRE(SoaArray<Vector3<f32>>::k_capacity_granularity == 16);
+
+    SoaArray<u8, f32, Vector3<f32>> array;
+    array.Reserve(10);
+    REQUIRE(array.GetCapacity() == 64);
+    array.Reserve(65);
+    REQUIRE(array.GetCapacity() == 128);
+    array.Reserve(5);
+    REQUIRE(array.GetCapacity() == 128);
+}
+
+TEST_CASE("Columns are aligned", "[SoaArray]")
+{
+    SoaArray<u8, f32, Vector3<f32>, f64> array;
+    for (i32 i = 0; i < 100; ++i)
+    {
+        array.PushBack(static_cast<u8>(i), static_cast<f32>(i), Vector3<f32>(1, 2, 3), static_cast<f64>(i));
+    }
+    REQUIRE(reinterpret_cast<u64>(array.GetColumn<0>().GetData()) % OPAL_CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<u64>(array.GetColumn<1>().GetData()) % OPAL_CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<u64>(array.GetColumn<2>().GetData()) % OPAL_CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<u64>(array.GetColumn<3>().GetData()) % OPAL_CACHE_LINE_SIZE == 0);
+    REQUIRE(array.GetPaddedSize() == 128);
+    REQUIRE(array.GetPaddedColumn<1>().GetSize() == 128);
+    REQUIRE(array.GetPaddedColumn<1>()[127] == 0.0f);
+}
+
+TEST_CASE("PushBack and access", "[SoaArray]")
+{
+    SoaArray<i32, f32> array;
+    for (i32 i = 0; i < 50; ++i)
+    {
+        array.PushBack(i, static_cast<f32>(i) * 0.5f);
+    }
+    REQUIRE(array.GetSize() == 50);
+    REQUIRE(array.GetCapacity() >= 50);
+    REQUIRE(array.GetCapacity() % SoaArray<i32, f32>::k_capacity_granularity == 0);
+
+    ArrayView<i32> ids = array.GetColumn<0>();
+    ArrayView<f32> values = array.GetColumn<1>();
+    REQUIRE(ids.GetSize() == 50);
+    REQUIRE(values.GetSize() == 50);
+    for (u64 i = 0; i < 50; ++i)
+    {
+        REQUIRE(ids[i] == static_cast<i32>(i));
+        REQUIRE(values[i] == static_cast<f32>(i) * 0.5f);
+    }
+
+    const SoaArray<i32, f32>& const_array = array;
+    ArrayView<const f32> const_values = const_array.GetColumn<1>();
+    REQUIRE(const_values[10] == 5.0f);
+    REQUIRE(const_array.Get<0>(49) == 49);
+}
+
+TEST_CASE("Erase", "[SoaArray]")
+{
+    SoaArray<i32, f32> array;
+    for (i32 i = 0; i < 5; ++i)
+    {
+        array.PushBack(i, static_cast<f32>(i));
+    }
+    SECTION("Erase middle swaps in the last element")
+    {
+        array.Erase(1);
+        REQUIRE(array.GetSize() == 4);
+        REQUIRE(array.Get<0>(1) == 4);
+        REQUIRE(array.Get<1>(1) == 4.0f);
+        REQUIRE(array.Get<0>(3) == 3);
+    }
+    SECTION("Erase last")
+    {
+        array.Erase(4);
+        REQUIRE(array.GetSize() == 4);
+        REQUIRE(array.Get<0>(3) == 3);
+    }
+    SECTION("Erase out of bounds")
+    {
+        REQUIRE_THROWS_AS(array.Erase(5), OutOfBoundsException);
+    }
+    SECTION("PopBack and Clear")
+    {
+        array.PopBack();
+        REQUIRE(array.GetSize() == 4);
+        const u64 capacity = array.GetCapacity();
+        array.Clear();
+        REQUIRE(array.IsEmpty());
+        REQUIRE(array.GetCapacity() == capacity);
+        REQUIRE(array.GetColumn<0>().IsEmpty());
+    }
+}
+
+TEST_CASE("Non-POD columns", "[SoaArray]")
+{
+    SoaArray<StringUtf8, i32> array;
+    for (i32 i = 0; i < 40; ++i)
+    {
+        array.PushBack(StringUtf8("name"), i);
+    }
+    array.Get<0>(39) = StringUtf8("last");
+    array.Erase(0);
+    REQUIRE(array.GetSize() == 39);
+    REQUIRE(array.Get<0>(0) == "last");
+    REQUIRE(array.Get<1>(0) == 39);
+
+    SoaArray<StringUtf8, i32> clone = array.Clone();
+    REQUIRE(clone.GetSize() == 39);
+    REQUIRE(clone.Get<0>(0) == "last");
+    REQUIRE(clone.Get<0>(1) == "name");
+    REQUIRE(clone.Get<1>(38) == 38);
+}
+
+TEST_CASE("Math kernels over columns", "[SoaArray]")
+{
+    SoaArray<Point3<f32>, Vector3<f32>> particles;
+    for (i32 i = 0; i < 20; ++i)
+    {
+        particles.PushBack(Point3<f32>(0, 0, 0), Vector3<f32>(1, static_cast<f32>(i), 2));
+    }
+    ArrayView<Point3<f32>> positions = particles.GetPaddedColumn<0>();
+    ArrayView<const Vector3<f32>> velocities = static_cast<const SoaArray<Point3<f32>, Vector3<f32>>&>(particles).GetPaddedColumn<1>();
+    for (u64 i = 0; i < positions.GetSize(); ++i)
+    {
+        positions[i] = positions[i] + velocities[i] * 0.5f;
+    }
+    REQUIRE(particles.Get<0>(0) == Point3<f32>(0.5f, 0.0f, 1.0f));
+    REQUIRE(particles.Get<0>(19) == Point3<f32>(0.5f, 9.5f, 1.0f));
+}
@@ -0,0 +1,107 @@
+#include "test-helpers.h"
+
+#include <format>
+
+#include "opal/container/dynamic-array.h"
+#include "opal/container/string-builder.h"
+#include "opal/container/string-format.h"
+#include "opal/file-system.h"
+#include "opal/paths.h"
+
+using namespace Opal;
+
+TEST_CASE("Append", "[StringBuilder]")
+{
+    StringBuilder builder;
+    REQUIRE(builder.IsEmpty());
+    REQUIRE(builder.GetAllocator() == GetDefaultAllocator());
+    REQUIRE(builder.ToString().IsEmpty());
+
+    builder.Append('a');
+    builder.Append("bcd");
+    builder.Append(StringViewUtf8("ef"));
+    builder.Append(3, 'x');
+    builder += 'y';
+    builder += "z";
+    builder.Append(nullptr, 0);
+    REQUIRE(builder.GetSize() == 11);
+    REQUIRE(builder.ToString() == "abcdefxxxyz");
+}
+
+TEST_CASE("Chunks grow geometrically", "[StringBuilder]")
+{
+    StringBuilder builder;
+    StringUtf8 expected;
+    for (i32 i = 0; i < 20000; ++i)
+    {
+        const char8 value = static_cast<char8>('a' + i % 26);
+        builder.Append(value);
+        expected.Append(value);
+    }
+    REQUIRE(builder.GetSize() == expected.GetSize());
+    REQUIRE(builder.ToString() == expected);
+
+    DynamicArray<u64> sizes;
+    u64 total = 0;
+    for (StringViewUtf8 chunk : builder.GetChunks())
+    {
+        sizes.PushBack(chunk.GetSize());
+        total += chunk.GetSize();
+    }
+    REQUIRE(total == expected.GetSize());
+    REQUIRE(sizes.GetSize() == 7);
+    REQUIRE(sizes[0] == StringBuilder::k_min_chunk_size);
+    REQUIRE(sizes[1] == 2 * StringBuilder::k_min_chunk_size);
+
+    SECTION("Large append that does not fit the next chunk")
+    {
+        const StringUtf8 large(3 * StringBuilder::k_max_chunk_size, 'q');
+        builder.Append(large.GetData(), large.GetSize());
+        expected.Append(large);
+        REQUIRE(builder.ToString() == expected);
+    }
+    SECTION("Clear")
+    {
+        builder.Clear();
+        REQUIRE(builder.IsEmpty());
+        REQUIRE(builder.GetChunks().begin() == builder.GetChunks().end());
+        builder.Append("again");
+        REQUIRE(builder.ToString() == "again");
+    }
+}
+
+TEST_CASE("Scratch allocator", "[StringBuilder]")
+{
+    LinearAllocator scratch("StringBuilderScratch");
+    StringBuilder builder(&scratch);
+    builder.Append(1000, '-');
+    StringBuilder moved(std::move(builder));
+    REQUIRE(builder.IsEmpty());
+    REQUIRE(moved.GetAllocator() == &scratch);
+    StringUtf8 output("start");
+    moved.AppendTo(output);
+    REQUIRE(output.GetSize() == 1005);
+}
+
+TEST_CASE("Format into StringBuilder", "[StringBuilder]")
+{
+    StringBuilder builder;
+    AppendFormat(builder, "{} + {} = {}", 1, 2, 3);
+    AppendFormat(builder, ", literal");
+    const f64 value = 3.14159;
+    std::vformat_to(builder.GetFormatIterator(), " {:.2f}", std::make_format_args(value));
+    REQUIRE(builder.ToString() == "1 + 2 = 3, literal 3.14");
+}
+
+TEST_CASE("WriteToFile", "[StringBuilder]")
+{
+    const StringUtf8 path = Paths::Combine(Paths::GetCurrentWorkingDirectory(), "string-builder.txt");
+    StringBuilder builder;
+    for (i32 i = 0; i < 1000; ++i)
+    {
+        AppendFormat(builder, "line {}\n", i);
+    }
+    builder.WriteToFile(path);
+    REQUIRE(ReadFileAsString(path) == builder.ToString());
+    DeleteFile(path);
+}
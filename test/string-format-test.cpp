@@ -22,6 +22,19 @@ TEST_CASE("Format float", "[StringFormat]")
     REQUIRE(StringViewUtf8(result) == StringViewUtf8("3.14"));
 }
 
+TEST_CASE("Format single number matches std::format", "[StringFormat]")
+{
+    REQUIRE(Format("{}", -123456789) == "-123456789");
+    REQUIRE(Format("{}", 0.1) == "0.1");
+    REQUIRE(Format("{}", 1e100) == "1e+100");
+    REQUIRE(Format("{}", 2.5f) == "2.5");
+    REQUIRE(Format("{}", 'x') == "x");
+
+    StringBuilder builder;
+    AppendFormat(builder, "{}", 18446744073709551615ull);
+    REQUIRE(builder.ToString() == "18446744073709551615");
+}
+
 TEST_CASE("Format multiple args", "[StringFormat]")
 {
     StringUtf8 result = Format("{} + {} = {}", 1, 2, 3);
@@ -58,3 +71,81 @@ TEST_CASE("Format with hex", "[StringFormat]")
     StringUtf8 result = Format("{:#x}", 255);
     REQUIRE(StringViewUtf8(result) == StringViewUtf8("0xff"));
 }
+
+TEST_CASE("Compile-time format", "[StringFormat]")
+{
+    SECTION("Literals and arguments")
+    {
+        REQUIRE(Format<"">().IsEmpty());
+        REQUIRE(Format<"literal">() == "literal");
+        REQUIRE(Format<"{} + {} = {}">(1, 2, 3) == "1 + 2 = 3");
+        REQUIRE(Format<"{{{}}} }}{{">(7) == "{7} }{");
+        REQUIRE(Format<"{1}{0}{1}">('a', 'b') == "bab");
+    }
+    SECTION("Argument types")
+    {
+        const StringUtf8 str("string");
+        const StringViewUtf8 view("view");
+        const char8* c_str = "c string";
+        REQUIRE(Format<"{} {} {} {}">(str, view, c_str, "literal") == "string view c string literal");
+        REQUIRE(Format<"{} {} {}">(true, false, 'x') == "true false x");
+        REQUIRE(Format<"{} {} {}">(-9223372036854775807ll - 1, 18446744073709551615ull, static_cast<u8>(200)) ==
+                "-9223372036854775808 18446744073709551615 200");
+        REQUIRE(Format<"{} {} {}">(0.1, 1e100, 2.5f) == "0.1 1e+100 2.5");
+    }
+    SECTION("Integer options")
+    {
+        REQUIRE(Format<"{:x}|{:X}|{:#x}|{:#X}">(255, 255, 255, 255) == "ff|FF|0xff|0XFF");
+        REQUIRE(Format<"{:x}|{:#X}|{:#x}">(0, -1, -2147483647 - 1) == "0|-0X1|-0x80000000");
+        REQUIRE(Format<"{:b}|{:#b}|{:o}|{:#o}|{:#o}|{:d}">(255, 0, 255, 255, 0, -1) == "11111111|0b0|377|0377|0|-1");
+        REQUIRE(Format<"{:04}|{:8}|{:#010x}|{:012b}">(-1, -1, -1, -1) == "-001|      -1|-0x0000001|-00000000001");
+        REQUIRE(Format<"{:04}|{:8}|{:#010x}|{:012b}">(255, 255, 255, 255) == "0255|     255|0x000000ff|000011111111");
+        REQUIRE(Format<"{:2}|{:#b}">(-2147483647 - 1, 18446744073709551615ull) ==
+                "-2147483648|0b1111111111111111111111111111111111111111111111111111111111111111");
+        REQUIRE(Format<"{:02x}">(static_cast<u8>(10)) == "0a");
+    }
+    SECTION("Other options use std::format")
+    {
+        REQUIRE(Format<"{:.2f}">(3.14159) == "3.14");
+        REQUIRE(Format<"{:e}">(1500.0) == "1.500000e+03");
+        REQUIRE(Format<"[{:>6}]">(StringViewUtf8("ab")) == "[    ab]");
+        REQUIRE(Format<"[{:*^7}]">(42) == "[**42***]");
+    }
+}
+
+TEST_CASE("Compile-time format outputs", "[StringFormat]")
+{
+    SECTION("Append to string")
+    {
+        StringUtf8 str("prefix: ");
+        AppendFormat<"value={}">(str, 99);
+        REQUIRE(str == "prefix: value=99");
+        for (i32 i = 0; i < 100; i++)
+        {
+            AppendFormat<",{}">(str, i);
+        }
+        REQUIRE(str.GetSize() == 16 + 10 * 2 + 90 * 3);
+    }
+    SECTION("Append to string builder")
+    {
+        StringBuilder builder;
+        AppendFormat<"{}={:#x};">(builder, "key", 255u);
+        AppendFormat<"{:.1f}">(builder, 0.25);
+        REQUIRE(builder.ToString() == "key=0xff;0.2");
+    }
+    SECTION("Fixed buffer")
+    {
+        char8 buffer[8];
+        Expected<char8*, ErrorCode> end = FormatTo<"{}-{}">(buffer, buffer + 8, 12, "ab");
+        REQUIRE(end.HasValue());
+        REQUIRE(StringViewUtf8(buffer, static_cast<u64>(end.GetValue() - buffer)) == "12-ab");
+
+        end = FormatTo<"{}-{}">(buffer, buffer + 8, 123456, "abcd");
+        REQUIRE(end.GetError() == ErrorCode::InsufficientSpace);
+        REQUIRE(StringViewUtf8(buffer, 8) == "123456-a");
+
+        end = FormatTo<"{:.3f}">(buffer, buffer + 4, 1.0);
+        REQUIRE(end.GetError() == ErrorCode::InsufficientSpace);
+        REQUIRE(StringViewUtf8(buffer, 4) == "1.00");
+    }
+}
@@ -0,0 +1,113 @@
+#include "test-helpers.h"
+
+#include "opal/container/dynamic-array.h"
+#include "opal/container/hash-map.h"
+#include "opal/container/string-pool.h"
+#include "opal/container/string.h"
+#include "opal/threading/thread.h"
+
+using namespace Opal;
+
+TEST_CASE("Intern", "[StringPool]")
+{
+    StringPool pool;
+    SECTION("Equal strings share a handle")
+    {
+        const StringUtf8 first("category");
+        const StringUtf8 second("category");
+        InternedString a = pool.Intern(first);
+        InternedString b = pool.Intern(second);
+        REQUIRE(a == b);
+        REQUIRE(a.GetData() == b.GetData());
+        REQUIRE(a.GetData() != first.GetData());
+        REQUIRE(a.GetView() == StringViewUtf8("category"));
+        REQUIRE(a.GetSize() == 8);
+        REQUIRE(a.GetData()[8] == 0);
+        REQUIRE(a.GetHash() == Hash::CalcRawArray(reinterpret_cast<const u8*>("category"), 8));
+        REQUIRE(pool.GetSize() == 1);
+    }
+    SECTION("Different strings get different handles")
+    {
+        InternedString a = pool.Intern("alpha");
+        InternedString b = pool.Intern("alphb");
+        InternedString c = pool.Intern("alph");
+        REQUIRE_FALSE(a == b);
+        REQUIRE_FALSE(a == c);
+        REQUIRE(pool.GetSize() == 3);
+    }
+    SECTION("Empty string")
+    {
+        InternedString empty = pool.Intern("");
+        REQUIRE(empty.IsEmpty());
+        REQUIRE(empty == InternedString());
+        REQUIRE(empty.GetSize() == 0);
+        REQUIRE(empty.GetData()[0] == 0);
+        REQUIRE(pool.GetSize() == 0);
+    }
+    SECTION("Handle is pointer-sized")
+    {
+        REQUIRE(sizeof(InternedString) == sizeof(void*));
+    }
+    SECTION("Handles stay valid while the pool grows")
+    {
+        InternedString first = pool.Intern("first");
+        const char8* data = first.GetData();
+        for (i32 i = 0; i < 5000; ++i)
+        {
+            StringUtf8 key("key_");
+            key += static_cast<char8>('a' + i % 26);
+            key.Append(static_cast<u64>(i % 97), 'x');
+            pool.Intern(key);
+        }
+        REQUIRE(pool.Intern("first").GetData() == data);
+        REQUIRE(first.GetView() == StringViewUtf8("first"));
+    }
+}
+
+TEST_CASE("Find", "[StringPool]")
+{
+    StringPool pool;
+    InternedString interned = pool.Intern("present");
+    REQUIRE(pool.Find("present").GetValue() == interned);
+    REQUIRE(pool.Find("absent").GetError() == ErrorCode::StringNotFound);
+    REQUIRE(pool.GetSize() == 1);
+    REQUIRE(pool.Find("").GetValue().IsEmpty());
+}
+
+TEST_CASE("Interned strings as HashMap keys", "[StringPool]")
+{
+    StringPool pool;
+    HashMap<InternedString, i32> map;
+    map.Insert(pool.Intern("one"), 1);
+    map.Insert(pool.Intern("two"), 2);
+    REQUIRE(map.GetValue(pool.Intern("one")) == 1);
+    REQUIRE(map.GetValue(pool.Intern("two")) == 2);
+    REQUIRE_FALSE(map.Contains(pool.Intern("three")));
+}
+
+TEST_CASE("Concurrent Intern", "[StringPool]")
+{
+    constexpr i32 k_count = 500;
+    StringPool pool;
+    auto work = [](StringPool& shared, DynamicArray<InternedString>& out)
+    {
+        for (i32 i = 0; i < k_count; ++i)
+        {
+            StringUtf8 str("name");
+            str += static_cast<char8>('a' + i % 26);
+            str += static_cast<char8>('a' + i / 26);
+            out.PushBack(shared.Intern(str));
+        }
+    };
+    DynamicArray<InternedString> first;
+    DynamicArray<InternedString> second;
+    ThreadHandle a = CreateThread(work, Ref<StringPool>(pool), Ref<DynamicArray<InternedString>>(first));
+    ThreadHandle b = CreateThread(work, Ref<StringPool>(pool), Ref<DynamicArray<InternedString>>(second));
+    JoinThread(a);
+    JoinThread(b);
+    REQUIRE(pool.GetSize() == k_count);
+    for (u64 i = 0; i < first.GetSize(); ++i)
+    {
+        REQUIRE(first[i] == second[i]);
+    }
+}
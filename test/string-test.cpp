@@ -1,4 +1,6 @@
+#include <clocale>
 #include <iostream>
+#include <limits>
 
 #include "test-helpers.h"
 
@@ -8,6 +10,8 @@
 #include "opal/container/hash-map.h"
 #include "opal/container/string-hash.h"
 #include "opal/container/string-view.h"
+#include "opal/math-base.h"
+#include "opal/rng.h"
 
 using namespace Opal;
 
@@ -1979,6 +1983,138 @@ TEST_CASE("Transcode with empty destination", "[String]")
     }
 }
 
+TEST_CASE("ValidateUtf8", "[String]")
+{
+    auto validate = [](std::initializer_list<u8> bytes) { return ValidateUtf8(ArrayView<const u8>(bytes.begin(), bytes.size())); };
+    SECTION("Valid input")
+    {
+        REQUIRE(validate({}));
+        REQUIRE(validate({'a', 'b', 'c'}));
+        REQUIRE(validate({0xC2, 0x80}));
+        REQUIRE(validate({0xE0, 0xA0, 0x80}));
+        REQUIRE(validate({0xED, 0x9F, 0xBF}));
+        REQUIRE(validate({0xEF, 0xBF, 0xBF}));
+        REQUIRE(validate({0xF0, 0x90, 0x80, 0x80}));
+        REQUIRE(validate({0xF4, 0x8F, 0xBF, 0xBF}));
+    }
+    SECTION("Invalid input")
+    {
+        REQUIRE_FALSE(validate({0x80}));
+        REQUIRE_FALSE(validate({0xC0, 0x80}));
+        REQUIRE_FALSE(validate({0xC1, 0xBF}));
+        REQUIRE_FALSE(validate({0xE0, 0x9F, 0xBF}));
+        REQUIRE_FALSE(validate({0xED, 0xA0, 0x80}));
+        REQUIRE_FALSE(validate({0xF0, 0x8F, 0xBF, 0xBF}));
+        REQUIRE_FALSE(validate({0xF4, 0x90, 0x80, 0x80}));
+        REQUIRE_FALSE(validate({0xF5, 0x80, 0x80, 0x80}));
+        REQUIRE_FALSE(validate({0xE2, 0x28, 0xA1}));
+        REQUIRE_FALSE(validate({0xE2, 0x82}));
+        REQUIRE_FALSE(validate({0xFF}));
+    }
+    SECTION("Errors after long ASCII runs")
+    {
+        for (u64 size = 0; size < 80; ++size)
+        {
+            StringUtf8 str(size, 'x');
+            const ArrayView<const u8> valid(reinterpret_cast<const u8*>(str.GetData()), str.GetSize());
+            REQUIRE(ValidateUtf8(valid));
+            str += static_cast<char8>(0xC3);
+            const ArrayView<const u8> truncated(reinterpret_cast<const u8*>(str.GetData()), str.GetSize());
+            REQUIRE_FALSE(ValidateUtf8(truncated));
+        }
+    }
+}
+
+TEST_CASE("Transcode mixed text in bulk", "[String]")
+{
+    // ASCII runs longer than a vector with multibyte characters at every offset
+    StringUtf32 utf32;
+    const uchar32 others[] = {U'\u00E9', U'\u65E5', U'\U0001F600'};
+    for (u64 i = 0; i < 200; ++i)
+    {
+        utf32 += static_cast<uchar32>(U'a' + i % 26);
+        if (i % 37 == 36)
+        {
+            utf32 += others[i % 3];
+        }
+    }
+
+    StringUtf8 utf8;
+    utf8.Resize(utf32.GetSize() * 4);
+    REQUIRE(Transcode(utf32, utf8) == ErrorCode::Success);
+    REQUIRE(ValidateUtf8(ArrayView<const u8>(reinterpret_cast<const u8*>(utf8.GetData()), utf8.GetSize())));
+
+    StringUtf32 utf32_result;
+    utf32_result.Resize(utf8.GetSize());
+    REQUIRE(Transcode(utf8, utf32_result) == ErrorCode::Success);
+    REQUIRE(utf32_result == utf32);
+
+    StringWide wide;
+    wide.Resize(utf8.GetSize());
+    REQUIRE(Transcode(utf8, wide) == ErrorCode::Success);
+    // One of the inserted characters needs a surrogate pair
+    REQUIRE(wide.GetSize() == utf32.GetSize() + 1);
+
+    StringUtf8 utf8_result;
+    utf8_result.Resize(utf8.GetSize());
+    REQUIRE(Transcode(wide, utf8_result) == ErrorCode::Success);
+    REQUIRE(utf8_result == utf8);
+
+    SECTION("Output one code unit too small")
+    {
+        StringUtf8 small;
+        small.Resize(utf8.GetSize() - 1);
+        REQUIRE(Transcode(utf32, small) == ErrorCode::InsufficientSpace);
+        StringWide small_wide;
+        small_wide.Resize(wide.GetSize() - 1);
+        REQUIRE(Transcode(utf8, small_wide) == ErrorCode::InsufficientSpace);
+    }
+}
+
+TEST_CASE("Transcode rejects malformed input", "[String]")
+{
+    SECTION("Overlong UTF-8")
+    {
+        StringUtf8 utf8("abc");
+        utf8 += static_cast<char8>(0xC0);
+        utf8 += static_cast<char8>(0x80);
+        StringUtf32 utf32;
+        utf32.Resize(10);
+        REQUIRE(Transcode(utf8, utf32) == ErrorCode::InvalidArgument);
+    }
+    SECTION("Truncated UTF-8")
+    {
+        StringUtf8 utf8("abc");
+        utf8 += static_cast<char8>(0xE6);
+        StringWide wide;
+        wide.Resize(10);
+        REQUIRE(Transcode(utf8, wide) == ErrorCode::IncompleteSequence);
+    }
+    SECTION("Unpaired surrogates in UTF-16")
+    {
+        StringWide wide;
+        wide += static_cast<char16>(0xDC00);
+        StringUtf8 utf8;
+        utf8.Resize(10);
+        REQUIRE(Transcode(wide, utf8) == ErrorCode::InvalidArgument);
+
+        StringWide truncated;
+        truncated += static_cast<char16>(0xD800);
+        REQUIRE(Transcode(truncated, utf8) == ErrorCode::IncompleteSequence);
+    }
+    SECTION("Code points out of range in UTF-32")
+    {
+        StringUtf8 utf8;
+        utf8.Resize(10);
+        StringUtf32 surrogate;
+        surrogate += static_cast<uchar32>(0xD800);
+        REQUIRE(Transcode(surrogate, utf8) == ErrorCode::InvalidArgument);
+        StringUtf32 too_large;
+        too_large += static_cast<uchar32>(0x110000);
+        REQUIRE(Transcode(too_large, utf8) == ErrorCode::InvalidArgument);
+    }
+}
+
 TEST_CASE("Lexicographical compare", "[String]")
 {
     SECTION("Two strings")
@@ -3921,6 +4057,27 @@ TEST_CASE("Make string from floating point", "[String]")
         REQUIRE(NumberToString(val, 1) == "2.3");
         REQUIRE(NumberToString(val, 0) == "2");
     }
+    SECTION("Large values and rounding")
+    {
+        REQUIRE(NumberToString(-0.125, 2) == "-0.12");
+        REQUIRE(NumberToString(1e300).GetSize() == 301 + 7);
+        REQUIRE(NumberToString(std::numeric_limits<f64>::lowest(), 0).GetSize() == 310);
+    }
+    SECTION("Independent of the locale")
+    {
+        const char* previous = std::setlocale(LC_NUMERIC, nullptr);
+        const StringUtf8 saved(previous != nullptr ? previous : "C");
+        for (const char* name : {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "German_Germany.1252"})
+        {
+            if (std::setlocale(LC_NUMERIC, name) != nullptr)
+            {
+                break;
+            }
+        }
+        const StringUtf8 str = NumberToString(2.5, 1);
+        std::setlocale(LC_NUMERIC, *saved);
+        REQUIRE(str == "2.5");
+    }
 }
 
 TEST_CASE("StringToNumber signed", "[String]")
@@ -4882,3 +5039,184 @@ TEST_CASE("Clonable with user-defined constructor", "[String]")
     original.a = "Changed";
     REQUIRE(cloned.a == "Hello");
 }
+
+namespace
+{
+
+u64 NaiveFind(const StringUtf8& haystack, const StringUtf8& needle, u64 start_pos)
+{
+    for (u64 pos = start_pos; pos + needle.GetSize() <= haystack.GetSize(); ++pos)
+    {
+        if (std::memcmp(haystack.GetData() + pos, needle.GetData(), needle.GetSize()) == 0)
+        {
+            return pos;
+        }
+    }
+    return StringUtf8::k_npos;
+}
+
+u64 NaiveReverseFind(const StringUtf8& haystack, const StringUtf8& needle, u64 end_pos)
+{
+    for (u64 pos = end_pos - needle.GetSize() + 1; pos-- > 0;)
+    {
+        if (std::memcmp(haystack.GetData() + pos, needle.GetData(), needle.GetSize()) == 0)
+        {
+            return pos;
+        }
+    }
+    return StringUtf8::k_npos;
+}
+
+}  // namespace
+
+TEST_CASE("Find and ReverseFind match a naive search", "[String]")
+{
+    // Small alphabet produces many partial matches, sizes cover the vector body and the scalar tails
+    u32 state = 12345;
+    auto next_char = [&state]()
+    {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<char8>('a' + (state >> 24) % 3);
+    };
+    for (u64 size : {1ull, 15ull, 33ull, 100ull, 1000ull})
+    {
+        StringUtf8 haystack;
+        for (u64 i = 0; i < size; ++i)
+        {
+            haystack += next_char();
+        }
+        for (u64 needle_size : {1ull, 2ull, 3ull, 5ull, 31ull, 32ull, 40ull})
+        {
+            for (u64 trial = 0; trial < 8; ++trial)
+            {
+                StringUtf8 needle;
+                if (trial % 2 == 0 && needle_size <= size)
+                {
+                    // Take the needle from the haystack so there is at least one match
+                    const u64 offset = (trial * 37) % (size - needle_size + 1);
+                    needle = StringUtf8(haystack.GetData() + offset, needle_size);
+                }
+                else
+                {
+                    for (u64 i = 0; i < needle_size; ++i)
+                    {
+                        needle += next_char();
+                    }
+                }
+                const u64 start_pos = trial * size / 16;
+                REQUIRE(Find(haystack, needle, start_pos) == NaiveFind(haystack, needle, start_pos));
+                REQUIRE(Find(StringViewUtf8(haystack), StringViewUtf8(needle), start_pos) == NaiveFind(haystack, needle, start_pos));
+                const u64 end_pos = size - trial * size / 16;
+                const u64 expected_reverse = needle_size > end_pos ? StringUtf8::k_npos : NaiveReverseFind(haystack, needle, end_pos);
+                REQUIRE(ReverseFind(haystack, needle, end_pos) == expected_reverse);
+                if (needle_size == 1)
+                {
+                    REQUIRE(Find(haystack, needle[0], start_pos) == NaiveFind(haystack, needle, start_pos));
+                    const u64 expected_char = NaiveReverseFind(haystack, needle, Min(end_pos + 1, size));
+                    REQUIRE(ReverseFind(haystack, needle[0], end_pos) == expected_char);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("ReverseFind with char pointer finds a match at the end", "[String]")
+{
+    const StringUtf8 str("Hello there");
+    REQUIRE(ReverseFind(str, "there") == 6);
+    REQUIRE(ReverseFind(StringViewUtf8(str), "there") == 6);
+}
+
+TEST_CASE("Compare and Equals long strings", "[String]")
+{
+    // Differences at every position around the vector widths, including bytes that are negative as char8.
+    for (u64 size = 0; size < 80; ++size)
+    {
+        StringUtf8 a(size, 'x');
+        REQUIRE(Compare(a, StringUtf8(size, 'x')).GetValue() == 0);
+        REQUIRE(Equals(a, StringViewUtf8(StringUtf8(size, 'x'))));
+        for (u64 pos = 0; pos < size; ++pos)
+        {
+            StringUtf8 b(size, 'x');
+            b[pos] = 'y';
+            REQUIRE(Compare(a, b).GetValue() == -1);
+            REQUIRE(Compare(b, a).GetValue() == 1);
+            REQUIRE(!Equals(a, b));
+            b[pos] = static_cast<char8>(0xC3);
+            REQUIRE(Compare(a, b).GetValue() == 1);
+            REQUIRE(Compare(a, 0, StringUtf8::k_npos, b.GetData()).GetValue() == 1);
+        }
+        REQUIRE(!Equals(a, StringUtf8(size + 1, 'x')));
+    }
+}
+
+TEST_CASE("EqualsIgnoreCase", "[String]")
+{
+    SECTION("ASCII")
+    {
+        REQUIRE(EqualsIgnoreCase("", ""));
+        REQUIRE(EqualsIgnoreCase("Content-Type", "content-TYPE"));
+        REQUIRE(!EqualsIgnoreCase("Content-Type", "Content-Typ"));
+        REQUIRE(!EqualsIgnoreCase("Content-Type", "Content_Type"));
+        REQUIRE(!EqualsIgnoreCase("@[`{", "`{@["));
+        REQUIRE(EqualsIgnoreCase("THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+                                 "the quick brown fox jumps over the lazy dog 0123456789"));
+        REQUIRE(!EqualsIgnoreCase("THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789",
+                                  "the quick brown fox jumps over the lazy cat 0123456789"));
+    }
+    SECTION("Unicode")
+    {
+        REQUIRE(EqualsIgnoreCase("Straße", "STRASSE"));
+        REQUIRE(EqualsIgnoreCase("STRAẞE", "strasse"));
+        REQUIRE(EqualsIgnoreCase("ΟΔΥΣΣΕΥΣ", "ὀδυσσεύς") == false);
+        REQUIRE(EqualsIgnoreCase("ΟΔΥΣΣΕΎΣ", "οδυσσεύς"));
+        REQUIRE(EqualsIgnoreCase("ПРИВЕТ, Мир", "привет, мир"));
+        REQUIRE(EqualsIgnoreCase("K", "k"));
+        REQUIRE(EqualsIgnoreCase("ﬃ", "FFI"));
+        REQUIRE(!EqualsIgnoreCase("Straße", "STRASS"));
+        REQUIRE(!EqualsIgnoreCase("é", "e"));
+    }
+    SECTION("Invalid UTF-8 only matches itself")
+    {
+        REQUIRE(EqualsIgnoreCase("A\xFF", "a\xFF"));
+        REQUIRE(!EqualsIgnoreCase("A\xFF", "a\xFE"));
+        REQUIRE(!EqualsIgnoreCase("\xC3", "\xC3\xA9"));
+    }
+}
+
+TEST_CASE("HashIgnoreCase", "[String]")
+{
+    REQUIRE(HashIgnoreCase("Content-Type") == HashIgnoreCase("CONTENT-type"));
+    REQUIRE(HashIgnoreCase("Straße") == HashIgnoreCase("STRASSE"));
+    REQUIRE(HashIgnoreCase("K") == HashIgnoreCase("K"));
+    REQUIRE(HashIgnoreCase("Content-Type") != HashIgnoreCase("Content-Typo"));
+    REQUIRE(HashIgnoreCase("abc") != HashIgnoreCase("abc", 1));
+    REQUIRE(StringHashIgnoreCase{}(StringUtf8("ABC")) == HashIgnoreCase("abc"));
+    REQUIRE(StringEqualsIgnoreCase{}(StringUtf8("ABC"), "abc"));
+
+    // Random text with case changes and characters whose folded form has a different size.
+    const char8* pieces[][2] = {{"a", "A"}, {"z", "Z"}, {"0", "0"}, {" ", " "},     {"ß", "SS"},
+                                {"ß", "ẞ"}, {"σ", "Σ"}, {"ς", "Σ"}, {"k", "K"}, {"é", "É"},
+                                {"ж", "Ж"}, {"ﬁ", "FI"}, {"İ", "i̇"}, {"\xFF", "\xFF"}};
+    RNG rng(11);
+    for (i32 i = 0; i < 2000; ++i)
+    {
+        StringUtf8 a;
+        StringUtf8 b;
+        const u32 count = rng.RandomU32(0, 300);
+        for (u32 j = 0; j < count; ++j)
+        {
+            const u32 piece = rng.RandomU32(0, static_cast<u32>(GetArraySize(pieces)));
+            const u32 side = rng.RandomU32(0, 2);
+            a.Append(pieces[piece][side]);
+            b.Append(pieces[piece][1 - side]);
+        }
+        REQUIRE(EqualsIgnoreCase(a, b));
+        REQUIRE(HashIgnoreCase(a) == HashIgnoreCase(b));
+        if (count > 0)
+        {
+            b.Append("x");
+            REQUIRE(!EqualsIgnoreCase(a, b));
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include "test-helpers.h"
 
+#include "opal/container/dynamic-array.h"
 #include "opal/container/string-view.h"
 
 using namespace Opal;
@@ -393,3 +394,112 @@ TEST_CASE("ToString", "[StringView]")
     StringUtf8 str = view.ToString();
     REQUIRE(str == "Hello World");
 }
+
+namespace
+{
+
+template <typename RangeType>
+DynamicArray<StringViewUtf8> Collect(const RangeType& range)
+{
+    DynamicArray<StringViewUtf8> tokens;
+    for (StringViewUtf8 token : range)
+    {
+        tokens.PushBack(token);
+    }
+    return tokens;
+}
+
+bool TokensEqual(const DynamicArray<StringViewUtf8>& tokens, std::initializer_list<const char8*> expected)
+{
+    if (tokens.GetSize() != expected.size())
+    {
+        return false;
+    }
+    u64 index = 0;
+    for (const char8* value : expected)
+    {
+        if (!(tokens[index++] == StringViewUtf8(value)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("Tokenize", "[StringView]")
+{
+    SECTION("Single character")
+    {
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8("a,b,,c"), ',')), {"a", "b", "", "c"}));
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8(",a,"), ',')), {"", "a", ""}));
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8(""), ',')), {""}));
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8("abc"), ',')), {"abc"}));
+    }
+    SECTION("Skip empty tokens")
+    {
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8(",,a,,b,,"), ',', true)), {"a", "b"}));
+        REQUIRE(Collect(Tokenize(StringViewUtf8(",,,"), ',', true)).GetSize() == 0);
+        REQUIRE(Collect(Tokenize(StringViewUtf8(""), ',', true)).GetSize() == 0);
+    }
+    SECTION("Sequence")
+    {
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8("one::two:three::"), "::")), {"one", "two:three", ""}));
+        REQUIRE(TokensEqual(Collect(Tokenize(StringViewUtf8("a-b"), "")), {"a-b"}));
+    }
+    SECTION("Any of")
+    {
+        REQUIRE(TokensEqual(Collect(TokenizeAnyOf(StringViewUtf8("a b\tc\n\nd"), " \t\n")), {"a", "b", "c", "", "d"}));
+        REQUIRE(TokensEqual(Collect(TokenizeAnyOf(StringViewUtf8("a b\tc\n\nd"), " \t\n", true)), {"a", "b", "c", "d"}));
+        // Large sets use the lookup table
+        REQUIRE(TokensEqual(Collect(TokenizeAnyOf(StringViewUtf8("x0y5z9w"), "0123456789")), {"x", "y", "z", "w"}));
+    }
+    SECTION("Tokens point into the source string")
+    {
+        StringUtf8 str("key=value");
+        auto range = Tokenize(str, '=');
+        auto it = range.begin();
+        REQUIRE(it->GetData() == str.GetData());
+        ++it;
+        REQUIRE(it->GetData() == str.GetData() + 4);
+        ++it;
+        REQUIRE(it == range.end());
+    }
+    SECTION("Long input crosses vector boundaries")
+    {
+        StringUtf8 str;
+        for (i32 i = 0; i < 200; ++i)
+        {
+            str += "field";
+            str += (i % 2 == 0) ? ',' : ';';
+        }
+        u64 count = 0;
+        for (StringViewUtf8 token : TokenizeAnyOf(str, ",;", true))
+        {
+            REQUIRE(token == StringViewUtf8("field"));
+            ++count;
+        }
+        REQUIRE(count == 200);
+    }
+    SECTION("Wide strings")
+    {
+        const char16 data[] = {'a', '|', 'b'};
+        const char16 separator = '|';
+        StringViewWide wide(data, 3);
+        u64 count = 0;
+        for (StringViewWide token : Tokenize(wide, separator))
+        {
+            REQUIRE(token.GetSize() == 1);
+            ++count;
+        }
+        REQUIRE(count == 2);
+        count = 0;
+        for (StringViewWide token : TokenizeAnyOf(wide, StringViewWide(&separator, 1)))
+        {
+            (void)token;
+            ++count;
+        }
+        REQUIRE(count == 2);
+    }
+}
@@ -1,18 +1,28 @@
 #include "test-helpers.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 
 #include "opal/container/scope-ptr.h"
 #include "opal/container/shared-ptr.h"
 #include "opal/container/string.h"
 #include "opal/rng.h"
+#include "opal/threading/channel-async.h"
 #include "opal/threading/channel-mpmc.h"
 #include "opal/threading/channel-spsc.h"
 #include "opal/threading/condition-variable.h"
+#include "opal/threading/coro.h"
+#include "opal/threading/future.h"
 #include "opal/threading/signal.h"
+#include "opal/threading/spin-wait.h"
+#include "opal/threading/task-graph.h"
 #include "opal/threading/mutex.h"
+#include "opal/threading/parallel-for.h"
 #include "opal/threading/thread-pool.h"
 #include "opal/threading/thread.h"
+#include "opal/threading/work-stealing-deque.h"
+#include "opal/time.h"
 
 using namespace Opal;
 
@@ -601,6 +611,17 @@ TEST_CASE("Thread pool", "[Thread]")
     REQUIRE(value == 10);
 }
 
+TEST_CASE("Thread pool with zero thread count", "[Thread]")
+{
+    // Zero picks one worker per logical core, for the old constructors as well
+    ThreadPool pool(0);
+    REQUIRE(pool.GetThreadCount() == std::max(1u, std::thread::hardware_concurrency()));
+    i32 value = 5;
+    auto task = pool.AddFunctionTask([&value](Task::TransmitterType&) { value = 10; });
+    task->WaitForCompletion();
+    REQUIRE(value == 10);
+}
+
 TEST_CASE("Thread pool captures string", "[Thread]")
 {
     ThreadPool pool(8);
@@ -610,6 +631,1143 @@ TEST_CASE("Thread pool captures string", "[Thread]")
     REQUIRE(value == "Hello");
 }
 
+namespace
+{
+
+void SpawnTree(Task::TransmitterType& transmitter, std::atomic<i32>& counter, i32 depth)
+{
+    counter.fetch_add(1, std::memory_order_relaxed);
+    if (depth == 0)
+    {
+        return;
+    }
+    for (i32 i = 0; i < 2; ++i)
+    {
+        transmitter.Send(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(
+            nullptr, [&counter, depth](Task::TransmitterType& tx) { SpawnTree(tx, counter, depth - 1); }));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Thread pool scheduling", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    SECTION("Many external submits")
+    {
+        ThreadPool pool(4, scheduling);
+        REQUIRE(pool.GetScheduling() == scheduling);
+        std::atomic<i32> counter = 0;
+        DynamicArray<IntrusivePtr<Task>> tasks;
+        for (i32 i = 0; i < 1000; ++i)
+        {
+            tasks.PushBack(pool.AddFunctionTask([&counter](Task::TransmitterType&) { counter.fetch_add(1); }));
+        }
+        for (IntrusivePtr<Task>& task : tasks)
+        {
+            task->WaitForCompletion();
+        }
+        REQUIRE(counter.load() == 1000);
+    }
+    SECTION("Close runs tasks spawned by other tasks")
+    {
+        std::atomic<i32> counter = 0;
+        {
+            ThreadPool pool(4, scheduling, 1024);
+            pool.AddFunctionTask([&counter](Task::TransmitterType& tx) { SpawnTree(tx, counter, 10); });
+        }
+        REQUIRE(counter.load() == 2047);
+    }
+    SECTION("Parent waits for child")
+    {
+        ThreadPool pool(2, scheduling);
+        i32 value = 0;
+        auto parent = pool.AddFunctionTask(
+            [&value](Task::TransmitterType& tx)
+            {
+                IntrusivePtr<Task> child = MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(
+                    nullptr, [&value](Task::TransmitterType&) { value = 42; });
+                tx.Send(child.Clone());
+                child->WaitForCompletion();
+                value += 1;
+            });
+        parent->WaitForCompletion();
+        REQUIRE(value == 43);
+    }
+}
+
+TEST_CASE("ParallelFor", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    ThreadPool pool(4, scheduling);
+    SECTION("Every index is visited once")
+    {
+        DynamicArray<std::atomic<i32>> visits(10000);
+        ParallelFor(pool, 100, 10000, 16, [&visits](u64 index) { visits[index].fetch_add(1); });
+        i32 wrong_count = 0;
+        for (u64 i = 0; i < visits.GetSize(); ++i)
+        {
+            wrong_count += visits[i].load() != (i >= 100 ? 1 : 0) ? 1 : 0;
+        }
+        REQUIRE(wrong_count == 0);
+    }
+    SECTION("Chunks respect the grain")
+    {
+        std::atomic<u64> total = 0;
+        std::atomic<u64> small_chunk_count = 0;
+        ParallelFor(pool, 0, 100000, 64,
+                    [&](u64 first, u64 last)
+                    {
+                        total.fetch_add(last - first);
+                        // Only the last chunk of the range can be smaller than the grain
+                        small_chunk_count.fetch_add(last - first < 64 && last != 100000 ? 1 : 0);
+                    });
+        REQUIRE(total.load() == 100000);
+        REQUIRE(small_chunk_count.load() == 0);
+    }
+    SECTION("Small and empty ranges run on the calling thread")
+    {
+        i32 calls = 0;
+        ParallelFor(pool, 5, 5, 1, [&calls](u64) { ++calls; });
+        REQUIRE(calls == 0);
+        ParallelFor(pool, 0, 10, 100, [&calls](u64) { ++calls; });
+        REQUIRE(calls == 10);
+    }
+    SECTION("Exception is rethrown on the caller")
+    {
+        std::atomic<u64> visited = 0;
+        REQUIRE_THROWS_AS(ParallelFor(pool, 0, 100000, 10,
+                                      [&visited](u64 index)
+                                      {
+                                          visited.fetch_add(1);
+                                          if (index == 500)
+                                          {
+                                              throw OutOfBoundsException(index, u64{0}, u64{500});
+                                          }
+                                      }),
+                          OutOfBoundsException);
+        REQUIRE(visited.load() <= 100000);
+        // The pool keeps working after a task threw
+        i32 value = 0;
+        pool.AddFunctionTask([&value](Task::TransmitterType&) { value = 1; })->WaitForCompletion();
+        REQUIRE(value == 1);
+    }
+    SECTION("Nested loops inside tasks")
+    {
+        std::atomic<u64> total = 0;
+        ParallelFor(pool, 0, 8, 1, [&](u64) { ParallelFor(pool, 0, 1000, 10, [&total](u64) { total.fetch_add(1); }); });
+        REQUIRE(total.load() == 8000);
+    }
+}
+
+TEST_CASE("ParallelForEach and ParallelReduce", "[Thread]")
+{
+    ThreadPool pool(4, ThreadPoolScheduling::WorkStealing);
+    DynamicArray<i64> values(50000);
+    for (u64 i = 0; i < values.GetSize(); ++i)
+    {
+        values[i] = static_cast<i64>(i);
+    }
+    SECTION("ForEach")
+    {
+        ParallelForEach(pool, ArrayView<i64>(values), [](i64& value) { value *= 2; });
+        REQUIRE(values[0] == 0);
+        REQUIRE(values[49999] == 99998);
+        REQUIRE(ParallelReduce(pool, ArrayView<const i64>(values), i64{0}, [](i64 a, i64 b) { return a + b; }) == 2499950000);
+    }
+    SECTION("Reduce")
+    {
+        const i64 sum = ParallelReduce(pool, ArrayView<i64>(values), i64{0}, [](i64 a, i64 b) { return a + b; }, 100);
+        REQUIRE(sum == 1249975000);
+        const i64 max = ParallelReduce(pool, ArrayView<i64>(values), i64{-1}, [](i64 a, i64 b) { return a > b ? a : b; });
+        REQUIRE(max == 49999);
+    }
+    SECTION("TransformReduce")
+    {
+        const u64 even_count = ParallelTransformReduce(
+            pool, ArrayView<const i64>(values), u64{0}, [](u64 a, u64 b) { return a + b; },
+            [](i64 value) { return value % 2 == 0 ? u64{1} : u64{0}; });
+        REQUIRE(even_count == 25000);
+    }
+    SECTION("Empty view returns the identity")
+    {
+        REQUIRE(ParallelReduce(pool, ArrayView<i64>(), i64{7}, [](i64 a, i64 b) { return a + b; }) == 7);
+    }
+}
+
+TEST_CASE("Task graph", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    ThreadPool pool(4, scheduling);
+    TaskGraph graph;
+    SECTION("Diamond runs in dependency order")
+    {
+        std::atomic<i32> step = 0;
+        i32 a_step = -1;
+        i32 b_step = -1;
+        i32 c_step = -1;
+        i32 d_step = -1;
+        const TaskGraph::NodeId a = graph.AddNode([&] { a_step = step.fetch_add(1); });
+        const TaskGraph::NodeId b = graph.AddContinuation(a, [&] { b_step = step.fetch_add(1); });
+        const TaskGraph::NodeId c = graph.AddContinuation(a, [&] { c_step = step.fetch_add(1); });
+        const TaskGraph::NodeId d = graph.AddNode([&] { d_step = step.fetch_add(1); });
+        graph.AddDependency(b, d);
+        graph.AddDependency(c, d);
+        REQUIRE(graph.GetNodeCount() == 4);
+        graph.Run(pool);
+        REQUIRE_FALSE(graph.IsRunning());
+        REQUIRE(a_step == 0);
+        REQUIRE(b_step > a_step);
+        REQUIRE(c_step > a_step);
+        REQUIRE(d_step == 3);
+    }
+    SECTION("Join node and many runs")
+    {
+        constexpr u32 k_stage_size = 20;
+        std::atomic<i32> first_stage_done = 0;
+        std::atomic<i32> errors = 0;
+        std::atomic<i32> second_stage_done = 0;
+        DynamicArray<TaskGraph::NodeId> first_stage;
+        for (u32 i = 0; i < k_stage_size; ++i)
+        {
+            first_stage.PushBack(graph.AddNode([&] { first_stage_done.fetch_add(1); }));
+        }
+        const TaskGraph::NodeId join = graph.AddJoinNode(ArrayView<const TaskGraph::NodeId>(first_stage));
+        for (u32 i = 0; i < k_stage_size; ++i)
+        {
+            graph.AddContinuation(join,
+                                  [&]
+                                  {
+                                      errors.fetch_add(first_stage_done.load() % static_cast<i32>(k_stage_size) != 0 ? 1 : 0);
+                                      second_stage_done.fetch_add(1);
+                                  });
+        }
+        for (i32 run = 0; run < 100; ++run)
+        {
+            graph.Run(pool);
+        }
+        REQUIRE(first_stage_done.load() == 100 * static_cast<i32>(k_stage_size));
+        REQUIRE(second_stage_done.load() == 100 * static_cast<i32>(k_stage_size));
+        REQUIRE(errors.load() == 0);
+    }
+    SECTION("Random pipeline respects every edge")
+    {
+        constexpr u32 k_node_count = 200;
+        DynamicArray<std::atomic<bool>> is_done(k_node_count);
+        DynamicArray<DynamicArray<u32>> predecessors(k_node_count);
+        std::atomic<i32> violations = 0;
+        RNG rng(7);
+        for (u32 i = 0; i < k_node_count; ++i)
+        {
+            graph.AddNode(
+                [&, i]
+                {
+                    for (const u32 predecessor : predecessors[i])
+                    {
+                        violations.fetch_add(is_done[predecessor].load() ? 0 : 1);
+                    }
+                    is_done[i].store(true);
+                });
+            for (u32 edge = 0; i > 0 && edge < 3; ++edge)
+            {
+                const u32 predecessor = rng.RandomU32(0, i);
+                predecessors[i].PushBack(predecessor);
+                graph.AddDependency(predecessor, i);
+            }
+        }
+        for (i32 run = 0; run < 10; ++run)
+        {
+            for (std::atomic<bool>& flag : is_done)
+            {
+                flag.store(false);
+            }
+            graph.Submit(pool);
+            graph.Wait();
+        }
+        REQUIRE(violations.load() == 0);
+    }
+    SECTION("Exception skips the rest and is rethrown")
+    {
+        bool continuation_ran = false;
+        const TaskGraph::NodeId a = graph.AddNode([] { throw InvalidArgumentException("Test", "Failed"); });
+        graph.AddContinuation(a, [&continuation_ran] { continuation_ran = true; });
+        REQUIRE_THROWS_AS(graph.Run(pool), InvalidArgumentException);
+        REQUIRE_FALSE(continuation_ran);
+        REQUIRE_THROWS_AS(graph.Run(pool), InvalidArgumentException);
+    }
+    SECTION("Cycles and unknown nodes are rejected")
+    {
+        const TaskGraph::NodeId a = graph.AddNode([] {});
+        const TaskGraph::NodeId b = graph.AddContinuation(a, [] {});
+        REQUIRE_THROWS_AS(graph.AddDependency(a, 5), OutOfBoundsException);
+        graph.AddDependency(b, a);
+        REQUIRE_THROWS_AS(graph.Submit(pool), InvalidArgumentException);
+        graph.Clear();
+        REQUIRE(graph.GetNodeCount() == 0);
+        graph.Run(pool);
+    }
+}
+
+TEST_CASE("Thread pool task exception", "[Thread]")
+{
+    ThreadPool pool(1);
+    auto failing = pool.AddFunctionTask([](Task::TransmitterType&) { throw InvalidArgumentException("Test", "Failed"); });
+    failing->WaitForCompletion();
+    REQUIRE(failing->GetException() != nullptr);
+    REQUIRE_THROWS_AS(std::rethrow_exception(failing->GetException()), InvalidArgumentException);
+    // The only worker survived
+    auto task = pool.AddFunctionTask([](Task::TransmitterType&) {});
+    task->WaitForCompletion();
+    REQUIRE(task->GetException() == nullptr);
+}
+
+TEST_CASE("Thread pool rejects tasks after Close", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    ThreadPool pool(ThreadPoolDesc{.thread_count = 2, .scheduling = scheduling});
+    auto before = pool.AddFunctionTask([](Task::TransmitterType&) {});
+    pool.Close();
+    REQUIRE(before->IsCompleted());
+    REQUIRE(before->GetException() == nullptr);
+
+    std::atomic<i32> run_count = 0;
+    auto count = [&run_count](Task::TransmitterType&) { run_count.fetch_add(1); };
+    DynamicArray<IntrusivePtr<Task>> tasks;
+    tasks.PushBack(pool.AddFunctionTask(count));
+    tasks.PushBack(pool.AddFunctionTask(count, TaskPriority::High));
+    tasks.PushBack(pool.AddFunctionTaskWithDeadline(count, GetMilliSeconds()));
+    tasks.PushBack(pool.AddFunctionTaskAt(count, GetMilliSeconds() + 10'000.0));
+    for (IntrusivePtr<Task>& task : tasks)
+    {
+        // Completes right away instead of waiting for a worker that is gone
+        task->WaitForCompletion();
+        REQUIRE(task->GetException() != nullptr);
+        REQUIRE_THROWS_AS(std::rethrow_exception(task->GetException()), ThreadPoolClosedException);
+    }
+    REQUIRE(run_count.load() == 0);
+    pool.Close();
+}
+
+TEST_CASE("Thread pool priorities and deadlines", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    std::atomic<bool> is_gate_running = false;
+    std::atomic<bool> is_gate_open = false;
+    auto gate = [&is_gate_running, &is_gate_open](Task::TransmitterType&)
+    {
+        is_gate_running = true;
+        while (!is_gate_open)
+        {
+            std::this_thread::yield();
+        }
+    };
+    // Only touched by the single worker, and read after its last task completed
+    DynamicArray<i32> order;
+    auto record = [&order](i32 id) { return [&order, id](Task::TransmitterType&) { order.PushBack(id); }; };
+
+    SECTION("Strict priority")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .starvation_limit = 0});
+        REQUIRE(pool.GetStarvationLimit() == 0);
+        pool.AddFunctionTask(gate);
+        while (!is_gate_running)
+        {
+            std::this_thread::yield();
+        }
+        pool.AddFunctionTask(record(0), TaskPriority::Background);
+        pool.AddFunctionTask(record(1), TaskPriority::Normal);
+        pool.AddFunctionTaskWithDeadline(record(2), 30.0);
+        pool.AddFunctionTaskWithDeadline(record(3), 10.0);
+        pool.AddFunctionTaskWithDeadline(record(4), 20.0);
+        pool.AddFunctionTaskWithDeadline(record(5), 10.0);
+        pool.AddFunctionTask(record(6), TaskPriority::High);
+        pool.AddFunctionTaskWithDeadline(record(7), 50.0, TaskPriority::Background);
+        is_gate_open = true;
+        pool.Close();
+        REQUIRE(order == DynamicArray<i32>{6, 3, 5, 4, 2, 1, 7, 0});
+    }
+    SECTION("Starvation limit lets background tasks through")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .starvation_limit = 3});
+        pool.AddFunctionTask(gate);
+        while (!is_gate_running)
+        {
+            std::this_thread::yield();
+        }
+        pool.AddFunctionTask(record(0), TaskPriority::Background);
+        for (i32 i = 1; i <= 8; ++i)
+        {
+            pool.AddFunctionTask(record(i), TaskPriority::High);
+        }
+        is_gate_open = true;
+        pool.Close();
+        REQUIRE(order.GetSize() == 9);
+        const u64 background_position = static_cast<u64>(std::find(order.begin(), order.end(), 0) - order.begin());
+        REQUIRE(background_position < 3);
+        // The high priority tasks keep their order
+        for (u64 i = 0, expected = 1; i < order.GetSize(); ++i)
+        {
+            if (i != background_position)
+            {
+                REQUIRE(order[i] == static_cast<i32>(expected++));
+            }
+        }
+    }
+    SECTION("Starvation limit of one alternates instead of inverting priorities")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .starvation_limit = 1});
+        REQUIRE(pool.GetStarvationLimit() == 2);
+        pool.AddFunctionTask(gate);
+        while (!is_gate_running)
+        {
+            std::this_thread::yield();
+        }
+        pool.AddFunctionTask(record(0), TaskPriority::Background);
+        pool.AddFunctionTask(record(9), TaskPriority::Background);
+        for (i32 i = 1; i <= 4; ++i)
+        {
+            pool.AddFunctionTask(record(i), TaskPriority::High);
+        }
+        is_gate_open = true;
+        pool.Close();
+        // The gate was a highest first pick, so the lowest lane goes next
+        REQUIRE(order == DynamicArray<i32>{0, 1, 9, 2, 3, 4});
+    }
+    SECTION("Non-blocking submission overflows full lanes")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .channel_capacity = 2});
+        pool.AddFunctionTask(gate);
+        while (!is_gate_running)
+        {
+            std::this_thread::yield();
+        }
+        // The lane holds two tasks, AddTask would wait for the blocked worker here
+        for (i32 i = 0; i < 6; ++i)
+        {
+            pool.AddTaskNonBlocking(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(nullptr, record(i)));
+        }
+        pool.AddTaskNonBlocking(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(nullptr, record(6)),
+                                TaskPriority::High);
+        is_gate_open = true;
+        pool.Close();
+        REQUIRE(order == DynamicArray<i32>{6, 0, 1, 2, 3, 4, 5});
+    }
+    SECTION("Tasks spawned from a worker")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .starvation_limit = 0});
+        auto parent = pool.AddFunctionTask(
+            [&record](Task::TransmitterType& tx)
+            {
+                tx.Send(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(nullptr, record(0)),
+                        TaskPriority::Background);
+                tx.Send(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(nullptr, record(1)));
+                tx.Send(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(nullptr, record(2)),
+                        TaskPriority::High);
+            });
+        parent->WaitForCompletion();
+        pool.Close();
+        REQUIRE(order == DynamicArray<i32>{2, 1, 0});
+    }
+}
+
+TEST_CASE("CPU info", "[Thread]")
+{
+    const CpuInfo info = GetCpuInfo();
+    REQUIRE(info.logical_cores_count > 0);
+    REQUIRE_FALSE(info.physical_processors.IsEmpty());
+    const u64 bit_count = info.physical_processors[0].logical_cores.GetSize();
+
+    // Every logical core belongs to exactly one physical core
+    DynamicBitSet logical_cores(bit_count);
+    u64 logical_core_count = 0;
+    for (u64 i = 0; i < info.physical_processors.GetSize(); ++i)
+    {
+        const PhysicalCoreInfo& core = info.physical_processors[i];
+        REQUIRE(core.id == i);
+        REQUIRE(core.logical_cores.GetSize() == bit_count);
+        REQUIRE(core.logical_cores.Any());
+        REQUIRE(core.is_hyperthreaded == (core.logical_cores.PopCount() > 1));
+        DynamicBitSet overlap = core.logical_cores.Clone();
+        REQUIRE(overlap.And(logical_cores).None());
+        logical_cores.Or(core.logical_cores);
+        logical_core_count += core.logical_cores.PopCount();
+        if (i > 0)
+        {
+            REQUIRE(info.physical_processors[i - 1].package_id <= core.package_id);
+        }
+    }
+    REQUIRE(logical_core_count == info.logical_cores_count);
+
+    for (u64 i = 0; i < info.caches.GetSize(); ++i)
+    {
+        const CacheInfo& cache = info.caches[i];
+        REQUIRE(cache.level > 0);
+        REQUIRE(cache.size > 0);
+        REQUIRE(cache.line_size > 0);
+        REQUIRE(cache.shared_logical_cores.GetSize() == bit_count);
+        REQUIRE(cache.shared_logical_cores.Any());
+        if (i > 0)
+        {
+            REQUIRE(info.caches[i - 1].level <= cache.level);
+        }
+    }
+    if (!info.caches.IsEmpty())
+    {
+        const u32 first_core = static_cast<u32>(logical_cores.FindFirstSet());
+        const CacheInfo* l1 = info.FindDataCache(1, first_core);
+        REQUIRE(l1 != nullptr);
+        REQUIRE(l1->type != CacheType::Instruction);
+        REQUIRE(l1->shared_logical_cores.Test(first_core));
+    }
+    REQUIRE(info.FindDataCache(100) == nullptr);
+
+    // Every logical core is local to a NUMA node
+    REQUIRE_FALSE(info.numa_nodes.IsEmpty());
+    DynamicBitSet numa_cores(bit_count);
+    for (const NumaNodeInfo& node : info.numa_nodes)
+    {
+        REQUIRE(node.logical_cores.GetSize() == bit_count);
+        numa_cores.Or(node.logical_cores);
+    }
+    REQUIRE(numa_cores.And(logical_cores) == logical_cores);
+}
+
+TEST_CASE("Thread pool pinning", "[Thread]")
+{
+    SECTION("Placement")
+    {
+        // Two packages with two cores each and two logical cores per core, numbered the way Linux does it
+        CpuInfo info;
+        info.logical_cores_count = 8;
+        auto add_core = [&info](u32 package_id, u32 first, u32 second)
+        {
+            PhysicalCoreInfo core;
+            core.id = static_cast<u32>(info.physical_processors.GetSize());
+            core.package_id = package_id;
+            core.logical_cores.Resize(8);
+            core.logical_cores.Set(first);
+            core.logical_cores.Set(second);
+            core.is_hyperthreaded = true;
+            info.physical_processors.PushBack(std::move(core));
+        };
+        add_core(1, 2, 6);
+        add_core(0, 0, 4);
+        add_core(1, 3, 7);
+        add_core(0, 1, 5);
+
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::None, 4).IsEmpty());
+        REQUIRE(GetThreadPoolPlacement(CpuInfo{}, ThreadPoolPinning::Compact, 4).IsEmpty());
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::PhysicalCores, 0) == DynamicArray<u32>{0, 1, 2, 3});
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::LogicalCores, 0) == DynamicArray<u32>{0, 1, 2, 3, 4, 5, 6, 7});
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::Compact, 0) == DynamicArray<u32>{0, 4, 1, 5, 2, 6, 3, 7});
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::Scatter, 0) == DynamicArray<u32>{0, 2, 1, 3, 4, 6, 5, 7});
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::Scatter, 3) == DynamicArray<u32>{0, 2, 1});
+        REQUIRE(GetThreadPoolPlacement(info, ThreadPoolPinning::PhysicalCores, 6) == DynamicArray<u32>{0, 1, 2, 3, 0, 1});
+    }
+    SECTION("Pinned pools run tasks")
+    {
+        const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+        const ThreadPoolPinning pinning = GENERATE(ThreadPoolPinning::None, ThreadPoolPinning::PhysicalCores,
+                                                   ThreadPoolPinning::LogicalCores, ThreadPoolPinning::Compact,
+                                                   ThreadPoolPinning::Scatter);
+        const DynamicArray<u32> placement = GetThreadPoolPlacement(GetCpuInfo(), pinning, 3);
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 3, .scheduling = scheduling, .pinning = pinning});
+        REQUIRE(pool.GetPinning() == pinning);
+        REQUIRE(pool.GetThreadCount() == 3);
+        for (u32 i = 0; i < 3; ++i)
+        {
+            REQUIRE(pool.GetWorkerCore(i) == (placement.IsEmpty() ? ThreadPool::k_invalid_core : placement[i]));
+        }
+        REQUIRE_THROWS_AS(pool.GetWorkerCore(3), OutOfBoundsException);
+
+        std::atomic<i32> sum = 0;
+        auto parent = pool.AddFunctionTask(
+            [&sum](Task::TransmitterType& tx)
+            {
+                for (i32 i = 1; i <= 100; ++i)
+                {
+                    tx.Send(MakeIntrusive<Task, FunctionTask<std::function<void(Task::TransmitterType&)>>>(
+                        nullptr, [&sum, i](Task::TransmitterType&) { sum.fetch_add(i, std::memory_order_relaxed); }));
+                }
+            });
+        parent->WaitForCompletion();
+        pool.Close();
+        REQUIRE(sum.load() == 5050);
+    }
+    SECTION("Thread count follows the cores")
+    {
+        ThreadPool pool(ThreadPoolDesc{.pinning = ThreadPoolPinning::PhysicalCores});
+        const CpuInfo info = GetCpuInfo();
+        REQUIRE(pool.GetThreadCount() == (info.physical_processors.IsEmpty() ? std::max(1u, std::thread::hardware_concurrency())
+                                                                             : info.physical_processors.GetSize()));
+    }
+}
+
+TEST_CASE("Thread pool scratch allocator", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+
+    SECTION("Reset after each task")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 2, .scheduling = scheduling});
+        REQUIRE(pool.GetScratchReset() == ThreadPoolScratchReset::AfterEachTask);
+        std::atomic<i32> dirty_count = 0;
+        DynamicArray<IntrusivePtr<Task>> tasks;
+        for (i32 i = 0; i < 64; ++i)
+        {
+            tasks.PushBack(pool.AddFunctionTask(
+                [&dirty_count](Task::TransmitterType&)
+                {
+                    LinearAllocator* scratch = GetScratchAllocator();
+                    if (scratch->Mark() != 0)
+                    {
+                        dirty_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    void* memory = scratch->Alloc(1024, 16);
+                    std::memset(memory, 0xAB, 1024);
+                }));
+        }
+        for (IntrusivePtr<Task>& task : tasks)
+        {
+            task->WaitForCompletion();
+            REQUIRE(task->GetException() == nullptr);
+        }
+        REQUIRE(dirty_count.load() == 0);
+    }
+    SECTION("Manual reset with a scope")
+    {
+        ThreadPool pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .scratch_reset = ThreadPoolScratchReset::Manual});
+        REQUIRE(pool.GetScratchReset() == ThreadPoolScratchReset::Manual);
+        // Only touched by the single worker, and read after its last task completed
+        u64 marks[3] = {};
+        pool.AddFunctionTask(
+            [&marks](Task::TransmitterType&)
+            {
+                GetScratchAllocator()->Alloc(64, 8);
+                marks[0] = GetScratchAllocator()->Mark();
+            });
+        pool.AddFunctionTask(
+            [&marks](Task::TransmitterType&)
+            {
+                marks[1] = GetScratchAllocator()->Mark();
+                {
+                    ScratchScope scope;
+                    GetScratchAllocator()->Alloc(256, 8);
+                }
+                marks[2] = GetScratchAllocator()->Mark();
+            });
+        pool.Close();
+        REQUIRE(marks[0] >= 64);
+        REQUIRE(marks[1] == marks[0]);
+        REQUIRE(marks[2] == marks[1]);
+    }
+}
+
+TEST_CASE("Thread pool idle spinning", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    const u32 spin_count = GENERATE(0u, 1000u);
+
+    ThreadPool pool(ThreadPoolDesc{.thread_count = 2, .scheduling = scheduling, .idle_spin_wait = {.spin_count = spin_count}});
+    REQUIRE(pool.GetIdleSpinWaitPolicy().spin_count == spin_count);
+    std::atomic<i32> sum = 0;
+    for (i32 round = 0; round < 8; ++round)
+    {
+        IntrusivePtr<Task> task = pool.AddFunctionTask([&sum](Task::TransmitterType&) { sum.fetch_add(1, std::memory_order_relaxed); });
+        task->WaitForCompletion(SpinWaitPolicy{.spin_count = spin_count});
+        // Give the workers time to go idle, so the next task has to wake one up
+        using namespace std::chrono_literals;
+        std::this_thread::sleep_for(1ms);
+    }
+    REQUIRE(sum.load() == 8);
+}
+
+TEST_CASE("Future and Promise", "[Thread]")
+{
+    SECTION("Value from another thread")
+    {
+        Promise<StringUtf8> promise;
+        Future<StringUtf8> future = promise.GetFuture();
+        REQUIRE(future.IsValid());
+        REQUIRE_FALSE(future.IsReady());
+        const ThreadHandle t = CreateThread(
+            [](Promise<StringUtf8>& p)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                p.SetValue("Hello");
+            },
+            Ref(promise));
+        REQUIRE(future.Get() == "Hello");
+        REQUIRE(future.IsReady());
+        REQUIRE(future.Clone().Get() == "Hello");
+        JoinThread(t);
+        REQUIRE_THROWS_AS(promise.SetValue("Again"), PromiseAlreadySatisfiedException);
+    }
+    SECTION("Exception")
+    {
+        Promise<i32> promise;
+        Future<i32> future = promise.GetFuture();
+        promise.SetException(std::make_exception_ptr(OutOfBoundsException("Test")));
+        REQUIRE(future.HasException());
+        REQUIRE_THROWS_AS(future.Get(), OutOfBoundsException);
+    }
+    SECTION("Broken promise")
+    {
+        Future<void> future;
+        {
+            Promise<void> promise;
+            future = promise.GetFuture();
+        }
+        REQUIRE_THROWS_AS(future.Get(), BrokenPromiseException);
+    }
+}
+
+TEST_CASE("Future continuations and combinators", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    ThreadPool pool(4, scheduling);
+    SECTION("Async")
+    {
+        Future<i32> value = Async(pool, [] { return 40; });
+        Future<void> nothing = Async(pool, [] {});
+        Future<i32> failure = Async(pool, []() -> i32 { throw InvalidArgumentException("Test", "Failed"); });
+        REQUIRE(value.Get() == 40);
+        nothing.Get();
+        REQUIRE_THROWS_AS(failure.Get(), InvalidArgumentException);
+    }
+    SECTION("Then")
+    {
+        Promise<i32> promise(pool.GetAllocator());
+        Future<StringUtf8> chained = promise.GetFuture()
+                                         .Then(pool, [](const i32& value) { return value + 2; })
+                                         .Then(pool, [](const i32& value) { return StringUtf8(value == 42 ? "yes" : "no"); });
+        std::atomic<i32> void_calls = 0;
+        Future<void> after_void = Async(pool, [] {}).Then(pool, [&void_calls] { void_calls.fetch_add(1); });
+        promise.SetValue(40);
+        REQUIRE(chained.Get() == "yes");
+        after_void.Get();
+        REQUIRE(void_calls.load() == 1);
+        // Continuation added to a completed future still runs
+        REQUIRE(chained.Then(pool, [](const StringUtf8& str) { return str.GetSize(); }).Get() == 3);
+    }
+    SECTION("Continuations scheduled by a worker do not block on full lane queues")
+    {
+        ThreadPool small_pool(ThreadPoolDesc{.thread_count = 1, .scheduling = scheduling, .channel_capacity = 2});
+        Promise<i32> promise(small_pool.GetAllocator());
+        DynamicArray<Future<i32>> continuations;
+        for (i32 i = 0; i < 8; ++i)
+        {
+            continuations.PushBack(promise.GetFuture().Then(small_pool, [i](const i32& value) { return value + i; }));
+        }
+        // The only worker completes the promise and submits all continuations to the lane that only it drains
+        small_pool.AddFunctionTask([&promise](Task::TransmitterType&) { promise.SetValue(10); })->WaitForCompletion();
+        i32 sum = 0;
+        for (Future<i32>& continuation : continuations)
+        {
+            sum += continuation.Get();
+        }
+        REQUIRE(sum == 108);
+    }
+    SECTION("Then propagates exceptions")
+    {
+        bool called = false;
+        Future<i32> failed = Async(pool, []() -> i32 { throw OutOfBoundsException("Test"); });
+        Future<i32> next = failed.Then(pool,
+                                       [&called](const i32& value)
+                                       {
+                                           called = true;
+                                           return value;
+                                       });
+        REQUIRE_THROWS_AS(next.Get(), OutOfBoundsException);
+        REQUIRE_FALSE(called);
+        Future<i32> throwing = Async(pool, [] { return 1; }).Then(pool, [](const i32&) -> i32 { throw InvalidArgumentException("Test", "Failed"); });
+        REQUIRE_THROWS_AS(throwing.Get(), InvalidArgumentException);
+    }
+    SECTION("WhenAll")
+    {
+        DynamicArray<Future<i32>> futures;
+        for (i32 i = 0; i < 50; ++i)
+        {
+            futures.PushBack(Async(pool, [i] { return i; }));
+        }
+        WhenAll(ArrayView<const Future<i32>>(futures)).Get();
+        i32 sum = 0;
+        for (const Future<i32>& future : futures)
+        {
+            REQUIRE(future.IsReady());
+            sum += future.Get();
+        }
+        REQUIRE(sum == 1225);
+
+        futures.PushBack(Async(pool, []() -> i32 { throw OutOfBoundsException("Test"); }));
+        REQUIRE_THROWS_AS(WhenAll(ArrayView<const Future<i32>>(futures)).Get(), OutOfBoundsException);
+        WhenAll(ArrayView<const Future<i32>>()).Get();
+    }
+    SECTION("WhenAll with inputs that fail at the same time")
+    {
+        constexpr i32 k_input_count = 8;
+        for (i32 round = 0; round < 100; ++round)
+        {
+            DynamicArray<Promise<i32>> promises;
+            DynamicArray<Future<i32>> futures;
+            for (i32 i = 0; i < k_input_count; ++i)
+            {
+                promises.PushBack(Promise<i32>(pool.GetAllocator()));
+                futures.PushBack(promises.Back().GetFuture());
+            }
+            Future<void> all = WhenAll(ArrayView<const Future<i32>>(futures));
+            std::atomic<bool> start = false;
+            DynamicArray<IntrusivePtr<Task>> tasks;
+            for (Promise<i32>& promise : promises)
+            {
+                tasks.PushBack(pool.AddFunctionTask(
+                    [&promise, &start](Task::TransmitterType&)
+                    {
+                        while (!start.load(std::memory_order_acquire))
+                        {
+                            CpuPause();
+                        }
+                        promise.SetException(std::make_exception_ptr(OutOfBoundsException("Test")));
+                    }));
+            }
+            start.store(true, std::memory_order_release);
+            REQUIRE_THROWS_AS(all.Get(), OutOfBoundsException);
+            // The promises live on this stack, so let the tasks finish with them first
+            for (IntrusivePtr<Task>& task : tasks)
+            {
+                task->WaitForCompletion();
+            }
+        }
+    }
+    SECTION("WhenAny")
+    {
+        Promise<i32> never;
+        Promise<i32> first;
+        DynamicArray<Future<i32>> futures;
+        futures.PushBack(never.GetFuture());
+        futures.PushBack(first.GetFuture());
+        Future<u64> any = WhenAny(ArrayView<const Future<i32>>(futures));
+        REQUIRE_FALSE(any.IsReady());
+        first.SetValue(5);
+        REQUIRE(any.Get() == 1);
+        never.SetValue(1);
+        REQUIRE(any.Get() == 1);
+        REQUIRE_THROWS_AS(WhenAny(ArrayView<const Future<i32>>()), InvalidArgumentException);
+    }
+}
+
+namespace
+{
+
+Coro<i32> AddOnPool(ThreadPool& pool, i32 a, i32 b)
+{
+    co_await pool.Schedule();
+    co_return a + b;
+}
+
+Coro<i32> SumOnPool(ThreadPool& pool, i32 count)
+{
+    i32 sum = 0;
+    for (i32 i = 0; i < count; ++i)
+    {
+        sum += co_await AddOnPool(pool, i, 1);
+    }
+    co_return sum;
+}
+
+Coro<std::thread::id> GetWorkerThreadId(ThreadPool& pool)
+{
+    co_await pool.Schedule(TaskPriority::High);
+    co_return std::this_thread::get_id();
+}
+
+Coro<void> ThrowOnPool(ThreadPool& pool)
+{
+    co_await pool.Schedule();
+    throw InvalidArgumentException("Coro", "Failed");
+}
+
+Coro<bool> CatchFromChild(ThreadPool& pool)
+{
+    try
+    {
+        co_await ThrowOnPool(pool);
+    }
+    catch (const InvalidArgumentException&)
+    {
+        co_return true;
+    }
+    co_return false;
+}
+
+Coro<StringUtf8> AwaitFuture(Future<StringUtf8> future)
+{
+    const StringUtf8& value = co_await future;
+    co_return value.Clone();
+}
+
+Coro<f64> SleepOnPool(ThreadPool& pool, f64 milliseconds)
+{
+    const f64 start = GetMilliSeconds();
+    co_await pool.Delay(milliseconds);
+    co_return GetMilliSeconds() - start;
+}
+
+Coro<i64> ConsumeChannel(ThreadPool& pool, ReceiverMPMC<i32>& receiver)
+{
+    i64 sum = 0;
+    while (true)
+    {
+        Expected<i32, ErrorCode> item = co_await ReceiveAsync(receiver, pool);
+        if (!item.HasValue())
+        {
+            // Catch assertions are not thread-safe, report unexpected errors through the result
+            co_return item.GetError() == ErrorCode::ChannelClosed ? sum : -1;
+        }
+        sum += item.GetValue();
+    }
+}
+
+Coro<i32> ReceiveOnce(ThreadPool& pool, ReceiverMPMC<i32>& receiver)
+{
+    Expected<i32, ErrorCode> item = co_await ReceiveAsync(receiver, pool);
+    co_return item.HasValue() ? item.GetValue() : -1;
+}
+
+Coro<i32> ReturnValue(i32 value)
+{
+    co_return value;
+}
+
+struct CountingFrameAllocator final : AllocatorBase
+{
+    CountingFrameAllocator() : AllocatorBase("CountingFrame") {}
+
+    void* Alloc(u64 size, u64 alignment) override
+    {
+        alloc_count.fetch_add(1);
+        return malloc_allocator.Alloc(size, alignment);
+    }
+    void Free(void* ptr) override
+    {
+        free_count.fetch_add(1);
+        malloc_allocator.Free(ptr);
+    }
+    [[nodiscard]] bool IsThreadSafe() const override { return true; }
+
+    MallocAllocator malloc_allocator;
+    std::atomic<i32> alloc_count = 0;
+    std::atomic<i32> free_count = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Coroutines", "[Thread]")
+{
+    const ThreadPoolScheduling scheduling = GENERATE(ThreadPoolScheduling::SharedQueue, ThreadPoolScheduling::WorkStealing);
+    ThreadPool pool(2, scheduling);
+    SECTION("Schedule and nested coroutines")
+    {
+        REQUIRE(Spawn(pool, GetWorkerThreadId(pool)).Get() != std::this_thread::get_id());
+        REQUIRE(Spawn(pool, SumOnPool(pool, 100)).Get() == 100 * 99 / 2 + 100);
+    }
+    SECTION("Exceptions")
+    {
+        REQUIRE_THROWS_AS(Spawn(pool, ThrowOnPool(pool)).Get(), InvalidArgumentException);
+        REQUIRE(Spawn(pool, CatchFromChild(pool)).Get());
+    }
+    SECTION("Await a future")
+    {
+        Promise<StringUtf8> promise;
+        Future<StringUtf8> result = Spawn(pool, AwaitFuture(promise.GetFuture()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE_FALSE(result.IsReady());
+        promise.SetValue("Hello");
+        REQUIRE(result.Get() == "Hello");
+
+        Promise<StringUtf8> ready_promise;
+        ready_promise.SetValue("Ready");
+        REQUIRE(Spawn(pool, AwaitFuture(ready_promise.GetFuture())).Get() == "Ready");
+    }
+    SECTION("Timers")
+    {
+        REQUIRE(Spawn(pool, SleepOnPool(pool, 20.0)).Get() >= 20.0);
+        // Far more sleeping coroutines than workers
+        DynamicArray<Future<f64>> sleepers;
+        for (i32 i = 0; i < 100; ++i)
+        {
+            sleepers.PushBack(Spawn(pool, SleepOnPool(pool, static_cast<f64>(i % 10))));
+        }
+        for (u64 i = 0; i < sleepers.GetSize(); ++i)
+        {
+            REQUIRE(sleepers[i].Get() >= static_cast<f64>(i % 10));
+        }
+        // Timer tasks run in the order they are due
+        ThreadPool single_pool(1, scheduling);
+        DynamicArray<i32> order;
+        const f64 now = GetMilliSeconds();
+        single_pool.AddFunctionTaskAt([&order](Task::TransmitterType&) { order.PushBack(2); }, now + 30.0);
+        single_pool.AddFunctionTaskAt([&order](Task::TransmitterType&) { order.PushBack(1); }, now + 15.0);
+        single_pool.Close();
+        REQUIRE(order == DynamicArray<i32>{1, 2});
+    }
+    SECTION("Receive from a channel")
+    {
+        ChannelMPMC<i32> channel(16);
+        // More consumers than workers, they only hold a thread while an item is processed
+        DynamicArray<Future<i64>> consumers;
+        for (i32 i = 0; i < 6; ++i)
+        {
+            consumers.PushBack(Spawn(pool, ConsumeChannel(pool, channel.receiver)));
+        }
+        const ThreadHandle producer = CreateThread(
+            [](TransmitterMPMC<i32>& tx)
+            {
+                for (i32 i = 1; i <= 5000; ++i)
+                {
+                    tx.Send(i);
+                    if (i % 1000 == 0)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    }
+                }
+                tx.Close();
+            },
+            Ref(channel.transmitter));
+        JoinThread(producer);
+        i64 sum = 0;
+        for (Future<i64>& consumer : consumers)
+        {
+            sum += consumer.Get();
+        }
+        REQUIRE(sum == 5000 * 5001 / 2);
+    }
+    SECTION("Sending on a worker does not block on full lane queues")
+    {
+        ThreadPool small_pool(ThreadPoolDesc{.thread_count = 1, .channel_capacity = 2});
+        ChannelMPMC<i32> channel(16);
+        DynamicArray<Future<i32>> receivers;
+        for (i32 i = 0; i < 8; ++i)
+        {
+            receivers.PushBack(Spawn(small_pool, ReceiveOnce(small_pool, channel.receiver)));
+        }
+        // Queued after the receivers, so they all wait on the channel when the single worker runs it. Waking them used
+        // to submit to the full lane queue that only this worker drains.
+        std::atomic<i32> sent_count = 0;
+        IntrusivePtr<Task> sender = small_pool.AddFunctionTask(
+            [&channel, &sent_count](Task::TransmitterType&)
+            {
+                for (i32 i = 1; i <= 8; ++i)
+                {
+                    if (channel.transmitter.TrySend(i))
+                    {
+                        sent_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        sender->WaitForCompletion();
+        REQUIRE(sent_count.load() == 8);
+        i32 sum = 0;
+        for (Future<i32>& receiver : receivers)
+        {
+            sum += receiver.Get();
+        }
+        REQUIRE(sum == 36);
+    }
+    SECTION("Frames use the default allocator")
+    {
+        CountingFrameAllocator allocator;
+        {
+            PushDefaultAllocator(&allocator);
+            Coro<i32> coro = ReturnValue(7);
+            PopDefaultAllocator();
+            REQUIRE(allocator.alloc_count.load() == 1);
+            REQUIRE(Spawn(pool, std::move(coro)).Get() == 7);
+        }
+        pool.Close();
+        REQUIRE(allocator.free_count.load() == 1);
+    }
+}
+
+TEST_CASE("Work-stealing deque", "[Thread]")
+{
+    SECTION("Owner pops LIFO, thieves steal FIFO")
+    {
+        WorkStealingDeque<i32> deque(4);
+        for (i32 i = 0; i < 10; ++i)
+        {
+            deque.Push(i);
+        }
+        REQUIRE(deque.GetSize() == 10);
+        REQUIRE(deque.GetCapacity() == 16);
+        i32 value = -1;
+        REQUIRE(deque.Pop(value));
+        REQUIRE(value == 9);
+        REQUIRE(deque.Steal(value));
+        REQUIRE(value == 0);
+        REQUIRE(deque.Steal(value));
+        REQUIRE(value == 1);
+        while (deque.Pop(value))
+        {
+        }
+        REQUIRE(value == 2);
+        REQUIRE(deque.IsEmpty());
+        REQUIRE_FALSE(deque.Steal(value));
+        REQUIRE_FALSE(deque.Pop(value));
+        REQUIRE(value == 2);
+    }
+    SECTION("Every item is taken exactly once")
+    {
+        constexpr i32 k_item_count = 100000;
+        constexpr i32 k_thief_count = 3;
+        WorkStealingDeque<i32> deque(8);
+        DynamicArray<std::atomic<i32>> taken(k_item_count);
+        std::atomic<bool> is_done = false;
+        DynamicArray<ThreadHandle> thieves;
+        for (i32 i = 0; i < k_thief_count; ++i)
+        {
+            thieves.PushBack(CreateThread(
+                [](WorkStealingDeque<i32>& victim, DynamicArray<std::atomic<i32>>& counts, std::atomic<bool>& should_stop)
+                {
+                    while (!should_stop.load())
+                    {
+                        i32 value = 0;
+                        if (victim.Steal(value))
+                        {
+                            counts[static_cast<u64>(value)].fetch_add(1);
+                        }
+                    }
+                },
+                Ref(deque), Ref(taken), Ref(is_done)));
+        }
+        for (i32 i = 0; i < k_item_count; ++i)
+        {
+            deque.Push(i);
+            i32 value = 0;
+            if (i % 3 == 0 && deque.Pop(value))
+            {
+                taken[static_cast<u64>(value)].fetch_add(1);
+            }
+        }
+        i32 value = 0;
+        while (deque.Pop(value))
+        {
+            taken[static_cast<u64>(value)].fetch_add(1);
+        }
+        is_done.store(true);
+        for (const ThreadHandle& thief : thieves)
+        {
+            JoinThread(thief);
+        }
+        i32 wrong_count = 0;
+        for (const std::atomic<i32>& count : taken)
+        {
+            wrong_count += count.load() != 1 ? 1 : 0;
+        }
+        REQUIRE(wrong_count == 0);
+    }
+}
+
 TEST_CASE("Signal initial state", "[Thread]")
 {
     Signal signal;
@@ -739,3 +1897,122 @@ TEST_CASE("Signal wait returns immediately when state already changed", "[Thread
     signal.Wait(0);
     REQUIRE(signal.GetState() == 1);
 }
+
+TEST_CASE("SpinWait", "[Thread]")
+{
+    SECTION("Spins until the budget is used up")
+    {
+        SpinWait spin(SpinWaitPolicy{.spin_count = 3, .max_pause_count = 4});
+        REQUIRE(spin.Spin());
+        REQUIRE(spin.Spin());
+        REQUIRE(spin.Spin());
+        REQUIRE(!spin.Spin());
+        spin.Reset();
+        REQUIRE(spin.Spin());
+    }
+    SECTION("Zero spin count never spins")
+    {
+        SpinWait spin(SpinWaitPolicy{.spin_count = 0});
+        REQUIRE(!spin.Spin());
+    }
+}
+
+TEST_CASE("SpinThenWait", "[Thread]")
+{
+    const u32 spin_count = GENERATE(0u, 10u, 100000u);
+    const SpinWaitPolicy policy{.spin_count = spin_count};
+
+    SECTION("Returns right away when the value already changed")
+    {
+        std::atomic<i32> value = 1;
+        SpinThenWait(value, 0, std::memory_order_acquire, policy);
+        REQUIRE(value.load() == 1);
+    }
+    SECTION("Woken by another thread")
+    {
+        std::atomic<i32> value = 0;
+        const ThreadHandle t = CreateThread(
+            [](std::atomic<i32>& v)
+            {
+                using namespace std::chrono_literals;
+                std::this_thread::sleep_for(20ms);
+                v.store(1, std::memory_order_release);
+                v.notify_all();
+            },
+            Ref(value));
+        SpinThenWait(value, 0, std::memory_order_acquire, policy);
+        REQUIRE(value.load() == 1);
+        JoinThread(t);
+    }
+}
+
+TEST_CASE("Signal with spin wait policy", "[Thread]")
+{
+    const u32 spin_count = GENERATE(0u, 100000u);
+    Signal signal(SpinWaitPolicy{.spin_count = spin_count});
+    REQUIRE(signal.GetSpinWaitPolicy().spin_count == spin_count);
+
+    const ThreadHandle t = CreateThread(
+        [](Signal& sig)
+        {
+            using namespace std::chrono_literals;
+            std::this_thread::sleep_for(20ms);
+            sig.NotifyOne();
+        },
+        Ref(signal));
+    signal.Wait(0);
+    REQUIRE(signal.GetState() == 1);
+    JoinThread(t);
+
+    REQUIRE(signal.WaitFor(1, 10) == false);
+
+    Signal moved(Move(signal));
+    REQUIRE(moved.GetSpinWaitPolicy().spin_count == spin_count);
+}
+
+TEST_CASE("Channels with spin wait policy", "[Thread]")
+{
+    constexpr i32 k_count = 1000;
+    const SpinWaitPolicy policy{.spin_count = GENERATE(0u, 1000u), .max_pause_count = 16};
+
+    SECTION("SPSC")
+    {
+        ChannelSPSC<i32> channel(4, nullptr, policy);
+        const ThreadHandle t = CreateThread(
+            [](TransmitterSPSC<i32> transmitter)
+            {
+                for (i32 i = 0; i < k_count; ++i)
+                {
+                    transmitter.Send(i);
+                }
+            },
+            Move(channel.transmitter));
+        i64 sum = 0;
+        for (i32 i = 0; i < k_count; ++i)
+        {
+            sum += channel.receiver.Receive().GetValue();
+        }
+        JoinThread(t);
+        REQUIRE(sum == static_cast<i64>(k_count) * (k_count - 1) / 2);
+    }
+    SECTION("MPMC")
+    {
+        ChannelMPMC<i32, true> channel(4, nullptr, policy);
+        const ThreadHandle t = CreateThread(
+            [](TransmitterMPMC<i32, true> transmitter)
+            {
+                for (i32 i = 0; i < k_count; ++i)
+                {
+                    transmitter.Send(i);
+                }
+            },
+            channel.transmitter.Clone());
+        i64 sum = 0;
+        for (i32 i = 0; i < k_count; ++i)
+        {
+            sum += channel.receiver.Receive().GetValue();
+        }
+        JoinThread(t);
+        REQUIRE(sum == static_cast<i64>(k_count) * (k_count - 1) / 2);
+    }
+}